@@ -139,6 +139,47 @@ int main( int argc, char *argv[] ) {
                         debug = 1 ;
                     }
 
+                    if ( argv[i][j] == 'f' ) {
+                        fuse_code = 0 ;
+                    }
+
+                    if ( argv[i][j] == 's' ) {
+                        fuse_stats = 1 ;
+                    }
+
+                    if ( argv[i][j] == 'p' ) {
+                        profile_mode = 1 ;
+                    }
+
+                    if ( argv[i][j] == 'P' ) {
+                        profile_mode = 1 ;
+                        if ( argv[i][j+1] == 0 ) {
+                            if ( i == argc - 1 ) {
+                                fprintf( stderr, "You must provide a file name" ) ;
+                                exit( 0 );
+                            }
+                            profile_file = argv[i+1] ;
+                            i++ ;
+                            break ;
+                        }
+                        profile_file = &argv[i][j + 1] ;
+                        break ;
+                    }
+
+                    if ( argv[i][j] == 'j' ) {
+                        if ( argv[i][j+1] == 0 ) {
+                            if ( i == argc - 1 ) {
+                                fprintf( stderr, "You must provide the number of threads" ) ;
+                                exit( 0 );
+                            }
+                            parallel_workers = atoi( argv[i+1] );
+                            i++ ;
+                            break ;
+                        }
+                        parallel_workers = atoi( &argv[i][j + 1] ) ;
+                        break ;
+                    }
+
                     if ( argv[i][j] == 'i' ) {
                         if ( argv[i][j+1] == 0 ) {
                             if ( i == argc - 1 ) {
@@ -171,6 +212,11 @@ int main( int argc, char *argv[] ) {
                     "see COPYING for details\n\n"
                     "Usage: %s [options] <data code block file>[.dcb]\n\n"
                     "   -d       Activate DEBUG mode\n"
+                    "   -f       Don't fuse instructions into superinstructions\n"
+                    "   -s       Show DCB loading and superinstruction statistics\n"
+                    "   -j n     Run pure processes in n threads\n"
+                    "   -p       Profile the bytecode, print a report on exit\n"
+                    "   -P file  Profile too, and write the folded stacks to file\n"
                     "   -i dir   Adds the directory to the PATH\n",
                     argv[0] ) ;
             return -1 ;
@@ -63,6 +63,17 @@ extern int debug ;          /* 1 if running in debug mode                    */
 /* Trace */
 extern int debug_mode;
 
+/* Superinstructions */
+extern int fuse_code;
+extern int fuse_stats;
+
+/* Worker threads for pure processes */
+extern int parallel_workers;
+
+/* Bytecode profiler */
+extern int profile_mode;
+extern char * profile_file;
+
 extern int exit_value;
 extern int must_exit;
 
@@ -81,6 +92,14 @@ extern int dcb_load_from( file * fp, const char * dcbname, int offset ) ;
 extern char * getid_name( unsigned int code );
 
 extern void mnemonic_dump( int i, int param );
+extern char * mnemonic_name( int i );
+
+extern uint64_t profile_clock();
+extern void profile_enter( INSTANCE * r );
+extern void profile_leave();
+extern void profile_instruction( INSTANCE * r, int code );
+extern void profile_sysproc( int code, uint64_t start );
+extern void profile_dump();
 
 /* --------------------------------------------------------------------------- */
 
@@ -32,14 +32,17 @@
 #include <string.h>
 #ifndef WIN32
 #include <unistd.h>
+#include <sys/mman.h>
 #else
 #include <direct.h>
 #endif
+#include <SDL.h>
 #include "bgdrtm.h"
 #include "dcb.h"
 #include "dirs.h"
 #include "files.h"
 #include "xstrings.h"
+#include "pslang.h"
 
 #define SYSPROCS_ONLY_DECLARE
 #include "sysprocs.h"
@@ -209,12 +212,228 @@ DCB_VAR * read_and_arrange_varspace( file * fp, int count )
     return vars;
 }
 
+/* ---------------------------------------------------------------------- */
+/* Mapped DCB                                                             */
+/* ---------------------------------------------------------------------- */
+
+static uint8_t * dcb_map = NULL ;   /* The mapped file, indexed by file offsets */
+
+/* ---------------------------------------------------------------------- */
+/*
+ *  FUNCTION : dcb_map_file
+ *
+ *  Map a DCB built with "bgdc -m" in memory. The code and the read-only
+ *  tables are then used in place, without reading them. The mapping is
+ *  private, so the few writes to it (the superinstructions) are copied on
+ *  write and never reach the file.
+ *
+ *  Only plain files can be mapped, and only on little endian machines,
+ *  where the DCB data doesn't need to be arranged. Everything else is
+ *  read from the file as usual.
+ *
+ *  PARAMS:
+ *      fp              DCB file, with the header already read
+ *      offset          Offset of the DCB in the file
+ *
+ *  RETURN VALUE:
+ *      Pointer to the start of the file in memory, or NULL if the DCB
+ *      can't be mapped
+ *
+ */
+
+static uint8_t * dcb_map_file( file * fp, int offset )
+{
+#if !defined(WIN32) && __BYTEORDER == __LIL_ENDIAN_ORDERING
+    int size ;
+    void * map ;
+
+    if ( fp->type != F_FILE || !( dcb.data.Flags & DCB_ALIGNED ) || ( offset & ( DCB_ALIGNMENT - 1 ) ) ) return NULL ;
+
+    size = file_size( fp ) ;
+    if ( size < offset + ( int ) dcb.data.OFilesTab ) return NULL ;
+
+    map = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno( fp->fp ), 0 ) ;
+    if ( map == MAP_FAILED ) return NULL ;
+
+    return ( uint8_t * ) map ;
+#else
+    return NULL ;
+#endif
+}
+
+/* ---------------------------------------------------------------------- */
+
+static DCB_VAR * dcb_load_vars( file * fp, int offset, int count )
+{
+    if ( dcb_map ) return ( DCB_VAR * )( dcb_map + offset ) ;
+
+    file_seek( fp, offset, SEEK_SET ) ;
+    return read_and_arrange_varspace( fp, count ) ;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Superinstructions                                                      */
+/* ---------------------------------------------------------------------- */
+
+int fuse_code  = 1 ;    /* Fuse common sequences into superinstructions */
+int fuse_stats = 0 ;    /* Print the fusion statistics after loading    */
+
+#define FUSE_MAX_LENGTH     4
+
+static struct
+{
+    int code ;
+    int length ;
+    int sequence[FUSE_MAX_LENGTH] ;
+    int count ;
+}
+superinstructions[] =
+{
+    { MN_PRIVATE_LET_CONST      , 3, { MN_PRIVATE   , MN_PUSH       , MN_LETNP                  } },
+    { MN_PRIVATE_LET_PRIVATE    , 3, { MN_PRIVATE   , MN_GET_PRIV   , MN_LETNP                  } },
+    { MN_LOCAL_LET_CONST        , 3, { MN_LOCAL     , MN_PUSH       , MN_LETNP                  } },
+    { MN_PRIVATE_ADD_CONST      , 4, { MN_PRIVATE   , MN_PUSH       , MN_VARADD , MN_POP        } },
+    { MN_PRIVATE_SUB_CONST      , 4, { MN_PRIVATE   , MN_PUSH       , MN_VARSUB , MN_POP        } },
+    { MN_LOCAL_ADD_CONST        , 4, { MN_LOCAL     , MN_PUSH       , MN_VARADD , MN_POP        } },
+    { MN_LOCAL_SUB_CONST        , 4, { MN_LOCAL     , MN_PUSH       , MN_VARSUB , MN_POP        } },
+    { MN_PRIVATE_INC            , 3, { MN_PRIVATE   , MN_INC        , MN_POP                    } },
+    { MN_PRIVATE_INC            , 3, { MN_PRIVATE   , MN_POSTINC    , MN_POP                    } },
+    { MN_PRIVATE_DEC            , 3, { MN_PRIVATE   , MN_DEC        , MN_POP                    } },
+    { MN_PRIVATE_DEC            , 3, { MN_PRIVATE   , MN_POSTDEC    , MN_POP                    } },
+    { MN_PRIVATE_EQ_JFALSE      , 4, { MN_GET_PRIV  , MN_PUSH       , MN_EQ     , MN_JFALSE     } },
+    { MN_PRIVATE_NE_JFALSE      , 4, { MN_GET_PRIV  , MN_PUSH       , MN_NE     , MN_JFALSE     } },
+    { MN_PRIVATE_GT_JFALSE      , 4, { MN_GET_PRIV  , MN_PUSH       , MN_GT     , MN_JFALSE     } },
+    { MN_PRIVATE_LT_JFALSE      , 4, { MN_GET_PRIV  , MN_PUSH       , MN_LT     , MN_JFALSE     } },
+    { MN_PRIVATE_GTE_JFALSE     , 4, { MN_GET_PRIV  , MN_PUSH       , MN_GTE    , MN_JFALSE     } },
+    { MN_PRIVATE_LTE_JFALSE     , 4, { MN_GET_PRIV  , MN_PUSH       , MN_LTE    , MN_JFALSE     } },
+    { MN_LOCAL_EQ_JFALSE        , 4, { MN_GET_LOCAL , MN_PUSH       , MN_EQ     , MN_JFALSE     } },
+    { MN_LOCAL_NE_JFALSE        , 4, { MN_GET_LOCAL , MN_PUSH       , MN_NE     , MN_JFALSE     } },
+    { MN_LOCAL_GT_JFALSE        , 4, { MN_GET_LOCAL , MN_PUSH       , MN_GT     , MN_JFALSE     } },
+    { MN_LOCAL_LT_JFALSE        , 4, { MN_GET_LOCAL , MN_PUSH       , MN_LT     , MN_JFALSE     } },
+    { MN_LOCAL_GTE_JFALSE       , 4, { MN_GET_LOCAL , MN_PUSH       , MN_GTE    , MN_JFALSE     } },
+    { MN_LOCAL_LTE_JFALSE       , 4, { MN_GET_LOCAL , MN_PUSH       , MN_LTE    , MN_JFALSE     } },
+    { 0                         , 0, { 0 } }
+} ;
+
+static int fuse_instructions = 0 ;
+static int fuse_pairs[256][256] ;
+
+/* ---------------------------------------------------------------------- */
+/*
+ *  FUNCTION : dcb_fuse_code
+ *
+ *  Replace the common instruction sequences of a process by
+ *  superinstructions. Only the first opcode of each sequence changes: the
+ *  superinstruction takes its operands from the original instructions,
+ *  that stay in place, and jumps over them. So code offsets don't move
+ *  and a jump into the middle of a sequence is still valid.
+ *
+ *  The code as it was in the DCB is kept in proc->original_code.
+ *
+ *  PARAMS:
+ *      proc            Process definition, with the code already loaded
+ *
+ *  RETURN VALUE:
+ *      Number of superinstructions created
+ *
+ */
+
+static int dcb_fuse_code( PROCDEF * proc )
+{
+    int count = proc->code_size / sizeof( int ) ;
+    int * code = proc->code ;
+    int pos, next, fused = 0 ;
+    int n, i, at ;
+
+    proc->original_code = code ;
+    if ( !fuse_code || !count ) return 0 ;
+
+    for ( pos = 0 ; pos < count ; pos = next )
+    {
+        next = pos + 1 + MN_PARAMS( code[pos] ) ;
+
+        for ( n = 0 ; superinstructions[n].code ; n++ )
+        {
+            for ( i = 0, at = pos ; i < superinstructions[n].length ; i++ )
+            {
+                if ( at >= count || code[at] != superinstructions[n].sequence[i] ) break ;
+                at += 1 + MN_PARAMS( code[at] ) ;
+            }
+            if ( i < superinstructions[n].length || at > count ) continue ;
+
+            if ( proc->original_code == code )
+            {
+                proc->original_code = ( int * ) malloc( proc->code_size ) ;
+                memcpy( proc->original_code, code, proc->code_size ) ;
+            }
+
+            code[pos] = superinstructions[n].code ;
+            superinstructions[n].count++ ;
+            fused++ ;
+            next = at ;
+            break ;
+        }
+
+        fuse_instructions++ ;
+        if ( next < count ) fuse_pairs[code[pos] & MN_MASK][code[next] & MN_MASK]++ ;
+    }
+
+    return fused ;
+}
+
+/* ---------------------------------------------------------------------- */
+/*
+ *  FUNCTION : dcb_fuse_dump
+ *
+ *  Print how many times each superinstruction was created, and the most
+ *  common instruction pairs left in the code, that would be candidates
+ *  for new superinstructions.
+ *
+ */
+
+static void dcb_fuse_dump( void )
+{
+    int n, m, i, best_a, best_b, fused = 0 ;
+
+    for ( n = 0 ; superinstructions[n].code ; n++ ) fused += superinstructions[n].count ;
+
+    printf( "Superinstructions: %d created, %d instructions after fusion\n", fused, fuse_instructions ) ;
+
+    for ( n = 0 ; superinstructions[n].code ; n++ )
+    {
+        if ( !superinstructions[n].count ) continue ;
+        printf( "    %s", mnemonic_name( superinstructions[n].code ) ) ;
+        for ( i = 0 ; i < superinstructions[n].length ; i++ ) printf( " %s", mnemonic_name( superinstructions[n].sequence[i] ) ) ;
+        printf( ": %d\n", superinstructions[n].count ) ;
+    }
+
+    printf( "Most common instruction pairs:\n" ) ;
+
+    for ( i = 0 ; i < 16 ; i++ )
+    {
+        best_a = best_b = 0 ;
+        for ( n = 0 ; n < 256 ; n++ )
+            for ( m = 0 ; m < 256 ; m++ )
+                if ( fuse_pairs[n][m] > fuse_pairs[best_a][best_b] )
+                {
+                    best_a = n ;
+                    best_b = m ;
+                }
+
+        if ( !fuse_pairs[best_a][best_b] ) break ;
+
+        printf( "    %s %s: %d\n", mnemonic_name( best_a ), mnemonic_name( best_b ), fuse_pairs[best_a][best_b] ) ;
+        fuse_pairs[best_a][best_b] = 0 ;
+    }
+}
+
 /* ---------------------------------------------------------------------- */
 
 int dcb_load_from( file * fp, const char * filename, int offset )
 {
     unsigned int n ;
     uint32_t size;
+    uint64_t start = SDL_GetPerformanceCounter() ;
 
     /* Lee el contenido del fichero */
 
@@ -240,6 +459,8 @@ int dcb_load_from( file * fp, const char * filename, int offset )
 
     ARRANGE_DWORD( &dcb.data.NSysProcsCodes );
 
+    ARRANGE_DWORD( &dcb.data.Flags );
+
     ARRANGE_DWORD( &dcb.data.OProcsTab );
     ARRANGE_DWORD( &dcb.data.OID );
     ARRANGE_DWORD( &dcb.data.OStrings );
@@ -258,9 +479,10 @@ int dcb_load_from( file * fp, const char * filename, int offset )
 
     if ( memcmp( dcb.data.Header, DCB_MAGIC, sizeof( DCB_MAGIC ) - 1 ) != 0 || dcb.data.Version != DCB_VERSION ) return 0 ;
 
+    dcb_map = dcb_map_file( fp, offset ) ;
+
     globaldata = calloc( dcb.data.SGlobal + 4, 1 ) ;
     localdata  = calloc( dcb.data.SLocal + 4, 1 ) ;
-    localstr   = ( int * ) calloc( dcb.data.NLocStrings + 4, sizeof( int ) ) ;
     dcb.proc   = ( DCB_PROC * ) calloc(( 1 + dcb.data.NProcs ), sizeof( DCB_PROC ) ) ;
     procs      = ( PROCDEF * ) calloc(( 1 + dcb.data.NProcs ), sizeof( PROCDEF ) ) ;
 
@@ -270,16 +492,27 @@ int dcb_load_from( file * fp, const char * filename, int offset )
 
     /* Recupera las zonas de datos globales */
 
-    file_seek( fp, offset + dcb.data.OGlobal, SEEK_SET ) ;
-    file_read( fp, globaldata, dcb.data.SGlobal ) ;         /* **** */
+    if ( dcb_map )
+    {
+        /* Only the data that changes is copied, the rest is used in place */
+        memcpy( globaldata, dcb_map + offset + dcb.data.OGlobal, dcb.data.SGlobal ) ;
+        memcpy( localdata, dcb_map + offset + dcb.data.OLocal, dcb.data.SLocal ) ;
+        localstr = ( int * )( dcb_map + offset + dcb.data.OLocStrings ) ;
+    }
+    else
+    {
+        file_seek( fp, offset + dcb.data.OGlobal, SEEK_SET ) ;
+        file_read( fp, globaldata, dcb.data.SGlobal ) ;         /* **** */
 
-    file_seek( fp, offset + dcb.data.OLocal, SEEK_SET ) ;
-    file_read( fp, localdata, dcb.data.SLocal ) ;           /* **** */
+        file_seek( fp, offset + dcb.data.OLocal, SEEK_SET ) ;
+        file_read( fp, localdata, dcb.data.SLocal ) ;           /* **** */
 
-    if ( dcb.data.NLocStrings )
-    {
-        file_seek( fp, offset + dcb.data.OLocStrings, SEEK_SET ) ;
-        file_readUint32A( fp, (uint32_t *)localstr, dcb.data.NLocStrings ) ;
+        localstr = ( int * ) calloc( dcb.data.NLocStrings + 4, sizeof( int ) ) ;
+        if ( dcb.data.NLocStrings )
+        {
+            file_seek( fp, offset + dcb.data.OLocStrings, SEEK_SET ) ;
+            file_readUint32A( fp, (uint32_t *)localstr, dcb.data.NLocStrings ) ;
+        }
     }
 
     file_seek( fp, offset + dcb.data.OProcsTab, SEEK_SET ) ;
@@ -325,7 +558,10 @@ int dcb_load_from( file * fp, const char * filename, int offset )
     dcb.data.OStrings += offset;
     dcb.data.OText += offset;
 
-    string_load( fp, dcb.data.OStrings, dcb.data.OText, dcb.data.NStrings, dcb.data.SText );
+    if ( dcb_map )
+        string_load_mem( ( char * )( dcb_map + dcb.data.OText ), ( uint32_t * )( dcb_map + dcb.data.OStrings ), dcb.data.NStrings );
+    else
+        string_load( fp, dcb.data.OStrings, dcb.data.OText, dcb.data.NStrings, dcb.data.SText );
 
     /* Recupera los ficheros incluídos */
 
@@ -351,7 +587,11 @@ int dcb_load_from( file * fp, const char * filename, int offset )
 
     /* Recupera los imports */
 
-    if ( dcb.data.NImports )
+    if ( dcb.data.NImports && dcb_map )
+    {
+        dcb.imports = ( uint32_t * )( dcb_map + offset + dcb.data.OImports ) ;
+    }
+    else if ( dcb.data.NImports )
     {
         dcb.imports = ( uint32_t * )calloc( dcb.data.NImports, sizeof( uint32_t ) ) ;
         file_seek( fp, offset + dcb.data.OImports, SEEK_SET ) ;
@@ -360,7 +600,11 @@ int dcb_load_from( file * fp, const char * filename, int offset )
 
     /* Recupera los datos de depurado */
 
-    if ( dcb.data.NID )
+    if ( dcb.data.NID && dcb_map )
+    {
+        dcb.id = ( DCB_ID * )( dcb_map + offset + dcb.data.OID ) ;
+    }
+    else if ( dcb.data.NID )
     {
         dcb.id = ( DCB_ID * ) calloc( dcb.data.NID, sizeof( DCB_ID ) ) ;
         file_seek( fp, offset + dcb.data.OID, SEEK_SET ) ;
@@ -373,16 +617,10 @@ int dcb_load_from( file * fp, const char * filename, int offset )
     }
 
     if ( dcb.data.NGloVars )
-    {
-        file_seek( fp, offset + dcb.data.OGloVars, SEEK_SET ) ;
-        dcb.glovar = read_and_arrange_varspace( fp, dcb.data.NGloVars );
-    }
+        dcb.glovar = dcb_load_vars( fp, offset + dcb.data.OGloVars, dcb.data.NGloVars );
 
     if ( dcb.data.NLocVars )
-    {
-        file_seek( fp, offset + dcb.data.OLocVars, SEEK_SET ) ;
-        dcb.locvar = read_and_arrange_varspace( fp, dcb.data.NLocVars );
-    }
+        dcb.locvar = dcb_load_vars( fp, offset + dcb.data.OLocVars, dcb.data.NLocVars );
 
     if ( dcb.data.NVarSpaces )
     {
@@ -401,8 +639,7 @@ int dcb_load_from( file * fp, const char * filename, int offset )
         {
             dcb.varspace_vars[n] = 0 ;
             if ( !dcb.varspace[n].NVars ) continue ;
-            file_seek( fp, offset + dcb.varspace[n].OVars, SEEK_SET ) ;
-            dcb.varspace_vars[n] = read_and_arrange_varspace( fp, dcb.varspace[n].NVars );
+            dcb.varspace_vars[n] = dcb_load_vars( fp, offset + dcb.varspace[n].OVars, dcb.varspace[n].NVars );
         }
     }
 
@@ -440,14 +677,22 @@ int dcb_load_from( file * fp, const char * filename, int offset )
         procs[n].name               = getid_name( procs[n].id ) ;
         procs[n].breakpoint         = 0;
 
-        if ( dcb.proc[n].data.SPrivate )
+        if ( dcb.proc[n].data.SPrivate && dcb_map )
+        {
+            procs[n].pridata = ( int * )( dcb_map + offset + dcb.proc[n].data.OPrivate ) ;
+        }
+        else if ( dcb.proc[n].data.SPrivate )
         {
             procs[n].pridata = ( int * )calloc( dcb.proc[n].data.SPrivate, sizeof( char ) ) ; /* El size ya esta calculado en bytes */
             file_seek( fp, offset + dcb.proc[n].data.OPrivate, SEEK_SET ) ;
             file_read( fp, procs[n].pridata, dcb.proc[n].data.SPrivate ) ;      /* *** */
         }
 
-        if ( dcb.proc[n].data.SPublic )
+        if ( dcb.proc[n].data.SPublic && dcb_map )
+        {
+            procs[n].pubdata = ( int * )( dcb_map + offset + dcb.proc[n].data.OPublic ) ;
+        }
+        else if ( dcb.proc[n].data.SPublic )
         {
             procs[n].pubdata = ( int * )calloc( dcb.proc[n].data.SPublic, sizeof( char ) ) ; /* El size ya esta calculado en bytes */
             file_seek( fp, offset + dcb.proc[n].data.OPublic, SEEK_SET ) ;
@@ -456,9 +701,16 @@ int dcb_load_from( file * fp, const char * filename, int offset )
 
         if ( dcb.proc[n].data.SCode )
         {
-            procs[n].code = ( int * ) calloc( dcb.proc[n].data.SCode, sizeof( char ) ) ; /* El size ya esta calculado en bytes */
-            file_seek( fp, offset + dcb.proc[n].data.OCode, SEEK_SET ) ;
-            file_readUint32A( fp, (uint32_t *)procs[n].code, dcb.proc[n].data.SCode / sizeof(uint32_t) ) ;
+            if ( dcb_map )
+            {
+                procs[n].code = ( int * )( dcb_map + offset + dcb.proc[n].data.OCode ) ;
+            }
+            else
+            {
+                procs[n].code = ( int * ) calloc( dcb.proc[n].data.SCode, sizeof( char ) ) ; /* El size ya esta calculado en bytes */
+                file_seek( fp, offset + dcb.proc[n].data.OCode, SEEK_SET ) ;
+                file_readUint32A( fp, (uint32_t *)procs[n].code, dcb.proc[n].data.SCode / sizeof(uint32_t) ) ;
+            }
 
             if ( dcb.proc[n].data.OExitCode )
                 procs[n].exitcode = dcb.proc[n].data.OExitCode ;
@@ -469,16 +721,26 @@ int dcb_load_from( file * fp, const char * filename, int offset )
                 procs[n].errorcode = dcb.proc[n].data.OErrorCode ;
             else
                 procs[n].errorcode = 0 ;
+
+            dcb_fuse_code( &procs[n] ) ;
         }
 
-        if ( dcb.proc[n].data.NPriStrings )
+        if ( dcb.proc[n].data.NPriStrings && dcb_map )
+        {
+            procs[n].strings = ( int * )( dcb_map + offset + dcb.proc[n].data.OPriStrings ) ;
+        }
+        else if ( dcb.proc[n].data.NPriStrings )
         {
             procs[n].strings = ( int * )calloc( dcb.proc[n].data.NPriStrings, sizeof( int ) ) ;
             file_seek( fp, offset + dcb.proc[n].data.OPriStrings, SEEK_SET ) ;
             file_readUint32A( fp, (uint32_t *)procs[n].strings, dcb.proc[n].data.NPriStrings ) ;
         }
 
-        if ( dcb.proc[n].data.NPubStrings )
+        if ( dcb.proc[n].data.NPubStrings && dcb_map )
+        {
+            procs[n].pubstrings = ( int * )( dcb_map + offset + dcb.proc[n].data.OPubStrings ) ;
+        }
+        else if ( dcb.proc[n].data.NPubStrings )
         {
             procs[n].pubstrings = ( int * )calloc( dcb.proc[n].data.NPubStrings, sizeof( int ) ) ;
             file_seek( fp, offset + dcb.proc[n].data.OPubStrings, SEEK_SET ) ;
@@ -486,16 +748,10 @@ int dcb_load_from( file * fp, const char * filename, int offset )
         }
 
         if ( dcb.proc[n].data.NPriVars )
-        {
-            file_seek( fp, offset + dcb.proc[n].data.OPriVars, SEEK_SET ) ;
-            dcb.proc[n].privar = read_and_arrange_varspace( fp, dcb.proc[n].data.NPriVars );
-        }
+            dcb.proc[n].privar = dcb_load_vars( fp, offset + dcb.proc[n].data.OPriVars, dcb.proc[n].data.NPriVars );
 
         if ( dcb.proc[n].data.NPubVars )
-        {
-            file_seek( fp, offset + dcb.proc[n].data.OPubVars, SEEK_SET ) ;
-            dcb.proc[n].pubvar = read_and_arrange_varspace( fp, dcb.proc[n].data.NPubVars );
-        }
+            dcb.proc[n].pubvar = dcb_load_vars( fp, offset + dcb.proc[n].data.OPubVars, dcb.proc[n].data.NPubVars );
     }
 
     /* Recupero tabla de fixup de sysprocs */
@@ -522,6 +778,14 @@ int dcb_load_from( file * fp, const char * filename, int offset )
 
     sysprocs_fixup();
 
+    if ( fuse_stats )
+    {
+        printf( "DCB loaded in %.3f ms (%s)\n",
+                ( SDL_GetPerformanceCounter() - start ) * 1000.0 / ( double ) SDL_GetPerformanceFrequency(),
+                dcb_map ? "mapped" : "read" ) ;
+        dcb_fuse_dump() ;
+    }
+
     mainproc = procdef_get_by_name( "MAIN" );
 
     return 1 ;
@@ -56,22 +56,163 @@
 #define HASH_INSTANCE(id)   (unsigned int)(((( uint32_t )(id)) >> 2 ) & 0x0000ffff)
 #define HASH_SIZE           65536
 
-INSTANCE ** hashed_by_id = NULL;
 INSTANCE ** hashed_by_instance = NULL;
 INSTANCE ** hashed_by_type = NULL;
 INSTANCE ** hashed_by_priority = NULL;
 
 INSTANCE * first_instance = NULL ;
 
-/* Priority lists */
+/* Priority lists. A bitmap tells which buckets are not empty, and a
+ * summary bitmap which words of it are not zero, so the scheduler goes
+ * straight from one used priority to the next one. Instances that can't
+ * run (sleeping, frozen or waiting) are parked out of the buckets until
+ * instance_status_changed() is called for them, or until a new pass over
+ * the buckets finds their STATUS changed (pid.status = ... from code). */
 
 static INSTANCE * iterator_by_priority  = NULL ;
 static int        iterator_pos          = HASH_SIZE;
 
-static int instance_maxid =  FIRST_INSTANCE_ID ;
+static uint32_t   priority_bitmap[HASH_SIZE / 32] ;
+static uint32_t   priority_summary[HASH_SIZE / 32 / 32] ;
 
-static int instance_min_actual_prio = INSTANCE_MAX_PRIORITY ;
-static int instance_max_actual_prio = INSTANCE_MIN_PRIORITY ;
+static INSTANCE * parked_instances      = NULL ;
+
+static INSTANCE ** priority_changed     = NULL ;
+static int        priority_changed_allocated = 0 ;
+
+/* Instance IDs. The lower bits of an ID are the index of its slot in
+ * the ID table, the upper ones the generation of the slot; it changes
+ * every time the slot is freed, so IDs of dead instances are detected */
+
+#define ID_INDEX_BITS       22
+#define ID_INDEX_MASK       ((1 << ID_INDEX_BITS) - 1)
+#define ID_MAX_SLOTS        (1 << ID_INDEX_BITS)
+#define ID_MAX_GENERATION   (0x7fffffff >> ID_INDEX_BITS)
+#define ID_MIN_SLOTS        65536
+
+#define ID_MAKE(gen,index)  (((gen) << ID_INDEX_BITS) | (index))
+#define ID_INDEX(id)        ((id) & ID_INDEX_MASK)
+#define ID_GENERATION(id)   (((uint32_t)(id)) >> ID_INDEX_BITS)
+
+typedef struct
+{
+    INSTANCE * instance ;
+    int generation ;
+    int next_free ;
+}
+ID_SLOT ;
+
+static ID_SLOT * id_slots           = NULL ;
+static int       id_slots_allocated = 0 ;
+static int       id_slots_used      = 0 ;
+static int       id_free_first      = -1 ;
+static int       id_free_last       = -1 ;
+
+/* Instance pool counters */
+
+int instance_created  = 0 ;
+int instance_recycled = 0 ;
+int instance_pooled   = 0 ;
+
+/* ---------------------------------------------------------------------- */
+/* Instance blocks                                                        */
+/* ---------------------------------------------------------------------- */
+
+/* Every instance lives in a single block, with its header followed by the
+ * local, private and public data and the stack. Destroyed instances are
+ * kept in a free list at their PROCDEF, as the next one of the same type
+ * needs a block of the very same size. Only the last INSTANCE_POOL_MAX
+ * blocks of each process are kept; the rest are freed */
+
+#define BLOCK_ALIGN(n)      (((n) + 7) & ~7)
+
+#define INSTANCE_POOL_MAX   256
+
+static int instance_block_size( PROCDEF * proc )
+{
+    return BLOCK_ALIGN( sizeof( INSTANCE ) ) +
+           BLOCK_ALIGN( local_size + 4 ) +
+           BLOCK_ALIGN( proc->private_size + 4 ) +
+           BLOCK_ALIGN( proc->public_size + 4 ) +
+           STACK_SIZE ;
+}
+
+/* ---------------------------------------------------------------------- */
+
+/*
+ *  FUNCTION : instance_alloc
+ *
+ *  Get a block for a new instance of the given process, taking it from
+ *  the free list if possible. The header is cleared, and the data and
+ *  stack pointers are set; their contents are left undefined.
+ *
+ *  PARAMS :
+ *      proc            Pointer to the procedure definition
+ *
+ *  RETURN VALUE :
+ *      Pointer to the new instance
+ */
+
+static INSTANCE * instance_alloc( PROCDEF * proc )
+{
+    INSTANCE * r ;
+    uint8_t * ptr ;
+
+    if ( ( r = proc->free_instances ) )
+    {
+        proc->free_instances = r->next ;
+        proc->free_count-- ;
+        instance_recycled++ ;
+        instance_pooled-- ;
+    }
+    else
+    {
+        r = ( INSTANCE * ) malloc( instance_block_size( proc ) ) ;
+        assert( r ) ;
+        instance_created++ ;
+    }
+
+    memset( r, 0, sizeof( INSTANCE ) ) ;
+
+    ptr = ( uint8_t * ) r + BLOCK_ALIGN( sizeof( INSTANCE ) ) ;
+    r->locdata = ( int * ) ptr ;    ptr += BLOCK_ALIGN( local_size + 4 ) ;
+    r->pridata = ( int * ) ptr ;    ptr += BLOCK_ALIGN( proc->private_size + 4 ) ;
+    r->pubdata = ( int * ) ptr ;    ptr += BLOCK_ALIGN( proc->public_size + 4 ) ;
+    r->stack   = ( int * ) ptr ;
+
+    return r ;
+}
+
+/* ---------------------------------------------------------------------- */
+
+/*
+ *  FUNCTION : instance_release
+ *
+ *  Return the block of a destroyed instance to the free list of its process,
+ *  or free it if the list is full
+ *
+ *  PARAMS :
+ *      r               Pointer to the instance
+ *
+ *  RETURN VALUE :
+ *      None
+ */
+
+static void instance_release( INSTANCE * r )
+{
+    PROCDEF * proc = r->proc ;
+
+    if ( proc->free_count >= INSTANCE_POOL_MAX )
+    {
+        free( r ) ;
+        return ;
+    }
+
+    r->next = proc->free_instances ;
+    proc->free_instances = r ;
+    proc->free_count++ ;
+    instance_pooled++ ;
+}
 
 /* ---------------------------------------------------------------------- */
 /* By id                                                                  */
@@ -79,15 +220,32 @@ static int instance_max_actual_prio = INSTANCE_MIN_PRIORITY ;
 
 void instance_add_to_list_by_id( INSTANCE * r, uint32_t id )
 {
-    if ( !hashed_by_id ) hashed_by_id = calloc( HASH_SIZE, sizeof( INSTANCE * ) );
-    hashed_by_id[HASH( id )] = r;
+    id_slots[ID_INDEX( id )].instance = r;
 }
 
 /* ---------------------------------------------------------------------- */
 
 void instance_remove_from_list_by_id( INSTANCE * r, uint32_t id )
 {
-    hashed_by_id[HASH( id )] = NULL;
+    int index = ID_INDEX( id ) ;
+    ID_SLOT * slot ;
+
+    if ( index >= id_slots_used ) return;
+
+    slot = &id_slots[index];
+    if ( slot->generation != ( int ) ID_GENERATION( id ) || slot->instance != r ) return;
+
+    /* Any ID pointing to this slot is stale from now on */
+
+    slot->instance = NULL;
+    if ( ++slot->generation > ID_MAX_GENERATION ) slot->generation = 1;
+
+    /* Freed slots are queued at the end, so each one is reused as late as possible */
+
+    slot->next_free = -1;
+    if ( id_free_last != -1 ) id_slots[id_free_last].next_free = index;
+    else                      id_free_first = index;
+    id_free_last = index;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -150,6 +308,46 @@ void instance_remove_from_list_by_type( INSTANCE * r, uint32_t type )
 /* By priority                                                            */
 /* ---------------------------------------------------------------------- */
 
+#ifdef __GNUC__
+#define HIGHEST_BIT(n)      (31 - __builtin_clz(n))
+#else
+static int HIGHEST_BIT( uint32_t n )
+{
+    int bit = 0 ;
+    while ( n >>= 1 ) bit++ ;
+    return bit ;
+}
+#endif
+
+/* Highest used bucket below pos, or -1 if there is none */
+
+static int priority_prev_bucket( int pos )
+{
+    uint32_t bits ;
+    int word ;
+
+    if ( --pos < 0 ) return -1;
+
+    word = pos >> 5;
+    bits = priority_bitmap[word] & ( 0xffffffff >> ( 31 - ( pos & 31 ) ) );
+    if ( bits ) return ( word << 5 ) + HIGHEST_BIT( bits );
+
+    if ( --word < 0 ) return -1;
+
+    pos = word >> 5;
+    bits = priority_summary[pos] & ( 0xffffffff >> ( 31 - ( word & 31 ) ) );
+    while ( !bits )
+    {
+        if ( --pos < 0 ) return -1;
+        bits = priority_summary[pos];
+    }
+
+    word = ( pos << 5 ) + HIGHEST_BIT( bits );
+    return ( word << 5 ) + HIGHEST_BIT( priority_bitmap[word] );
+}
+
+/* ---------------------------------------------------------------------- */
+
 void instance_add_to_list_by_priority( INSTANCE * r, int32_t priority )
 {
     unsigned int hash ;
@@ -167,8 +365,8 @@ void instance_add_to_list_by_priority( INSTANCE * r, int32_t priority )
     hashed_by_priority[hash] = r;
     r->last_priority = priority ;
 
-    if ( priority < instance_min_actual_prio ) instance_min_actual_prio = priority ;
-    if ( priority > instance_max_actual_prio ) instance_max_actual_prio = priority ;
+    priority_bitmap[hash >> 5] |= 1u << ( hash & 31 ) ;
+    priority_summary[hash >> 10] |= 1u << ( ( hash >> 5 ) & 31 ) ;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -177,6 +375,17 @@ void instance_remove_from_list_by_priority( INSTANCE * r )
 {
     unsigned int hash = HASH_PRIORITY( r->last_priority );
 
+    /* Parked instances are not in the buckets */
+
+    if ( r->parked )
+    {
+        if ( r->prev_by_priority ) r->prev_by_priority->next_by_priority = r->next_by_priority ;
+        if ( r->next_by_priority ) r->next_by_priority->prev_by_priority = r->prev_by_priority ;
+        if ( parked_instances == r ) parked_instances = r->next_by_priority ;
+        r->parked = 0 ;
+        return ;
+    }
+
     /* Update iterator_by_priority if necessary */
 
     if ( iterator_by_priority == r ) instance_next_by_priority() ;
@@ -188,18 +397,181 @@ void instance_remove_from_list_by_priority( INSTANCE * r )
 
     if ( !hashed_by_priority[hash] )
     {
-        if ( r->last_priority == instance_min_actual_prio )
-        {
-            while ( instance_min_actual_prio < instance_max_actual_prio && !hashed_by_priority[ instance_min_actual_prio + INSTANCE_NORMALIZE_PRIORITY ] )
-                    instance_min_actual_prio++;
-        }
+        priority_bitmap[hash >> 5] &= ~( 1u << ( hash & 31 ) ) ;
+        if ( !priority_bitmap[hash >> 5] ) priority_summary[hash >> 10] &= ~( 1u << ( ( hash >> 5 ) & 31 ) ) ;
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+
+/*
+ *  FUNCTION : instance_park
+ *
+ *  Moves an instance that can't run out of the priority buckets, so
+ *  the scheduler doesn't visit it again until its status changes.
+ *
+ *  PARAMS :
+ *      r               Pointer to the instance
+ *
+ *  RETURN VALUE :
+ *      None
+ */
+
+static void instance_park( INSTANCE * r )
+{
+    instance_remove_from_list_by_priority( r );
+
+    /* Its status will not change while it is parked */
+
+    LOCDWORD( r, SAVED_STATUS ) = LOCDWORD( r, STATUS );
+
+    r->prev_by_priority = NULL ;
+    r->next_by_priority = parked_instances ;
+    if ( parked_instances ) parked_instances->prev_by_priority = r ;
+    parked_instances = r ;
+    r->parked = 1 ;
+}
+
+/* ---------------------------------------------------------------------- */
+
+#define INSTANCE_CAN_RUN(s) ((s) == STATUS_RUNNING || (s) == STATUS_KILLED || (s) == STATUS_DEAD)
 
-        if ( r->last_priority == instance_max_actual_prio )
+/*
+ *  FUNCTION : instance_status_changed
+ *
+ *  Should be called after changing the STATUS of another instance, so it
+ *  is scheduled again at once if it was parked. Otherwise the change is
+ *  seen at the start of the next pass, see instance_unpark_changed().
+ *
+ *  PARAMS :
+ *      r               Pointer to the instance
+ *
+ *  RETURN VALUE :
+ *      None
+ */
+
+void instance_status_changed( INSTANCE * r )
+{
+    if ( !r->parked || !INSTANCE_CAN_RUN( LOCDWORD( r, STATUS ) ) ) return ;
+
+    instance_remove_from_list_by_priority( r );
+
+    LOCINT32( r, SAVED_PRIORITY ) = LOCINT32( r, PRIORITY );
+    instance_add_to_list_by_priority( r, LOCINT32( r, PRIORITY ) );
+}
+
+/* ---------------------------------------------------------------------- */
+
+/*
+ *  FUNCTION : instance_unpark_changed
+ *
+ *  Schedules again the parked instances whose STATUS was changed to a
+ *  runnable one without instance_status_changed(), as a store to
+ *  another process' STATUS from code does. Called before each pass,
+ *  so they still run in the same frame.
+ *
+ *  PARAMS :
+ *      None
+ *
+ *  RETURN VALUE :
+ *      None
+ */
+
+static void instance_unpark_changed()
+{
+    INSTANCE * i, * next ;
+
+    for ( i = parked_instances ; i ; i = next )
+    {
+        next = i->next_by_priority ;
+        instance_status_changed( i ) ;
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+
+/*
+ *  FUNCTION : instance_next_scheduled
+ *
+ *  Walks the scheduled (not parked) instances in priority order, without
+ *  touching the iterator used by instance_next_by_priority(). The list
+ *  must not change during the walk.
+ *
+ *  PARAMS :
+ *      i               Pointer to the previous instance, or NULL to start
+ *
+ *  RETURN VALUE :
+ *      Pointer to the next instance, or NULL at the end of the list
+ */
+
+INSTANCE * instance_next_scheduled( INSTANCE * i )
+{
+    int pos = HASH_SIZE ;
+
+    if ( !hashed_by_priority ) return NULL ;
+
+    if ( i )
+    {
+        if ( i->next_by_priority ) return i->next_by_priority ;
+        pos = HASH_PRIORITY( i->last_priority ) ;
+    }
+
+    if ( ( pos = priority_prev_bucket( pos ) ) == -1 ) return NULL ;
+
+    return hashed_by_priority[pos] ;
+}
+
+/* ---------------------------------------------------------------------- */
+
+/*
+ *  FUNCTION : instance_frame_done
+ *
+ *  Updates the frame counters and the priority of the scheduled
+ *  instances, at the end of a frame. Parked ones are not visited.
+ *
+ *  PARAMS :
+ *      None
+ *
+ *  RETURN VALUE :
+ *      None
+ */
+
+void instance_frame_done()
+{
+    INSTANCE * i ;
+    int pos = HASH_SIZE, status, n, count = 0 ;
+
+    if ( !hashed_by_priority ) return ;
+
+    while ( ( pos = priority_prev_bucket( pos ) ) != -1 )
+    {
+        for ( i = hashed_by_priority[pos]; i; i = i->next_by_priority )
         {
-            while ( instance_max_actual_prio > instance_min_actual_prio && !hashed_by_priority[ instance_max_actual_prio + INSTANCE_NORMALIZE_PRIORITY ] )
-                    instance_max_actual_prio--;
+            status = LOCDWORD( i, STATUS );
+            if ( status == STATUS_RUNNING ) LOCINT32( i, FRAME_PERCENT ) -= 100 ;
+            LOCDWORD( i, SAVED_STATUS ) = status ;
+
+            /* Moving it now would break the walk */
+
+            if ( LOCINT32( i, SAVED_PRIORITY ) != LOCINT32( i, PRIORITY ) )
+            {
+                if ( count == priority_changed_allocated )
+                {
+                    priority_changed_allocated += 256 ;
+                    priority_changed = ( INSTANCE ** ) realloc( priority_changed, priority_changed_allocated * sizeof( INSTANCE * ) );
+                    assert( priority_changed ) ;
+                }
+                priority_changed[count++] = i;
+            }
         }
     }
+
+    for ( n = 0; n < count; n++ )
+    {
+        i = priority_changed[n];
+        LOCINT32( i, SAVED_PRIORITY ) = LOCINT32( i, PRIORITY );
+        instance_dirty( i );
+    }
 }
 
 /* ---------------------------------------------------------------------- */
@@ -219,6 +591,7 @@ void instance_remove_from_list_by_priority( INSTANCE * r )
 
 void instance_dirty( INSTANCE * i )
 {
+    if ( i->parked ) return;
     instance_remove_from_list_by_priority( i );
     instance_add_to_list_by_priority( i, LOCINT32( i, PRIORITY ) );
 }
@@ -234,13 +607,20 @@ void instance_dirty( INSTANCE * i )
  *      id              Integer ID of the instance
  *
  *  RETURN VALUE :
- *      Pointer to the found instance or NULL if not found
+ *      Pointer to the found instance or NULL if not found,
+ *      or if the ID belongs to an instance already destroyed
  */
 
 INSTANCE * instance_get( int id )
 {
-    if ( !hashed_by_id || !id ) return NULL;
-    return ( hashed_by_id[HASH( id )] );
+    ID_SLOT * slot ;
+
+    if ( id < FIRST_INSTANCE_ID || ID_INDEX( id ) >= id_slots_used ) return NULL;
+
+    slot = &id_slots[ID_INDEX( id )];
+    if ( slot->generation != ( int ) ID_GENERATION( id ) ) return NULL;
+
+    return ( slot->instance );
 }
 
 /* ---------------------------------------------------------------------- */
@@ -248,7 +628,9 @@ INSTANCE * instance_get( int id )
 /*
  *  FUNCTION : instance_getid
  *
- *  Allocate and return a free instance identifier code.
+ *  Allocate and return a free instance identifier code. The slot of the
+ *  ID table stays reserved until the instance is removed from the list
+ *  by id. The table grows as needed, up to ID_MAX_SLOTS live instances.
  *
  *  PARAMS :
  *      None
@@ -260,31 +642,43 @@ INSTANCE * instance_get( int id )
 
 int instance_getid()
 {
-    int id = instance_maxid++ ;
+    ID_SLOT * slot ;
+    int index ;
 
-    if ( !hashed_by_id ) hashed_by_id = calloc( HASH_SIZE, sizeof( INSTANCE * ) );
+    /* New slots are used until the table is full, then the free ones */
 
-    if ( id <= LAST_INSTANCE_ID && !hashed_by_id[ HASH( id ) ] ) return id;
+    if ( id_slots_used == id_slots_allocated && id_free_first == -1 )
+    {
+        int count = id_slots_allocated ? id_slots_allocated * 2 : ID_MIN_SLOTS ;
+
+        if ( count > ID_MAX_SLOTS ) count = ID_MAX_SLOTS ;
+        if ( count == id_slots_allocated ) return -1;
 
-    if ( instance_maxid > LAST_INSTANCE_ID )
+        slot = ( ID_SLOT * ) realloc( id_slots, count * sizeof( ID_SLOT ) );
+        if ( !slot ) return -1;
+
+        id_slots = slot;
+        id_slots_allocated = count;
+    }
+
+    if ( id_slots_used < id_slots_allocated )
     {
-        for ( instance_maxid = FIRST_INSTANCE_ID; instance_maxid <= LAST_INSTANCE_ID; instance_maxid++ )
-        {
-            if ( !hashed_by_id[HASH( instance_maxid )] ) return instance_maxid++;
-        }
+        index = id_slots_used++;
+        slot = &id_slots[index];
+        slot->generation = 1;
     }
     else
     {
-        for ( ; instance_maxid <= LAST_INSTANCE_ID; instance_maxid++ )
-        {
-            if ( !hashed_by_id[HASH( instance_maxid )] ) return instance_maxid++;
-        }
-        for ( instance_maxid = FIRST_INSTANCE_ID; instance_maxid < id; instance_maxid++ )
-        {
-            if ( !hashed_by_id[HASH( instance_maxid )] ) return instance_maxid++;
-        }
+        index = id_free_first;
+        slot = &id_slots[index];
+        id_free_first = slot->next_free;
+        if ( id_free_first == -1 ) id_free_last = -1;
     }
-    return -1;
+
+    slot->instance = NULL;
+    slot->next_free = -1;
+
+    return ID_MAKE( slot->generation, index );
 }
 
 /* ---------------------------------------------------------------------- */
@@ -315,12 +709,8 @@ INSTANCE * instance_duplicate( INSTANCE * father )
 
     if ( ( pid = instance_getid() ) == -1 ) return NULL;
 
-    r = ( INSTANCE * ) calloc( 1, sizeof( INSTANCE ) ) ;
-    assert( r ) ;
+    r = instance_alloc( father->proc ) ;
 
-    r->pridata          = ( int * ) malloc( father->private_size + 4 ) ;
-    r->pubdata          = ( int * ) malloc( father->public_size + 4 ) ;
-    r->locdata          = ( int * ) malloc( local_size + 4 ) ;
     r->code             = father->code ;
     r->codeptr          = father->codeptr ;
     r->exitcode         = father->exitcode ;
@@ -385,7 +775,6 @@ INSTANCE * instance_duplicate( INSTANCE * father )
 
     r->called_by = NULL;
 
-    r->stack = malloc( father->stack[0] );
     memmove(r->stack, father->stack, (int)father->stack_ptr - (int)father->stack);
     r->stack_ptr = &r->stack[1];
 
@@ -425,12 +814,8 @@ INSTANCE * instance_new( PROCDEF * proc, INSTANCE * father )
 
     if ( ( pid = instance_getid() ) == -1 ) return NULL;
 
-    r = ( INSTANCE * ) calloc( 1, sizeof( INSTANCE ) ) ;
-    assert( r ) ;
+    r = instance_alloc( proc ) ;
 
-    r->pridata          = ( int * ) malloc( proc->private_size + 4 ) ;
-    r->pubdata          = ( int * ) malloc( proc->public_size + 4 ) ;
-    r->locdata          = ( int * ) malloc( local_size + 4 ) ;
     r->code             = proc->code ;
     r->codeptr          = proc->code ;
     r->exitcode         = proc->exitcode ;
@@ -501,7 +886,6 @@ INSTANCE * instance_new( PROCDEF * proc, INSTANCE * father )
 
     r->called_by = NULL;
 
-    r->stack = malloc( STACK_SIZE );
     r->stack_ptr = &r->stack[1];
     r->stack[0] = STACK_SIZE;
 
@@ -581,7 +965,7 @@ void instance_destroy_all( INSTANCE * except )
  *    - Updates any instance list, removing the given instance
  *    - Discards all local and private strings
  *    - Updates all parents local family variables
- *    - Frees any memory involved
+ *    - Returns its memory block to the free list of the process
  *
  *  PARAMS :
  *      r           Pointer to the instance
@@ -632,12 +1016,29 @@ void instance_destroy( INSTANCE * r )
     instance_remove_from_list_by_type( r, LOCDWORD( r, PROCESS_TYPE ) );
     instance_remove_from_list_by_priority( r );
 
-    if ( r->stack ) free( r->stack ) ;
+    instance_release( r ) ;
+}
+
+/* ---------------------------------------------------------------------- */
+
+/*
+ *  FUNCTION : instance_caller
+ *
+ *  Returns the instance that called the given one, if it is still alive.
+ *  The caller is checked by its PROCESS_ID, as the block of a destroyed
+ *  caller may already belong to another instance.
+ *
+ *  PARAMS :
+ *      i               Pointer to the instance
+ *
+ *  RETURN VALUE :
+ *      Pointer to the caller, or NULL if there is none
+ */
 
-    if ( r->locdata ) free( r->locdata ) ;
-    if ( r->pubdata ) free( r->pubdata ) ;
-    if ( r->pridata ) free( r->pridata ) ;
-    free( r ) ;
+INSTANCE * instance_caller( INSTANCE * r )
+{
+    if ( !r->called_by || instance_get( r->called_by_id ) != r->called_by ) return NULL ;
+    return r->called_by ;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -683,30 +1084,42 @@ int instance_exists( INSTANCE * r )
  *
  *  RETURN VALUE :
  *      Pointer to the next priority on the list or NULL
- *      if there is no more instances. The next call in this
+ *      if there is no more instances. Instances that can't
+ *      run are parked and skipped. The next call in this
  *      case will return a pointer to the first instance
  *      (the one with the lower priority)
  */
 
 INSTANCE * instance_next_by_priority()
 {
-    INSTANCE * r = iterator_by_priority ;
-
-    if ( iterator_by_priority ) iterator_by_priority = iterator_by_priority->next_by_priority;
+    INSTANCE * r ;
 
-    if ( !iterator_by_priority )
+    while ( 1 )
     {
-        if ( !hashed_by_priority ) return NULL;
+        r = iterator_by_priority ;
 
-        if ( iterator_pos < ( instance_min_actual_prio + INSTANCE_NORMALIZE_PRIORITY ) ||
-             iterator_pos > ( instance_max_actual_prio + INSTANCE_NORMALIZE_PRIORITY )
-           )
-            iterator_pos = instance_max_actual_prio + INSTANCE_NORMALIZE_PRIORITY + 1;
+        if ( iterator_by_priority ) iterator_by_priority = iterator_by_priority->next_by_priority;
 
-        while ( --iterator_pos >= ( instance_min_actual_prio + INSTANCE_NORMALIZE_PRIORITY ) && !( iterator_by_priority = hashed_by_priority[iterator_pos] ) );
-    }
+        if ( !iterator_by_priority )
+        {
+            if ( !hashed_by_priority ) return NULL;
+
+            /* After the end of the list, start again from the top */
 
-    return ( r ) ;
+            if ( !r )
+            {
+                instance_unpark_changed();
+                iterator_pos = HASH_SIZE;
+            }
+
+            if ( ( iterator_pos = priority_prev_bucket( iterator_pos ) ) != -1 )
+                iterator_by_priority = hashed_by_priority[iterator_pos];
+        }
+
+        if ( !r || INSTANCE_CAN_RUN( LOCDWORD( r, STATUS ) ) ) return ( r ) ;
+
+        instance_park( r );
+    }
 }
 
 /* ---------------------------------------------------------------------- */
@@ -0,0 +1,2042 @@
+/*
+ *  Copyright (C) 2014-2015 Joseba García Etxebarria <joseba.gar@gmail.com>
+ *  Copyright (C) 2006-2012 SplinterGU (Fenix/Bennugd)
+ *  Copyright (C) 2002-2006 Fenix Team (Fenix)
+ *  Copyright (C) 1999-2002 José Luis Cebrián Pagüe (Fenix)
+ *
+ *  This file is part of PixTudio
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty. In no event will the authors be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *     1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *
+ *     2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+/* Opcode handlers                                                        */
+/* ---------------------------------------------------------------------- */
+/*
+ * This file is not compiled on its own: it is the body of the opcode
+ * switch and interpreter.c includes it twice, once for the debug engine
+ * and once for the release one. Before each inclusion the following
+ * macros must be defined:
+ *
+ *   OP( name, value )  Last case label of each handler
+ *   NEXT               Go on with the next instruction
+ *   NEXT_CHECKED       Same, after something that may change the status
+ *                      of the instance (system functions, calls...)
+ *   BRANCH             Go on after a jump, ptr already points to the target
+ */
+
+    /* Stack manipulation */
+
+    OP( DUP, MN_DUP )
+        *r->stack_ptr = r->stack_ptr[-1] ;
+        r->stack_ptr++;
+        ptr++ ;
+        NEXT ;
+
+    OP( PUSH, MN_PUSH )
+        *r->stack_ptr++ = ptr[1] ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( POP, MN_POP )
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_INDEX:
+    case MN_INDEX | MN_UNSIGNED:
+    case MN_INDEX | MN_STRING:
+    case MN_INDEX | MN_WORD:
+    case MN_INDEX | MN_WORD | MN_UNSIGNED:
+    case MN_INDEX | MN_BYTE:
+    case MN_INDEX | MN_BYTE | MN_UNSIGNED:
+    OP( INDEX, MN_INDEX | MN_FLOAT ) /* Add float, I don't know why it was missing (SplinterGU) */
+        r->stack_ptr[-1] += ptr[1] ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( ARRAY, MN_ARRAY )
+        r->stack_ptr[-2] += ( ptr[1] * r->stack_ptr[-1] ) ;
+        r->stack_ptr-- ;
+        ptr += 2 ;
+        NEXT ;
+
+    /* Process calls */
+
+    OP( CLONE, MN_CLONE )
+        i = instance_duplicate( r ) ;
+        i->codeptr = ptr + 2 ;
+        ptr = r->code + ptr[1] ;
+        BRANCH ;
+
+    case MN_CALL:
+    OP( CALL, MN_PROC )
+    {
+        PROCDEF * proc = procdef_get( ptr[1] ) ;
+        uint32_t child_id ;
+
+        if ( !proc )
+        {
+            fprintf( stderr, "ERROR: Runtime error in %s(%d) - Unknown process\n", r->proc->name, LOCDWORD( r, PROCESS_ID ) ) ;
+            exit( 0 );
+        }
+
+        /* Process uses FRAME or locals, must create an instance */
+        i = instance_new( proc, r ) ;
+
+        assert ( i ) ;
+
+        for ( n = 0; n < proc->params; n++ )
+            PRIDWORD( i, 4 * n ) = r->stack_ptr[-proc->params+n] ;
+
+        r->stack_ptr -= proc->params ;
+
+        /* I go to waiting status (by default) */
+        LOCDWORD( r, STATUS ) |= STATUS_WAITING_MASK;
+        i->called_by    = r;
+        i->called_by_id = LOCDWORD( r, PROCESS_ID );
+        child_id        = LOCDWORD( i, PROCESS_ID );
+
+        /* Run the process/function */
+        if ( *ptr == MN_CALL )
+        {
+            r->stack[0] |= STACK_RETURN_VALUE;
+            r->stack_ptr++;
+            *r->stack_ptr = instance_go( i );
+        }
+        else
+        {
+            r->stack[0] &= ~STACK_RETURN_VALUE;
+            instance_go( i );
+        }
+
+        /* By id: the block of a finished child may be reused by another one */
+        child_is_alive = ( instance_get( child_id ) == i );
+
+        ptr += 2 ;
+
+        /* If the process is a function in a frame, save the stack and leave */
+        /* If the process/function still running, then it is in a FRAME.
+           If the process/function is running code, then it his status is RUNNING */
+        if ( child_is_alive &&
+                (
+                    (( status = LOCDWORD( r, STATUS ) ) &  STATUS_WAITING_MASK ) ||
+                    ( status & ~STATUS_WAITING_MASK ) == STATUS_FROZEN ||
+                    ( status & ~STATUS_WAITING_MASK ) == STATUS_SLEEPING
+                )
+           )
+        {
+            /* I go to sleep and return from this process/function */
+            i->called_by    = r;
+            i->called_by_id = LOCDWORD( r, PROCESS_ID );
+
+            /* Save the instruction pointer */
+            /* This instance don't run other code until the child return */
+            r->codeptr = ptr ;
+
+            /* If it don't was a CALL, then I set a flag in "len" for no return value */
+            if ( ptr[-2] == MN_CALL )
+                r->stack[0] |= STACK_RETURN_VALUE;
+            else
+                r->stack[0] &= ~STACK_RETURN_VALUE;
+
+            if ( debug_next && trace_sentence != -1 )
+            {
+                force_debug = 1;
+                debug_next = 0;
+            }
+            return 0;
+        }
+
+        /* Wake up! */
+        LOCDWORD( r, STATUS ) &= ~STATUS_WAITING_MASK;
+        if ( child_is_alive ) i->called_by = NULL;
+
+        NEXT_CHECKED ;
+    }
+
+    OP( SYSCALL, MN_SYSCALL )
+        p = sysproc_get( ptr[1] ) ;
+        if ( !p )
+        {
+            fprintf( stderr, "ERROR: Runtime error in %s(%d) - Unknown system function\n", r->proc->name, LOCDWORD( r, PROCESS_ID ) ) ;
+            exit( 0 );
+        }
+
+        r->stack_ptr -= p->params ;
+        *r->stack_ptr = ( *p->func )( r, r->stack_ptr ) ;
+        r->stack_ptr++ ;
+        ptr += 2 ;
+        NEXT_CHECKED ;
+
+    OP( SYSPROC, MN_SYSPROC )
+        p = sysproc_get( ptr[1] ) ;
+        if ( !p )
+        {
+            fprintf( stderr, "ERROR: Runtime error in %s(%d) - Unknown system process\n", r->proc->name, LOCDWORD( r, PROCESS_ID ) ) ;
+            exit( 0 );
+        }
+        r->stack_ptr -= p->params ;
+        ( *p->func )( r, r->stack_ptr ) ;
+        ptr += 2 ;
+        NEXT_CHECKED ;
+
+    /* Access to variables address */
+
+    case MN_PRIVATE:
+    case MN_PRIVATE | MN_UNSIGNED:
+    case MN_PRIVATE | MN_WORD:
+    case MN_PRIVATE | MN_BYTE:
+    case MN_PRIVATE | MN_WORD | MN_UNSIGNED:
+    case MN_PRIVATE | MN_BYTE | MN_UNSIGNED:
+    case MN_PRIVATE | MN_STRING:
+    OP( PRIVATE, MN_PRIVATE | MN_FLOAT )
+        *r->stack_ptr++ = ( uint32_t ) & PRIDWORD( r, ptr[1] );
+        ptr += 2 ;
+        NEXT ;
+
+    case MN_PUBLIC:
+    case MN_PUBLIC | MN_UNSIGNED:
+    case MN_PUBLIC | MN_WORD:
+    case MN_PUBLIC | MN_BYTE:
+    case MN_PUBLIC | MN_WORD | MN_UNSIGNED:
+    case MN_PUBLIC | MN_BYTE | MN_UNSIGNED:
+    case MN_PUBLIC | MN_STRING:
+    OP( PUBLIC, MN_PUBLIC | MN_FLOAT )
+        *r->stack_ptr++ = ( uint32_t ) & PUBDWORD( r, ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    case MN_LOCAL:
+    case MN_LOCAL | MN_UNSIGNED:
+    case MN_LOCAL | MN_WORD:
+    case MN_LOCAL | MN_BYTE:
+    case MN_LOCAL | MN_WORD | MN_UNSIGNED:
+    case MN_LOCAL | MN_BYTE | MN_UNSIGNED:
+    case MN_LOCAL | MN_STRING:
+    OP( LOCAL, MN_LOCAL | MN_FLOAT )
+        *r->stack_ptr++ = ( uint32_t ) & LOCDWORD( r, ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    case MN_GLOBAL:
+    case MN_GLOBAL | MN_UNSIGNED:
+    case MN_GLOBAL | MN_WORD:
+    case MN_GLOBAL | MN_BYTE:
+    case MN_GLOBAL | MN_WORD | MN_UNSIGNED:
+    case MN_GLOBAL | MN_BYTE | MN_UNSIGNED:
+    case MN_GLOBAL | MN_STRING:
+    OP( GLOBAL, MN_GLOBAL | MN_FLOAT )
+        *r->stack_ptr++ = ( uint32_t ) & GLODWORD( ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    case MN_REMOTE:
+    case MN_REMOTE | MN_UNSIGNED:
+    case MN_REMOTE | MN_WORD:
+    case MN_REMOTE | MN_BYTE:
+    case MN_REMOTE | MN_WORD | MN_UNSIGNED:
+    case MN_REMOTE | MN_BYTE | MN_UNSIGNED:
+    case MN_REMOTE | MN_STRING:
+    OP( REMOTE, MN_REMOTE | MN_FLOAT )
+        i = instance_get( r->stack_ptr[-1] ) ;
+        if ( !i )
+        {
+            fprintf( stderr, "ERROR: Runtime error in %s(%d) - Process %d not active\n", r->proc->name, LOCDWORD( r, PROCESS_ID ), r->stack_ptr[-1] ) ;
+            exit( 0 );
+        }
+        else
+            r->stack_ptr[-1] = ( uint32_t ) & LOCDWORD( i, ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    case MN_REMOTE_PUBLIC:
+    case MN_REMOTE_PUBLIC | MN_UNSIGNED:
+    case MN_REMOTE_PUBLIC | MN_WORD:
+    case MN_REMOTE_PUBLIC | MN_BYTE:
+    case MN_REMOTE_PUBLIC | MN_WORD | MN_UNSIGNED:
+    case MN_REMOTE_PUBLIC | MN_BYTE | MN_UNSIGNED:
+    case MN_REMOTE_PUBLIC | MN_STRING:
+    OP( REMOTE_PUBLIC, MN_REMOTE_PUBLIC | MN_FLOAT )
+        i = instance_get( r->stack_ptr[-1] ) ;
+        if ( !i )
+        {
+            fprintf( stderr, "ERROR: Runtime error in %s(%d) - Process %d not active\n", r->proc->name, LOCDWORD( r, PROCESS_ID ), r->stack_ptr[-1] ) ;
+            exit( 0 );
+        }
+        else
+            r->stack_ptr[-1] = ( uint32_t ) & PUBDWORD( i, ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    /* Access to variables DWORD type */
+
+    case MN_GET_PRIV:
+    case MN_GET_PRIV | MN_FLOAT:
+    OP( GET_PRIV, MN_GET_PRIV | MN_UNSIGNED )
+        *r->stack_ptr++ = PRIDWORD( r, ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    case MN_GET_PUBLIC:
+    case MN_GET_PUBLIC | MN_FLOAT:
+    OP( GET_PUBLIC, MN_GET_PUBLIC | MN_UNSIGNED )
+        *r->stack_ptr++ = PUBDWORD( r, ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    case MN_GET_LOCAL:
+    case MN_GET_LOCAL | MN_FLOAT:
+    OP( GET_LOCAL, MN_GET_LOCAL | MN_UNSIGNED )
+        *r->stack_ptr++ = LOCDWORD( r, ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    case MN_GET_GLOBAL:
+    case MN_GET_GLOBAL | MN_FLOAT:
+    OP( GET_GLOBAL, MN_GET_GLOBAL | MN_UNSIGNED )
+        *r->stack_ptr++ = GLODWORD( ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    case MN_GET_REMOTE:
+    case MN_GET_REMOTE | MN_FLOAT:
+    OP( GET_REMOTE, MN_GET_REMOTE | MN_UNSIGNED )
+        i = instance_get( r->stack_ptr[-1] ) ;
+        if ( !i )
+        {
+            fprintf( stderr, "ERROR: Runtime error in %s(%d) - Process %d not active\n", r->proc->name, LOCDWORD( r, PROCESS_ID ), r->stack_ptr[-1] ) ;
+            exit( 0 );
+        }
+        else
+            r->stack_ptr[-1] = LOCDWORD( i, ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    case MN_GET_REMOTE_PUBLIC:
+    case MN_GET_REMOTE_PUBLIC | MN_FLOAT:
+    OP( GET_REMOTE_PUBLIC, MN_GET_REMOTE_PUBLIC | MN_UNSIGNED )
+        i = instance_get( r->stack_ptr[-1] ) ;
+        if ( !i )
+        {
+            fprintf( stderr, "ERROR: Runtime error in %s(%d) - Process %d not active\n", r->proc->name, LOCDWORD( r, PROCESS_ID ), r->stack_ptr[-1] ) ;
+            exit( 0 );
+        }
+        else
+            r->stack_ptr[-1] = PUBDWORD( i, ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    case MN_PTR:
+    case MN_PTR | MN_UNSIGNED:
+    OP( PTR, MN_PTR | MN_FLOAT )
+        r->stack_ptr[-1] = *( int32_t * )r->stack_ptr[-1] ;
+        ptr++ ;
+        NEXT ;
+
+    /* Access to variables STRING type */
+
+    OP( PUSH_STRING, MN_PUSH | MN_STRING )
+        *r->stack_ptr++ = ptr[1];
+        string_use( r->stack_ptr[-1] );
+        ptr += 2 ;
+        NEXT ;
+
+    OP( GET_PRIV_STRING, MN_GET_PRIV | MN_STRING )
+        *r->stack_ptr++ = PRIDWORD( r, ptr[1] ) ;
+        string_use( r->stack_ptr[-1] );
+        ptr += 2 ;
+        NEXT ;
+
+    OP( GET_PUBLIC_STRING, MN_GET_PUBLIC | MN_STRING )
+        *r->stack_ptr++ = PUBDWORD( r, ptr[1] ) ;
+        string_use( r->stack_ptr[-1] );
+        ptr += 2 ;
+        NEXT ;
+
+    OP( GET_LOCAL_STRING, MN_GET_LOCAL | MN_STRING )
+        *r->stack_ptr++ = LOCDWORD( r, ptr[1] ) ;
+        string_use( r->stack_ptr[-1] );
+        ptr += 2 ;
+        NEXT ;
+
+    OP( GET_GLOBAL_STRING, MN_GET_GLOBAL | MN_STRING )
+        *r->stack_ptr++ = GLODWORD( ptr[1] ) ;
+        string_use( r->stack_ptr[-1] );
+        ptr += 2 ;
+        NEXT ;
+
+    OP( GET_REMOTE_STRING, MN_GET_REMOTE | MN_STRING )
+        i = instance_get( r->stack_ptr[-1] ) ;
+        if ( !i )
+        {
+            fprintf( stderr, "ERROR: Runtime error in %s(%d) - Process %d not active\n", r->proc->name, LOCDWORD( r, PROCESS_ID ), r->stack_ptr[-1] ) ;
+            exit( 0 );
+        }
+        else
+            r->stack_ptr[-1] = LOCDWORD( i, ptr[1] ) ;
+        string_use( r->stack_ptr[-1] );
+        ptr += 2 ;
+        NEXT ;
+
+    OP( GET_REMOTE_PUBLIC_STRING, MN_GET_REMOTE_PUBLIC | MN_STRING )
+        i = instance_get( r->stack_ptr[-1] );
+        if ( !i )
+        {
+            fprintf( stderr, "ERROR: Runtime error in %s(%d) - Process %d not active\n", r->proc->name, LOCDWORD( r, PROCESS_ID ), r->stack_ptr[-1] ) ;
+            exit( 0 );
+        }
+        else
+            r->stack_ptr[-1] = PUBDWORD( i, ptr[1] ) ;
+        string_use( r->stack_ptr[-1] );
+        ptr += 2 ;
+        NEXT ;
+
+    OP( STRING_PTR, MN_STRING | MN_PTR )
+        r->stack_ptr[-1] = *( int32_t * )r->stack_ptr[-1] ;
+        string_use( r->stack_ptr[-1] );
+        ptr++ ;
+        NEXT ;
+
+    OP( STRING_POP, MN_STRING | MN_POP )
+        string_discard( r->stack_ptr[-1] ) ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    /* Access to variables WORD type */
+
+    OP( WORD_GET_PRIV, MN_WORD | MN_GET_PRIV )
+        *r->stack_ptr++ = PRIINT16( r, ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( WORD_GET_PRIV_UNSIGNED, MN_WORD | MN_GET_PRIV | MN_UNSIGNED )
+        *r->stack_ptr++ = PRIWORD( r, ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( WORD_GET_PUBLIC, MN_WORD | MN_GET_PUBLIC )
+        *r->stack_ptr++ = PUBINT16( r, ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( WORD_GET_PUBLIC_UNSIGNED, MN_WORD | MN_GET_PUBLIC | MN_UNSIGNED )
+        *r->stack_ptr++ = PUBWORD( r, ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( WORD_GET_LOCAL, MN_WORD | MN_GET_LOCAL )
+        *r->stack_ptr++ = LOCINT16( r, ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( WORD_GET_LOCAL_UNSIGNED, MN_WORD | MN_GET_LOCAL | MN_UNSIGNED )
+        *r->stack_ptr++ = LOCWORD( r, ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( WORD_GET_GLOBAL, MN_WORD | MN_GET_GLOBAL )
+        *r->stack_ptr++ = GLOINT16( ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( WORD_GET_GLOBAL_UNSIGNED, MN_WORD | MN_GET_GLOBAL | MN_UNSIGNED )
+        *r->stack_ptr++ = GLOWORD( ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( WORD_GET_REMOTE, MN_WORD | MN_GET_REMOTE )
+        i = instance_get( r->stack_ptr[-1] ) ;
+        if ( !i )
+        {
+            fprintf( stderr, "ERROR: Runtime error in %s(%d) - Process %d not active\n", r->proc->name, LOCDWORD( r, PROCESS_ID ), r->stack_ptr[-1] ) ;
+            exit( 0 );
+        }
+        else
+            r->stack_ptr[-1] = LOCINT16( i, ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( WORD_GET_REMOTE_UNSIGNED, MN_WORD | MN_GET_REMOTE | MN_UNSIGNED )
+        i = instance_get( r->stack_ptr[-1] ) ;
+        if ( !i )
+        {
+            fprintf( stderr, "ERROR: Runtime error in %s(%d) - Process %d not active\n", r->proc->name, LOCDWORD( r, PROCESS_ID ), r->stack_ptr[-1] ) ;
+            exit( 0 );
+        }
+        else
+            r->stack_ptr[-1] = LOCWORD( i, ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( WORD_GET_REMOTE_PUBLIC, MN_WORD | MN_GET_REMOTE_PUBLIC )
+        i = instance_get( r->stack_ptr[-1] ) ;
+        if ( !i )
+        {
+            fprintf( stderr, "ERROR: Runtime error in %s(%d) - Process %d not active\n", r->proc->name, LOCDWORD( r, PROCESS_ID ), r->stack_ptr[-1] ) ;
+            exit( 0 );
+        }
+        else
+            r->stack_ptr[-1] = PUBINT16( i, ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( WORD_GET_REMOTE_PUBLIC_UNSIGNED, MN_WORD | MN_GET_REMOTE_PUBLIC | MN_UNSIGNED )
+        i = instance_get( r->stack_ptr[-1] ) ;
+        if ( !i )
+        {
+            fprintf( stderr, "ERROR: Runtime error in %s(%d) - Process %d not active\n", r->proc->name, LOCDWORD( r, PROCESS_ID ), r->stack_ptr[-1] ) ;
+            exit( 0 );
+        }
+        else
+            r->stack_ptr[-1] = PUBWORD( i, ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( WORD_PTR, MN_WORD | MN_PTR )
+        r->stack_ptr[-1] = *( int16_t * )r->stack_ptr[-1] ;
+        ptr++ ;
+        NEXT ;
+
+    OP( WORD_PTR_UNSIGNED, MN_WORD | MN_PTR | MN_UNSIGNED )
+        r->stack_ptr[-1] = *( uint16_t * )r->stack_ptr[-1] ;
+        ptr++ ;
+        NEXT ;
+
+    /* Access to variables BYTE type */
+
+    OP( BYTE_GET_PRIV, MN_BYTE | MN_GET_PRIV )
+        *r->stack_ptr++ = PRIINT8( r, ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( BYTE_GET_PRIV_UNSIGNED, MN_BYTE | MN_GET_PRIV | MN_UNSIGNED )
+        *r->stack_ptr++ = PRIBYTE( r, ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( BYTE_GET_PUBLIC, MN_BYTE | MN_GET_PUBLIC )
+        *r->stack_ptr++ = PUBINT8( r, ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( BYTE_GET_PUBLIC_UNSIGNED, MN_BYTE | MN_GET_PUBLIC | MN_UNSIGNED )
+        *r->stack_ptr++ = PUBBYTE( r, ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( BYTE_GET_LOCAL, MN_BYTE | MN_GET_LOCAL )
+        *r->stack_ptr++ = LOCINT8( r, ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( BYTE_GET_LOCAL_UNSIGNED, MN_BYTE | MN_GET_LOCAL | MN_UNSIGNED )
+        *r->stack_ptr++ = LOCBYTE( r, ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( BYTE_GET_GLOBAL, MN_BYTE | MN_GET_GLOBAL )
+        *r->stack_ptr++ = GLOINT8( ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( BYTE_GET_GLOBAL_UNSIGNED, MN_BYTE | MN_GET_GLOBAL | MN_UNSIGNED )
+        *r->stack_ptr++ = GLOBYTE( ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( BYTE_GET_REMOTE, MN_BYTE | MN_GET_REMOTE )
+        i = instance_get( r->stack_ptr[-1] ) ;
+        if ( !i )
+        {
+            fprintf( stderr, "ERROR: Runtime error in %s(%d) - Process %d not active\n", r->proc->name, LOCDWORD( r, PROCESS_ID ), r->stack_ptr[-1] ) ;
+            exit( 0 );
+        }
+        else
+            r->stack_ptr[-1] = LOCINT8( i, ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( BYTE_GET_REMOTE_UNSIGNED, MN_BYTE | MN_GET_REMOTE | MN_UNSIGNED )
+        i = instance_get( r->stack_ptr[-1] ) ;
+        if ( !i )
+        {
+            fprintf( stderr, "ERROR: Runtime error in %s(%d) - Process %d not active\n", r->proc->name, LOCDWORD( r, PROCESS_ID ), r->stack_ptr[-1] ) ;
+            exit( 0 );
+        }
+        else
+            r->stack_ptr[-1] = LOCBYTE( i, ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( BYTE_GET_REMOTE_PUBLIC, MN_BYTE | MN_GET_REMOTE_PUBLIC )
+        i = instance_get( r->stack_ptr[-1] ) ;
+        if ( !i )
+        {
+            fprintf( stderr, "ERROR: Runtime error in %s(%d) - Process %d not active\n", r->proc->name, LOCDWORD( r, PROCESS_ID ), r->stack_ptr[-1] ) ;
+            exit( 0 );
+        }
+        else
+            r->stack_ptr[-1] = PUBINT8( i, ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( BYTE_GET_REMOTE_PUBLIC_UNSIGNED, MN_BYTE | MN_GET_REMOTE_PUBLIC | MN_UNSIGNED )
+        i = instance_get( r->stack_ptr[-1] ) ;
+        if ( !i )
+        {
+            fprintf( stderr, "ERROR: Runtime error in %s(%d) - Process %d not active\n", r->proc->name, LOCDWORD( r, PROCESS_ID ), r->stack_ptr[-1] ) ;
+            exit( 0 );
+        }
+        else
+            r->stack_ptr[-1] = PUBBYTE( i, ptr[1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( BYTE_PTR, MN_BYTE | MN_PTR )
+        r->stack_ptr[-1] = *(( int8_t * )r->stack_ptr[-1] ) ;
+        ptr++ ;
+        NEXT ;
+
+    OP( BYTE_PTR_UNSIGNED, MN_BYTE | MN_PTR | MN_UNSIGNED )
+        r->stack_ptr[-1] = *(( uint8_t * )r->stack_ptr[-1] ) ;
+        ptr++ ;
+        NEXT ;
+
+    /* Floating point math */
+
+    OP( FLOAT_NEG, MN_FLOAT | MN_NEG )
+        *( float * )&r->stack_ptr[-1] = -*(( float * ) & r->stack_ptr[-1] ) ;
+        ptr++ ;
+        NEXT ;
+
+    OP( FLOAT_NOT, MN_FLOAT | MN_NOT )
+        *( float * )&r->stack_ptr[-1] = ( float ) !*(( float * ) & r->stack_ptr[-1] ) ;
+        ptr++ ;
+        NEXT ;
+
+    OP( FLOAT_ADD, MN_FLOAT | MN_ADD )
+        *( float * )&r->stack_ptr[-2] += *(( float * ) & r->stack_ptr[-1] ) ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( FLOAT_SUB, MN_FLOAT | MN_SUB )
+        *( float * )&r->stack_ptr[-2] -= *(( float * ) & r->stack_ptr[-1] ) ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( FLOAT_MUL, MN_FLOAT | MN_MUL )
+        *( float * )&r->stack_ptr[-2] *= *(( float * ) & r->stack_ptr[-1] ) ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( FLOAT_DIV, MN_FLOAT | MN_DIV )
+        *( float * )&r->stack_ptr[-2] /= *(( float * ) & r->stack_ptr[-1] ) ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( FLOAT2INT, MN_FLOAT2INT )
+        *( int32_t * )&( r->stack_ptr[-ptr[1] - 1] ) = ( int32_t ) * ( float * ) & ( r->stack_ptr[-ptr[1] - 1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    case MN_INT2FLOAT:
+    OP( INT2FLOAT, MN_INT2FLOAT | MN_UNSIGNED )
+        *( float * )&( r->stack_ptr[-ptr[1] - 1] ) = ( float ) * ( int32_t * ) & ( r->stack_ptr[-ptr[1] - 1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( INT2FLOAT_UNSIGNED_WORD, MN_INT2FLOAT | MN_UNSIGNED | MN_WORD )
+        *( float * )&( r->stack_ptr[-ptr[1] - 1] ) = ( float ) * ( uint16_t * ) & ( r->stack_ptr[-ptr[1] - 1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( INT2FLOAT_UNSIGNED_BYTE, MN_INT2FLOAT | MN_UNSIGNED | MN_BYTE )
+        *( float * )&( r->stack_ptr[-ptr[1] - 1] ) = ( float ) * ( uint8_t * ) & ( r->stack_ptr[-ptr[1] - 1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    case MN_INT2WORD:
+    OP( INT2WORD, MN_INT2WORD | MN_UNSIGNED )
+        *( uint32_t * )&( r->stack_ptr[-ptr[1] - 1] ) = ( int32_t )( uint16_t ) * ( int32_t * ) & ( r->stack_ptr[-ptr[1] - 1] ) ;
+        ptr += 2;
+        NEXT ;
+    case MN_INT2BYTE:
+    OP( INT2BYTE, MN_INT2BYTE | MN_UNSIGNED )
+        *( uint32_t * )&( r->stack_ptr[-ptr[1] - 1] ) = ( int32_t )( uint8_t ) * ( int32_t * ) & ( r->stack_ptr[-ptr[1] - 1] ) ;
+        ptr += 2;
+        NEXT ;
+
+    /* Mathematical operations */
+
+    case MN_NEG:
+    OP( NEG, MN_NEG | MN_UNSIGNED )
+        r->stack_ptr[-1] = -r->stack_ptr[-1] ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_NOT:
+    OP( NOT, MN_NOT | MN_UNSIGNED )
+        r->stack_ptr[-1] = !( r->stack_ptr[-1] ) ;
+        ptr++ ;
+        NEXT ;
+
+    OP( ADD, MN_ADD )
+        r->stack_ptr[-2] += r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( SUB, MN_SUB )
+        r->stack_ptr[-2] -= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_MUL | MN_WORD:
+    case MN_MUL | MN_BYTE:
+    OP( MUL_WORD, MN_MUL )
+        r->stack_ptr[-2] *= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_MUL | MN_WORD | MN_UNSIGNED:
+    case MN_MUL | MN_BYTE | MN_UNSIGNED:
+    OP( MUL_WORD_UNSIGNED, MN_MUL | MN_UNSIGNED )
+        r->stack_ptr[-2] = ( uint32_t )r->stack_ptr[-2] * ( uint32_t )r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_DIV | MN_WORD:
+    case MN_DIV | MN_BYTE:
+    OP( DIV_WORD, MN_DIV )
+        if ( r->stack_ptr[-1] == 0 )
+        {
+            fprintf( stderr, "ERROR: Runtime error in %s(%d) - Division by zero\n", r->proc->name, LOCDWORD( r, PROCESS_ID ) ) ;
+            exit( 0 );
+        }
+        r->stack_ptr[-2] /= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_DIV | MN_WORD | MN_UNSIGNED:
+    case MN_DIV | MN_BYTE | MN_UNSIGNED:
+    OP( DIV_WORD_UNSIGNED, MN_DIV | MN_UNSIGNED )
+        if ( r->stack_ptr[-1] == 0 )
+        {
+            fprintf( stderr, "ERROR: Runtime error in %s(%d) - Division by zero\n", r->proc->name, LOCDWORD( r, PROCESS_ID ) ) ;
+            exit( 0 );
+        }
+        r->stack_ptr[-2] = ( uint32_t )r->stack_ptr[-2] / ( uint32_t )r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_MOD | MN_WORD:
+    case MN_MOD | MN_BYTE:
+    OP( MOD_WORD, MN_MOD )
+        if ( r->stack_ptr[-1] == 0 )
+        {
+            fprintf( stderr, "ERROR: Runtime error in %s(%d) - Division by zero\n", r->proc->name, LOCDWORD( r, PROCESS_ID ) ) ;
+            exit( 0 );
+        }
+        r->stack_ptr[-2] %= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_MOD | MN_WORD | MN_UNSIGNED:
+    case MN_MOD | MN_BYTE | MN_UNSIGNED:
+    OP( MOD_WORD_UNSIGNED, MN_MOD | MN_UNSIGNED )
+        if ( r->stack_ptr[-1] == 0 )
+        {
+            fprintf( stderr, "ERROR: Runtime error in %s(%d) - Division by zero\n", r->proc->name, LOCDWORD( r, PROCESS_ID ) ) ;
+            exit( 0 );
+        }
+        r->stack_ptr[-2] = ( uint32_t )r->stack_ptr[-2] % ( uint32_t )r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    /* Bitwise operations */
+
+    OP( ROR, MN_ROR )
+        ( r->stack_ptr[-2] ) = (( int32_t )r->stack_ptr[-2] ) >> r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( ROR_UNSIGNED, MN_ROR | MN_UNSIGNED )
+        r->stack_ptr[-2] = (( uint32_t ) r->stack_ptr[-2] ) >> r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( WORD_ROR, MN_WORD | MN_ROR )
+        r->stack_ptr[-2] = (( int16_t ) r->stack_ptr[-2] ) >> r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( WORD_ROR_UNSIGNED, MN_WORD | MN_ROR | MN_UNSIGNED )
+        r->stack_ptr[-2] = (( uint16_t ) r->stack_ptr[-2] ) >> r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( BYTE_ROR, MN_BYTE | MN_ROR )
+        r->stack_ptr[-2] = (( int8_t ) r->stack_ptr[-2] >> r->stack_ptr[-1] ) ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( BYTE_ROR_UNSIGNED, MN_BYTE | MN_ROR | MN_UNSIGNED )
+        r->stack_ptr[-2] = (( uint8_t ) r->stack_ptr[-2] ) >> r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( ROL, MN_ROL )
+        ( r->stack_ptr[-2] ) = (( int32_t )r->stack_ptr[-2] ) << r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    /* All the next ROL operations, don't could be necessaries, but well... */
+
+    OP( ROL_UNSIGNED, MN_ROL | MN_UNSIGNED )
+        ( r->stack_ptr[-2] ) = ( uint32_t )( r->stack_ptr[-2] << r->stack_ptr[-1] );
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( WORD_ROL, MN_WORD | MN_ROL )
+        ( r->stack_ptr[-2] ) = (( int16_t )r->stack_ptr[-2] ) << r->stack_ptr[-1];
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( WORD_ROL_UNSIGNED, MN_WORD | MN_ROL | MN_UNSIGNED )
+        ( r->stack_ptr[-2] ) = ( uint16_t )( r->stack_ptr[-2] << r->stack_ptr[-1] );
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( BYTE_ROL, MN_BYTE | MN_ROL )
+        ( r->stack_ptr[-2] ) = (( int8_t )r->stack_ptr[-2] ) << r->stack_ptr[-1];
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( BYTE_ROL_UNSIGNED, MN_BYTE | MN_ROL | MN_UNSIGNED )
+        ( r->stack_ptr[-2] ) = ( uint8_t )( r->stack_ptr[-2] << r->stack_ptr[-1] );
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_BAND:
+    OP( BAND, MN_BAND | MN_UNSIGNED )
+        r->stack_ptr[-2] &= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_BOR:
+    OP( BOR, MN_BOR | MN_UNSIGNED )
+        r->stack_ptr[-2] |= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_BXOR:
+    OP( BXOR, MN_BXOR | MN_UNSIGNED )
+        r->stack_ptr[-2] ^= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_BNOT:
+    OP( BNOT, MN_BNOT | MN_UNSIGNED )
+        r->stack_ptr[-1] = ~( r->stack_ptr[-1] ) ;
+        ptr++ ;
+        NEXT ;
+
+    OP( BYTE_BNOT, MN_BYTE | MN_BNOT )
+        r->stack_ptr[-1] = ( int8_t ) ~( r->stack_ptr[-1] ) ;
+        ptr++ ;
+        NEXT ;
+
+    OP( BYTE_BNOT_UNSIGNED, MN_BYTE | MN_BNOT | MN_UNSIGNED )
+        r->stack_ptr[-1] = ( uint8_t ) ~( r->stack_ptr[-1] ) ;
+        ptr++ ;
+        NEXT ;
+
+    OP( WORD_BNOT, MN_WORD | MN_BNOT )
+        r->stack_ptr[-1] = ( int16_t ) ~( r->stack_ptr[-1] ) ;
+        ptr++ ;
+        NEXT ;
+
+    OP( WORD_BNOT_UNSIGNED, MN_WORD | MN_BNOT | MN_UNSIGNED )
+        r->stack_ptr[-1] = ( uint16_t ) ~( r->stack_ptr[-1] ) ;
+        ptr++ ;
+        NEXT ;
+
+    /* Logical operations */
+
+    OP( AND, MN_AND )
+        r->stack_ptr[-2] = r->stack_ptr[-2] && r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( OR, MN_OR )
+        r->stack_ptr[-2] = r->stack_ptr[-2] || r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( XOR, MN_XOR )
+        r->stack_ptr[-2] = ( r->stack_ptr[-2] != 0 ) ^( r->stack_ptr[-1] != 0 ) ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    /* Comparisons */
+
+    OP( EQ, MN_EQ )
+        r->stack_ptr[-2] = ( r->stack_ptr[-2] == r->stack_ptr[-1] ) ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( NE, MN_NE )
+        r->stack_ptr[-2] = ( r->stack_ptr[-2] != r->stack_ptr[-1] ) ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( GTE, MN_GTE )
+        r->stack_ptr[-2] = ( r->stack_ptr[-2] >= r->stack_ptr[-1] ) ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( GTE_UNSIGNED, MN_GTE | MN_UNSIGNED )
+        r->stack_ptr[-2] = (( uint32_t )r->stack_ptr[-2] >= ( uint32_t )r->stack_ptr[-1] ) ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( LTE, MN_LTE )
+        r->stack_ptr[-2] = ( r->stack_ptr[-2] <= r->stack_ptr[-1] ) ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( LTE_UNSIGNED, MN_LTE | MN_UNSIGNED )
+        r->stack_ptr[-2] = (( uint32_t )r->stack_ptr[-2] <= ( uint32_t )r->stack_ptr[-1] ) ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( LT, MN_LT )
+        r->stack_ptr[-2] = ( r->stack_ptr[-2] < r->stack_ptr[-1] ) ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( LT_UNSIGNED, MN_LT | MN_UNSIGNED )
+        r->stack_ptr[-2] = (( uint32_t )r->stack_ptr[-2] < ( uint32_t )r->stack_ptr[-1] ) ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( GT, MN_GT )
+        r->stack_ptr[-2] = ( r->stack_ptr[-2] > r->stack_ptr[-1] ) ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( GT_UNSIGNED, MN_GT | MN_UNSIGNED )
+        r->stack_ptr[-2] = (( uint32_t )r->stack_ptr[-2] > ( uint32_t )r->stack_ptr[-1] ) ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    /* Floating point comparisons */
+
+    OP( EQ_FLOAT, MN_EQ | MN_FLOAT )
+        r->stack_ptr[-2] = ( *( float * ) & r->stack_ptr[-2] == *( float * ) & r->stack_ptr[-1] ) ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( NE_FLOAT, MN_NE | MN_FLOAT )
+        r->stack_ptr[-2] = ( *( float * ) & r->stack_ptr[-2] != *( float * ) & r->stack_ptr[-1] ) ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( GTE_FLOAT, MN_GTE | MN_FLOAT )
+        r->stack_ptr[-2] = ( *( float * ) & r->stack_ptr[-2] >= *( float * ) & r->stack_ptr[-1] ) ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( LTE_FLOAT, MN_LTE | MN_FLOAT )
+        r->stack_ptr[-2] = ( *( float * ) & r->stack_ptr[-2] <= *( float * ) & r->stack_ptr[-1] ) ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( LT_FLOAT, MN_LT | MN_FLOAT )
+        r->stack_ptr[-2] = ( *( float * ) & r->stack_ptr[-2] < *( float * ) & r->stack_ptr[-1] ) ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( GT_FLOAT, MN_GT | MN_FLOAT )
+        r->stack_ptr[-2] = ( *( float * ) & r->stack_ptr[-2] > *( float * ) & r->stack_ptr[-1] ) ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    /* String comparisons */
+
+    OP( EQ_STRING, MN_EQ | MN_STRING )
+        n = string_comp( r->stack_ptr[-2], r->stack_ptr[-1] ) == 0 ;
+        string_discard( r->stack_ptr[-2] );
+        string_discard( r->stack_ptr[-1] );
+        r->stack_ptr[-2] = n;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( NE_STRING, MN_NE | MN_STRING )
+        n = string_comp( r->stack_ptr[-2], r->stack_ptr[-1] ) != 0 ;
+        string_discard( r->stack_ptr[-2] );
+        string_discard( r->stack_ptr[-1] );
+        r->stack_ptr[-2] = n;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( GTE_STRING, MN_GTE | MN_STRING )
+        n = string_comp( r->stack_ptr[-2], r->stack_ptr[-1] ) >= 0 ;
+        string_discard( r->stack_ptr[-2] );
+        string_discard( r->stack_ptr[-1] );
+        r->stack_ptr[-2] = n;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( LTE_STRING, MN_LTE | MN_STRING )
+        n = string_comp( r->stack_ptr[-2], r->stack_ptr[-1] ) <= 0 ;
+        string_discard( r->stack_ptr[-2] );
+        string_discard( r->stack_ptr[-1] );
+        r->stack_ptr[-2] = n;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( LT_STRING, MN_LT | MN_STRING )
+        n = string_comp( r->stack_ptr[-2], r->stack_ptr[-1] ) <  0 ;
+        string_discard( r->stack_ptr[-2] );
+        string_discard( r->stack_ptr[-1] );
+        r->stack_ptr[-2] = n;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( GT_STRING, MN_GT | MN_STRING )
+        n = string_comp( r->stack_ptr[-2], r->stack_ptr[-1] ) >  0 ;
+        string_discard( r->stack_ptr[-2] );
+        string_discard( r->stack_ptr[-1] );
+        r->stack_ptr[-2] = n;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    /* String operations */
+
+    OP( VARADD_STRING, MN_VARADD | MN_STRING )
+        n = *( int32_t * )( r->stack_ptr[-2] ) ;
+        *( int32_t * )( r->stack_ptr[-2] ) = string_append( n, r->stack_ptr[-1] ) ;
+        if ( *( int32_t * )( r->stack_ptr[-2] ) != n )
+        {
+            string_use( *( int32_t * )( r->stack_ptr[-2] ) );
+            string_discard( n );
+        }
+        string_discard( r->stack_ptr[-1] );
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( LETNP_STRING, MN_LETNP | MN_STRING )
+        string_discard( *( int32_t * )( r->stack_ptr[-2] ) );
+        ( *( int32_t * )( r->stack_ptr[-2] ) ) = r->stack_ptr[-1];
+        r->stack_ptr -= 2 ;
+        ptr++ ;
+        NEXT ;
+
+    OP( LET_STRING, MN_LET | MN_STRING )
+        string_discard( *( int32_t * )( r->stack_ptr[-2] ) );
+        ( *( int32_t * )( r->stack_ptr[-2] ) ) = r->stack_ptr[-1];
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( ADD_STRING, MN_ADD | MN_STRING )
+        n = string_add( r->stack_ptr[-2], r->stack_ptr[-1] );
+        string_use( n ) ;
+        string_discard( r->stack_ptr[-2] );
+        string_discard( r->stack_ptr[-1] );
+        r->stack_ptr-- ;
+        r->stack_ptr[-1] = n ;
+        ptr++ ;
+        NEXT ;
+
+    OP( INT2STR, MN_INT2STR )
+        r->stack_ptr[-ptr[1] - 1] = string_itoa( r->stack_ptr[-ptr[1] - 1] ) ;
+        string_use( r->stack_ptr[-ptr[1] - 1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( INT2STR_UNSIGNED, MN_INT2STR | MN_UNSIGNED )
+        r->stack_ptr[-ptr[1] - 1] = string_uitoa( r->stack_ptr[-ptr[1] - 1] ) ;
+        string_use( r->stack_ptr[-ptr[1] - 1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( INT2STR_WORD, MN_INT2STR | MN_WORD )
+        r->stack_ptr[-ptr[1] - 1] = string_itoa( r->stack_ptr[-ptr[1] - 1] ) ;
+        string_use( r->stack_ptr[-ptr[1] - 1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( INT2STR_UNSIGNED_WORD, MN_INT2STR | MN_UNSIGNED | MN_WORD )
+        r->stack_ptr[-ptr[1] - 1] = string_uitoa( r->stack_ptr[-ptr[1] - 1] ) ;
+        string_use( r->stack_ptr[-ptr[1] - 1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( INT2STR_BYTE, MN_INT2STR | MN_BYTE )
+        r->stack_ptr[-ptr[1] - 1] = string_itoa( r->stack_ptr[-ptr[1] - 1] ) ;
+        string_use( r->stack_ptr[-ptr[1] - 1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( INT2STR_UNSIGNED_BYTE, MN_INT2STR | MN_UNSIGNED | MN_BYTE )
+        r->stack_ptr[-ptr[1] - 1] = string_uitoa( r->stack_ptr[-ptr[1] - 1] ) ;
+        string_use( r->stack_ptr[-ptr[1] - 1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( FLOAT2STR, MN_FLOAT2STR )
+        r->stack_ptr[-ptr[1] - 1] = string_ftoa( *( float * ) & r->stack_ptr[-ptr[1] - 1] ) ;
+        string_use( r->stack_ptr[-ptr[1] - 1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( CHR2STR, MN_CHR2STR )
+        buffer[0] = ( uint8_t )r->stack_ptr[-ptr[1] - 1] ;
+        buffer[1] = 0 ;
+        r->stack_ptr[-ptr[1] - 1] = string_new( buffer ) ;
+        string_use( r->stack_ptr[-ptr[1] - 1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( STRI2CHR, MN_STRI2CHR )
+        n = string_char( r->stack_ptr[-2], r->stack_ptr[-1] ) ;
+        string_discard( r->stack_ptr[-2] );
+        r->stack_ptr-- ;
+        r->stack_ptr[-1] = n ;
+        ptr++ ;
+        NEXT ;
+
+    OP( STR2CHR, MN_STR2CHR )
+        n = r->stack_ptr[-ptr[1] - 1] ;
+        r->stack_ptr[-1] = *string_get( n ) ;
+        string_discard( n );
+        ptr += 2 ;
+        NEXT ;
+
+    OP( POINTER2STR, MN_POINTER2STR )
+        r->stack_ptr[-ptr[1] - 1] = string_ptoa( *( void ** ) & r->stack_ptr[-ptr[1] - 1] ) ;
+        string_use( r->stack_ptr[-ptr[1] - 1] ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( STR2FLOAT, MN_STR2FLOAT )
+        n = r->stack_ptr[-ptr[1] - 1] ;
+        str = ( char * )string_get( n ) ;
+        *( float * )( &r->stack_ptr[-ptr[1] - 1] ) = str ? ( float )atof( str ) : 0.0f ;
+        string_discard( n ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( STR2INT, MN_STR2INT )
+        n = r->stack_ptr[-ptr[1] - 1] ;
+        str = ( char * )string_get( n ) ;
+        r->stack_ptr[-ptr[1] - 1] = str ? atoi( str ) : 0 ;
+        string_discard( n ) ;
+        ptr += 2 ;
+        NEXT ;
+
+    /* Fixed-length strings operations*/
+
+    OP( A2STR, MN_A2STR )
+        str = *( char ** )( &r->stack_ptr[-ptr[1] - 1] ) ;
+        n = string_new( str );
+        string_use( n );
+        r->stack_ptr[-ptr[1] - 1] = n ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( STR2A, MN_STR2A )
+        n = r->stack_ptr[-1];
+        strncpy( *( char ** )( &r->stack_ptr[-2] ), string_get( n ), ptr[1] ) ;
+        (( char * )( r->stack_ptr[-2] ) )[ptr[1]] = 0;
+        r->stack_ptr[-2] = r->stack_ptr[-1];
+        r->stack_ptr--;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( STRACAT, MN_STRACAT )
+        n = r->stack_ptr[-1];
+        strncat( *( char ** )( &r->stack_ptr[-2] ), string_get( n ), (ptr[1]-1) - strlen( *( char ** )( &r->stack_ptr[-2] ) ) ) ;
+        (( char * )( r->stack_ptr[-2] ) )[ptr[1]-1] = 0;
+        r->stack_ptr[-2] = r->stack_ptr[-1];
+        r->stack_ptr--;
+        ptr += 2 ;
+        NEXT ;
+
+    /* Direct operations with variables DWORD type */
+
+    case MN_LETNP:
+    OP( LETNP, MN_LETNP | MN_UNSIGNED )
+        ( *( int32_t * )( r->stack_ptr[-2] ) ) = r->stack_ptr[-1] ;
+        r->stack_ptr -= 2 ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_LET:
+    OP( LET, MN_LET | MN_UNSIGNED )
+        ( *( int32_t * )( r->stack_ptr[-2] ) ) = r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_INC:
+    OP( INC, MN_INC | MN_UNSIGNED )
+        ( *( int32_t * )( r->stack_ptr[-1] ) ) += ptr[1] ;
+        ptr += 2 ;
+        NEXT ;
+
+    case MN_DEC:
+    OP( DEC, MN_DEC | MN_UNSIGNED )
+        ( *( int32_t * )( r->stack_ptr[-1] ) ) -= ptr[1] ;
+        ptr += 2 ;
+        NEXT ;
+
+    case MN_POSTDEC:
+    OP( POSTDEC, MN_POSTDEC | MN_UNSIGNED )
+        ( *( int32_t * )( r->stack_ptr[-1] ) ) -= ptr[1] ;
+        r->stack_ptr[-1] = *( int32_t * )( r->stack_ptr[-1] ) + ptr[1] ;
+        ptr += 2 ;
+        NEXT ;
+
+    case MN_POSTINC:
+    OP( POSTINC, MN_POSTINC | MN_UNSIGNED )
+        *(( int32_t * )( r->stack_ptr[-1] ) ) += ptr[1] ;
+        r->stack_ptr[-1] = *( int32_t * )( r->stack_ptr[-1] ) - ptr[1] ;
+        ptr += 2 ;
+        NEXT ;
+
+    case MN_VARADD:
+    OP( VARADD, MN_VARADD | MN_UNSIGNED )
+        *( int32_t * )( r->stack_ptr[-2] ) += r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_VARSUB:
+    OP( VARSUB, MN_VARSUB | MN_UNSIGNED )
+        *( int32_t * )( r->stack_ptr[-2] ) -= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_VARMUL:
+    OP( VARMUL, MN_VARMUL | MN_UNSIGNED )
+        *( int32_t * )( r->stack_ptr[-2] ) *= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_VARDIV:
+    OP( VARDIV, MN_VARDIV | MN_UNSIGNED )
+        if ( r->stack_ptr[-1] == 0 )
+        {
+            fprintf( stderr, "ERROR: Runtime error in %s(%d) - Division by zero\n", r->proc->name, LOCDWORD( r, PROCESS_ID ) ) ;
+            exit( 0 );
+        }
+        *( int32_t * )( r->stack_ptr[-2] ) /= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_VARMOD:
+    OP( VARMOD, MN_VARMOD | MN_UNSIGNED )
+        if ( r->stack_ptr[-1] == 0 )
+        {
+            fprintf( stderr, "ERROR: Runtime error in %s(%d) - Division by zero\n", r->proc->name, LOCDWORD( r, PROCESS_ID ) ) ;
+            exit( 0 );
+        }
+        *( int32_t * )( r->stack_ptr[-2] ) %= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_VAROR:
+    OP( VAROR, MN_VAROR | MN_UNSIGNED )
+        *( int32_t * )( r->stack_ptr[-2] ) |= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_VARXOR:
+    OP( VARXOR, MN_VARXOR | MN_UNSIGNED )
+        *( int32_t * )( r->stack_ptr[-2] ) ^= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_VARAND:
+    OP( VARAND, MN_VARAND | MN_UNSIGNED )
+        *( int32_t * )( r->stack_ptr[-2] ) &= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( VARROR, MN_VARROR )
+        *( int32_t * )( r->stack_ptr[-2] ) >>= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( VARROR_UNSIGNED, MN_VARROR | MN_UNSIGNED )
+        *( uint32_t * )( r->stack_ptr[-2] ) >>= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( VARROL, MN_VARROL )
+        *( int32_t * )( r->stack_ptr[-2] ) <<= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( VARROL_UNSIGNED, MN_VARROL | MN_UNSIGNED )
+        *( uint32_t * )( r->stack_ptr[-2] ) <<= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    /* Direct operations with variables WORD type */
+
+    case MN_WORD | MN_LETNP:
+    OP( WORD_LETNP, MN_WORD | MN_LETNP | MN_UNSIGNED )
+        ( *( int16_t * )( r->stack_ptr[-2] ) ) = r->stack_ptr[-1] ;
+        r->stack_ptr -= 2 ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_WORD | MN_LET:
+    OP( WORD_LET, MN_WORD | MN_LET | MN_UNSIGNED )
+        ( *( int16_t * )( r->stack_ptr[-2] ) ) = r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_WORD | MN_INC:
+    OP( WORD_INC, MN_WORD | MN_INC | MN_UNSIGNED )
+        ( *( int16_t * )( r->stack_ptr[-1] ) ) += ptr[1] ;
+        ptr += 2 ;
+        NEXT ;
+
+    case MN_WORD | MN_DEC:
+    OP( WORD_DEC, MN_WORD | MN_DEC | MN_UNSIGNED )
+        ( *( int16_t * )( r->stack_ptr[-1] ) ) -= ptr[1] ;
+        ptr += 2 ;
+        NEXT ;
+
+    case MN_WORD | MN_POSTDEC:
+    OP( WORD_POSTDEC, MN_WORD | MN_POSTDEC | MN_UNSIGNED )
+        ( *( int16_t * )( r->stack_ptr[-1] ) ) -= ptr[1] ;
+        r->stack_ptr[-1] = *( int16_t * )( r->stack_ptr[-1] ) + ptr[1] ;
+        ptr += 2 ;
+        NEXT ;
+
+    case MN_WORD | MN_POSTINC:
+    OP( WORD_POSTINC, MN_WORD | MN_POSTINC | MN_UNSIGNED )
+        *(( int16_t * )( r->stack_ptr[-1] ) ) += ptr[1] ;
+        r->stack_ptr[-1] = *( int16_t * )( r->stack_ptr[-1] ) - ptr[1] ;
+        ptr += 2 ;
+        NEXT ;
+
+    case MN_WORD | MN_VARADD:
+    OP( WORD_VARADD, MN_WORD | MN_VARADD | MN_UNSIGNED )
+        *( int16_t * )( r->stack_ptr[-2] ) += r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_WORD | MN_VARSUB:
+    OP( WORD_VARSUB, MN_WORD | MN_VARSUB | MN_UNSIGNED )
+        *( int16_t * )( r->stack_ptr[-2] ) -= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_WORD | MN_VARMUL:
+    OP( WORD_VARMUL, MN_WORD | MN_VARMUL | MN_UNSIGNED )
+        *( int16_t * )( r->stack_ptr[-2] ) *= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_WORD | MN_VARDIV:
+    OP( WORD_VARDIV, MN_WORD | MN_VARDIV | MN_UNSIGNED )
+        if (( int16_t )r->stack_ptr[-1] == 0 )
+        {
+            fprintf( stderr, "ERROR: Runtime error in %s(%d) - Division by zero\n", r->proc->name, LOCDWORD( r, PROCESS_ID ) ) ;
+            exit( 0 );
+        }
+        *( int16_t * )( r->stack_ptr[-2] ) /= ( int16_t )r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_WORD | MN_VARMOD:
+    OP( WORD_VARMOD, MN_WORD | MN_VARMOD | MN_UNSIGNED )
+        if (( int16_t )r->stack_ptr[-1] == 0 )
+        {
+            fprintf( stderr, "ERROR: Runtime error in %s(%d) - Division by zero\n", r->proc->name, LOCDWORD( r, PROCESS_ID ) ) ;
+            exit( 0 );
+        }
+        *( int16_t * )( r->stack_ptr[-2] ) %= ( int16_t )r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_WORD | MN_VAROR:
+    OP( WORD_VAROR, MN_WORD | MN_VAROR | MN_UNSIGNED )
+        *( int16_t * )( r->stack_ptr[-2] ) |= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_WORD | MN_VARXOR:
+    OP( WORD_VARXOR, MN_WORD | MN_VARXOR | MN_UNSIGNED )
+        *( int16_t * )( r->stack_ptr[-2] ) ^= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_WORD | MN_VARAND:
+    OP( WORD_VARAND, MN_WORD | MN_VARAND | MN_UNSIGNED )
+        *( int16_t * )( r->stack_ptr[-2] ) &= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( WORD_VARROR, MN_WORD | MN_VARROR )
+        *( int16_t * )( r->stack_ptr[-2] ) >>= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( WORD_VARROR_UNSIGNED, MN_WORD | MN_VARROR | MN_UNSIGNED )
+        *( uint16_t * )( r->stack_ptr[-2] ) >>= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( WORD_VARROL, MN_WORD | MN_VARROL )
+        *( int16_t * )( r->stack_ptr[-2] ) <<= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( WORD_VARROL_UNSIGNED, MN_WORD | MN_VARROL | MN_UNSIGNED )
+        *( uint16_t * )( r->stack_ptr[-2] ) <<= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    /* Direct operations with variables BYTE type */
+
+    case MN_BYTE | MN_LETNP:
+    OP( BYTE_LETNP, MN_BYTE | MN_LETNP | MN_UNSIGNED )
+        ( *( uint8_t * )( r->stack_ptr[-2] ) ) = r->stack_ptr[-1] ;
+        r->stack_ptr -= 2 ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_BYTE | MN_LET:
+    OP( BYTE_LET, MN_BYTE | MN_LET | MN_UNSIGNED )
+        ( *( uint8_t * )( r->stack_ptr[-2] ) ) = r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_BYTE | MN_INC:
+    OP( BYTE_INC, MN_BYTE | MN_INC | MN_UNSIGNED )
+        ( *( uint8_t * )( r->stack_ptr[-1] ) ) += ptr[1] ;
+        ptr += 2 ;
+        NEXT ;
+
+    case MN_BYTE | MN_DEC:
+    OP( BYTE_DEC, MN_BYTE | MN_DEC | MN_UNSIGNED )
+        ( *( uint8_t * )( r->stack_ptr[-1] ) ) -= ptr[1] ;
+        ptr += 2 ;
+        NEXT ;
+
+    case MN_BYTE | MN_POSTDEC:
+    OP( BYTE_POSTDEC, MN_BYTE | MN_POSTDEC | MN_UNSIGNED )
+        ( *( uint8_t * )( r->stack_ptr[-1] ) ) -= ptr[1] ;
+        r->stack_ptr[-1] = *( uint8_t * )( r->stack_ptr[-1] ) + ptr[1] ;
+        ptr += 2 ;
+        NEXT ;
+
+    case MN_BYTE | MN_POSTINC:
+    OP( BYTE_POSTINC, MN_BYTE | MN_POSTINC | MN_UNSIGNED )
+        *(( uint8_t * )( r->stack_ptr[-1] ) ) += ptr[1] ;
+        r->stack_ptr[-1] = *( uint8_t * )( r->stack_ptr[-1] ) - ptr[1] ;
+        ptr += 2 ;
+        NEXT ;
+
+    case MN_BYTE | MN_VARADD:
+    OP( BYTE_VARADD, MN_BYTE | MN_VARADD | MN_UNSIGNED )
+        *( uint8_t * )( r->stack_ptr[-2] ) += r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_BYTE | MN_VARSUB:
+    OP( BYTE_VARSUB, MN_BYTE | MN_VARSUB | MN_UNSIGNED )
+        *( uint8_t * )( r->stack_ptr[-2] ) -= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_BYTE | MN_VARMUL:
+    OP( BYTE_VARMUL, MN_BYTE | MN_VARMUL | MN_UNSIGNED )
+        *( uint8_t * )( r->stack_ptr[-2] ) *= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_BYTE | MN_VARDIV:
+    OP( BYTE_VARDIV, MN_BYTE | MN_VARDIV | MN_UNSIGNED )
+        if (( uint8_t )r->stack_ptr[-1] == 0 )
+        {
+            fprintf( stderr, "ERROR: Runtime error in %s(%d) - Division by zero\n", r->proc->name, LOCDWORD( r, PROCESS_ID ) ) ;
+            exit( 0 );
+        }
+        *( uint8_t * )( r->stack_ptr[-2] ) /= ( uint8_t )r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_BYTE | MN_VARMOD:
+    OP( BYTE_VARMOD, MN_BYTE | MN_VARMOD | MN_UNSIGNED )
+        if (( uint8_t )r->stack_ptr[-1] == 0 )
+        {
+            fprintf( stderr, "ERROR: Runtime error in %s(%d) - Division by zero\n", r->proc->name, LOCDWORD( r, PROCESS_ID ) ) ;
+            exit( 0 );
+        }
+        *( uint8_t * )( r->stack_ptr[-2] ) %= ( uint8_t )r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_BYTE | MN_VAROR:
+    OP( BYTE_VAROR, MN_BYTE | MN_VAROR | MN_UNSIGNED )
+        *( uint8_t * )( r->stack_ptr[-2] ) |= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_BYTE | MN_VARXOR:
+    OP( BYTE_VARXOR, MN_BYTE | MN_VARXOR | MN_UNSIGNED )
+        *( uint8_t * )( r->stack_ptr[-2] ) ^= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    case MN_BYTE | MN_VARAND:
+    OP( BYTE_VARAND, MN_BYTE | MN_VARAND | MN_UNSIGNED )
+        *( uint8_t * )( r->stack_ptr[-2] ) &= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( BYTE_VARROR, MN_BYTE | MN_VARROR )
+        *( int8_t * )( r->stack_ptr[-2] ) >>= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( BYTE_VARROR_UNSIGNED, MN_BYTE | MN_VARROR | MN_UNSIGNED )
+        *( uint8_t * )( r->stack_ptr[-2] ) >>= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( BYTE_VARROL, MN_BYTE | MN_VARROL )
+        *( int8_t * )( r->stack_ptr[-2] ) <<= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( BYTE_VARROL_UNSIGNED, MN_BYTE | MN_VARROL | MN_UNSIGNED )
+        *( uint8_t * )( r->stack_ptr[-2] ) <<= r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    /* Direct operations with variables FLOAT type */
+
+    OP( FLOAT_LETNP, MN_FLOAT | MN_LETNP )
+        ( *( float * )( r->stack_ptr[-2] ) ) = *( float * ) & r->stack_ptr[-1] ;
+        r->stack_ptr -= 2 ;
+        ptr++ ;
+        NEXT ;
+
+    OP( FLOAT_LET, MN_FLOAT | MN_LET )
+        ( *( float * )( r->stack_ptr[-2] ) ) = *( float * ) & r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( FLOAT_INC, MN_FLOAT | MN_INC )
+        ( *( float * )( r->stack_ptr[-1] ) ) += ptr[1] ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( FLOAT_DEC, MN_FLOAT | MN_DEC )
+        ( *( float * )( r->stack_ptr[-1] ) ) -= ptr[1] ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( FLOAT_POSTDEC, MN_FLOAT | MN_POSTDEC )
+        ( *( float * )( r->stack_ptr[-1] ) ) -= ptr[1] ;
+        r->stack_ptr[-1] = *( uint32_t * )( r->stack_ptr[-1] ) + ptr[1] ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( FLOAT_POSTINC, MN_FLOAT | MN_POSTINC )
+        *(( float * )( r->stack_ptr[-1] ) ) += ptr[1] ;
+        r->stack_ptr[-1] = *( uint32_t * )( r->stack_ptr[-1] ) - ptr[1] ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( FLOAT_VARADD, MN_FLOAT | MN_VARADD )
+        *( float * )( r->stack_ptr[-2] ) += *( float * ) & r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( FLOAT_VARSUB, MN_FLOAT | MN_VARSUB )
+        *( float * )( r->stack_ptr[-2] ) -= *( float * ) & r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( FLOAT_VARMUL, MN_FLOAT | MN_VARMUL )
+        *( float * )( r->stack_ptr[-2] ) *= *( float * ) & r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    OP( FLOAT_VARDIV, MN_FLOAT | MN_VARDIV )
+        *( float * )( r->stack_ptr[-2] ) /= *( float * ) & r->stack_ptr[-1] ;
+        r->stack_ptr-- ;
+        ptr++ ;
+        NEXT ;
+
+    /* Jumps */
+
+    OP( JUMP, MN_JUMP )
+        ptr = r->code + ptr[1] ;
+        BRANCH ;
+
+    OP( JTRUE, MN_JTRUE )
+        r->stack_ptr-- ;
+        if ( *r->stack_ptr )
+        {
+            ptr = r->code + ptr[1] ;
+            BRANCH ;
+        }
+        ptr += 2 ;
+        NEXT ;
+
+    OP( JFALSE, MN_JFALSE )
+        r->stack_ptr-- ;
+        if ( !*r->stack_ptr )
+        {
+            ptr = r->code + ptr[1] ;
+            BRANCH ;
+        }
+        ptr += 2 ;
+        NEXT ;
+
+    OP( JTTRUE, MN_JTTRUE )
+        if ( r->stack_ptr[-1] )
+        {
+            ptr = r->code + ptr[1] ;
+            BRANCH ;
+        }
+        ptr += 2 ;
+        NEXT ;
+
+    OP( JTFALSE, MN_JTFALSE )
+        if ( !r->stack_ptr[-1] )
+        {
+            ptr = r->code + ptr[1] ;
+            BRANCH ;
+        }
+        ptr += 2 ;
+        NEXT ;
+
+    OP( NCALL, MN_NCALL )
+        *r->stack_ptr++ = ptr - r->code + 2 ; /* Push next address */
+        ptr = r->code + ptr[1] ; /* Call function */
+        r->call_level++;
+        NEXT ;
+
+    /* Switch */
+
+    OP( SWITCH, MN_SWITCH )
+        r->switchval = *--r->stack_ptr ;
+        r->cased = 0 ;
+        ptr++ ;
+        NEXT ;
+
+    OP( SWITCH_STRING, MN_SWITCH | MN_STRING )
+        if ( r->switchval_string != 0 ) string_discard( r->switchval_string );
+        r->switchval_string = *--r->stack_ptr;
+        r->cased = 0;
+        ptr++;
+        NEXT ;
+
+    OP( CASE, MN_CASE )
+        if ( r->switchval == *--r->stack_ptr ) r->cased = 2 ;
+        ptr++ ;
+        NEXT ;
+
+    OP( CASE_STRING, MN_CASE | MN_STRING )
+        if ( string_comp( r->switchval_string, *--r->stack_ptr ) == 0 ) r->cased = 2 ;
+        string_discard( *r->stack_ptr );
+        string_discard( r->stack_ptr[-1] );
+        ptr++;
+        NEXT ;
+
+    OP( CASE_R, MN_CASE_R )
+        r->stack_ptr -= 2 ;
+        if ( r->switchval >= r->stack_ptr[0] && r->switchval <= r->stack_ptr[1] ) r->cased = 1 ;
+        ptr++ ;
+        NEXT ;
+
+    OP( CASE_R_STRING, MN_CASE_R | MN_STRING )
+        r->stack_ptr -= 2;
+        if ( string_comp( r->switchval_string, r->stack_ptr[0] ) >= 0 &&
+             string_comp( r->switchval_string, r->stack_ptr[1] ) <= 0 )
+            r->cased = 1;
+        string_discard( r->stack_ptr[0] );
+        string_discard( r->stack_ptr[1] );
+        ptr++;
+        NEXT ;
+
+    OP( JNOCASE, MN_JNOCASE )
+        if ( r->cased < 1 )
+        {
+            ptr = r->code + ptr[1] ;
+            BRANCH ;
+        }
+        ptr += 2 ;
+        NEXT ;
+
+    /* Process control */
+
+    OP( TYPE, MN_TYPE )
+    {
+        PROCDEF * proct = procdef_get( ptr[1] ) ;
+        if ( !proct )
+        {
+            fprintf( stderr, "ERROR: Runtime error in %s(%d) - Invalid type\n", r->proc->name, LOCDWORD( r, PROCESS_ID ) ) ;
+            exit( 0 );
+        }
+        *r->stack_ptr++ = proct->type ;
+        ptr += 2 ;
+        NEXT ;
+    }
+
+    OP( FRAME, MN_FRAME )
+        LOCINT32( r, FRAME_PERCENT ) += r->stack_ptr[-1];
+        r->stack_ptr-- ;
+        r->codeptr = ptr + 1 ;
+        return_value = LOCDWORD( r, PROCESS_ID );
+
+        if ( !( r->proc->flags & PROC_FUNCTION ) &&
+                instance_caller( r ) && ( LOCDWORD( r->called_by, STATUS ) & STATUS_WAITING_MASK ) )
+        {
+            /* We're returning and the parent is waiting: wake it up */
+            if ( r->called_by->stack && ( r->called_by->stack[0] & STACK_RETURN_VALUE ) )
+                r->called_by->stack_ptr[-1] = return_value;
+
+            LOCDWORD( r->called_by, STATUS ) &= ~STATUS_WAITING_MASK;
+            instance_status_changed( r->called_by );
+            r->called_by = NULL;
+        }
+        goto break_all ;
+
+    OP( END, MN_END )
+        if ( r->call_level > 0 )
+        {
+            ptr = r->code + *--r->stack_ptr ;
+            r->call_level--;
+            BRANCH ;
+        }
+
+        if ( LOCDWORD( r, STATUS ) != STATUS_DEAD ) LOCDWORD( r, STATUS ) = STATUS_KILLED ;
+        goto break_all ;
+
+    OP( RETURN, MN_RETURN )
+        if ( r->call_level > 0 )
+        {
+            ptr = r->code + *--r->stack_ptr ;
+            r->call_level--;
+            BRANCH ;
+        }
+
+        if ( LOCDWORD( r, STATUS ) != STATUS_DEAD ) LOCDWORD( r, STATUS ) = STATUS_KILLED ;
+        r->stack_ptr-- ;
+        return_value = *r->stack_ptr ;
+        goto break_all ;
+
+    /* Handlers */
+
+    OP( EXITHNDLR, MN_EXITHNDLR )
+        r->exitcode = ptr[1] ;
+        ptr += 2 ;
+        NEXT ;
+
+    OP( ERRHNDLR, MN_ERRHNDLR )
+        r->errorcode = ptr[1] ;
+        ptr += 2 ;
+        NEXT ;
+
+    /* Superinstructions (see dcb_fuse_code() in dcbr.c) */
+
+    OP( PRIVATE_LET_CONST, MN_PRIVATE_LET_CONST )
+        PRIDWORD( r, ptr[1] ) = ptr[3] ;
+        ptr += 5 ;
+        NEXT ;
+
+    OP( PRIVATE_LET_PRIVATE, MN_PRIVATE_LET_PRIVATE )
+        PRIDWORD( r, ptr[1] ) = PRIDWORD( r, ptr[3] ) ;
+        ptr += 5 ;
+        NEXT ;
+
+    OP( LOCAL_LET_CONST, MN_LOCAL_LET_CONST )
+        LOCDWORD( r, ptr[1] ) = ptr[3] ;
+        ptr += 5 ;
+        NEXT ;
+
+    OP( PRIVATE_ADD_CONST, MN_PRIVATE_ADD_CONST )
+        PRIINT32( r, ptr[1] ) += ptr[3] ;
+        ptr += 6 ;
+        NEXT ;
+
+    OP( PRIVATE_SUB_CONST, MN_PRIVATE_SUB_CONST )
+        PRIINT32( r, ptr[1] ) -= ptr[3] ;
+        ptr += 6 ;
+        NEXT ;
+
+    OP( LOCAL_ADD_CONST, MN_LOCAL_ADD_CONST )
+        LOCINT32( r, ptr[1] ) += ptr[3] ;
+        ptr += 6 ;
+        NEXT ;
+
+    OP( LOCAL_SUB_CONST, MN_LOCAL_SUB_CONST )
+        LOCINT32( r, ptr[1] ) -= ptr[3] ;
+        ptr += 6 ;
+        NEXT ;
+
+    OP( PRIVATE_INC, MN_PRIVATE_INC )
+        PRIINT32( r, ptr[1] ) += ptr[3] ;
+        ptr += 5 ;
+        NEXT ;
+
+    OP( PRIVATE_DEC, MN_PRIVATE_DEC )
+        PRIINT32( r, ptr[1] ) -= ptr[3] ;
+        ptr += 5 ;
+        NEXT ;
+
+    OP( PRIVATE_EQ_JFALSE, MN_PRIVATE_EQ_JFALSE )
+        if ( !( PRIINT32( r, ptr[1] ) == ptr[3] ) )
+        {
+            ptr = r->code + ptr[6] ;
+            BRANCH ;
+        }
+        ptr += 7 ;
+        NEXT ;
+
+    OP( PRIVATE_NE_JFALSE, MN_PRIVATE_NE_JFALSE )
+        if ( !( PRIINT32( r, ptr[1] ) != ptr[3] ) )
+        {
+            ptr = r->code + ptr[6] ;
+            BRANCH ;
+        }
+        ptr += 7 ;
+        NEXT ;
+
+    OP( PRIVATE_GT_JFALSE, MN_PRIVATE_GT_JFALSE )
+        if ( !( PRIINT32( r, ptr[1] ) > ptr[3] ) )
+        {
+            ptr = r->code + ptr[6] ;
+            BRANCH ;
+        }
+        ptr += 7 ;
+        NEXT ;
+
+    OP( PRIVATE_LT_JFALSE, MN_PRIVATE_LT_JFALSE )
+        if ( !( PRIINT32( r, ptr[1] ) < ptr[3] ) )
+        {
+            ptr = r->code + ptr[6] ;
+            BRANCH ;
+        }
+        ptr += 7 ;
+        NEXT ;
+
+    OP( PRIVATE_GTE_JFALSE, MN_PRIVATE_GTE_JFALSE )
+        if ( !( PRIINT32( r, ptr[1] ) >= ptr[3] ) )
+        {
+            ptr = r->code + ptr[6] ;
+            BRANCH ;
+        }
+        ptr += 7 ;
+        NEXT ;
+
+    OP( PRIVATE_LTE_JFALSE, MN_PRIVATE_LTE_JFALSE )
+        if ( !( PRIINT32( r, ptr[1] ) <= ptr[3] ) )
+        {
+            ptr = r->code + ptr[6] ;
+            BRANCH ;
+        }
+        ptr += 7 ;
+        NEXT ;
+
+    OP( LOCAL_EQ_JFALSE, MN_LOCAL_EQ_JFALSE )
+        if ( !( LOCINT32( r, ptr[1] ) == ptr[3] ) )
+        {
+            ptr = r->code + ptr[6] ;
+            BRANCH ;
+        }
+        ptr += 7 ;
+        NEXT ;
+
+    OP( LOCAL_NE_JFALSE, MN_LOCAL_NE_JFALSE )
+        if ( !( LOCINT32( r, ptr[1] ) != ptr[3] ) )
+        {
+            ptr = r->code + ptr[6] ;
+            BRANCH ;
+        }
+        ptr += 7 ;
+        NEXT ;
+
+    OP( LOCAL_GT_JFALSE, MN_LOCAL_GT_JFALSE )
+        if ( !( LOCINT32( r, ptr[1] ) > ptr[3] ) )
+        {
+            ptr = r->code + ptr[6] ;
+            BRANCH ;
+        }
+        ptr += 7 ;
+        NEXT ;
+
+    OP( LOCAL_LT_JFALSE, MN_LOCAL_LT_JFALSE )
+        if ( !( LOCINT32( r, ptr[1] ) < ptr[3] ) )
+        {
+            ptr = r->code + ptr[6] ;
+            BRANCH ;
+        }
+        ptr += 7 ;
+        NEXT ;
+
+    OP( LOCAL_GTE_JFALSE, MN_LOCAL_GTE_JFALSE )
+        if ( !( LOCINT32( r, ptr[1] ) >= ptr[3] ) )
+        {
+            ptr = r->code + ptr[6] ;
+            BRANCH ;
+        }
+        ptr += 7 ;
+        NEXT ;
+
+    OP( LOCAL_LTE_JFALSE, MN_LOCAL_LTE_JFALSE )
+        if ( !( LOCINT32( r, ptr[1] ) <= ptr[3] ) )
+        {
+            ptr = r->code + ptr[6] ;
+            BRANCH ;
+        }
+        ptr += 7 ;
+        NEXT ;
+
+    /* Others */
+
+    OP( DEBUG, MN_DEBUG )
+        if ( dcb.data.NSourceFiles )
+        {
+            if ( debug > 0 ) printf( "\n::: DEBUG from %s(%d)\n", r->proc->name, LOCDWORD( r, PROCESS_ID ) ) ;
+            debug_next = 1;
+        }
+        ptr++;
+        NEXT_CHECKED ;
+
+    OP( SENTENCE, MN_SENTENCE )
+        trace_sentence     = ptr[1];
+        trace_instance     = r;
+        ptr += 2 ;
+        NEXT ;
+
+    default:
+        fprintf( stderr, "ERROR: Runtime error in %s(%d) - Mnemonic 0x%02X not implemented\n", r->proc->name, LOCDWORD( r, PROCESS_ID ), *ptr ) ;
+        exit( 0 );
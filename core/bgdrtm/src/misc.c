@@ -260,11 +260,16 @@ void bgdrtm_entry( int argc, char * argv[] )
 void bgdrtm_exit( int exit_value )
 {
     int n;
+
+    profile_dump();
+
     /* Finalize all modules */
     if ( module_finalize_count )
         for ( n = 0; n < module_finalize_count; n++ )
             module_finalize_list[n]();
 
+    workers_exit();
+
     exit( exit_value ) ;
 }
 
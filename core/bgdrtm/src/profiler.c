@@ -0,0 +1,445 @@
+/*
+ *  Copyright (C) 2014-2015 Joseba García Etxebarria <joseba.gar@gmail.com>
+ *  Copyright (C) 2006-2012 SplinterGU (Fenix/Bennugd)
+ *  Copyright (C) 2002-2006 Fenix Team (Fenix)
+ *  Copyright (C) 1999-2002 José Luis Cebrián Pagüe (Fenix)
+ *
+ *  This file is part of PixTudio
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty. In no event will the authors be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *     1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *
+ *     2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include <SDL.h>
+
+#include "bgdrtm.h"
+#include "sysprocs_p.h"
+#include "pslang.h"
+#include "instance.h"
+
+/* ---------------------------------------------------------------------- */
+/* Bytecode profiler                                                      */
+/* ---------------------------------------------------------------------- */
+
+/* When profile_mode is set, every instance runs in the checked engine of
+ * instance_go(), that counts each instruction by process and by opcode,
+ * and the calls to system functions with their time. instance_go() keeps
+ * a stack of the running processes (a function called from a process
+ * runs inside it), to split the time of each one from the time of the
+ * functions it calls, and to collect the folded stacks for flamegraphs.
+ * The counters are not thread-safe, so no pure processes run in parallel
+ * while profiling. */
+
+#define PROFILE_MAX_DEPTH   64
+
+int    profile_mode = 0 ;                   /* 1 to profile the bytecode           */
+char * profile_file = NULL ;                /* File for the folded stacks, or NULL */
+
+typedef struct
+{
+    uint64_t    instructions ;
+    uint64_t    time ;                      /* Including the functions called */
+    uint64_t    self ;
+    int         runs ;
+}
+PROFILE_PROC ;
+
+typedef struct
+{
+    uint64_t    time ;
+    int         calls ;
+}
+PROFILE_SYSPROC ;
+
+typedef struct
+{
+    int         depth ;
+    int       * path ;                      /* Process types, outermost first */
+    uint64_t    self ;
+}
+PROFILE_STACK ;
+
+static PROFILE_PROC    * profile_procs = NULL ;
+static int               profile_procs_allocated = 0 ;
+
+static PROFILE_SYSPROC * profile_sysprocs = NULL ;
+static int               profile_sysprocs_allocated = 0 ;
+
+static uint64_t          profile_opcodes[256] ;
+
+static struct
+{
+    int         type ;
+    uint64_t    start ;
+    uint64_t    children ;
+}
+profile_running[PROFILE_MAX_DEPTH] ;
+
+static int               profile_depth = 0 ;
+
+static PROFILE_STACK   * profile_stacks = NULL ;
+static int               profile_stacks_count = 0 ;
+static int             * profile_stacks_hash = NULL ;    /* Index + 1 of each entry, 0 if empty */
+static int               profile_stacks_hash_size = 0 ;
+
+/* ---------------------------------------------------------------------- */
+
+static PROFILE_PROC * profile_proc( int type )
+{
+    if ( type >= profile_procs_allocated )
+    {
+        int n = type + 64 ;
+
+        profile_procs = ( PROFILE_PROC * ) realloc( profile_procs, n * sizeof( PROFILE_PROC ) ) ;
+        assert( profile_procs ) ;
+        memset( profile_procs + profile_procs_allocated, 0, ( n - profile_procs_allocated ) * sizeof( PROFILE_PROC ) ) ;
+        profile_procs_allocated = n ;
+    }
+
+    return &profile_procs[type] ;
+}
+
+/* ---------------------------------------------------------------------- */
+
+static unsigned profile_stack_hash( int depth )
+{
+    unsigned h = 2166136261u ;
+    int n ;
+
+    for ( n = 0 ; n < depth ; n++ ) h = ( h ^ ( unsigned ) profile_running[n].type ) * 16777619u ;
+
+    return h ;
+}
+
+/* Adds self time to the stack of processes running now */
+
+static void profile_stack_add( int depth, uint64_t self )
+{
+    unsigned h = profile_stack_hash( depth ), mask ;
+    PROFILE_STACK * s ;
+    int n, e ;
+
+    if ( profile_stacks_count * 2 >= profile_stacks_hash_size )
+    {
+        profile_stacks_hash_size = profile_stacks_hash_size ? profile_stacks_hash_size * 2 : 256 ;
+        free( profile_stacks_hash ) ;
+        profile_stacks_hash = ( int * ) calloc( profile_stacks_hash_size, sizeof( int ) ) ;
+        profile_stacks = ( PROFILE_STACK * ) realloc( profile_stacks, ( profile_stacks_hash_size / 2 ) * sizeof( PROFILE_STACK ) ) ;
+        assert( profile_stacks_hash && profile_stacks ) ;
+
+        /* Rehash the stacks already seen */
+
+        mask = profile_stacks_hash_size - 1 ;
+        for ( e = 0 ; e < profile_stacks_count ; e++ )
+        {
+            unsigned eh = 2166136261u ;
+
+            for ( n = 0 ; n < profile_stacks[e].depth ; n++ ) eh = ( eh ^ ( unsigned ) profile_stacks[e].path[n] ) * 16777619u ;
+            for ( eh &= mask ; profile_stacks_hash[eh] ; eh = ( eh + 1 ) & mask ) ;
+            profile_stacks_hash[eh] = e + 1 ;
+        }
+    }
+
+    mask = profile_stacks_hash_size - 1 ;
+
+    for ( h &= mask ; ( e = profile_stacks_hash[h] ) ; h = ( h + 1 ) & mask )
+    {
+        s = &profile_stacks[e - 1] ;
+        if ( s->depth != depth ) continue ;
+        for ( n = 0 ; n < depth && s->path[n] == profile_running[n].type ; n++ ) ;
+        if ( n == depth )
+        {
+            s->self += self ;
+            return ;
+        }
+    }
+
+    s = &profile_stacks[profile_stacks_count++] ;
+    s->depth = depth ;
+    s->path = ( int * ) malloc( depth * sizeof( int ) ) ;
+    assert( s->path ) ;
+    for ( n = 0 ; n < depth ; n++ ) s->path[n] = profile_running[n].type ;
+    s->self = self ;
+
+    profile_stacks_hash[h] = profile_stacks_count ;
+}
+
+/* ---------------------------------------------------------------------- */
+
+/*
+ *  FUNCTION : profile_clock
+ *
+ *  Returns the high resolution counter used for the times
+ *
+ *  PARAMS :
+ *      None
+ *
+ *  RETURN VALUE :
+ *      Value of the counter
+ */
+
+uint64_t profile_clock()
+{
+    return SDL_GetPerformanceCounter() ;
+}
+
+/*
+ *  FUNCTION : profile_enter
+ *
+ *  Called by instance_go() before running an instance
+ *
+ *  PARAMS :
+ *      r           Pointer to the instance
+ *
+ *  RETURN VALUE :
+ *      None
+ */
+
+void profile_enter( INSTANCE * r )
+{
+    if ( profile_depth < PROFILE_MAX_DEPTH )
+    {
+        profile_running[profile_depth].type     = r->proc->type ;
+        profile_running[profile_depth].children = 0 ;
+        profile_running[profile_depth].start    = profile_clock() ;
+        profile_proc( r->proc->type )->runs++ ;
+    }
+    profile_depth++ ;
+}
+
+/*
+ *  FUNCTION : profile_leave
+ *
+ *  Called by instance_go() after running an instance. The instance may
+ *  not exist anymore.
+ *
+ *  PARAMS :
+ *      None
+ *
+ *  RETURN VALUE :
+ *      None
+ */
+
+void profile_leave()
+{
+    uint64_t elapsed ;
+    PROFILE_PROC * p ;
+    int n, type ;
+
+    /* Deeper calls count as time of the last process tracked */
+
+    if ( --profile_depth >= PROFILE_MAX_DEPTH ) return ;
+
+    type = profile_running[profile_depth].type ;
+    elapsed = profile_clock() - profile_running[profile_depth].start ;
+
+    p = profile_proc( type ) ;
+    p->self += elapsed - profile_running[profile_depth].children ;
+
+    /* Recursive calls are already in the time of the outer one */
+
+    for ( n = 0 ; n < profile_depth && profile_running[n].type != type ; n++ ) ;
+    if ( n == profile_depth ) p->time += elapsed ;
+
+    profile_stack_add( profile_depth + 1, elapsed - profile_running[profile_depth].children ) ;
+
+    if ( profile_depth > 0 ) profile_running[profile_depth - 1].children += elapsed ;
+}
+
+/*
+ *  FUNCTION : profile_instruction
+ *
+ *  Counts an instruction, run by the checked engine of instance_go()
+ *
+ *  PARAMS :
+ *      r           Pointer to the instance
+ *      code        Instruction code
+ *
+ *  RETURN VALUE :
+ *      None
+ */
+
+void profile_instruction( INSTANCE * r, int code )
+{
+    profile_opcodes[code & MN_MASK]++ ;
+    profile_proc( r->proc->type )->instructions++ ;
+}
+
+/*
+ *  FUNCTION : profile_sysproc
+ *
+ *  Counts a call to a system function
+ *
+ *  PARAMS :
+ *      code        System function code
+ *      start       Value of profile_clock() before the call
+ *
+ *  RETURN VALUE :
+ *      None
+ */
+
+void profile_sysproc( int code, uint64_t start )
+{
+    uint64_t elapsed = profile_clock() - start ;
+
+    if ( code < 0 ) return ;
+
+    if ( code >= profile_sysprocs_allocated )
+    {
+        int n = code + 64 ;
+
+        profile_sysprocs = ( PROFILE_SYSPROC * ) realloc( profile_sysprocs, n * sizeof( PROFILE_SYSPROC ) ) ;
+        assert( profile_sysprocs ) ;
+        memset( profile_sysprocs + profile_sysprocs_allocated, 0, ( n - profile_sysprocs_allocated ) * sizeof( PROFILE_SYSPROC ) ) ;
+        profile_sysprocs_allocated = n ;
+    }
+
+    profile_sysprocs[code].calls++ ;
+    profile_sysprocs[code].time += elapsed ;
+}
+
+/* ---------------------------------------------------------------------- */
+
+static const char * profile_proc_name( int type )
+{
+    PROCDEF * proc = procdef_get( type ) ;
+    return proc && proc->name ? proc->name : "?" ;
+}
+
+static const char * profile_sysproc_name( int code )
+{
+    SYSPROC * p = sysproc_get( code ) ;
+    char * name = sysproc_name( code ) ;
+
+    if ( name ) return name ;
+    return p && p->name ? p->name : "?" ;
+}
+
+static int profile_cmp_procs( const void * a, const void * b )
+{
+    uint64_t x = profile_procs[*( int * ) a].self, y = profile_procs[*( int * ) b].self ;
+    return x < y ? 1 : x > y ? -1 : 0 ;
+}
+
+static int profile_cmp_sysprocs( const void * a, const void * b )
+{
+    uint64_t x = profile_sysprocs[*( int * ) a].time, y = profile_sysprocs[*( int * ) b].time ;
+    return x < y ? 1 : x > y ? -1 : 0 ;
+}
+
+static int profile_cmp_opcodes( const void * a, const void * b )
+{
+    uint64_t x = profile_opcodes[*( int * ) a], y = profile_opcodes[*( int * ) b] ;
+    return x < y ? 1 : x > y ? -1 : 0 ;
+}
+
+/*
+ *  FUNCTION : profile_dump
+ *
+ *  Prints the profile report, sorted by time, and writes the folded
+ *  stacks to profile_file (one "MAIN;PLAYER;SHOOT microseconds" line for
+ *  each stack of processes, as flamegraph.pl reads them)
+ *
+ *  PARAMS :
+ *      None
+ *
+ *  RETURN VALUE :
+ *      None
+ */
+
+void profile_dump()
+{
+    double usec = 1000000.0 / ( double ) SDL_GetPerformanceFrequency() ;
+    int * order, count, n, i ;
+    FILE * fp ;
+
+    if ( !profile_mode ) return ;
+
+    count = profile_procs_allocated > profile_sysprocs_allocated ? profile_procs_allocated : profile_sysprocs_allocated ;
+    if ( count < 256 ) count = 256 ;
+    order = ( int * ) malloc( count * sizeof( int ) ) ;
+    assert( order ) ;
+
+    /* Processes */
+
+    for ( n = 0, count = 0 ; n < profile_procs_allocated ; n++ ) if ( profile_procs[n].runs ) order[count++] = n ;
+    qsort( order, count, sizeof( int ), profile_cmp_procs ) ;
+
+    printf( "\nProfile: processes, by self time\n\n" ) ;
+    printf( "%-32s %10s %14s %14s %14s\n", "Process", "Runs", "Instructions", "Self (us)", "Total (us)" ) ;
+    for ( n = 0 ; n < count ; n++ )
+    {
+        PROFILE_PROC * p = &profile_procs[order[n]] ;
+        printf( "%-32s %10d %14llu %14.0f %14.0f\n", profile_proc_name( order[n] ), p->runs,
+                ( unsigned long long ) p->instructions, p->self * usec, p->time * usec ) ;
+    }
+
+    /* System functions */
+
+    for ( n = 0, count = 0 ; n < profile_sysprocs_allocated ; n++ ) if ( profile_sysprocs[n].calls ) order[count++] = n ;
+    qsort( order, count, sizeof( int ), profile_cmp_sysprocs ) ;
+
+    printf( "\nProfile: system functions, by time\n\n" ) ;
+    printf( "%-32s %10s %14s %14s\n", "Function", "Calls", "Time (us)", "Per call (us)" ) ;
+    for ( n = 0 ; n < count ; n++ )
+    {
+        PROFILE_SYSPROC * p = &profile_sysprocs[order[n]] ;
+        printf( "%-32s %10d %14.0f %14.3f\n", profile_sysproc_name( order[n] ), p->calls, p->time * usec, p->time * usec / p->calls ) ;
+    }
+
+    /* Opcodes */
+
+    for ( n = 0, count = 0 ; n < 256 ; n++ ) if ( profile_opcodes[n] ) order[count++] = n ;
+    qsort( order, count, sizeof( int ), profile_cmp_opcodes ) ;
+
+    printf( "\nProfile: instructions\n\n" ) ;
+    for ( n = 0 ; n < count ; n++ )
+        printf( "%-32s %14llu\n", mnemonic_name( order[n] ), ( unsigned long long ) profile_opcodes[order[n]] ) ;
+
+    free( order ) ;
+
+    /* Folded stacks */
+
+    if ( !profile_file ) return ;
+
+    if ( !( fp = fopen( profile_file, "w" ) ) )
+    {
+        fprintf( stderr, "ERROR: Can't write the profile to %s\n", profile_file ) ;
+        return ;
+    }
+
+    for ( n = 0 ; n < profile_stacks_count ; n++ )
+    {
+        PROFILE_STACK * s = &profile_stacks[n] ;
+
+        for ( i = 0 ; i < s->depth ; i++ ) fprintf( fp, "%s%s", i ? ";" : "", profile_proc_name( s->path[i] ) ) ;
+        fprintf( fp, " %.0f\n", s->self * usec ) ;
+    }
+
+    fclose( fp ) ;
+}
+
+/* ---------------------------------------------------------------------- */
@@ -46,9 +46,14 @@
 
 #define BLOCK_INCR  1024
 
-#define bit_set(m,b)    (((uint32_t *)(m))[(b)>>5] |=   1<<((b)&0x1F))
-#define bit_clr(m,b)    (((uint32_t *)(m))[(b)>>5] &= ~(1<<((b)&0x1F)))
-#define bit_tst(m,b)    (((uint32_t *)(m))[(b)>>5] &   (1<<((b)&0x1F)))
+/* Short strings made by the number conversions are interned: the same
+ * text gets the same string while somebody uses it. This is safe because
+ * every caller uses a new string right away (string_use) */
+
+#define INTERN_SIZE     1024                /* Entries in the intern table, power of 2 */
+#define INTERN_MAX_LEN  15                  /* Longest text interned */
+
+#define STRING_MIN_SIZE 32                  /* Minimum buffer size for appends */
 
 /****************************************************************************/
 /* STATIC VARIABLES :                                                       */
@@ -59,20 +64,26 @@ static char     * string_mem = NULL ;
 
 static int      string_reserved = 0;        /* Last fixed string */
 
-static char     ** string_ptr = NULL ;      /* Pointers to each string's text. Every string is allocated using strdup() or malloc().
+static char     ** string_ptr = NULL ;      /* Pointers to each string's text. Every string is allocated using malloc().
                                                A pointer of a unused slot is 0.
                                                Exception: "fixed" strings are stored in a separate memory block and should not be freed */
 static uint32_t * string_uct = NULL ;       /* Usage count for each string. An unused slot has a count of 0 */
 
-static uint32_t * string_bmp = NULL ;       /* Bitmap for speed up string creation, and reused freed slots */
+static uint32_t * string_len = NULL ;       /* Length of each string, without the ending '\0' */
+
+static uint32_t * string_size = NULL ;      /* Allocated bytes of each string's text, 0 for the fixed strings */
+
+static int      * string_next = NULL ;      /* Next free slot, for the free ones */
 
-static int      string_allocated = 0 ;      /* How many string slots are available in the ptr, uct and dontfree arrays */
+static int      string_free = -1 ;          /* First free slot, -1 if none */
 
-static int      string_bmp_start = 0 ;      /* Offset of assignable string for reused (32bits each one) */
+static int      string_allocated = 0 ;      /* How many string slots are available in the arrays */
 
 static int      string_last_id = 1 ;        /* How many strings slots are used. This is only the bigger id in use + 1.
                                                There may be unused slots in this many positions */
 
+static int      string_intern[INTERN_SIZE] ;   /* Interned string of each hash, -1 if none */
+
 /* --------------------------------------------------------------------------- */
 
 void _string_ptoa( char *t, void * ptr )
@@ -163,23 +174,72 @@ void _string_utoa( char *p, unsigned long n )
 
 static void string_alloc( int count )
 {
-    int lim = ( string_allocated >> 5 ) ;
-
     count = (( count >> 5 ) + 1 ) << 5 ;
 
     string_allocated += count ;
 
     string_ptr = ( char ** ) realloc( string_ptr, string_allocated * sizeof( char * ) ) ;
     string_uct = ( uint32_t * ) realloc( string_uct, string_allocated * sizeof( uint32_t ) ) ;
-    string_bmp = ( uint32_t * ) realloc( string_bmp, ( string_allocated >> 5 ) * sizeof( uint32_t ) );
+    string_len = ( uint32_t * ) realloc( string_len, string_allocated * sizeof( uint32_t ) ) ;
+    string_size = ( uint32_t * ) realloc( string_size, string_allocated * sizeof( uint32_t ) ) ;
+    string_next = ( int * ) realloc( string_next, string_allocated * sizeof( int ) ) ;
 
-    if ( !string_ptr || !string_uct || !string_bmp )
+    if ( !string_ptr || !string_uct || !string_len || !string_size || !string_next )
     {
         fprintf( stderr, "ERROR: Runtime error - string_alloc: out of memory\n" ) ;
         exit( 0 );
     }
 
-    memset( &string_bmp[ lim ], '\0', ( count >> 5 ) * sizeof ( uint32_t ) );
+    memset( &string_ptr[ string_allocated - count ], '\0', count * sizeof ( char * ) );
+}
+
+/****************************************************************************/
+/* FUNCTION : string_hash                                                   */
+/****************************************************************************/
+/* Slot of a text in the intern table (FNV-1a)                              */
+/****************************************************************************/
+
+static int string_hash( const char * ptr, unsigned len )
+{
+    uint32_t h = 2166136261u ;
+
+    while ( len-- ) h = ( h ^ ( uint8_t ) * ptr++ ) * 16777619u ;
+
+    return h & ( INTERN_SIZE - 1 ) ;
+}
+
+/****************************************************************************/
+/* FUNCTION : string_unintern                                               */
+/****************************************************************************/
+/* Takes a string out of the intern table, if it is there. This should be   */
+/* called before the string is freed or its text changed.                   */
+/****************************************************************************/
+
+static void string_unintern( int code )
+{
+    int slot ;
+
+    if ( string_len[code] > INTERN_MAX_LEN ) return ;
+
+    slot = string_hash( string_ptr[code], string_len[code] ) ;
+    if ( string_intern[slot] == code ) string_intern[slot] = -1 ;
+}
+
+/****************************************************************************/
+/* FUNCTION : string_release                                                */
+/****************************************************************************/
+/* Frees the text of a dynamic string and puts its slot in the free list    */
+/****************************************************************************/
+
+static void string_release( int code )
+{
+    string_unintern( code ) ;
+
+    free( string_ptr[code] ) ;
+    string_ptr[code] = NULL ;
+
+    string_next[code] = string_free ;
+    string_free = code ;
 }
 
 /****************************************************************************/
@@ -199,7 +259,9 @@ void string_init()
 
     string_last_id = 0;
     string_reserved = 0;
-    string_bmp_start = 0;
+    string_free = -1;
+
+    memset( string_intern, 0xFF, sizeof( string_intern ) );
 }
 
 /****************************************************************************/
@@ -219,18 +281,13 @@ void string_dump( void ( *wlog )( const char *fmt, ... ) )
     else
         printf( "[STRING] ---- Dumping MaxID=%d strings ----\n", string_allocated ) ;
 
-    for ( i = 0; i < string_allocated; i++ )
+    for ( i = 0; i < string_last_id; i++ )
     {
         if ( string_ptr[i] )
         {
             if ( !string_uct[i] )
             {
-                if ( i >= string_reserved )
-                {
-                    free( string_ptr[i] ) ;
-                    string_ptr[i] = NULL ;
-                    bit_clr( string_bmp, i );
-                }
+                if ( i >= string_reserved ) string_release( i ) ;
                 continue ;
             }
             used++;
@@ -265,6 +322,54 @@ const char * string_get( int code )
     return string_ptr[code] ;
 }
 
+/****************************************************************************/
+/* FUNCTION : string_length                                                 */
+/****************************************************************************/
+/* int code: identifier of the string                                       */
+/****************************************************************************/
+/* Returns the length of an string, without calling strlen()                */
+/****************************************************************************/
+
+int string_length( int code )
+{
+    assert( code < string_allocated && code >= 0 ) ;
+    return string_ptr[code] ? ( int ) string_len[code] : 0 ;
+}
+
+/****************************************************************************/
+/* FUNCTION : string_load_mem                                               */
+/****************************************************************************/
+/* char * text: the text area of the DCB                                    */
+/* uint32_t * string_offset: offset of every string in the text area        */
+/* int nstrings: number of strings                                          */
+/****************************************************************************/
+/* Loads the strings of a DCB already in memory (see string_load). The text */
+/* is used in place, so it must stay valid for the whole execution. The     */
+/* offsets are not needed after the call.                                   */
+/****************************************************************************/
+
+void string_load_mem( char * text, uint32_t * string_offset, int nstrings )
+{
+    int n;
+
+    string_mem = text;
+
+    if ( string_last_id + nstrings > string_allocated )
+        string_alloc((( string_last_id + nstrings - string_allocated ) / BLOCK_INCR + 1 ) * BLOCK_INCR ) ;
+
+    for ( n = 0 ; n < nstrings ; n++ )
+    {
+        string_ptr[string_last_id + n] = string_mem + string_offset[n] ;
+        string_uct[string_last_id + n] = 0 ;
+        string_len[string_last_id + n] = strlen( string_mem + string_offset[n] ) ;
+        string_size[string_last_id + n] = 0 ;
+    }
+
+    string_last_id += nstrings ;
+
+    string_reserved = string_last_id ;
+}
+
 /****************************************************************************/
 /* FUNCTION : string_load                                                   */
 /****************************************************************************/
@@ -281,10 +386,10 @@ const char * string_get( int code )
 void string_load( void * fp, int ostroffs, int ostrdata, int nstrings, int totalsize )
 {
     uint32_t * string_offset;
-    int n;
+    char * text;
 
-    string_mem = malloc( totalsize );
-    assert( string_mem );
+    text = malloc( totalsize );
+    assert( text );
 
     string_offset = ( uint32_t * ) malloc( sizeof( uint32_t ) * nstrings ) ;
     assert( string_offset );
@@ -292,25 +397,10 @@ void string_load( void * fp, int ostroffs, int ostrdata, int nstrings, int total
     file_seek(( file * )fp, ostroffs, SEEK_SET ) ;
     file_readUint32A(( file * )fp, string_offset, nstrings ) ;
 
-    if ( string_last_id + nstrings > string_allocated )
-        string_alloc((( string_last_id + nstrings - string_allocated ) / BLOCK_INCR + 1 ) * BLOCK_INCR ) ;
-
     file_seek(( file * )fp, ostrdata, SEEK_SET ) ;
-    file_read(( file * )fp, string_mem, totalsize ) ;
-
-    for ( n = 0 ; n < nstrings ; n++ )
-    {
-        string_ptr[string_last_id + n] = string_mem + string_offset[n] ;
-        string_uct[string_last_id + n] = 0 ;
-        bit_set( string_bmp, string_last_id + n );
-    }
-
-    string_last_id += nstrings ;
-
-    string_last_id = ( string_last_id + 32 ) & ~0x1F;
+    file_read(( file * )fp, text, totalsize ) ;
 
-    string_reserved = string_last_id ;
-    string_bmp_start = string_last_id >> 5;
+    string_load_mem( text, string_offset, nstrings ) ;
 
     free( string_offset ) ;
 }
@@ -343,103 +433,96 @@ void string_use( int code )
 
 void string_discard( int code )
 {
-    if ( code < 0 || code > string_allocated || !string_ptr[code] ) return;
+    if ( code < 0 || code >= string_allocated || !string_ptr[code] ) return;
 
     if ( !string_uct[code] ) return ;
 
     string_uct[code]-- ;
 
-    if ( !string_uct[code] )
-    {
-        if ( code >= string_reserved )
-        {
-            free( string_ptr[code] ) ;
-            string_ptr[code] = NULL ;
-            bit_clr( string_bmp, code );
-        }
-    }
+    if ( !string_uct[code] && code >= string_reserved ) string_release( code ) ;
 }
 
 /****************************************************************************/
 /* FUNCTION : string_getid                                                  */
 /****************************************************************************/
-/* Searchs for an available ID and returns it. If none available, more space*/
-/* is allocated for the new string. This is used for new strings only.      */
+/* Returns an available ID: the last one freed, or the next never used. If  */
+/* none available, more space is allocated for the new string. This is used */
+/* for new strings only.                                                    */
 /****************************************************************************/
 
 static int string_getid()
 {
-    int n, nb, lim, ini ;
+    int id ;
 
-    /* Si tengo suficientes alocados, retorno el siguiente segun string_last_id */
-    if ( string_last_id < string_allocated )
+    if ( string_free != -1 )
     {
-        if ( !bit_tst( string_bmp, string_last_id ) )
-        {
-            bit_set( string_bmp, string_last_id );
-            return string_last_id++ ;
-        }
+        id = string_free ;
+        string_free = string_next[id] ;
+        return id ;
     }
 
-    /* Ya no tengo mas espacio, entonces busco alguno libre entre ~+32 desde el ultimo fijo y ~-32 del ultimo asignado */
+    if ( string_last_id >= string_allocated ) string_alloc( BLOCK_INCR ) ;
 
-    ini = ( string_last_id < string_allocated ) ? ( string_last_id >> 5 ) : string_reserved ;
-    lim = ( string_allocated >> 5 ) ;
+    return string_last_id++ ;
+}
 
-    while ( 1 )
-    {
-        for ( n = ini; n < lim ; n++ )
-        {
-            if ( string_bmp[n] != ( uint32_t ) 0xFFFFFFFF ) /* Aca hay 1 libre, busco cual es */
-            {
-                for ( nb = 0; nb < 32; nb++ )
-                {
-                    if ( !bit_tst( string_bmp + n, nb ) )
-                    {
-                        string_last_id = ( n << 5 ) + nb ;
-                        bit_set( string_bmp, string_last_id );
-                        return string_last_id++ ;
-                    }
-                }
-            }
-        }
-        if ( ini == string_reserved ) break;
-        lim = ini;
-        ini = string_reserved;
-    }
+/****************************************************************************/
+/* FUNCTION : string_put                                                    */
+/****************************************************************************/
+/* Stores a malloc'ed text as a new string and returns its ID               */
+/****************************************************************************/
 
-    string_last_id = string_allocated ;
+static int string_put( char * str, unsigned len, unsigned size )
+{
+    int id = string_getid() ;
 
-    /* Incremento espacio, no habia libres */
-    string_alloc( BLOCK_INCR ) ;
+    string_ptr[id] = str ;
+    string_uct[id] = 0 ;
+    string_len[id] = len ;
+    string_size[id] = size ;
 
-    assert( !bit_tst( string_bmp, string_last_id ) );
+    return id ;
+}
 
-    /* Devuelvo string_last_id e incremento en 1, ya que ahora tengo BLOCK_INCR mas que antes */
-    bit_set( string_bmp, string_last_id );
-    return string_last_id++ ;
+/****************************************************************************/
+/* FUNCTION : string_grow                                                   */
+/****************************************************************************/
+/* Makes room in a dynamic string for a text of the given length. The       */
+/* buffer size is doubled, so many appends take linear time overall.        */
+/****************************************************************************/
+
+static void string_grow( int code, unsigned len )
+{
+    unsigned size = string_size[code] < STRING_MIN_SIZE ? STRING_MIN_SIZE : string_size[code] ;
+    char * str ;
+
+    if ( len < string_size[code] ) return ;
+
+    while ( size <= len ) size <<= 1 ;
+
+    str = ( char * ) realloc( string_ptr[code], size ) ;
+    assert( str ) ;
+
+    string_ptr[code] = str ;
+    string_size[code] = size ;
 }
 
 /****************************************************************************/
 /* FUNCTION : string_new                                                    */
 /****************************************************************************/
-/* Create a new string. It returns its ID. Note that it uses strdup()       */
+/* Create a new string. It returns its ID.                                  */
 /* TODO: do something if no memory available                                */
 /****************************************************************************/
 
 int string_new( const char * ptr )
 {
-    char * str = strdup( ptr ) ;
-    int    id ;
+    unsigned len = strlen( ptr ) ;
+    char * str = malloc( len + 1 ) ;
 
     assert( str ) ;
+    memcpy( str, ptr, len + 1 ) ;
 
-    id = string_getid() ;
-
-    string_ptr[id] = str ;
-    string_uct[id] = 0 ;
-
-    return id ;
+    return string_put( str, len, len + 1 ) ;
 }
 
 /*
@@ -457,16 +540,47 @@ int string_new( const char * ptr )
 
 int string_newa( const char * ptr, unsigned count )
 {
-    char * str = malloc( count + 1 );
-    int    id ;
+    const char * end = memchr( ptr, '\0', count ) ;
+    char * str ;
+
+    if ( end ) count = end - ptr ;
 
+    str = malloc( count + 1 );
     assert( str ) ;
-    id = string_getid() ;
 
-    strncpy( str, ptr, count );
+    memcpy( str, ptr, count );
     str[count] = '\0';
-    string_ptr[id] = str ;
-    string_uct[id] = 0 ;
+
+    return string_put( str, count, count + 1 ) ;
+}
+
+/*
+ *  FUNCTION : string_intern_new
+ *
+ *  Create a short string, or return the one already created with the
+ *  same text if somebody still uses it
+ *
+ *  PARAMS:
+ *              ptr         Pointer to the text
+ *              len         Length of the text
+ *
+ *  RETURN VALUE:
+ *      ID of the string
+ */
+
+static int string_intern_new( const char * ptr, unsigned len )
+{
+    int slot, id ;
+
+    if ( len > INTERN_MAX_LEN ) return string_newa( ptr, len ) ;
+
+    slot = string_hash( ptr, len ) ;
+    id = string_intern[slot] ;
+
+    if ( id >= 0 && string_len[id] == len && !memcmp( string_ptr[id], ptr, len ) ) return id ;
+
+    id = string_newa( ptr, len ) ;
+    string_intern[slot] = id ;
 
     return id ;
 }
@@ -474,29 +588,25 @@ int string_newa( const char * ptr, unsigned count )
 /****************************************************************************/
 /* FUNCTION : string_concat                                                 */
 /****************************************************************************/
-/* Add some text to an string and return the resulting string. This does not*/
-/* modify the original string, but creates a new one.                       */
+/* Add some text to an string and return the resulting string. This         */
+/* modifies the original string, and returns its same ID.                   */
 /****************************************************************************/
 
 int string_concat( int code1, char * str2 )
 {
-    char * str1 ;
-    int len1, len2;
-
-    assert( code1 < string_allocated && code1 >= 0 ) ;
+    unsigned len1, len2 ;
 
-    str1 = string_ptr[code1] ;
-    assert( str1 ) ;
-
-    len1 = strlen( str1 ) ;
-    len2 = strlen( str2 ) + 1 ;
+    assert( code1 < string_allocated && code1 >= string_reserved ) ;
+    assert( string_ptr[code1] ) ;
 
-    str1 = ( char * ) realloc( str1, len1 + len2 ) ;
-    assert( str1 ) ;
+    string_unintern( code1 ) ;
 
-    memmove( str1 + len1, str2, len2 ) ;
+    len1 = string_len[code1] ;
+    len2 = strlen( str2 ) ;
 
-    string_ptr[code1] = str1 ;
+    string_grow( code1, len1 + len2 ) ;
+    memmove( string_ptr[code1] + len1, str2, len2 + 1 ) ;
+    string_len[code1] = len1 + len2 ;
 
     return code1 ;
 }
@@ -513,27 +623,52 @@ int string_add( int code1, int code2 )
     const char * str1 = string_get( code1 ) ;
     const char * str2 = string_get( code2 ) ;
     char * str3 ;
-    int id ;
-    int len1, len2;
+    unsigned len1, len2;
 
     assert( str1 ) ;
     assert( str2 ) ;
 
-    len1 = strlen( str1 ) ;
-    len2 = strlen( str2 ) + 1;
+    len1 = string_len[code1] ;
+    len2 = string_len[code2] ;
 
-    str3 = ( char * ) malloc( len1 + len2 ) ;
+    str3 = ( char * ) malloc( len1 + len2 + 1 ) ;
     assert( str3 ) ;
 
-    memmove( str3, str1, len1 ) ;
-    memmove( str3 + len1, str2, len2 ) ;
+    memcpy( str3, str1, len1 ) ;
+    memcpy( str3 + len1, str2, len2 + 1 ) ;
 
-    id = string_getid() ;
+    return string_put( str3, len1 + len2, len1 + len2 + 1 ) ;
+}
 
-    string_ptr[id] = str3 ;
-    string_uct[id] = 0 ;
+/****************************************************************************/
+/* FUNCTION : string_append                                                 */
+/****************************************************************************/
+/* Add an string to another one, as string_add() does. If nobody else uses  */
+/* the first string (its usage count is 1), it is changed in place and its  */
+/* same ID is returned, so building a string in a loop is not quadratic.    */
+/****************************************************************************/
 
-    return id ;
+int string_append( int code1, int code2 )
+{
+    unsigned len1, len2 ;
+
+    if ( code1 < string_reserved || string_uct[code1] != 1 || !string_ptr[code1] )
+        return string_add( code1, code2 ) ;
+
+    assert( string_get( code2 ) ) ;
+
+    string_unintern( code1 ) ;
+
+    len1 = string_len[code1] ;
+    len2 = string_len[code2] ;
+
+    /* code2 may be code1, so take its pointer after growing */
+
+    string_grow( code1, len1 + len2 ) ;
+    memmove( string_ptr[code1] + len1, string_ptr[code2], len2 + 1 ) ;
+    string_len[code1] = len1 + len2 ;
+
+    return code1 ;
 }
 
 /****************************************************************************/
@@ -544,19 +679,11 @@ int string_add( int code1, int code2 )
 
 int string_ptoa( void * n )
 {
-    char * str ;
-    int id ;
-
-    str = ( char * ) malloc( 10 ) ;
-    assert( str )  ;
+    char str[16] ;
 
     _string_ptoa( str, n ) ;
 
-    id = string_getid() ;
-    string_ptr[id] = str ;
-    string_uct[id] = 0 ;
-
-    return id ;
+    return string_intern_new( str, 8 ) ;
 }
 
 /****************************************************************************/
@@ -567,10 +694,7 @@ int string_ptoa( void * n )
 
 int string_ftoa( float n )
 {
-    char * str = ( char * ) malloc( 32 ), * ptr = str;
-    int id ;
-
-    assert( str )  ;
+    char str[64], * ptr = str ;
 
     ptr += sprintf( str, "%f", n ) - 1;
 
@@ -579,18 +703,15 @@ int string_ftoa( float n )
         if ( *ptr != '0' ) break ;
         *ptr-- = 0 ;
     }
-    if ( ptr >= str && *ptr == '.' ) *ptr = 0 ;
+    if ( ptr >= str && *ptr == '.' ) *ptr-- = 0 ;
     if ( *str == 0 )
     {
         *str = '0';
         *( str + 1 ) = '\0';
+        ptr = str ;
     }
 
-    id = string_getid() ;
-    string_ptr[id] = str ;
-    string_uct[id] = 0 ;
-
-    return id ;
+    return string_intern_new( str, ptr + 1 - str ) ;
 }
 
 /****************************************************************************/
@@ -601,19 +722,11 @@ int string_ftoa( float n )
 
 int string_itoa( int n )
 {
-    char * str ;
-    int id ;
-
-    str = ( char * ) malloc( 16 ) ;
-    assert( str )  ;
+    char str[16] ;
 
     _string_ntoa( str, n ) ;
 
-    id = string_getid() ;
-    string_ptr[id] = str ;
-    string_uct[id] = 0 ;
-
-    return id ;
+    return string_intern_new( str, strlen( str ) ) ;
 }
 
 /****************************************************************************/
@@ -624,33 +737,32 @@ int string_itoa( int n )
 
 int string_uitoa( unsigned int n )
 {
-    char * str ;
-    int id ;
-
-    str = ( char * ) malloc( 16 ) ;
-    assert( str )  ;
+    char str[16] ;
 
     _string_utoa( str, n ) ;
 
-    id = string_getid() ;
-    string_ptr[id] = str ;
-    string_uct[id] = 0 ;
-
-    return id ;
+    return string_intern_new( str, strlen( str ) ) ;
 }
 
 /****************************************************************************/
 /* FUNCTION : string_comp                                                   */
 /****************************************************************************/
-/* Compare two strings using strcmp and return the result                   */
+/* Compare two strings and return the result, as strcmp does                */
 /****************************************************************************/
 
 int string_comp( int code1, int code2 )
 {
     const char * str1 = string_get( code1 ) ;
     const char * str2 = string_get( code2 ) ;
+    unsigned len ;
+
+    if ( code1 == code2 ) return 0 ;
+
+    /* Comparing the ending '\0' of the shortest string gives the order */
+
+    len = string_len[code1] < string_len[code2] ? string_len[code1] : string_len[code2] ;
 
-    return strcmp( str1, str2 ) ;
+    return memcmp( str1, str2, len + 1 ) ;
 }
 
 /****************************************************************************/
@@ -671,7 +783,7 @@ int string_char( int n, int nchar )
 
     if ( nchar < 0 )
     {
-        nchar = strlen( str ) + nchar ;
+        nchar = string_len[n] + nchar ;
         if ( nchar < 0 ) return 0 ;
     }
 
@@ -691,11 +803,10 @@ int string_char( int n, int nchar )
 int string_substr( int code, int first, int len )
 {
     const char * str = string_get( code ) ;
-    char       * ptr ;
-    int          rlen, n ;
+    int          rlen ;
 
     assert( str ) ;
-    rlen = strlen( str ) ;
+    rlen = string_len[code] ;
 
     if ( first < 0 )
     {
@@ -713,15 +824,7 @@ int string_substr( int code, int first, int len )
 
     if (( first + len ) > rlen ) len = ( rlen - first ) ;
 
-    ptr = ( char * )malloc( len + 1 ) ;
-    memcpy( ptr, str + first, len ) ;
-    ptr[len] = '\0' ;
-
-    n = string_getid() ;
-    string_ptr[n] = ptr ;
-    string_uct[n] = 0 ;
-
-    return n ;
+    return string_newa( str + first, len ) ;
 }
 
 /*
@@ -750,7 +853,7 @@ int string_find( int code1, int code2, int first )
 
     if ( first < 0 )
     {
-        first += strlen( str1 ) ;
+        first += string_len[code1] ;
         if ( first < 0 ) return -1;
         str1 += first;
     }
@@ -798,21 +901,16 @@ int string_ucase( int code )
 {
     const char * str = string_get( code ) ;
     char       * base, * ptr ;
-    int          id ;
 
     assert( str ) ;
 
-    base = ( char * )malloc( strlen( str ) + 1 ) ;
+    base = ( char * )malloc( string_len[code] + 1 ) ;
     assert( base ) ;
 
     for ( ptr = base; *str ; ptr++, str++ ) *ptr = TOUPPER( *str ) ;
     ptr[0] = '\0' ;
 
-    id = string_getid() ;
-    string_ptr[id] = base ;
-    string_uct[id] = 0 ;
-
-    return id ;
+    return string_put( base, ptr - base, ptr - base + 1 ) ;
 }
 
 /*
@@ -832,21 +930,16 @@ int string_lcase( int code )
 {
     const char * str = string_get( code ) ;
     char       * base, * ptr ;
-    int          id ;
 
     assert( str ) ;
 
-    base = ( char * )malloc( strlen( str ) + 1 ) ;
+    base = ( char * )malloc( string_len[code] + 1 ) ;
     assert( base ) ;
 
     for ( ptr = base; *str ; ptr++, str++ ) *ptr = TOLOWER( *str ) ;
     ptr[0] = '\0' ;
 
-    id = string_getid() ;
-    string_ptr[id] = base ;
-    string_uct[id] = 0 ;
-
-    return id ;
+    return string_put( base, ptr - base, ptr - base + 1 ) ;
 }
 
 /*
@@ -864,19 +957,16 @@ int string_lcase( int code )
 int string_strip( int code )
 {
     const char * str = string_get( code ) ;
-    char * base, * ptr;
-    int id = string_new( str );
+    const char * end ;
 
-    ptr = base = ( char * )string_get( id ) ;
+    assert( str );
 
-    assert( ptr );
+    end = str + string_len[code] ;
 
     while ( *str == ' ' || *str == '\n' || *str == '\r' || *str == '\t' ) str++;
-    while ( *str ) *ptr++ = *str++;
-    while ( ptr > base && ( ptr[-1] == ' ' || ptr[-1] == '\n' || ptr[-1] == '\r' || ptr[-1] == '\t' ) ) ptr--;
-    *ptr = '\0';
+    while ( end > str && ( end[-1] == ' ' || end[-1] == '\n' || end[-1] == '\r' || end[-1] == '\t' ) ) end--;
 
-    return id ;
+    return string_newa( str, end - str ) ;
 }
 
 /*
@@ -896,7 +986,7 @@ int string_format( double number, int dec, char point, char thousands )
 {
     char * str = malloc( 128 );
     char * s = str, * t, * p = NULL;
-    int c, id, neg ;
+    int c, neg ;
 
     assert( str );
 
@@ -943,12 +1033,7 @@ int string_format( double number, int dec, char point, char thousands )
         *t-- = *s-- ;
     }
 
-    id = string_getid() ;
-
-    string_ptr[id] = str ;
-    string_uct[id] = 0 ;
-
-    return id;
+    return string_put( str, strlen( str ), 128 ) ;
 }
 
 /*
@@ -1000,11 +1085,10 @@ int string_pad( int code, int total, int align )
 
     int    len;
     int    spaces = 0;
-    int    id;
     char * str;
 
     assert( ptr );
-    len = strlen( ptr );
+    len = string_len[code];
     if ( len < total ) spaces = total - len;
 
     if ( !spaces ) return string_new( ptr ) ;
@@ -1024,9 +1108,5 @@ int string_pad( int code, int total, int align )
         str[total] = '\0';
     }
 
-    id = string_getid() ;
-    string_ptr[id] = str ;
-    string_uct[id] = 0 ;
-
-    return id ;
+    return string_put( str, total, total + 1 ) ;
 }
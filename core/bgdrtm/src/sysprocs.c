@@ -324,7 +324,7 @@ int compare_priority( const HOOK * a1, const HOOK * a2 )
 
 /* ---------------------------------------------------------------------- */
 
-int sysproc_add( char * name, char * paramtypes, int type, void * func )
+static int sysproc_add_flags( char * name, char * paramtypes, int type, void * func, int flags )
 {
     static SYSPROC * sysproc_new = 0 ;
     static int sysproc_count = 0 ;
@@ -352,6 +352,7 @@ int sysproc_add( char * name, char * paramtypes, int type, void * func )
     sysproc_new->type = type ;
     sysproc_new->func = ( SYSFUNC * ) func ;
     sysproc_new->id = getid( name ) ;
+    sysproc_new->flags = flags ;
 
     sysproc_new++ ;
     sysproc_count++ ;
@@ -363,6 +364,13 @@ int sysproc_add( char * name, char * paramtypes, int type, void * func )
 
 /* ---------------------------------------------------------------------- */
 
+int sysproc_add( char * name, char * paramtypes, int type, void * func )
+{
+    return sysproc_add_flags( name, paramtypes, type, func, 0 ) ;
+}
+
+/* ---------------------------------------------------------------------- */
+
 SYSPROC * sysproc_get( int code )
 {
     return sysproc_tab[code] ;
@@ -376,7 +384,7 @@ void sysproc_add_tab( DLSYSFUNCS * functions_exports )
     {
         while ( functions_exports->name )
         {
-            sysproc_add( functions_exports->name, functions_exports->paramtypes, functions_exports->type, functions_exports->func );
+            sysproc_add_flags( functions_exports->name, functions_exports->paramtypes, functions_exports->type, functions_exports->func, functions_exports->flags );
             functions_exports++;
         }
     }
@@ -0,0 +1,320 @@
+/*
+ *  Copyright (C) 2014-2015 Joseba García Etxebarria <joseba.gar@gmail.com>
+ *  Copyright (C) 2006-2012 SplinterGU (Fenix/Bennugd)
+ *  Copyright (C) 2002-2006 Fenix Team (Fenix)
+ *  Copyright (C) 1999-2002 José Luis Cebrián Pagüe (Fenix)
+ *
+ *  This file is part of PixTudio
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty. In no event will the authors be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *     1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *
+ *     2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include <SDL.h>
+
+#include "bgdrtm.h"
+#include "bgddl.h"
+#include "sysprocs_p.h"
+#include "pslang.h"
+#include "instance.h"
+#include "offsets.h"
+
+/* ---------------------------------------------------------------------- */
+/* Parallel execution of pure processes                                   */
+/* ---------------------------------------------------------------------- */
+
+/* A pure process only touches its own variables and calls system
+ * functions flagged as SYSFUNC_THREADSAFE, so at the start of every frame
+ * all the pure instances ready to run are executed at once by a pool of
+ * worker threads. Anything that changes shared state is left for the main
+ * thread: a pure instance that ends just goes KILLED, and is destroyed by
+ * the serial loop of instance_go_all() as usual. */
+
+int parallel_workers = 0 ;                  /* Worker threads, 0 for none */
+
+static SDL_Thread ** worker_threads = NULL ;
+static int           worker_count   = 0 ;
+
+static SDL_mutex   * worker_lock    = NULL ;
+static SDL_cond    * worker_start   = NULL ;
+static SDL_cond    * worker_done    = NULL ;
+
+static int           worker_batch   = 0 ;   /* Changes on every dispatch */
+static int           worker_busy    = 0 ;
+static int           worker_quit    = 0 ;
+
+static INSTANCE   ** work_list      = NULL ;
+static int           work_count     = 0 ;
+static int           work_allocated = 0 ;
+static SDL_atomic_t  work_next ;
+
+/* ---------------------------------------------------------------------- */
+
+/*
+ *  FUNCTION : instance_set_pure
+ *
+ *  Marks a process as pure, after checking that its code doesn't use
+ *  global or remote variables, strings, other processes, debug info, or
+ *  system functions that are not thread-safe.
+ *
+ *  PARAMS :
+ *      proc            Pointer to the procedure definition
+ *      pure            1 to mark the process, 0 to unmark it
+ *
+ *  RETURN VALUE :
+ *      1 if the process is pure now, 0 otherwise
+ */
+
+int instance_set_pure( PROCDEF * proc, int pure )
+{
+    int * code = proc->original_code ? proc->original_code : proc->code ;
+    int count = proc->code_size / sizeof( int ) ;
+    int pos ;
+    SYSPROC * p ;
+
+    proc->flags &= ~PROC_PURE ;
+    if ( !pure ) return 0 ;
+
+    for ( pos = 0 ; pos < count ; pos += 1 + MN_PARAMS( code[pos] ) )
+    {
+        if ( MN_TYPEOF( code[pos] ) == MN_STRING ) return 0 ;
+
+        switch ( code[pos] & MN_MASK )
+        {
+            case MN_CALL:
+            case MN_PROC:
+            case MN_CLONE:
+            case MN_DEBUG:
+            case MN_SENTENCE:   /* Sets the debugger globals, with -g */
+            case MN_GLOBAL:
+            case MN_REMOTE:
+            case MN_GET_GLOBAL:
+            case MN_GET_REMOTE:
+            case MN_REMOTE_PUBLIC:
+            case MN_GET_REMOTE_PUBLIC:
+            case MN_SUBSTR:
+            case MN_STRI2CHR:
+            case MN_INT2STR:
+            case MN_FLOAT2STR:
+            case MN_CHR2STR:
+            case MN_A2STR:
+            case MN_STR2A:
+            case MN_STRACAT:
+            case MN_POINTER2STR:
+            case MN_STR2INT:
+            case MN_STR2FLOAT:
+            case MN_STR2CHR:
+                return 0 ;
+
+            case MN_SYSCALL:
+            case MN_SYSPROC:
+                p = sysproc_get( code[pos + 1] ) ;
+                if ( !p || !( p->flags & SYSFUNC_THREADSAFE ) ) return 0 ;
+                break ;
+        }
+    }
+
+    proc->flags |= PROC_PURE ;
+    return 1 ;
+}
+
+/* ---------------------------------------------------------------------- */
+
+static void work_run()
+{
+    int n ;
+
+    while ( ( n = SDL_AtomicAdd( &work_next, 1 ) ) < work_count )
+        instance_go( work_list[n] ) ;
+}
+
+/* ---------------------------------------------------------------------- */
+
+static int worker_main( void * data )
+{
+    int batch = 0 ;
+
+    SDL_LockMutex( worker_lock ) ;
+    while ( 1 )
+    {
+        while ( !worker_quit && batch == worker_batch ) SDL_CondWait( worker_start, worker_lock ) ;
+        if ( worker_quit ) break ;
+        batch = worker_batch ;
+        SDL_UnlockMutex( worker_lock ) ;
+
+        work_run() ;
+
+        SDL_LockMutex( worker_lock ) ;
+        if ( !--worker_busy ) SDL_CondSignal( worker_done ) ;
+    }
+    SDL_UnlockMutex( worker_lock ) ;
+
+    return 0 ;
+}
+
+/* ---------------------------------------------------------------------- */
+
+static int workers_init()
+{
+    char name[32] ;
+
+    if ( worker_threads ) return worker_count ;
+
+    worker_lock  = SDL_CreateMutex() ;
+    worker_start = SDL_CreateCond() ;
+    worker_done  = SDL_CreateCond() ;
+
+    if ( !worker_lock || !worker_start || !worker_done )
+    {
+        parallel_workers = 0 ;
+        return 0 ;
+    }
+
+    /* The main thread works too */
+
+    worker_threads = ( SDL_Thread ** ) calloc( parallel_workers, sizeof( SDL_Thread * ) ) ;
+    assert( worker_threads ) ;
+
+    for ( worker_count = 0 ; worker_count < parallel_workers - 1 ; worker_count++ )
+    {
+        sprintf( name, "Pure process worker %d", worker_count + 1 ) ;
+        if ( !( worker_threads[worker_count] = SDL_CreateThread( worker_main, name, NULL ) ) ) break ;
+    }
+
+    return worker_count ;
+}
+
+/* ---------------------------------------------------------------------- */
+
+/*
+ *  FUNCTION : workers_exit
+ *
+ *  Stops the worker threads
+ *
+ *  PARAMS :
+ *      None
+ *
+ *  RETURN VALUE :
+ *      None
+ */
+
+void workers_exit()
+{
+    int n ;
+
+    if ( !worker_threads ) return ;
+
+    SDL_LockMutex( worker_lock ) ;
+    worker_quit = 1 ;
+    SDL_CondBroadcast( worker_start ) ;
+    SDL_UnlockMutex( worker_lock ) ;
+
+    for ( n = 0 ; n < worker_count ; n++ ) SDL_WaitThread( worker_threads[n], NULL ) ;
+
+    free( worker_threads ) ;
+    worker_threads = NULL ;
+    worker_count = 0 ;
+}
+
+/* ---------------------------------------------------------------------- */
+
+/*
+ *  FUNCTION : instance_go_pure
+ *
+ *  Runs at once, in the worker threads, every pure instance that is
+ *  ready to run this frame. The exec hooks are called before, from the
+ *  main thread, in priority order.
+ *
+ *  PARAMS :
+ *      None
+ *
+ *  RETURN VALUE :
+ *      Number of instances executed
+ */
+
+int instance_go_pure()
+{
+    INSTANCE * i ;
+    int n ;
+
+    if ( parallel_workers < 2 || debug > 0 || debug_mode || force_debug || profile_mode ) return 0 ;
+    if ( instance_pre_execute_hook_count || instance_pos_execute_hook_count ) return 0 ;
+    if ( !workers_init() ) return 0 ;
+
+    work_count = 0 ;
+
+    for ( i = instance_next_scheduled( NULL ) ; i ; i = instance_next_scheduled( i ) )
+    {
+        if ( !( i->proc->flags & PROC_PURE ) || i->called_by || i->breakpoint || i->proc->breakpoint ) continue ;
+        if ( LOCDWORD( i, STATUS ) != STATUS_RUNNING || LOCINT32( i, FRAME_PERCENT ) >= 100 ) continue ;
+
+        /* The first run is serial. The threaded code table of the process
+           must be complete, as the workers only read it */
+
+        if ( i->first_run || !instance_threaded_ready( i->proc ) ) continue ;
+
+        if ( work_count == work_allocated )
+        {
+            work_allocated += 256 ;
+            work_list = ( INSTANCE ** ) realloc( work_list, work_allocated * sizeof( INSTANCE * ) ) ;
+            assert( work_list ) ;
+        }
+        work_list[work_count++] = i ;
+    }
+
+    if ( !work_count ) return 0 ;
+
+    for ( n = 0 ; n < work_count ; n++ )
+    {
+        i = work_list[n] ;
+        i->parallel = 1 ;
+
+        if ( process_exec_hook_count )
+        {
+            int h ;
+            for ( h = 0 ; h < process_exec_hook_count ; h++ )
+                process_exec_hook_list[h]( i ) ;
+        }
+    }
+
+    SDL_AtomicSet( &work_next, 0 ) ;
+
+    SDL_LockMutex( worker_lock ) ;
+    worker_busy = worker_count ;
+    worker_batch++ ;
+    SDL_CondBroadcast( worker_start ) ;
+    SDL_UnlockMutex( worker_lock ) ;
+
+    work_run() ;
+
+    SDL_LockMutex( worker_lock ) ;
+    while ( worker_busy ) SDL_CondWait( worker_done, worker_lock ) ;
+    SDL_UnlockMutex( worker_lock ) ;
+
+    for ( n = 0 ; n < work_count ; n++ ) work_list[n]->parallel = 0 ;
+
+    return work_count ;
+}
+
+/* ---------------------------------------------------------------------- */
@@ -172,6 +172,28 @@ mnemonics[] =
     { "REMOTE_PUBLIC"               , MN_REMOTE_PUBLIC          , 1 },
     { "GET_REMOTE_PUBLIC"           , MN_GET_REMOTE_PUBLIC      , 1 },
 
+    { "PRIVATE_LET_CONST"           , MN_PRIVATE_LET_CONST      , 1 },
+    { "PRIVATE_LET_PRIVATE"         , MN_PRIVATE_LET_PRIVATE    , 1 },
+    { "LOCAL_LET_CONST"             , MN_LOCAL_LET_CONST        , 1 },
+    { "PRIVATE_ADD_CONST"           , MN_PRIVATE_ADD_CONST      , 1 },
+    { "PRIVATE_SUB_CONST"           , MN_PRIVATE_SUB_CONST      , 1 },
+    { "LOCAL_ADD_CONST"             , MN_LOCAL_ADD_CONST        , 1 },
+    { "LOCAL_SUB_CONST"             , MN_LOCAL_SUB_CONST        , 1 },
+    { "PRIVATE_INC"                 , MN_PRIVATE_INC            , 1 },
+    { "PRIVATE_DEC"                 , MN_PRIVATE_DEC            , 1 },
+    { "PRIVATE_EQ_JFALSE"           , MN_PRIVATE_EQ_JFALSE      , 1 },
+    { "PRIVATE_NE_JFALSE"           , MN_PRIVATE_NE_JFALSE      , 1 },
+    { "PRIVATE_GT_JFALSE"           , MN_PRIVATE_GT_JFALSE      , 1 },
+    { "PRIVATE_LT_JFALSE"           , MN_PRIVATE_LT_JFALSE      , 1 },
+    { "PRIVATE_GTE_JFALSE"          , MN_PRIVATE_GTE_JFALSE     , 1 },
+    { "PRIVATE_LTE_JFALSE"          , MN_PRIVATE_LTE_JFALSE     , 1 },
+    { "LOCAL_EQ_JFALSE"             , MN_LOCAL_EQ_JFALSE        , 1 },
+    { "LOCAL_NE_JFALSE"             , MN_LOCAL_NE_JFALSE        , 1 },
+    { "LOCAL_GT_JFALSE"             , MN_LOCAL_GT_JFALSE        , 1 },
+    { "LOCAL_LT_JFALSE"             , MN_LOCAL_LT_JFALSE        , 1 },
+    { "LOCAL_GTE_JFALSE"            , MN_LOCAL_GTE_JFALSE       , 1 },
+    { "LOCAL_LTE_JFALSE"            , MN_LOCAL_LTE_JFALSE       , 1 },
+
     { 0                             , -1                        , 0 }
 } ;
 
@@ -192,21 +214,42 @@ mnemonics_sorted[256];
 
 /* ---------------------------------------------------------------------- */
 
-void mnemonic_dump( int i, int param )
+static void mnemonics_init()
 {
     int n = 0 ;
 
-    if ( !mnemonics_inited )
+    while ( mnemonics[n].name )
     {
-        while ( mnemonics[n].name )
-        {
-            sprintf( mnemonics_sorted[mnemonics[n].code & MN_MASK].name, "%-20s", mnemonics[n].name );
-            mnemonics_sorted[mnemonics[n].code & MN_MASK].params    = mnemonics[n].params;
-            n++ ;
-        }
-        mnemonics_inited = 1;
+        sprintf( mnemonics_sorted[mnemonics[n].code & MN_MASK].name, "%-20s", mnemonics[n].name );
+        mnemonics_sorted[mnemonics[n].code & MN_MASK].params    = mnemonics[n].params;
+        n++ ;
+    }
+    mnemonics_inited = 1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+char * mnemonic_name( int i )
+{
+    int n = 0 ;
+
+    while ( mnemonics[n].name )
+    {
+        if ( ( mnemonics[n].code & MN_MASK ) == ( i & MN_MASK ) ) return mnemonics[n].name ;
+        n++ ;
     }
 
+    return "?" ;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void mnemonic_dump( int i, int param )
+{
+    int n = 0 ;
+
+    if ( !mnemonics_inited ) mnemonics_init() ;
+
     n = i & MN_MASK ;
 
 #ifdef __BGDRTM__
@@ -82,8 +82,13 @@ typedef struct
     char * paramtypes;
     int type;
     void * func;
+    int flags;
 } DLSYSFUNCS;
 
+/* DLSYSFUNCS flags */
+
+#define SYSFUNC_THREADSAFE  0x01    /* Only uses its params and the locals of the caller, may be called by pure processes */
+
 typedef struct
 {
     char * name;
@@ -41,6 +41,9 @@
 #include "typedef.h"
 
 #define DCB_DEBUG 1
+#define DCB_ALIGNED 2       /* Sections start at DCB_ALIGNMENT boundaries, the runtime may map the file */
+
+#define DCB_ALIGNMENT 16
 
 #ifdef _MSC_VER
 #pragma pack(push, 1)
@@ -215,7 +218,8 @@ typedef struct          /* Cabecera general del fichero */
     uint32_t    NImports ;
     uint32_t    NSourceFiles ;
     uint32_t    NSysProcsCodes ; /* For SYSPROCS fixup */
-    uint32_t    __reserved1[2] ;
+    uint32_t    Flags ;     /* DCB_ALIGNED */
+    uint32_t    __reserved1[1] ;
 
     uint32_t    OProcsTab ;
     uint32_t    OID ;
@@ -40,6 +40,7 @@ typedef struct _procdef
 	int * pubdata ;
 
 	int * code ;
+	int * original_code ;	/* Code as read from the DCB, before fusion (for the debugger) */
 
 	int exitcode ;
 	int errorcode ;
@@ -62,6 +63,10 @@ typedef struct _procdef
 	char * name ;
 
     int breakpoint;
+
+    void ** threaded ;     /* Handler of each instruction, for the release engine */
+    void * free_instances ; /* Blocks of destroyed instances, ready to be reused */
+    int free_count ;        /* Number of blocks in free_instances */
 }
 PROCDEF ;
 
@@ -69,6 +74,7 @@ PROCDEF ;
 #define PROC_USES_LOCALS	0x02
 #define PROC_FUNCTION   	0x04
 #define PROC_USES_PUBLICS   0x08
+#define PROC_PURE           0x10    /* Set at runtime, see instance_set_pure() */
 
 /* System functions */
 
@@ -82,6 +88,7 @@ typedef struct _sysproc
 	int       params ;
 	SYSFUNC * func ;
 	int       id ;
+	int       flags ;
 }
 SYSPROC ;
 
@@ -47,6 +47,10 @@ extern int          local_size ;
 extern INSTANCE     * first_instance ;
 extern INSTANCE     * last_instance ;
 
+extern int          instance_created ;
+extern int          instance_recycled ;
+extern int          instance_pooled ;
+
 extern int          instance_getid() ;
 extern INSTANCE     * instance_get( int id ) ;
 extern INSTANCE     * instance_get_by_type( uint32_t type, INSTANCE ** context ) ;
@@ -62,9 +66,18 @@ extern void         instance_dump_all() ;
 extern void         instance_posupdate( INSTANCE * i ) ;
 extern int          instance_poschanged( INSTANCE * i ) ;
 extern int          instance_exists( INSTANCE * i ) ;
+extern INSTANCE     * instance_caller( INSTANCE * i ) ;
 
 extern INSTANCE     * instance_next_by_priority();
 extern void         instance_dirty( INSTANCE * i ) ;
+extern void         instance_status_changed( INSTANCE * i ) ;
+extern void         instance_frame_done() ;
+extern INSTANCE     * instance_next_scheduled( INSTANCE * i ) ;
+
+extern int          instance_set_pure( PROCDEF * proc, int pure ) ;
+extern int          instance_go_pure() ;
+extern int          instance_threaded_ready( PROCDEF * proc ) ;
+extern void         workers_exit() ;
 
 /* Las siguientes funciones son el punto de entrada del intérprete */
 
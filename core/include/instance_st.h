@@ -31,7 +31,7 @@
 #define __INSTANCE_ST_H
 
 #define FIRST_INSTANCE_ID   0x00010000
-#define LAST_INSTANCE_ID    0x0001ffff
+#define LAST_INSTANCE_ID    0x7fffffff
 
 #define STACK_RETURN_VALUE  0x8000
 #define STACK_SIZE_MASK     0x7FFF
@@ -71,6 +71,11 @@ typedef struct _instance
     struct _instance * next_by_priority ;
     struct _instance * prev_by_priority ;
     int last_priority ;
+    int parked ;
+
+    /* Set while a worker thread runs it */
+
+    int parallel ;
 
     /* Linked list by process_type */
 
@@ -85,6 +90,7 @@ typedef struct _instance
     /* Function support */
 
     struct _instance * called_by ;
+    uint32_t called_by_id ;     /* PROCESS_ID of called_by, as its block may be reused */
 
     /* The first integer at the stack is the stack size,
        with optional NO_RETURN_VALUE mask. The stack contents follows */
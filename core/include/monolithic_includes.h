@@ -156,7 +156,7 @@ basic_symbols symbol_list[] =
     { "mod_map.fakelib"      , mod_map_modules_dependency, mod_map_constants_def, NULL, NULL, NULL, mod_map_functions_exports },
     { "mod_dir.fakelib"      , NULL, NULL, NULL, mod_dir_globals_def, NULL, mod_dir_functions_exports },
     { "mod_text.fakelib"     , mod_text_modules_dependency, mod_text_constants_def, NULL, NULL, NULL, mod_text_functions_exports },
-    { "mod_rand.fakelib"     , NULL, NULL, NULL, NULL, NULL, mod_rand_functions_exports },
+    { "mod_rand.fakelib"     , NULL, NULL, NULL, NULL, mod_rand_locals_def, mod_rand_functions_exports },
     { "mod_grproc.fakelib"   , mod_grproc_modules_dependency, NULL, NULL, NULL, mod_grproc_locals_def, mod_grproc_functions_exports },
     { "mod_scroll.fakelib"   , mod_scroll_modules_dependency, NULL, NULL, NULL, NULL, mod_scroll_functions_exports },
 #ifndef NO_LIBKEY
@@ -164,7 +164,7 @@ basic_symbols symbol_list[] =
 #endif
     { "mod_draw.fakelib"     , mod_draw_modules_dependency, NULL, NULL, NULL, NULL, mod_draw_functions_exports },
     { "mod_screen.fakelib"   , mod_screen_modules_dependency, NULL, NULL, NULL, NULL, mod_screen_functions_exports },
-    { "mod_path.fakelib"     , mod_path_modules_dependency, mod_path_constants_def, NULL, NULL, NULL, mod_path_functions_exports },
+    { "mod_path.fakelib"     , mod_path_modules_dependency, mod_path_constants_def, NULL, NULL, mod_path_locals_def, mod_path_functions_exports },
     { "mod_blendop.fakelib"  , mod_blendop_modules_dependency, NULL, NULL, NULL, NULL, mod_blendop_functions_exports },
     { "mod_wm.fakelib"       , mod_wm_modules_dependency, NULL, NULL, NULL, NULL, mod_wm_functions_exports },
     { "mod_sys.fakelib"      , NULL, mod_sys_constants_def, NULL, NULL, NULL, mod_sys_functions_exports },
@@ -214,7 +214,7 @@ extra_symbols symbol_list_runtime[] =
     { libmouse_globals_fixup, NULL, libmouse_module_initialize, NULL, NULL, NULL, NULL, libmouse_handler_hooks}, //libmouse
     { NULL, NULL, libfont_module_initialize, NULL, NULL, NULL, NULL, NULL }, //libfont
     { libtext_globals_fixup, NULL, NULL, NULL, NULL, NULL, NULL, NULL }, //libtext
-    { libscroll_globals_fixup, libscroll_locals_fixup, NULL, NULL, NULL, NULL, NULL, NULL }, //libscroll
+    { libscroll_globals_fixup, libscroll_locals_fixup, NULL, NULL, libscroll_instance_create_hook, libscroll_instance_destroy_hook, NULL, NULL }, //libscroll
 #ifndef NO_LIBKEY
     { libkey_globals_fixup, NULL, libkey_module_initialize, libkey_module_finalize, NULL, NULL, NULL, libkey_handler_hooks }, //libkey
 #endif
@@ -239,15 +239,15 @@ extra_symbols symbol_list_runtime[] =
     { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL }, //mod_map
     { mod_dir_globals_fixup, NULL, NULL, NULL, NULL, NULL, NULL, NULL }, //mod_dir
     { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL }, //mod_text
-    { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL }, //mod_rand
-    { mod_grproc_globals_fixup, mod_grproc_locals_fixup, NULL, NULL, NULL, NULL, mod_grproc_process_exec_hook, NULL }, //mod_grproc
+    { NULL, mod_rand_locals_fixup, NULL, NULL, NULL, NULL, NULL, NULL }, //mod_rand
+    { mod_grproc_globals_fixup, mod_grproc_locals_fixup, NULL, NULL, mod_grproc_instance_create_hook, mod_grproc_instance_destroy_hook, mod_grproc_process_exec_hook, mod_grproc_handler_hooks }, //mod_grproc
     { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL }, //mod_scroll
 #ifndef NO_LIBKEY
     { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL }, //mod_key
 #endif
     { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL }, //mod_draw
     { mod_screen_globals_fixup, mod_screen_locals_fixup, NULL, NULL, NULL, NULL, NULL, NULL }, //mod_screen
-    { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL }, //mod_path
+    { NULL, mod_path_locals_fixup, mod_path_module_initialize, NULL, NULL, mod_path_instance_destroy_hook, NULL, mod_path_handler_hooks }, //mod_path
     { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL }, //mod_blendop
     { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL }, //mod_wm
     { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL }, //mod_sys
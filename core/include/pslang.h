@@ -181,14 +181,14 @@
 #define MN_BOR                  (0x4A| MN_0_PARAMS)
 #define MN_BXOR                 (0x4B| MN_0_PARAMS)
 
-/*** Free 4C, 4D, 4E, 4F ***/
+/*** Free 4F (4C, 4D, 4E: superinstructions) ***/
 
 /* Funciones de conversión */
 
 #define MN_INT2FLOAT            (0x50| MN_1_PARAMS)
 #define MN_FLOAT2INT            (0x51| MN_1_PARAMS)
 
-/*** Free 52, 53, 54, 55, 56, 57, 58, 59, 5A, 5B, 5C, 5D, 5E, 5F ****/
+/*** 52 to 5F: superinstructions ****/
 
 #define MN_A2STR                (0x60| MN_1_PARAMS)
 #define MN_STR2A                (0x61| MN_1_PARAMS)
@@ -199,7 +199,7 @@
 /* Funciones de control de flujo */
 #define MN_NCALL                (0x65| MN_1_PARAMS)
 
-/*** Free 66, 67, 68, 69 ****/
+/*** 66, 67, 68, 69: superinstructions ****/
 
 /* Handlers */
 #define MN_EXITHNDLR            (0x6A| MN_1_PARAMS)
@@ -237,6 +237,38 @@
 
 #define MN_SENTENCE             (0x7F| MN_1_PARAMS)
 
+/* Superinstructions
+ *
+ * Never emitted by the compiler: the runtime creates them when it loads
+ * the DCB, replacing the first opcode of a common sequence. The rest of
+ * the sequence is kept in place, and the superinstruction reads its
+ * operands from there and skips it.
+ */
+
+#define MN_PRIVATE_LET_CONST    (0x52| MN_1_PARAMS)     /* PRIVATE a, PUSH c, LETNP             */
+#define MN_PRIVATE_LET_PRIVATE  (0x53| MN_1_PARAMS)     /* PRIVATE a, GET_PRIV b, LETNP         */
+#define MN_LOCAL_LET_CONST      (0x54| MN_1_PARAMS)     /* LOCAL a, PUSH c, LETNP               */
+#define MN_PRIVATE_ADD_CONST    (0x55| MN_1_PARAMS)     /* PRIVATE a, PUSH c, VARADD, POP       */
+#define MN_PRIVATE_SUB_CONST    (0x56| MN_1_PARAMS)     /* PRIVATE a, PUSH c, VARSUB, POP       */
+#define MN_LOCAL_ADD_CONST      (0x57| MN_1_PARAMS)     /* LOCAL a, PUSH c, VARADD, POP         */
+#define MN_LOCAL_SUB_CONST      (0x58| MN_1_PARAMS)     /* LOCAL a, PUSH c, VARSUB, POP         */
+#define MN_PRIVATE_INC          (0x59| MN_1_PARAMS)     /* PRIVATE a, INC/POSTINC n, POP        */
+#define MN_PRIVATE_DEC          (0x5A| MN_1_PARAMS)     /* PRIVATE a, DEC/POSTDEC n, POP        */
+
+#define MN_PRIVATE_EQ_JFALSE    (0x5B| MN_1_PARAMS)     /* GET_PRIV a, PUSH c, EQ, JFALSE l     */
+#define MN_PRIVATE_NE_JFALSE    (0x5C| MN_1_PARAMS)     /* GET_PRIV a, PUSH c, NE, JFALSE l     */
+#define MN_PRIVATE_GT_JFALSE    (0x5D| MN_1_PARAMS)     /* GET_PRIV a, PUSH c, GT, JFALSE l     */
+#define MN_PRIVATE_LT_JFALSE    (0x5E| MN_1_PARAMS)     /* GET_PRIV a, PUSH c, LT, JFALSE l     */
+#define MN_PRIVATE_GTE_JFALSE   (0x5F| MN_1_PARAMS)     /* GET_PRIV a, PUSH c, GTE, JFALSE l    */
+#define MN_PRIVATE_LTE_JFALSE   (0x66| MN_1_PARAMS)     /* GET_PRIV a, PUSH c, LTE, JFALSE l    */
+
+#define MN_LOCAL_EQ_JFALSE      (0x67| MN_1_PARAMS)     /* GET_LOCAL a, PUSH c, EQ, JFALSE l    */
+#define MN_LOCAL_NE_JFALSE      (0x68| MN_1_PARAMS)     /* GET_LOCAL a, PUSH c, NE, JFALSE l    */
+#define MN_LOCAL_GT_JFALSE      (0x69| MN_1_PARAMS)     /* GET_LOCAL a, PUSH c, GT, JFALSE l    */
+#define MN_LOCAL_LT_JFALSE      (0x4C| MN_1_PARAMS)     /* GET_LOCAL a, PUSH c, LT, JFALSE l    */
+#define MN_LOCAL_GTE_JFALSE     (0x4D| MN_1_PARAMS)     /* GET_LOCAL a, PUSH c, GTE, JFALSE l   */
+#define MN_LOCAL_LTE_JFALSE     (0x4E| MN_1_PARAMS)     /* GET_LOCAL a, PUSH c, LTE, JFALSE l   */
+
 /* Max: 0x7F */
 
 #endif
@@ -38,19 +38,24 @@
 #ifndef __XSTRINGS_H
 #define __XSTRINGS_H
 
+#include <stdint.h>
+
 extern void _string_ptoa( char *t, void * p );
 extern void _string_ntoa( char *p, unsigned long n );
 extern void _string_utoa( char *p, unsigned long n );
 
 extern void         string_init() ;
 extern const char * string_get( int code ) ;
+extern int          string_length( int code ) ;
 extern void         string_dump( void ( *wlog )( const char *fmt, ... ) );
 extern void         string_load( void *, int, int, int, int ) ;
+extern void         string_load_mem( char * text, uint32_t * offsets, int nstrings ) ;
 extern int          string_new( const char * ptr ) ;
 extern int          string_newa( const char * ptr, unsigned count ) ;
 extern void         string_use( int code ) ;
 extern void         string_discard( int code ) ;
 extern int          string_add( int code1, int code2 ) ;
+extern int          string_append( int code1, int code2 ) ;
 extern int          string_compile( const char ** source ) ;
 extern int          string_itoa( int n ) ;
 extern int          string_uitoa( unsigned int n ) ;
@@ -79,6 +79,7 @@ extern void codeblock_label_set (CODEBLOCK * c, int label, int offset) ;
 extern int  codeblock_label_get (CODEBLOCK * c, int label);
 extern int codeblock_label_get_id_by_name (CODEBLOCK * c, int name);
 extern void codeblock_postprocess (CODEBLOCK * c) ;
+extern void codeblock_optimize (CODEBLOCK * c) ;
 extern void codeblock_dump (CODEBLOCK * c) ;
 extern void mnemonic_dump (int i, int param) ;
 extern void program_postprocess () ;
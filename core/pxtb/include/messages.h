@@ -48,6 +48,8 @@
     "   -s stub         Generate a stubbed executable from the given stub\n" \
     "   -g              Stores debugging information at the DCB\n" \
     "   -c              File uses the MS-DOS character set\n" \
+    "   -O              Optimize the generated code\n" \
+    "   -m              Align the DCB sections, so it can be mapped in memory\n" \
     "   -D macro=text   Set a macro\n" \
     "   -p|--pedantic   Don't use automatic declare\n" \
     "   --libmode       Build a library\n" \
@@ -95,6 +95,7 @@ extern int autoinclude ;    /* Incluye ficheros en el DCB automáticamente */
 extern int imports[] ;      /* Códigos de cadena con nombres de imports */
 extern int nimports ;       /* Número de imports */
 extern int libmode ;
+extern int optimize ;       /* -O: optimiza el código generado */
 
 extern char langinfo[64] ;  /* language setting */
 
@@ -30,6 +30,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <limits.h>
 
 #include "pxtb.h"
 
@@ -134,6 +135,433 @@ void codeblock_postprocess (CODEBLOCK * code)
 	}
 }
 
+/*
+ *  FUNCTION : codeblock_optimize
+ *
+ *  Optimizes the code of a codeblock, once codeblock_postprocess() has
+ *  resolved all the jumps to absolute offsets. Only used with -O.
+ *  Every pass does the following, and passes are repeated until
+ *  nothing changes:
+ *
+ *  - Folds operations on constants (PUSH a, PUSH b, ADD => PUSH a+b),
+ *    and removes constants that are pushed only to be discarded
+ *  - Strength reduction: multiplies by powers of two become shifts,
+ *    and multiplies or divisions by one are removed
+ *  - Jumps to a JUMP go straight to its destination, and jumps to the
+ *    next instruction are removed
+ *  - Removes the unreachable code after JUMP, RETURN and END
+ *  - s = s + x, on a STRING variable, becomes s += x
+ *
+ *  Removed instructions are taken out of the code, and all the jumps,
+ *  the ONEXIT/ONERROR offsets and the sentence (line table) offsets
+ *  are updated.
+ *
+ *  PARAMS :
+ *      c			Pointer to the codeblock to optimize
+ *
+ *  RETURN VALUE :
+ *      None
+ */
+
+static int codeblock_is_jump (int code)
+{
+	return code == MN_JUMP      || code == MN_NCALL   ||
+	       code == MN_JFALSE    || code == MN_JTFALSE ||
+	       code == MN_JTRUE     || code == MN_JTTRUE  ||
+	       code == MN_JNOCASE   || code == MN_CLONE   ||
+	       code == MN_EXITHNDLR || code == MN_ERRHNDLR ;
+}
+
+static int codeblock_power_of_two (int value)
+{
+	int n ;
+
+	if (value <= 0 || (value & (value - 1))) return -1 ;
+	for (n = 0 ; value > 1 ; n++) value >>= 1 ;
+	return n ;
+}
+
+/* Result of a binary operation on two constants, as the interpreter would
+ * do it. Returns 0 if it can't be folded (division by zero...) */
+
+static int codeblock_fold (int code, int a, int b, int * result)
+{
+	switch (code)
+	{
+		case MN_ADD:                    *result = (int)((unsigned)a + (unsigned)b) ;    return 1 ;
+		case MN_SUB:                    *result = (int)((unsigned)a - (unsigned)b) ;    return 1 ;
+		case MN_MUL:
+		case MN_MUL | MN_UNSIGNED:      *result = (int)((unsigned)a * (unsigned)b) ;    return 1 ;
+
+		case MN_DIV:
+			if (!b || (a == INT_MIN && b == -1)) return 0 ;
+			*result = a / b ;
+			return 1 ;
+
+		case MN_DIV | MN_UNSIGNED:
+			if (!b) return 0 ;
+			*result = (int)((unsigned)a / (unsigned)b) ;
+			return 1 ;
+
+		case MN_MOD:
+			if (!b || (a == INT_MIN && b == -1)) return 0 ;
+			*result = a % b ;
+			return 1 ;
+
+		case MN_MOD | MN_UNSIGNED:
+			if (!b) return 0 ;
+			*result = (int)((unsigned)a % (unsigned)b) ;
+			return 1 ;
+
+		case MN_ROR:
+			if (b < 0 || b > 31) return 0 ;
+			*result = a >> b ;
+			return 1 ;
+
+		case MN_ROR | MN_UNSIGNED:
+			if (b < 0 || b > 31) return 0 ;
+			*result = (int)((unsigned)a >> b) ;
+			return 1 ;
+
+		case MN_ROL:
+			if (b < 0 || b > 31) return 0 ;
+			*result = (int)((unsigned)a << b) ;
+			return 1 ;
+
+		case MN_AND:                    *result = a && b ;          return 1 ;
+		case MN_OR:                     *result = a || b ;          return 1 ;
+		case MN_XOR:                    *result = (a != 0) ^ (b != 0) ; return 1 ;
+		case MN_BAND:                   *result = a & b ;           return 1 ;
+		case MN_BOR:                    *result = a | b ;           return 1 ;
+		case MN_BXOR:                   *result = a ^ b ;           return 1 ;
+
+		case MN_EQ:                     *result = a == b ;          return 1 ;
+		case MN_NE:                     *result = a != b ;          return 1 ;
+		case MN_GT:                     *result = a >  b ;          return 1 ;
+		case MN_LT:                     *result = a <  b ;          return 1 ;
+		case MN_GTE:                    *result = a >= b ;          return 1 ;
+		case MN_LTE:                    *result = a <= b ;          return 1 ;
+	}
+
+	return 0 ;
+}
+
+/* s = s + x becomes s += x, that the interpreter can do in place when
+ * nobody else uses the string. x must be a single value, maybe converted
+ * to string, so it doesn't matter that s is read after it. Returns the
+ * offset after the rewritten code, or 0 if the code at p doesn't match */
+
+static int codeblock_string_append (int * data, int count, int p, char * target, char * dead)
+{
+	int get, value, add, let, n ;
+
+	switch (data[p] & MN_MASK)
+	{
+		case MN_PRIVATE:    get = MN_GET_PRIV ;     break ;
+		case MN_LOCAL:      get = MN_GET_LOCAL ;    break ;
+		case MN_GLOBAL:     get = MN_GET_GLOBAL ;   break ;
+		case MN_PUBLIC:     get = MN_GET_PUBLIC ;   break ;
+		default:            return 0 ;
+	}
+
+	if (p + 5 >= count || data[p+2] != (get | MN_STRING) || data[p+3] != data[p+1]) return 0 ;
+
+	value = p + 4 ;
+	switch (data[value] & MN_MASK)
+	{
+		case MN_PUSH:
+		case MN_GET_PRIV:
+		case MN_GET_LOCAL:
+		case MN_GET_GLOBAL:
+		case MN_GET_PUBLIC:
+			break ;
+		default:
+			return 0 ;
+	}
+
+	add = value + 2 ;
+	if (add + 1 < count && data[add+1] == 0 &&
+	    ((data[add] & MN_MASK) == MN_INT2STR || data[add] == MN_FLOAT2STR || data[add] == MN_CHR2STR))
+		add += 2 ;
+	else if (MN_TYPEOF(data[value]) != MN_STRING)
+		return 0 ;
+
+	let = add + 1 ;
+	if (let >= count || data[add] != (MN_ADD | MN_STRING)) return 0 ;
+	if (data[let] != (MN_LETNP | MN_STRING) && data[let] != (MN_LET | MN_STRING)) return 0 ;
+
+	for (n = p + 2 ; n <= let ; n += MN_PARAMS(data[n]) + 1)
+		if (target[n]) return 0 ;
+
+	/* VARADD leaves the address in the stack, as LET does */
+
+	dead[p+2] = 1 ;
+	data[add] = MN_VARADD | MN_STRING ;
+	if (data[let] == (MN_LET | MN_STRING))
+		dead[let] = 1 ;
+	else
+		data[let] = MN_POP ;
+
+	return let + 1 ;
+}
+
+static int codeblock_optimize_pass (CODEBLOCK * c, PROCDEF * proc)
+{
+	int * data = c->data ;
+	int count = c->current ;
+	char * target = (char *) calloc (count + 1, 1) ;
+	char * dead = (char *) calloc (count + 1, 1) ;
+	int * map, * out ;
+	int p, n, next, code, value, hops, shift ;
+	int prev = -1, prev2 = -1 ;
+	int changes = 0 ;
+
+	if (!target || !dead)
+	{
+		fprintf (stdout, "CODEBLOCK: out of memory\n") ;
+		exit (1) ;
+	}
+
+	/* Mark every place the execution can arrive to, other than from
+	 * the previous instruction */
+
+	target[0] = 1 ;
+	if (proc->exitcode > 0 && proc->exitcode <= count) target[proc->exitcode] = 1 ;
+	if (proc->errorcode > 0 && proc->errorcode <= count) target[proc->errorcode] = 1 ;
+
+	for (p = 0 ; p < count ; p += MN_PARAMS(data[p]) + 1)
+	{
+		if (codeblock_is_jump (data[p]) && p + 1 < count && data[p+1] >= 0 && data[p+1] <= count)
+			target[data[p+1]] = 1 ;
+	}
+
+	for (p = 0 ; p < count ; p = next)
+	{
+		next = p + MN_PARAMS(data[p]) + 1 ;
+		code = data[p] ;
+
+		/* Something jumps here, so we don't know what was executed before */
+		if (target[p]) prev = prev2 = -1 ;
+
+		/* Jump threading */
+
+		if (codeblock_is_jump (code) && data[p+1] >= 0)
+		{
+			value = data[p+1] ;
+			for (hops = 0 ; hops < 32 && value < count - 1 && data[value] == MN_JUMP && data[value+1] != value ; hops++)
+				value = data[value+1] ;
+
+			if (value != data[p+1])
+			{
+				data[p+1] = value ;
+				changes++ ;
+			}
+
+			if (code == MN_JUMP && value == next)
+			{
+				if (target[p]) target[next] = 1 ;
+				dead[p] = 1 ;
+				changes++ ;
+				continue ;
+			}
+		}
+
+		/* String appends */
+
+		if ((value = codeblock_string_append (data, count, p, target, dead)) > 0)
+		{
+			next = value ;
+			prev = prev2 = -1 ;
+			changes++ ;
+			continue ;
+		}
+
+		/* Constant folding and strength reduction */
+
+		if (prev >= 0 && data[prev] == MN_PUSH && !target[p])
+		{
+			if (prev2 >= 0 && data[prev2] == MN_PUSH && !target[prev] &&
+			    codeblock_fold (code, data[prev2+1], data[prev+1], &value))
+			{
+				data[prev2+1] = value ;
+				dead[prev] = dead[p] = 1 ;
+				prev = prev2 ;
+				prev2 = -1 ;
+				changes++ ;
+				continue ;
+			}
+
+			switch (code)
+			{
+				case MN_NEG:
+					data[prev+1] = (int)(0u - (unsigned)data[prev+1]) ;
+					dead[p] = 1 ;
+					changes++ ;
+					continue ;
+
+				case MN_NOT:
+					data[prev+1] = !data[prev+1] ;
+					dead[p] = 1 ;
+					changes++ ;
+					continue ;
+
+				case MN_BNOT:
+					data[prev+1] = ~data[prev+1] ;
+					dead[p] = 1 ;
+					changes++ ;
+					continue ;
+
+				case MN_INDEX:
+					data[prev+1] = (int)((unsigned)data[prev+1] + (unsigned)data[p+1]) ;
+					dead[p] = 1 ;
+					changes++ ;
+					continue ;
+
+				case MN_POP:
+					if (target[prev]) target[next] = 1 ;
+					dead[prev] = dead[p] = 1 ;
+					prev = prev2 ;
+					prev2 = -1 ;
+					changes++ ;
+					continue ;
+
+				case MN_MUL:
+				case MN_MUL | MN_UNSIGNED:
+				case MN_DIV:
+				case MN_DIV | MN_UNSIGNED:
+					if (data[prev+1] == 1)
+					{
+						/* x * 1, x / 1 */
+						if (target[prev]) target[next] = 1 ;
+						dead[prev] = dead[p] = 1 ;
+						prev = prev2 ;
+						prev2 = -1 ;
+						changes++ ;
+						continue ;
+					}
+					shift = codeblock_power_of_two (data[prev+1]) ;
+					if (shift > 0 && (code & MN_MASK) == MN_MUL)
+					{
+						data[prev+1] = shift ;
+						data[p] = MN_ROL ;
+						changes++ ;
+					}
+					else if (shift > 0 && code == (MN_DIV | MN_UNSIGNED))
+					{
+						data[prev+1] = shift ;
+						data[p] = MN_ROR | MN_UNSIGNED ;
+						changes++ ;
+					}
+					break ;
+
+				case MN_MOD | MN_UNSIGNED:
+					if (codeblock_power_of_two (data[prev+1]) >= 0)
+					{
+						data[prev+1]-- ;
+						data[p] = MN_BAND ;
+						changes++ ;
+					}
+					break ;
+			}
+		}
+
+		if (code == MN_INDEX && data[p+1] == 0)
+		{
+			if (target[p]) target[next] = 1 ;
+			dead[p] = 1 ;
+			changes++ ;
+			continue ;
+		}
+
+		/* Unreachable code */
+
+		if (code == MN_JUMP || code == MN_RETURN || code == MN_END)
+		{
+			for (n = next ; n < count && !target[n] ; n += MN_PARAMS(data[n]) + 1)
+			{
+				dead[n] = 1 ;
+				changes++ ;
+			}
+			next = n ;
+			prev = prev2 = -1 ;
+			continue ;
+		}
+
+		prev2 = prev ;
+		prev = p ;
+	}
+
+	if (!changes)
+	{
+		free (target) ;
+		free (dead) ;
+		return 0 ;
+	}
+
+	/* Remove the dead instructions and update the offsets. Jumps to a
+	 * removed instruction go to the next instruction kept */
+
+	map = (int *) malloc ((count + 1) * sizeof(int)) ;
+	out = (int *) malloc ((c->reserved) * sizeof(int)) ;
+	if (!map || !out)
+	{
+		fprintf (stdout, "CODEBLOCK: out of memory\n") ;
+		exit (1) ;
+	}
+
+	for (p = 0, n = 0 ; p < count ; p = next)
+	{
+		next = p + MN_PARAMS(data[p]) + 1 ;
+		for (value = p ; value < next && value <= count ; value++) map[value] = n ;
+		if (!dead[p])
+		{
+			out[n++] = data[p] ;
+			if (next - p > 1) out[n++] = data[p+1] ;
+		}
+	}
+	map[count] = n ;
+
+	for (p = 0 ; p < n ; p += MN_PARAMS(out[p]) + 1)
+	{
+		if (codeblock_is_jump (out[p]) && out[p+1] >= 0 && out[p+1] <= count)
+			out[p+1] = map[out[p+1]] ;
+	}
+
+	if (proc->exitcode > 0 && proc->exitcode <= count) proc->exitcode = map[proc->exitcode] ;
+	if (proc->errorcode > 0 && proc->errorcode <= count) proc->errorcode = map[proc->errorcode] ;
+
+	/* The debugger line table points into the code too */
+
+	for (p = 0 ; p < proc->sentence_count ; p++)
+	{
+		if (proc->sentences[p].offset >= 0 && proc->sentences[p].offset <= count)
+			proc->sentences[p].offset = map[proc->sentences[p].offset] ;
+	}
+
+	free (c->data) ;
+	c->data = out ;
+	c->current = n ;
+	c->previous = c->previous2 = 0 ;
+
+	free (map) ;
+	free (target) ;
+	free (dead) ;
+	return changes ;
+}
+
+void codeblock_optimize (CODEBLOCK * c)
+{
+	PROCDEF * proc = procdef_search_by_codeblock (c) ;
+	int passes = 0, size = c->current ;
+
+	if (!proc || proc->imported) return ;
+
+	while (codeblock_optimize_pass (c, proc) && ++passes < 16) ;
+
+	if (debug && size != c->current)
+		printf ("Optimizer: %s %d -> %d\n", identifier_name (proc->identifier), size * 4, c->current * 4) ;
+}
+
 /*
  *  FUNCTION : codeblock_init
  *
@@ -187,6 +187,23 @@ void dcb_prepare_type( DCB_TYPEDEF * d, TYPEDEF * t )
     ARRANGE_DWORD( &d->Members );
 }
 
+/* With -m (DCB_ALIGNED) every section starts at a DCB_ALIGNMENT boundary, so
+ * the runtime can map the file and use the sections in place */
+
+static long dcb_align( long offset )
+{
+    if ( !( dcb_options & DCB_ALIGNED ) ) return offset;
+    return ( offset + DCB_ALIGNMENT - 1 ) & ~( DCB_ALIGNMENT - 1 );
+}
+
+static void dcb_pad( file * fp, long base )
+{
+    static char zeros[DCB_ALIGNMENT];
+    long pos = file_pos( fp ) - base;
+
+    if ( dcb_align( pos ) != pos ) file_write( fp, zeros, dcb_align( pos ) - pos );
+}
+
 /* Make DCB file (see dcb.h) */
 
 DCB_HEADER dcb;
@@ -292,6 +309,8 @@ int dcb_save( const char * filename, int options, const char * stubname )
 
     dcb.data.NSysProcsCodes = NSysProcs;                                        ARRANGE_DWORD( &dcb.data.NSysProcsCodes );
 
+    dcb.data.Flags          = dcb_options & DCB_ALIGNED;                        ARRANGE_DWORD( &dcb.data.Flags );
+
     /* 2. Build process table */
 
     dcb.proc = ( DCB_PROC * ) calloc( procdef_count, sizeof( DCB_PROC ) );
@@ -397,19 +416,19 @@ int dcb_save( const char * filename, int options, const char * stubname )
 
     /* 4. Calculate offsets */
 
-    offset = sizeof( DCB_HEADER_DATA );
+    offset = dcb_align( sizeof( DCB_HEADER_DATA ) );
 
-    dcb.data.OProcsTab      = offset; offset += sizeof( DCB_PROC_DATA ) * procdef_count;    ARRANGE_DWORD( &dcb.data.OProcsTab );
-    dcb.data.OStrings       = offset; offset += 4 * string_count;                           ARRANGE_DWORD( &dcb.data.OStrings );
-    dcb.data.OGloVars       = offset; offset += sizeof( DCB_VAR ) * global.count;           ARRANGE_DWORD( &dcb.data.OGloVars );
-    dcb.data.OLocVars       = offset; offset += sizeof( DCB_VAR ) * local.count;            ARRANGE_DWORD( &dcb.data.OLocVars );
-    dcb.data.OLocStrings    = offset; offset += 4 * local.stringvar_count;                  ARRANGE_DWORD( &dcb.data.OLocStrings );
-    dcb.data.OID            = offset; offset += sizeof( DCB_ID ) * identifier_count;        ARRANGE_DWORD( &dcb.data.OID );
-    dcb.data.OVarSpaces     = offset; offset += sizeof( DCB_VARSPACE ) * dcb_varspaces;     ARRANGE_DWORD( &dcb.data.OVarSpaces );
-    dcb.data.OText          = offset; offset += string_used;                                ARRANGE_DWORD( &dcb.data.OText );
-    dcb.data.OImports       = offset; offset += 4 * nimports;                               ARRANGE_DWORD( &dcb.data.OImports );
-    dcb.data.OGlobal        = offset; offset += globaldata->current;                        ARRANGE_DWORD( &dcb.data.OGlobal );
-    dcb.data.OLocal         = offset; offset += localdata->current;                         ARRANGE_DWORD( &dcb.data.OLocal );
+    dcb.data.OProcsTab      = offset; offset = dcb_align( offset + sizeof( DCB_PROC_DATA ) * procdef_count );   ARRANGE_DWORD( &dcb.data.OProcsTab );
+    dcb.data.OStrings       = offset; offset = dcb_align( offset + 4 * string_count );                          ARRANGE_DWORD( &dcb.data.OStrings );
+    dcb.data.OGloVars       = offset; offset = dcb_align( offset + sizeof( DCB_VAR ) * global.count );          ARRANGE_DWORD( &dcb.data.OGloVars );
+    dcb.data.OLocVars       = offset; offset = dcb_align( offset + sizeof( DCB_VAR ) * local.count );           ARRANGE_DWORD( &dcb.data.OLocVars );
+    dcb.data.OLocStrings    = offset; offset = dcb_align( offset + 4 * local.stringvar_count );                 ARRANGE_DWORD( &dcb.data.OLocStrings );
+    dcb.data.OID            = offset; offset = dcb_align( offset + sizeof( DCB_ID ) * identifier_count );       ARRANGE_DWORD( &dcb.data.OID );
+    dcb.data.OVarSpaces     = offset; offset = dcb_align( offset + sizeof( DCB_VARSPACE ) * dcb_varspaces );    ARRANGE_DWORD( &dcb.data.OVarSpaces );
+    dcb.data.OText          = offset; offset = dcb_align( offset + string_used );                               ARRANGE_DWORD( &dcb.data.OText );
+    dcb.data.OImports       = offset; offset = dcb_align( offset + 4 * nimports );                              ARRANGE_DWORD( &dcb.data.OImports );
+    dcb.data.OGlobal        = offset; offset = dcb_align( offset + globaldata->current );                       ARRANGE_DWORD( &dcb.data.OGlobal );
+    dcb.data.OLocal         = offset; offset = dcb_align( offset + localdata->current );                        ARRANGE_DWORD( &dcb.data.OLocal );
 
     dcb.data.OSourceFiles   = offset;                                                       ARRANGE_DWORD( &dcb.data.OSourceFiles );
 
@@ -417,6 +436,8 @@ int dcb_save( const char * filename, int options, const char * stubname )
     for ( n = 0; n < n_files; n++ )
         offset += sizeof( uint32_t ) + strlen( files[n] ) + 1;
 
+    offset = dcb_align( offset );
+
     dcb.data.OSysProcsCodes = offset;                                                       ARRANGE_DWORD( &dcb.data.OSysProcsCodes );
     for ( s = sysprocs; s->name; s++ )
     {
@@ -424,28 +445,30 @@ int dcb_save( const char * filename, int options, const char * stubname )
         offset += s->params;
     }
 
+    offset = dcb_align( offset );
+
     for ( n = 0; n < dcb_varspaces; n++ )
     {
         dcb.varspace[n].OVars = offset;                                                     ARRANGE_DWORD( &dcb.varspace[n].OVars );
-        offset += sizeof( DCB_VAR ) * dcb_orig_varspace[n]->count;
+        offset = dcb_align( offset + sizeof( DCB_VAR ) * dcb_orig_varspace[n]->count );
     }
 
     for ( n = 0; n < procdef_count; n++ )
     {
-        dcb.proc[n].data.OSentences  = offset; offset += sizeof( DCB_SENTENCE ) * procs[n]->sentence_count;     ARRANGE_DWORD( &dcb.proc[n].data.OSentences );
+        dcb.proc[n].data.OSentences  = offset; offset = dcb_align( offset + sizeof( DCB_SENTENCE ) * procs[n]->sentence_count );    ARRANGE_DWORD( &dcb.proc[n].data.OSentences );
 
         /* Private */
-        dcb.proc[n].data.OPriVars    = offset; offset += sizeof( DCB_VAR ) * procs[n]->privars->count;          ARRANGE_DWORD( &dcb.proc[n].data.OPriVars );
-        dcb.proc[n].data.OPriStrings = offset; offset += 4 * procs[n]->privars->stringvar_count;                ARRANGE_DWORD( &dcb.proc[n].data.OPriStrings );
-        dcb.proc[n].data.OPrivate    = offset; offset += procs[n]->pridata->current;                            ARRANGE_DWORD( &dcb.proc[n].data.OPrivate );
+        dcb.proc[n].data.OPriVars    = offset; offset = dcb_align( offset + sizeof( DCB_VAR ) * procs[n]->privars->count );         ARRANGE_DWORD( &dcb.proc[n].data.OPriVars );
+        dcb.proc[n].data.OPriStrings = offset; offset = dcb_align( offset + 4 * procs[n]->privars->stringvar_count );               ARRANGE_DWORD( &dcb.proc[n].data.OPriStrings );
+        dcb.proc[n].data.OPrivate    = offset; offset = dcb_align( offset + procs[n]->pridata->current );                           ARRANGE_DWORD( &dcb.proc[n].data.OPrivate );
 
         /* Publics */
-        dcb.proc[n].data.OPubVars    = offset; offset += sizeof( DCB_VAR ) * procs[n]->pubvars->count;          ARRANGE_DWORD( &dcb.proc[n].data.OPubVars );
-        dcb.proc[n].data.OPubStrings = offset; offset += 4 * procs[n]->pubvars->stringvar_count;                ARRANGE_DWORD( &dcb.proc[n].data.OPubStrings );
-        dcb.proc[n].data.OPublic     = offset; offset += procs[n]->pubdata->current;                            ARRANGE_DWORD( &dcb.proc[n].data.OPublic );
+        dcb.proc[n].data.OPubVars    = offset; offset = dcb_align( offset + sizeof( DCB_VAR ) * procs[n]->pubvars->count );         ARRANGE_DWORD( &dcb.proc[n].data.OPubVars );
+        dcb.proc[n].data.OPubStrings = offset; offset = dcb_align( offset + 4 * procs[n]->pubvars->stringvar_count );               ARRANGE_DWORD( &dcb.proc[n].data.OPubStrings );
+        dcb.proc[n].data.OPublic     = offset; offset = dcb_align( offset + procs[n]->pubdata->current );                           ARRANGE_DWORD( &dcb.proc[n].data.OPublic );
 
         /* Code */
-        dcb.proc[n].data.OCode       = offset; offset += procs[n]->code.current * 4;                            ARRANGE_DWORD( &dcb.proc[n].data.OCode );
+        dcb.proc[n].data.OCode       = offset; offset = dcb_align( offset + procs[n]->code.current * 4 );                           ARRANGE_DWORD( &dcb.proc[n].data.OCode );
     }
 
     /* Archivos incluidos */
@@ -476,21 +499,22 @@ int dcb_save( const char * filename, int options, const char * stubname )
     /* ************************************** */
     /* ************************************** */
 
-    file_write( fp, &dcb, sizeof( DCB_HEADER_DATA ) );
+    file_write( fp, &dcb, sizeof( DCB_HEADER_DATA ) );                      dcb_pad( fp, stubsize );
 
     for ( n = 0; n < procdef_count; n++ )
         file_write( fp, &dcb.proc[n], sizeof( DCB_PROC_DATA ) );
-
-    file_writeUint32A( fp, (uint32_t *)string_offset, string_count );
-    file_write( fp, dcb.glovar, sizeof( DCB_VAR ) * global.count );         /* Ya procesado el byteorder */
-    file_write( fp, dcb.locvar, sizeof( DCB_VAR ) * local.count );          /* Ya procesado el byteorder */
-    file_writeUint32A( fp, (uint32_t *)local.stringvars, local.stringvar_count );
-    file_write( fp, dcb.id, sizeof( DCB_ID ) * identifier_count );          /* Ya procesado el byteorder */
-    file_write( fp, dcb.varspace, sizeof( DCB_VARSPACE ) * dcb_varspaces ); /* Ya procesado el byteorder */
-    file_write( fp, string_mem, string_used );                              /* No necesita byteorder */
-    file_writeUint32A( fp, (uint32_t *)imports, nimports );
-    file_write( fp, globaldata->bytes, globaldata->current );   /* ****** */
-    file_write( fp, localdata->bytes, localdata->current );     /* ****** */
+    dcb_pad( fp, stubsize );
+
+    file_writeUint32A( fp, (uint32_t *)string_offset, string_count );       dcb_pad( fp, stubsize );
+    file_write( fp, dcb.glovar, sizeof( DCB_VAR ) * global.count );         dcb_pad( fp, stubsize ); /* Ya procesado el byteorder */
+    file_write( fp, dcb.locvar, sizeof( DCB_VAR ) * local.count );          dcb_pad( fp, stubsize ); /* Ya procesado el byteorder */
+    file_writeUint32A( fp, (uint32_t *)local.stringvars, local.stringvar_count );   dcb_pad( fp, stubsize );
+    file_write( fp, dcb.id, sizeof( DCB_ID ) * identifier_count );          dcb_pad( fp, stubsize ); /* Ya procesado el byteorder */
+    file_write( fp, dcb.varspace, sizeof( DCB_VARSPACE ) * dcb_varspaces ); dcb_pad( fp, stubsize ); /* Ya procesado el byteorder */
+    file_write( fp, string_mem, string_used );                              dcb_pad( fp, stubsize ); /* No necesita byteorder */
+    file_writeUint32A( fp, (uint32_t *)imports, nimports );                 dcb_pad( fp, stubsize );
+    file_write( fp, globaldata->bytes, globaldata->current );               dcb_pad( fp, stubsize ); /* ****** */
+    file_write( fp, localdata->bytes, localdata->current );                 dcb_pad( fp, stubsize ); /* ****** */
 
     if ( dcb_options & DCB_DEBUG )
     {
@@ -502,6 +526,8 @@ int dcb_save( const char * filename, int options, const char * stubname )
         }
     }
 
+    dcb_pad( fp, stubsize );
+
     for ( s = sysprocs; s->name; s++ )
     {
         int l = s->params;
@@ -513,6 +539,8 @@ int dcb_save( const char * filename, int options, const char * stubname )
         file_write( fp, s->paramtypes, l );
     }
 
+    dcb_pad( fp, stubsize );
+
     for ( n = 0; n < dcb_varspaces; n++ )
     {
         VARIABLE * var;
@@ -530,24 +558,26 @@ int dcb_save( const char * filename, int options, const char * stubname )
 
             file_write( fp, &v, sizeof( DCB_VAR ) );
         }
+
+        dcb_pad( fp, stubsize );
     }
 
     for ( n = 0; n < procdef_count; n++ )
     {
-        file_write( fp, dcb.proc[n].sentence, sizeof( DCB_SENTENCE ) * procs[n]->sentence_count );  /* Ya procesado el byteorder */
+        file_write( fp, dcb.proc[n].sentence, sizeof( DCB_SENTENCE ) * procs[n]->sentence_count );  dcb_pad( fp, stubsize ); /* Ya procesado el byteorder */
 
         /* Privadas */
-        file_write( fp, dcb.proc[n].privar, sizeof( DCB_VAR ) * procs[n]->privars->count );         /* Ya procesado el byteorder */
-        file_writeUint32A( fp, (uint32_t *)procs[n]->privars->stringvars, procs[n]->privars->stringvar_count );
-        file_write( fp, procs[n]->pridata->bytes, procs[n]->pridata->current );                     /* ****** */
+        file_write( fp, dcb.proc[n].privar, sizeof( DCB_VAR ) * procs[n]->privars->count );         dcb_pad( fp, stubsize ); /* Ya procesado el byteorder */
+        file_writeUint32A( fp, (uint32_t *)procs[n]->privars->stringvars, procs[n]->privars->stringvar_count );    dcb_pad( fp, stubsize );
+        file_write( fp, procs[n]->pridata->bytes, procs[n]->pridata->current );                     dcb_pad( fp, stubsize ); /* ****** */
 
         /* Publicas */
-        file_write( fp, dcb.proc[n].pubvar, sizeof( DCB_VAR ) * procs[n]->pubvars->count );         /* Ya procesado el byteorder */
-        file_writeUint32A( fp, (uint32_t *)procs[n]->pubvars->stringvars, procs[n]->pubvars->stringvar_count );
-        file_write( fp, procs[n]->pubdata->bytes, procs[n]->pubdata->current );                     /* ****** */
+        file_write( fp, dcb.proc[n].pubvar, sizeof( DCB_VAR ) * procs[n]->pubvars->count );         dcb_pad( fp, stubsize ); /* Ya procesado el byteorder */
+        file_writeUint32A( fp, (uint32_t *)procs[n]->pubvars->stringvars, procs[n]->pubvars->stringvar_count );    dcb_pad( fp, stubsize );
+        file_write( fp, procs[n]->pubdata->bytes, procs[n]->pubdata->current );                     dcb_pad( fp, stubsize ); /* ****** */
 
         /* Code */
-        file_writeUint32A( fp, (uint32_t *)procs[n]->code.data, procs[n]->code.current );
+        file_writeUint32A( fp, (uint32_t *)procs[n]->code.data, procs[n]->code.current );           dcb_pad( fp, stubsize );
     }
 
     /* Cada uno de los archivos incluidos */
@@ -63,6 +63,7 @@ char langinfo[64];
 extern int debug;
 int autodeclare = 1;
 int libmode = 0;
+int optimize = 0;
 
 char * main_path = NULL;
 
@@ -227,6 +228,10 @@ int main( int argc, char *argv[] )
 
                 if ( argv[i][j] == 'p' ) autodeclare = 0 ;
 
+                if ( argv[i][j] == 'O' ) optimize = 1 ;
+
+                if ( argv[i][j] == 'm' ) dcb_options |= DCB_ALIGNED;
+
                 if ( argv[i][j] == 's' )
                 {
                     /* -s "stub": Use a stub */
@@ -156,12 +156,15 @@ void procdef_destroy (PROCDEF * proc)
 
 /* Realiza acciones posteriores al compilado sobre el código:
  * - Convierte saltos de código de etiqueta a offset
- * - Convierte identificador de procesos en CALL o TYPE a typeid */
+ * - Convierte identificador de procesos en CALL o TYPE a typeid
+ * - Con -O, optimiza el código resultante */
 
 void program_postprocess ()
 {
     int n ;
     for (n = 0; n <= procdef_maxid; n++) codeblock_postprocess (&procs[n]->code) ;
+    if (optimize)
+        for (n = 0; n <= procdef_maxid; n++) codeblock_optimize (&procs[n]->code) ;
 }
 
 void program_dumpprocesses()
@@ -0,0 +1,488 @@
+/*
+ *  Copyright (C) 2014-2015 Joseba García Etxebarria <joseba.gar@gmail.com>
+ *  Copyright (C) 2006-2012 SplinterGU (Fenix/Bennugd)
+ *  Copyright (C) 2002-2006 Fenix Team (Fenix)
+ *  Copyright (C) 1999-2002 José Luis Cebrián Pagüe (Fenix)
+ *
+ *  This file is part of PixTudio
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty. In no event will the authors be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *     1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *
+ *     2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ *
+ */
+
+/* --------------------------------------------------------------------------- */
+
+#include <stdlib.h>
+#include <math.h>
+
+#include <SDL.h>
+
+#include "libblit.h"
+#include "g_video.h"
+
+/* --------------------------------------------------------------------------- */
+
+/* Draw commands to the screen are collected between gr_batch_begin() and
+ * gr_batch_end(). They are drawn in submission order, but a command can
+ * be moved back to join an earlier one with the same texture, blend mode,
+ * alpha and clip rect, when it doesn't overlap any of the commands it
+ * jumps over, so the result is the same with fewer state changes. Bands
+ * (librender uses one for each Z value) are never mixed. Outside a batch
+ * commands are drawn at once, as before.
+ */
+
+typedef struct
+{
+    SDL_Texture * texture ;
+    SDL_Rect src ;
+    int has_src ;
+    SDL_Rect dst ;
+    double angle ;
+    SDL_Point center ;
+    SDL_RendererFlip flip ;
+    SDL_BlendMode mode ;
+    Uint8 alpha ;
+    SDL_Rect clip ;
+    SDL_Rect bounds ;   /* Screen area it can touch, rotation included */
+    int band ;
+    int done ;
+}
+BATCH_COMMAND ;
+
+static BATCH_COMMAND * batch = NULL ;
+static int batch_count = 0 ;
+static int batch_allocated = 0 ;
+
+static BATCH_COMMAND * batch_grouped = NULL ;
+static int batch_grouped_allocated = 0 ;
+
+/* How far ahead a command can be taken from to join a group */
+#define BATCH_LOOKAHEAD 32
+
+static int batch_active = 0 ;
+static int batch_band = 0 ;
+
+static int batch_suspended = 0 ;
+
+/* --------------------------------------------------------------------------- */
+
+#define SAME_RECT(a,b)  ( (a).x == (b).x && (a).y == (b).y && (a).w == (b).w && (a).h == (b).h )
+
+#define SAME_STATE(a,b) ( (a).band == (b).band && (a).texture == (b).texture && (a).mode == (b).mode && \
+                          (a).alpha == (b).alpha && SAME_RECT( (a).clip, (b).clip ) )
+
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : batch_group
+ *
+ *  Reorder the queued commands so the ones with the same state follow each
+ *  other, without changing what is drawn. After each command, the next
+ *  BATCH_LOOKAHEAD commands of its band that share its state are moved
+ *  right behind it, unless they overlap one of the commands they would
+ *  jump over. Everything else keeps the submission order.
+ *
+ *  PARAMS :
+ *      None
+ *
+ *  RETURN VALUE :
+ *      None
+ *
+ */
+
+static void batch_group( void )
+{
+    int skipped[ BATCH_LOOKAHEAD ] ;
+    int i, j, k, nskipped, count = 0 ;
+    BATCH_COMMAND * list ;
+
+    if ( batch_grouped_allocated < batch_allocated )
+    {
+        list = realloc( batch_grouped, batch_allocated * sizeof( BATCH_COMMAND ) ) ;
+        if ( !list ) return ; /* Out of memory, draw them in order */
+        batch_grouped = list ;
+        batch_grouped_allocated = batch_allocated ;
+    }
+
+    for ( i = 0 ; i < batch_count ; i++ ) batch[ i ].done = 0 ;
+
+    for ( i = 0 ; i < batch_count ; i++ )
+    {
+        if ( batch[ i ].done ) continue ;
+        batch_grouped[ count++ ] = batch[ i ] ;
+
+        for ( j = i + 1, nskipped = 0 ; j < batch_count && j <= i + BATCH_LOOKAHEAD && batch[ j ].band == batch[ i ].band ; j++ )
+        {
+            if ( batch[ j ].done ) continue ;
+
+            if ( SAME_STATE( batch[ j ], batch[ i ] ) )
+            {
+                for ( k = 0 ; k < nskipped ; k++ )
+                    if ( SDL_HasIntersection( &batch[ j ].bounds, &batch[ skipped[ k ] ].bounds ) ) break ;
+
+                if ( k == nskipped )
+                {
+                    batch_grouped[ count++ ] = batch[ j ] ;
+                    batch[ j ].done = 1 ;
+                    continue ;
+                }
+            }
+
+            skipped[ nskipped++ ] = j ;
+        }
+    }
+
+    list = batch ;
+    batch = batch_grouped ;
+    batch_grouped = list ;
+
+    k = batch_allocated ;
+    batch_allocated = batch_grouped_allocated ;
+    batch_grouped_allocated = k ;
+}
+
+#if SDL_VERSION_ATLEAST(2,0,18)
+
+/* Renders cmd[0..count-1], all with the same state, as a single geometry call */
+
+static SDL_Vertex * batch_vertices = NULL ;
+static int * batch_indices = NULL ;
+static int batch_vertices_allocated = 0 ;
+
+static int batch_geometry( BATCH_COMMAND * cmd, int count )
+{
+    SDL_Texture * texture = cmd->texture ;
+    SDL_Vertex * v ;
+    int * idx ;
+    int tw, th, n, k ;
+    float u0, v0, u1, v1, t, cx, cy, px, py, s, c ;
+    static const float qx[4] = { 0, 1, 1, 0 }, qy[4] = { 0, 0, 1, 1 } ;
+
+    if ( count * 4 > batch_vertices_allocated )
+    {
+        v = realloc( batch_vertices, count * 4 * sizeof( SDL_Vertex ) ) ;
+        if ( !v ) return -1 ;
+        batch_vertices = v ;
+        idx = realloc( batch_indices, count * 6 * sizeof( int ) ) ;
+        if ( !idx ) return -1 ;
+        batch_indices = idx ;
+        batch_vertices_allocated = count * 4 ;
+    }
+
+    if ( SDL_QueryTexture( texture, NULL, NULL, &tw, &th ) < 0 || !tw || !th ) return -1 ;
+
+    for ( n = 0, v = batch_vertices, idx = batch_indices ; n < count ; n++, cmd++ )
+    {
+        if ( cmd->has_src )
+        {
+            u0 = ( float ) cmd->src.x / tw ;
+            v0 = ( float ) cmd->src.y / th ;
+            u1 = ( float ) ( cmd->src.x + cmd->src.w ) / tw ;
+            v1 = ( float ) ( cmd->src.y + cmd->src.h ) / th ;
+        }
+        else
+        {
+            u0 = v0 = 0.0f ;
+            u1 = v1 = 1.0f ;
+        }
+
+        if ( cmd->flip & SDL_FLIP_HORIZONTAL ) { t = u0 ; u0 = u1 ; u1 = t ; }
+        if ( cmd->flip & SDL_FLIP_VERTICAL ) { t = v0 ; v0 = v1 ; v1 = t ; }
+
+        /* Same rotation SDL_RenderCopyEx does: clockwise degrees around center */
+        s = ( float ) sin( cmd->angle * M_PI / 180.0 ) ;
+        c = ( float ) cos( cmd->angle * M_PI / 180.0 ) ;
+        cx = cmd->dst.x + cmd->center.x ;
+        cy = cmd->dst.y + cmd->center.y ;
+
+        for ( k = 0 ; k < 4 ; k++ )
+        {
+            px = cmd->dst.x + qx[k] * cmd->dst.w - cx ;
+            py = cmd->dst.y + qy[k] * cmd->dst.h - cy ;
+            v[k].position.x = cx + px * c - py * s ;
+            v[k].position.y = cy + px * s + py * c ;
+            v[k].tex_coord.x = qx[k] ? u1 : u0 ;
+            v[k].tex_coord.y = qy[k] ? v1 : v0 ;
+            v[k].color.r = v[k].color.g = v[k].color.b = 255 ;
+            v[k].color.a = cmd->alpha ;
+        }
+
+        idx[0] = n * 4 ; idx[1] = n * 4 + 1 ; idx[2] = n * 4 + 2 ;
+        idx[3] = n * 4 ; idx[4] = n * 4 + 2 ; idx[5] = n * 4 + 3 ;
+
+        v += 4 ;
+        idx += 6 ;
+    }
+
+    return SDL_RenderGeometry( renderer, texture, batch_vertices, count * 4, batch_indices, count * 6 ) ;
+}
+
+#endif
+
+/* --------------------------------------------------------------------------- */
+
+static void batch_draw( BATCH_COMMAND * cmd, int set_state )
+{
+    if ( set_state )
+    {
+        SDL_SetTextureAlphaMod( cmd->texture, cmd->alpha ) ;
+        SDL_SetTextureBlendMode( cmd->texture, cmd->mode ) ;
+    }
+
+    /* Some renderers (the software one) always rotate in SDL_RenderCopyEx,
+       losing pixels at the edges */
+    if ( cmd->angle == 0.0 && cmd->flip == SDL_FLIP_NONE )
+        SDL_RenderCopy( renderer, cmd->texture, cmd->has_src ? &cmd->src : NULL, &cmd->dst ) ;
+    else
+        SDL_RenderCopyEx( renderer, cmd->texture, cmd->has_src ? &cmd->src : NULL, &cmd->dst, cmd->angle, &cmd->center, cmd->flip ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : gr_batch_begin
+ *
+ *  Start collecting the draw commands to the screen
+ *
+ *  PARAMS :
+ *      None
+ *
+ *  RETURN VALUE :
+ *      None
+ *
+ */
+
+void gr_batch_begin( void )
+{
+    if ( batch_active ) gr_batch_flush() ;
+
+    batch_active = 1 ;
+    batch_band = 0 ;
+}
+
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : gr_batch_band
+ *
+ *  Start a new band. Commands are never reordered across bands
+ *
+ *  PARAMS :
+ *      None
+ *
+ *  RETURN VALUE :
+ *      None
+ *
+ */
+
+void gr_batch_band( void )
+{
+    if ( batch_active && batch_count && batch[ batch_count - 1 ].band == batch_band ) batch_band++ ;
+}
+
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : gr_batch_copy
+ *
+ *  Draw (or queue, inside a batch) a texture to the screen. Parameters
+ *  are the same of SDL_RenderCopyEx, plus the texture state to use
+ *
+ *  PARAMS :
+ *      texture         Texture to draw
+ *      src             Source rect, or NULL for the whole texture
+ *      dst             Destination rect
+ *      angle           Angle, in degrees, clockwise
+ *      center          Rotation center, relative to dst
+ *      flip            Mirror flags
+ *      mode            Blend mode
+ *      alpha           Alpha modulation
+ *      clip            Clip rect
+ *
+ *  RETURN VALUE :
+ *      None
+ *
+ */
+
+void gr_batch_copy( SDL_Texture * texture, const SDL_Rect * src, const SDL_Rect * dst, double angle, const SDL_Point * center, SDL_RendererFlip flip, SDL_BlendMode mode, Uint8 alpha, const SDL_Rect * clip )
+{
+    BATCH_COMMAND * cmd, immediate ;
+
+    if ( batch_active && batch_count >= batch_allocated )
+    {
+        int allocated = batch_allocated ? batch_allocated * 2 : 256 ;
+        BATCH_COMMAND * commands = realloc( batch, allocated * sizeof( BATCH_COMMAND ) ) ;
+        if ( commands )
+        {
+            batch = commands ;
+            batch_allocated = allocated ;
+        }
+        else
+            gr_batch_flush() ; /* Out of memory, draw what we have */
+    }
+
+    cmd = ( batch_active && batch_count < batch_allocated ) ? &batch[ batch_count ] : &immediate ;
+
+    cmd->texture = texture ;
+    cmd->has_src = src ? 1 : 0 ;
+    if ( src ) cmd->src = *src ;
+    cmd->dst = *dst ;
+    cmd->angle = angle ;
+    if ( center )
+        cmd->center = *center ;
+    else
+    {
+        cmd->center.x = dst->w / 2 ;
+        cmd->center.y = dst->h / 2 ;
+    }
+    cmd->flip = flip ;
+    cmd->mode = mode ;
+    cmd->alpha = alpha ;
+    cmd->clip = *clip ;
+    cmd->band = batch_band ;
+
+    cmd->bounds = *dst ;
+    if ( angle != 0.0 )
+    {
+        /* Any rotation stays inside the circle around the center */
+        int rx = MAX( abs( cmd->center.x ), abs( dst->w - cmd->center.x ) ) ;
+        int ry = MAX( abs( cmd->center.y ), abs( dst->h - cmd->center.y ) ) ;
+        int r = ( int ) ceil( sqrt( ( double ) rx * rx + ( double ) ry * ry ) ) + 1 ;
+
+        cmd->bounds.x = dst->x + cmd->center.x - r ;
+        cmd->bounds.y = dst->y + cmd->center.y - r ;
+        cmd->bounds.w = cmd->bounds.h = 2 * r ;
+    }
+
+    if ( cmd != &immediate )
+    {
+        batch_count++ ;
+        return ;
+    }
+
+    bitmap_flush_textures() ;
+    SDL_RenderSetClipRect( renderer, clip ) ;
+    batch_draw( cmd, 1 ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : gr_batch_flush
+ *
+ *  Draw all the queued commands
+ *
+ *  PARAMS :
+ *      None
+ *
+ *  RETURN VALUE :
+ *      None
+ *
+ */
+
+void gr_batch_flush( void )
+{
+    BATCH_COMMAND * cmd, * end ;
+    SDL_Rect clip ;
+    int run, n ;
+
+    if ( !batch_count ) return ;
+
+    /* Pixels changed while queueing must reach the textures first */
+    bitmap_flush_textures() ;
+
+    batch_group() ;
+
+    end = batch + batch_count ;
+    for ( cmd = batch ; cmd < end ; cmd += run )
+    {
+        /* The clip only has to be set when it changes */
+        if ( cmd == batch || !SAME_RECT( cmd->clip, clip ) )
+        {
+            clip = cmd->clip ;
+            SDL_RenderSetClipRect( renderer, &clip ) ;
+        }
+
+        /* Commands that share all the state */
+        for ( run = 1 ; cmd + run < end && SAME_STATE( cmd[ run ], *cmd ) ; run++ ) ;
+
+        SDL_SetTextureBlendMode( cmd->texture, cmd->mode ) ;
+
+#if SDL_VERSION_ATLEAST(2,0,18)
+        if ( batch_geometry( cmd, run ) == 0 ) continue ;
+#endif
+
+        SDL_SetTextureAlphaMod( cmd->texture, cmd->alpha ) ;
+        for ( n = 0 ; n < run ; n++ ) batch_draw( &cmd[ n ], 0 ) ;
+    }
+
+    batch_count = 0 ;
+}
+
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : gr_batch_target
+ *
+ *  Draw the next commands into a render target texture, or to the screen
+ *  again. Commands to a texture are never queued, and the commands to the
+ *  screen queued so far are drawn first, so they still see the texture as
+ *  it was.
+ *
+ *  PARAMS :
+ *      texture         Render target texture, or NULL for the screen
+ *
+ *  RETURN VALUE :
+ *      None
+ *
+ */
+
+void gr_batch_target( SDL_Texture * texture )
+{
+    if ( texture )
+    {
+        gr_batch_flush() ;
+        batch_suspended = batch_active ;
+        batch_active = 0 ;
+        SDL_SetRenderTarget( renderer, texture ) ;
+    }
+    else
+    {
+        SDL_SetRenderTarget( renderer, NULL ) ;
+        batch_active = batch_suspended ;
+        batch_suspended = 0 ;
+    }
+}
+
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : gr_batch_end
+ *
+ *  Draw the queued commands and stop collecting them
+ *
+ *  PARAMS :
+ *      None
+ *
+ *  RETURN VALUE :
+ *      None
+ *
+ */
+
+void gr_batch_end( void )
+{
+    gr_batch_flush() ;
+    batch_active = 0 ;
+}
+
+/* --------------------------------------------------------------------------- */
@@ -0,0 +1,48 @@
+/*
+ *  Copyright (C) 2014-2015 Joseba García Etxebarria <joseba.gar@gmail.com>
+ *  Copyright (C) 2006-2012 SplinterGU (Fenix/Bennugd)
+ *  Copyright (C) 2002-2006 Fenix Team (Fenix)
+ *  Copyright (C) 1999-2002 José Luis Cebrián Pagüe (Fenix)
+ *
+ *  This file is part of PixTudio
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty. In no event will the authors be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *     1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *
+ *     2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ *
+ */
+
+#ifndef __BATCH_H
+#define __BATCH_H
+
+/* --------------------------------------------------------------------------- */
+
+#include <SDL.h>
+
+/* --------------------------------------------------------------------------- */
+
+extern void gr_batch_begin( void ) ;
+extern void gr_batch_band( void ) ;
+extern void gr_batch_copy( SDL_Texture * texture, const SDL_Rect * src, const SDL_Rect * dst, double angle, const SDL_Point * center, SDL_RendererFlip flip, SDL_BlendMode mode, Uint8 alpha, const SDL_Rect * clip ) ;
+extern void gr_batch_flush( void ) ;
+extern void gr_batch_target( SDL_Texture * texture ) ;
+extern void gr_batch_end( void ) ;
+
+/* --------------------------------------------------------------------------- */
+
+#endif
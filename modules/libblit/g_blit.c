@@ -1214,6 +1214,16 @@ static void draw_hspan_16to16( uint16_t *scr, uint16_t * tex, int pixels, int in
     int i;
     uint8_t * _scr = ( uint8_t * ) scr, * _tex = ( uint8_t * ) tex;
 
+    if ( blit_simd.key16 )
+    {
+        while ( l-- )
+        {
+            blit_simd.key16( scr, tex, pixels, incs );
+            scr = ( uint16_t * )( _scr += scr_inc ); tex = ( uint16_t * )( _tex += tex_inc );
+        }
+        return;
+    }
+
     while ( l-- )
     {
         for ( i = pixels; i--; )
@@ -1569,6 +1579,16 @@ static void draw_hspan_32to32( uint32_t *scr, uint32_t * tex, int pixels, int in
     uint8_t * _scr = ( uint8_t * ) scr, * _tex = ( uint8_t * ) tex;
     uint32_t r, g, b, c;
 
+    if ( blit_simd.alpha32 )
+    {
+        while ( l-- )
+        {
+            blit_simd.alpha32( scr, tex, pixels, incs );
+            scr = ( uint32_t * )( _scr += scr_inc ); tex = ( uint32_t * )( _tex += tex_inc );
+        }
+        return;
+    }
+
     while ( l-- )
     {
         for ( i = pixels; i--; )
@@ -1607,6 +1627,16 @@ static void draw_hspan_32to32_ablend( uint32_t *scr, uint32_t * tex, int pixels,
     uint8_t * _scr = ( uint8_t * ) scr, * _tex = ( uint8_t * ) tex;
     uint32_t r, g, b, c;
 
+    if ( blit_simd.blend32 )
+    {
+        while ( l-- )
+        {
+            blit_simd.blend32( scr, tex, pixels, incs, blend_func == substractive_blend32 ? BLIT_SIMD_SUB : BLIT_SIMD_ADD, _factor, _factor2 );
+            scr = ( uint32_t * )( _scr += scr_inc ); tex = ( uint32_t * )( _tex += tex_inc );
+        }
+        return;
+    }
+
     while ( l-- )
     {
         for ( i = pixels; i--; )
@@ -1646,6 +1676,16 @@ static void draw_hspan_32to32_tablend( uint32_t *scr, uint32_t * tex, int pixels
     uint32_t r, g, b;
     unsigned int c, _f, _f2;
 
+    if ( blit_simd.tblend32 )
+    {
+        while ( l-- )
+        {
+            blit_simd.tblend32( scr, tex, pixels, incs, blend_func == substractive_blend32 ? BLIT_SIMD_SUB : BLIT_SIMD_ADD, _factor, _factor2 );
+            scr = ( uint32_t * )( _scr += scr_inc ); tex = ( uint32_t * )( _tex += tex_inc );
+        }
+        return;
+    }
+
     while ( l-- )
     {
         for ( i = pixels; i--; )
@@ -1689,6 +1729,16 @@ static void draw_hspan_32to32_translucent( uint32_t *scr, uint32_t * tex, int pi
     int r, g, b;
     unsigned int c, _f, _f2;
 
+    if ( blit_simd.translucent32 )
+    {
+        while ( l-- )
+        {
+            blit_simd.translucent32( scr, tex, pixels, incs, _factor, _factor2 );
+            scr = ( uint32_t * )( _scr += scr_inc ); tex = ( uint32_t * )( _tex += tex_inc );
+        }
+        return;
+    }
+
     while ( l-- )
     {
         for ( i = pixels; i--; )
@@ -1917,6 +1967,52 @@ void gr_get_bbox( REGION * dest, REGION * clip, int x, int y, int flags, int ang
     dest->y2 = max.y / 1000 ;
 }
 
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : blit_to_target
+ *
+ *  Tell if a blit into a graph is done by the renderer, as the blits to
+ *  the screen. Only render target graphs are drawn this way, and only
+ *  from graphs with a texture (not from themselves).
+ *
+ *  PARAMS :
+ *      dest            Destination bitmap
+ *      gr              Bitmap to draw
+ *
+ *  RETURN VALUE :
+ *      1 if the renderer has to do the blit
+ *
+ */
+
+static int blit_to_target( GRAPH * dest, GRAPH * gr )
+{
+    return ( dest->info_flags & GI_TARGET ) && gr->texture && gr != dest ;
+}
+
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : blit_target_done
+ *
+ *  Go back to drawing on the screen after a blit into a render target,
+ *  and remember that the data of the target has to be read back
+ *
+ *  PARAMS :
+ *      dest            Destination bitmap
+ *
+ *  RETURN VALUE :
+ *      None
+ *
+ */
+
+static void blit_target_done( GRAPH * dest )
+{
+    gr_batch_target( NULL ) ;
+
+    dest->info_flags |= GI_TARGET_DRAWN ;
+    dest->info_flags &= ~GI_CLEAN ;
+    dest->modified = 2 ;
+}
+
 /* --------------------------------------------------------------------------- */
 /*
  *  FUNCTION : gr_rotated_blit
@@ -1975,9 +2071,12 @@ void gr_rotated_blit( GRAPH * dest, REGION * clip, int scrx, int scry, int flags
 
     if ( scalex <= 0 || scaley <= 0 ) return;
 
-    // When drawing to screen, use SDL_Render directly, otherwise use
-    // the software blitter
-    if( scrbitmap && dest == scrbitmap ) {
+    /* Still in the upload queue, the texture is needed now */
+    if ( gr->texture_queued ) bitmap_upload_texture( gr ) ;
+
+    // When drawing to screen or to a render target, use SDL_Render directly,
+    // otherwise use the software blitter
+    if( ( scrbitmap && dest == scrbitmap ) || ( dest && blit_to_target( dest, gr ) ) ) {
         if(! gr->texture) {
             return;
         }
@@ -2045,14 +2144,24 @@ void gr_rotated_blit( GRAPH * dest, REGION * clip, int scrx, int scry, int flags
                 alpha = ((( flags & B_ALPHA_MASK ) >> B_ALPHA_SHIFT ) );
             }
         }
-        SDL_SetTextureAlphaMod(gr->texture, alpha);
 
-        SDL_SetTextureBlendMode(gr->texture, mode);
-        SDL_RenderSetClipRect(renderer, &clipRect);
+        if ( dest != scrbitmap )
+        {
+            /* CPU changes still pending must reach both textures before
+               the renderer draws into the target */
+            bitmap_flush_texture( dest ) ;
+            bitmap_flush_texture( gr ) ;
+            gr_batch_target( dest->texture ) ;
+        }
+
+        gr_batch_copy(gr->texture, gr->atlas_page ? &gr->atlas_rect : NULL, &dstRect, flip_factor * angle/-1000., &rcenter, flip, mode, alpha, &clipRect);
 
-        SDL_RenderCopyEx(renderer, gr->texture, NULL, &dstRect, flip_factor * angle/-1000., &rcenter, flip);
+        if ( dest != scrbitmap ) blit_target_done( dest ) ;
     } else {
         // Software blit
+        bitmap_sync_data( dest ) ;
+        bitmap_sync_data( gr ) ;
+
         if ( !dest->data || !gr->data ) {
             return;
         }
@@ -2595,8 +2704,25 @@ void gr_rotated_blit( GRAPH * dest, REGION * clip, int scrx, int scry, int flags
                 }
             }
         }
-        // Update the texture
-        bitmap_update_texture(dest);
+        // Queue the covered area for upload
+        {
+            REGION region ;
+
+            region.x  = region.x2 = corners[0].x ;
+            region.y  = region.y2 = corners[0].y ;
+            for ( i = 1; i < 4; i++ )
+            {
+                if ( region.x  > corners[i].x ) region.x  = corners[i].x ;
+                if ( region.x2 < corners[i].x ) region.x2 = corners[i].x ;
+                if ( region.y  > corners[i].y ) region.y  = corners[i].y ;
+                if ( region.y2 < corners[i].y ) region.y2 = corners[i].y ;
+            }
+            region.x  = MAX( region.x - 1, min.x ) ;
+            region.y  = MAX( region.y - 1, min.y ) ;
+            region.x2 = MIN( region.x2 + 1, max.x ) ;
+            region.y2 = MIN( region.y2 + 1, max.y ) ;
+            bitmap_mark_dirty( dest, &region ) ;
+        }
     }
 
     dest->info_flags &= ~GI_CLEAN;
@@ -2641,9 +2767,12 @@ void gr_blit( GRAPH * dest, REGION * clip, int scrx, int scry, int flags, GRAPH
 
     if ( !dest ) dest = scrbitmap ;
 
-    // When drawing to screen, use SDL_Render directly, otherwise use homegrown
-    // software solution
-    if( scrbitmap && dest == scrbitmap ) {
+    /* Still in the upload queue, the texture is needed now */
+    if ( gr->texture_queued ) bitmap_upload_texture( gr ) ;
+
+    // When drawing to screen or to a render target, use SDL_Render directly,
+    // otherwise use homegrown software solution
+    if( ( scrbitmap && dest == scrbitmap ) || ( dest && blit_to_target( dest, gr ) ) ) {
         if(! gr->texture) {
             return;
         }
@@ -2703,29 +2832,41 @@ void gr_blit( GRAPH * dest, REGION * clip, int scrx, int scry, int flags, GRAPH
                 alpha = ((( flags & B_ALPHA_MASK ) >> B_ALPHA_SHIFT ) );
             }
         }
-        SDL_SetTextureAlphaMod(gr->texture, alpha);
 
-        SDL_SetTextureBlendMode(gr->texture, mode);
-        SDL_RenderSetClipRect(renderer, &clipRect);
+        if ( dest != scrbitmap )
+        {
+            /* CPU changes still pending must reach both textures before
+               the renderer draws into the target */
+            bitmap_flush_texture( dest ) ;
+            bitmap_flush_texture( gr ) ;
+            gr_batch_target( dest->texture ) ;
+        }
 
-        SDL_RenderCopyEx(renderer, gr->texture, NULL, &dstRect, 0., NULL, flip);
+        gr_batch_copy(gr->texture, gr->atlas_page ? &gr->atlas_rect : NULL, &dstRect, 0., NULL, flip, mode, alpha, &clipRect);
         piece = gr->next_piece;
         while(piece) {
             dstRect.x = scrx - center.x + piece->x;
             dstRect.y = scry - center.y + piece->y;
             if(piece->texture) {
-                SDL_SetTextureBlendMode(piece->texture, mode);
                 SDL_QueryTexture(piece->texture, NULL, NULL, &dstRect.w, &dstRect.h);
-                SDL_RenderCopyEx(renderer, piece->texture, NULL, &dstRect, 0., NULL, flip);
+                gr_batch_copy(piece->texture, NULL, &dstRect, 0., NULL, flip, mode, alpha, &clipRect);
             }
             piece = piece->next;
         }
+
+        if ( dest != scrbitmap ) blit_target_done( dest ) ;
     } else {
         // Software blitting
+        bitmap_sync_data( dest ) ;
+        bitmap_sync_data( gr ) ;
+
         if ( !dest->data || !gr->data ) {
             return;
         }
 
+        /* Pick the vectorized spans the first time */
+        if ( blit_simd.level == BLIT_SIMD_AUTO ) gr_blit_simd_set( BLIT_SIMD_AUTO );
+
         /* Calculate the clipping coordinates */
         if ( clip )
         {
@@ -3154,9 +3295,11 @@ void gr_blit( GRAPH * dest, REGION * clip, int scrx, int scry, int flags, GRAPH
 
         if ( p > 0 ) draw_hspan( scr, tex, p, direction, l, scr_inc, tex_inc );
 
-        // Update the texture
-        if(update_texture) {
-            bitmap_update_texture(dest);
+        // Queue the drawn area for upload
+        if ( update_texture )
+        {
+            REGION region = { x, y, x + p - 1, y + l - 1 } ;
+            bitmap_mark_dirty( dest, &region ) ;
         }
     }
 
@@ -0,0 +1,733 @@
+/*
+ *  Copyright (C) 2014-2015 Joseba García Etxebarria <joseba.gar@gmail.com>
+ *  Copyright (C) 2006-2012 SplinterGU (Fenix/Bennugd)
+ *  Copyright (C) 2002-2006 Fenix Team (Fenix)
+ *  Copyright (C) 1999-2002 José Luis Cebrián Pagüe (Fenix)
+ *
+ *  This file is part of PixTudio
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty. In no event will the authors be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *     1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *
+ *     2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ *
+ */
+
+/* --------------------------------------------------------------------------- */
+/*
+ *  Vectorized versions of the most used spans of the software blitter.
+ *
+ *  The C spans in g_blit.c are the reference: every kernel here has to
+ *  give the very same pixels, rounding included. The leftover pixels of
+ *  each row are drawn with the px_xxx() helpers, that are the C spans
+ *  written for a single pixel.
+ */
+/* --------------------------------------------------------------------------- */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL_cpuinfo.h>
+
+#include "libblit.h"
+#include "g_blit_simd.h"
+
+/* --------------------------------------------------------------------------- */
+
+#if ( defined( __GNUC__ ) || defined( __clang__ ) ) && ( defined( __i386__ ) || defined( __x86_64__ ) )
+#define BLIT_SIMD_X86
+#define TARGET_SSE2 __attribute__(( target( "sse2" ) ))
+#define TARGET_AVX2 __attribute__(( target( "avx2" ) ))
+#elif defined( _MSC_VER ) && ( defined( _M_IX86 ) || defined( _M_X64 ) )
+#define BLIT_SIMD_X86
+#define TARGET_SSE2
+#define TARGET_AVX2
+#elif defined( __ARM_NEON ) || defined( __ARM_NEON__ )
+#define BLIT_SIMD_ARM
+#endif
+
+#if defined( BLIT_SIMD_X86 )
+#include <immintrin.h>
+#elif defined( BLIT_SIMD_ARM )
+#include <arm_neon.h>
+#endif
+
+/* --------------------------------------------------------------------------- */
+
+BLIT_SIMD_KERNELS blit_simd = { BLIT_SIMD_AUTO, NULL, NULL, NULL, NULL, NULL } ;
+
+/* --------------------------------------------------------------------------- */
+/* Single pixel versions                                                       */
+/* --------------------------------------------------------------------------- */
+
+/* ( c * f + s * f2 ) >> 8 for each color channel */
+
+static uint32_t px_mix( uint32_t c, uint32_t s, uint32_t f, uint32_t f2 )
+{
+    return (((((( c >> 16 ) & 0xff ) * f ) + ((( s >> 16 ) & 0xff ) * f2 ) ) >> 8 ) << 16 ) |
+           (((((( c >>  8 ) & 0xff ) * f ) + ((( s >>  8 ) & 0xff ) * f2 ) ) >> 8 ) <<  8 ) |
+           ((((   c         & 0xff ) * f ) + ((  s         & 0xff ) * f2 ) ) >> 8 ) ;
+}
+
+/* Same as additive_blend32 / substractive_blend32 */
+
+static uint32_t px_op( uint32_t t, uint32_t s, int op )
+{
+    uint32_t c = 0 ;
+    int n, v ;
+
+    for ( n = 0 ; n < 24 ; n += 8 )
+    {
+        v = (( t >> n ) & 0xff ) + (( s >> n ) & 0xff ) ;
+        if ( op == BLIT_SIMD_SUB ) v = ( v < 256 ) ? 0 : v - 256 ;
+        else if ( v > 255 ) v = 255 ;
+        c |= v << n ;
+    }
+
+    return c ;
+}
+
+static uint32_t px_alpha32( uint32_t t, uint32_t s )
+{
+    uint32_t a = t >> 24 ;
+
+    if ( !t ) return s ;
+    if ( t == 0xff000000 ) return t ;
+    return MAX( t & 0xff000000, s & 0xff000000 ) | px_mix( t, s, a, 255 - a ) ;
+}
+
+static uint32_t px_translucent32( uint32_t t, uint32_t s, uint32_t factor, uint32_t factor2 )
+{
+    uint32_t f = t >> 24 ;
+
+    if ( !t ) return s ;
+    if ( f != 0xff ) f = f * factor / 255, factor2 = 255 - f ;
+    else f = factor ;
+    return MAX( t & 0xff000000, s & 0xff000000 ) | px_mix( t, s, f, factor2 ) ;
+}
+
+static uint32_t px_blend32( uint32_t t, uint32_t s, int op )
+{
+    uint32_t a = t >> 24 ;
+
+    if ( !t ) return s ;
+    if ( t == 0xff000000 ) return 0xff000000 | px_op( t, s, op ) ;
+    return ( s & 0xff000000 ) | px_mix( px_op( t, s, op ), s, a, 255 - a ) ;
+}
+
+static uint32_t px_tblend32( uint32_t t, uint32_t s, int op, uint32_t factor, uint32_t factor2 )
+{
+    uint32_t f = t >> 24 ;
+
+    if ( !t ) return s ;
+    if ( f != 0xff ) f = f * factor / 255, factor2 = 255 - f ;
+    else f = factor ;
+    return ( s & 0xff000000 ) | px_mix( px_op( t, s, op ), s, f, factor2 ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+/* SSE2 and AVX2                                                               */
+/* --------------------------------------------------------------------------- */
+
+#ifdef BLIT_SIMD_X86
+
+static TARGET_SSE2 __m128i sse2_load32( uint32_t * tex, int incs )
+{
+    if ( incs > 0 ) return _mm_loadu_si128(( __m128i * ) tex ) ;
+    return _mm_shuffle_epi32( _mm_loadu_si128(( __m128i * )( tex - 3 ) ), _MM_SHUFFLE( 0, 1, 2, 3 ) ) ;
+}
+
+static TARGET_SSE2 __m128i sse2_select( __m128i mask, __m128i a, __m128i b )
+{
+    return _mm_or_si128( _mm_and_si128( mask, a ), _mm_andnot_si128( mask, b ) ) ;
+}
+
+/* ( c * f + s * f2 ) >> 8 for each channel, f and f2 given per pixel */
+
+static TARGET_SSE2 __m128i sse2_mix( __m128i c, __m128i s, __m128i f, __m128i f2 )
+{
+    __m128i zero = _mm_setzero_si128() ;
+    __m128i lo, hi ;
+
+    f  = _mm_or_si128( f,  _mm_slli_epi32( f,  16 ) ) ;
+    f2 = _mm_or_si128( f2, _mm_slli_epi32( f2, 16 ) ) ;
+
+    lo = _mm_add_epi16( _mm_mullo_epi16( _mm_unpacklo_epi8( c, zero ), _mm_unpacklo_epi32( f, f ) ),
+                        _mm_mullo_epi16( _mm_unpacklo_epi8( s, zero ), _mm_unpacklo_epi32( f2, f2 ) ) ) ;
+    hi = _mm_add_epi16( _mm_mullo_epi16( _mm_unpackhi_epi8( c, zero ), _mm_unpackhi_epi32( f, f ) ),
+                        _mm_mullo_epi16( _mm_unpackhi_epi8( s, zero ), _mm_unpackhi_epi32( f2, f2 ) ) ) ;
+
+    return _mm_packus_epi16( _mm_srli_epi16( lo, 8 ), _mm_srli_epi16( hi, 8 ) ) ;
+}
+
+/* Per pixel factors of the translucent spans: alpha * factor / 255,
+   or the global factors for opaque pixels */
+
+static TARGET_SSE2 void sse2_factors( __m128i t, int factor, int factor2, __m128i * f, __m128i * f2 )
+{
+    __m128i a = _mm_srli_epi32( t, 24 ) ;
+    __m128i c255 = _mm_set1_epi32( 255 ) ;
+    __m128i opaque = _mm_cmpeq_epi32( a, c255 ) ;
+    __m128i x = _mm_mullo_epi16( a, _mm_set1_epi32( factor ) ) ;
+
+    /* x / 255, exact for x < 65535 */
+    x = _mm_srli_epi32( _mm_add_epi32( _mm_add_epi32( x, _mm_set1_epi32( 1 ) ), _mm_srli_epi32( x, 8 ) ), 8 ) ;
+
+    *f  = sse2_select( opaque, _mm_set1_epi32( factor ), x ) ;
+    *f2 = sse2_select( opaque, _mm_set1_epi32( factor2 ), _mm_sub_epi32( c255, x ) ) ;
+}
+
+static TARGET_SSE2 __m128i sse2_op( __m128i t, __m128i s, int op )
+{
+    __m128i c ;
+
+    if ( op == BLIT_SIMD_SUB )
+        c = _mm_subs_epu8( _mm_subs_epu8( s, _mm_xor_si128( t, _mm_set1_epi32( -1 ) ) ), _mm_set1_epi8( 1 ) ) ;
+    else
+        c = _mm_adds_epu8( t, s ) ;
+
+    return _mm_and_si128( c, _mm_set1_epi32( 0x00ffffff ) ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static TARGET_SSE2 void sse2_key16( uint16_t * scr, uint16_t * tex, int pixels, int incs )
+{
+    __m128i t, s ;
+
+    for ( ; pixels >= 8 ; pixels -= 8, scr += 8, tex += 8 * incs )
+    {
+        if ( incs > 0 )
+            t = _mm_loadu_si128(( __m128i * ) tex ) ;
+        else
+        {
+            t = _mm_loadu_si128(( __m128i * )( tex - 7 ) ) ;
+            t = _mm_shufflelo_epi16( t, _MM_SHUFFLE( 0, 1, 2, 3 ) ) ;
+            t = _mm_shufflehi_epi16( t, _MM_SHUFFLE( 0, 1, 2, 3 ) ) ;
+            t = _mm_shuffle_epi32( t, _MM_SHUFFLE( 1, 0, 3, 2 ) ) ;
+        }
+        s = _mm_loadu_si128(( __m128i * ) scr ) ;
+        _mm_storeu_si128(( __m128i * ) scr, sse2_select( _mm_cmpeq_epi16( t, _mm_setzero_si128() ), s, t ) ) ;
+    }
+
+    for ( ; pixels-- ; scr++, tex += incs ) if ( *tex ) *scr = *tex ;
+}
+
+static TARGET_SSE2 void sse2_alpha32( uint32_t * scr, uint32_t * tex, int pixels, int incs )
+{
+    __m128i amask = _mm_set1_epi32( 0xff000000 ) ;
+    __m128i t, s, a, c ;
+
+    for ( ; pixels >= 4 ; pixels -= 4, scr += 4, tex += 4 * incs )
+    {
+        t = sse2_load32( tex, incs ) ;
+        s = _mm_loadu_si128(( __m128i * ) scr ) ;
+        a = _mm_srli_epi32( t, 24 ) ;
+
+        c = sse2_mix( t, s, a, _mm_sub_epi32( _mm_set1_epi32( 255 ), a ) ) ;
+        c = _mm_or_si128( _mm_andnot_si128( amask, c ), _mm_and_si128( amask, _mm_max_epu8( t, s ) ) ) ;
+        c = sse2_select( _mm_cmpeq_epi32( t, amask ), t, c ) ;
+        c = sse2_select( _mm_cmpeq_epi32( t, _mm_setzero_si128() ), s, c ) ;
+
+        _mm_storeu_si128(( __m128i * ) scr, c ) ;
+    }
+
+    for ( ; pixels-- ; scr++, tex += incs ) *scr = px_alpha32( *tex, *scr ) ;
+}
+
+static TARGET_SSE2 void sse2_translucent32( uint32_t * scr, uint32_t * tex, int pixels, int incs, int factor, int factor2 )
+{
+    __m128i amask = _mm_set1_epi32( 0xff000000 ) ;
+    __m128i t, s, f, f2, c ;
+
+    for ( ; pixels >= 4 ; pixels -= 4, scr += 4, tex += 4 * incs )
+    {
+        t = sse2_load32( tex, incs ) ;
+        s = _mm_loadu_si128(( __m128i * ) scr ) ;
+        sse2_factors( t, factor, factor2, &f, &f2 ) ;
+
+        c = sse2_mix( t, s, f, f2 ) ;
+        c = _mm_or_si128( _mm_andnot_si128( amask, c ), _mm_and_si128( amask, _mm_max_epu8( t, s ) ) ) ;
+        c = sse2_select( _mm_cmpeq_epi32( t, _mm_setzero_si128() ), s, c ) ;
+
+        _mm_storeu_si128(( __m128i * ) scr, c ) ;
+    }
+
+    for ( ; pixels-- ; scr++, tex += incs ) *scr = px_translucent32( *tex, *scr, factor, factor2 ) ;
+}
+
+static TARGET_SSE2 void sse2_blend32( uint32_t * scr, uint32_t * tex, int pixels, int incs, int op, int factor, int factor2 )
+{
+    __m128i amask = _mm_set1_epi32( 0xff000000 ) ;
+    __m128i t, s, a, b, c ;
+
+    for ( ; pixels >= 4 ; pixels -= 4, scr += 4, tex += 4 * incs )
+    {
+        t = sse2_load32( tex, incs ) ;
+        s = _mm_loadu_si128(( __m128i * ) scr ) ;
+        a = _mm_srli_epi32( t, 24 ) ;
+        b = sse2_op( t, s, op ) ;
+
+        c = sse2_mix( b, s, a, _mm_sub_epi32( _mm_set1_epi32( 255 ), a ) ) ;
+        c = _mm_or_si128( _mm_andnot_si128( amask, c ), _mm_and_si128( amask, s ) ) ;
+        c = sse2_select( _mm_cmpeq_epi32( t, amask ), _mm_or_si128( b, amask ), c ) ;
+        c = sse2_select( _mm_cmpeq_epi32( t, _mm_setzero_si128() ), s, c ) ;
+
+        _mm_storeu_si128(( __m128i * ) scr, c ) ;
+    }
+
+    for ( ; pixels-- ; scr++, tex += incs ) *scr = px_blend32( *tex, *scr, op ) ;
+}
+
+static TARGET_SSE2 void sse2_tblend32( uint32_t * scr, uint32_t * tex, int pixels, int incs, int op, int factor, int factor2 )
+{
+    __m128i amask = _mm_set1_epi32( 0xff000000 ) ;
+    __m128i t, s, f, f2, c ;
+
+    for ( ; pixels >= 4 ; pixels -= 4, scr += 4, tex += 4 * incs )
+    {
+        t = sse2_load32( tex, incs ) ;
+        s = _mm_loadu_si128(( __m128i * ) scr ) ;
+        sse2_factors( t, factor, factor2, &f, &f2 ) ;
+
+        c = sse2_mix( sse2_op( t, s, op ), s, f, f2 ) ;
+        c = _mm_or_si128( _mm_andnot_si128( amask, c ), _mm_and_si128( amask, s ) ) ;
+        c = sse2_select( _mm_cmpeq_epi32( t, _mm_setzero_si128() ), s, c ) ;
+
+        _mm_storeu_si128(( __m128i * ) scr, c ) ;
+    }
+
+    for ( ; pixels-- ; scr++, tex += incs ) *scr = px_tblend32( *tex, *scr, op, factor, factor2 ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static TARGET_AVX2 __m256i avx2_load32( uint32_t * tex, int incs )
+{
+    if ( incs > 0 ) return _mm256_loadu_si256(( __m256i * ) tex ) ;
+    return _mm256_permutevar8x32_epi32( _mm256_loadu_si256(( __m256i * )( tex - 7 ) ), _mm256_setr_epi32( 7, 6, 5, 4, 3, 2, 1, 0 ) ) ;
+}
+
+static TARGET_AVX2 __m256i avx2_mix( __m256i c, __m256i s, __m256i f, __m256i f2 )
+{
+    __m256i zero = _mm256_setzero_si256() ;
+    __m256i lo, hi ;
+
+    f  = _mm256_or_si256( f,  _mm256_slli_epi32( f,  16 ) ) ;
+    f2 = _mm256_or_si256( f2, _mm256_slli_epi32( f2, 16 ) ) ;
+
+    lo = _mm256_add_epi16( _mm256_mullo_epi16( _mm256_unpacklo_epi8( c, zero ), _mm256_unpacklo_epi32( f, f ) ),
+                           _mm256_mullo_epi16( _mm256_unpacklo_epi8( s, zero ), _mm256_unpacklo_epi32( f2, f2 ) ) ) ;
+    hi = _mm256_add_epi16( _mm256_mullo_epi16( _mm256_unpackhi_epi8( c, zero ), _mm256_unpackhi_epi32( f, f ) ),
+                           _mm256_mullo_epi16( _mm256_unpackhi_epi8( s, zero ), _mm256_unpackhi_epi32( f2, f2 ) ) ) ;
+
+    return _mm256_packus_epi16( _mm256_srli_epi16( lo, 8 ), _mm256_srli_epi16( hi, 8 ) ) ;
+}
+
+static TARGET_AVX2 void avx2_factors( __m256i t, int factor, int factor2, __m256i * f, __m256i * f2 )
+{
+    __m256i a = _mm256_srli_epi32( t, 24 ) ;
+    __m256i c255 = _mm256_set1_epi32( 255 ) ;
+    __m256i opaque = _mm256_cmpeq_epi32( a, c255 ) ;
+    __m256i x = _mm256_mullo_epi16( a, _mm256_set1_epi32( factor ) ) ;
+
+    x = _mm256_srli_epi32( _mm256_add_epi32( _mm256_add_epi32( x, _mm256_set1_epi32( 1 ) ), _mm256_srli_epi32( x, 8 ) ), 8 ) ;
+
+    *f  = _mm256_blendv_epi8( x, _mm256_set1_epi32( factor ), opaque ) ;
+    *f2 = _mm256_blendv_epi8( _mm256_sub_epi32( c255, x ), _mm256_set1_epi32( factor2 ), opaque ) ;
+}
+
+static TARGET_AVX2 __m256i avx2_op( __m256i t, __m256i s, int op )
+{
+    __m256i c ;
+
+    if ( op == BLIT_SIMD_SUB )
+        c = _mm256_subs_epu8( _mm256_subs_epu8( s, _mm256_xor_si256( t, _mm256_set1_epi32( -1 ) ) ), _mm256_set1_epi8( 1 ) ) ;
+    else
+        c = _mm256_adds_epu8( t, s ) ;
+
+    return _mm256_and_si256( c, _mm256_set1_epi32( 0x00ffffff ) ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static TARGET_AVX2 void avx2_key16( uint16_t * scr, uint16_t * tex, int pixels, int incs )
+{
+    __m256i reverse = _mm256_setr_epi8( 14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1,
+                                        14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1 ) ;
+    __m256i t, s ;
+
+    for ( ; pixels >= 16 ; pixels -= 16, scr += 16, tex += 16 * incs )
+    {
+        if ( incs > 0 )
+            t = _mm256_loadu_si256(( __m256i * ) tex ) ;
+        else
+            t = _mm256_permute4x64_epi64( _mm256_shuffle_epi8( _mm256_loadu_si256(( __m256i * )( tex - 15 ) ), reverse ), _MM_SHUFFLE( 1, 0, 3, 2 ) ) ;
+        s = _mm256_loadu_si256(( __m256i * ) scr ) ;
+        _mm256_storeu_si256(( __m256i * ) scr, _mm256_blendv_epi8( t, s, _mm256_cmpeq_epi16( t, _mm256_setzero_si256() ) ) ) ;
+    }
+
+    for ( ; pixels-- ; scr++, tex += incs ) if ( *tex ) *scr = *tex ;
+}
+
+static TARGET_AVX2 void avx2_alpha32( uint32_t * scr, uint32_t * tex, int pixels, int incs )
+{
+    __m256i amask = _mm256_set1_epi32( 0xff000000 ) ;
+    __m256i t, s, a, c ;
+
+    for ( ; pixels >= 8 ; pixels -= 8, scr += 8, tex += 8 * incs )
+    {
+        t = avx2_load32( tex, incs ) ;
+        s = _mm256_loadu_si256(( __m256i * ) scr ) ;
+        a = _mm256_srli_epi32( t, 24 ) ;
+
+        c = avx2_mix( t, s, a, _mm256_sub_epi32( _mm256_set1_epi32( 255 ), a ) ) ;
+        c = _mm256_blendv_epi8( c, _mm256_max_epu8( t, s ), amask ) ;
+        c = _mm256_blendv_epi8( c, t, _mm256_cmpeq_epi32( t, amask ) ) ;
+        c = _mm256_blendv_epi8( c, s, _mm256_cmpeq_epi32( t, _mm256_setzero_si256() ) ) ;
+
+        _mm256_storeu_si256(( __m256i * ) scr, c ) ;
+    }
+
+    for ( ; pixels-- ; scr++, tex += incs ) *scr = px_alpha32( *tex, *scr ) ;
+}
+
+static TARGET_AVX2 void avx2_translucent32( uint32_t * scr, uint32_t * tex, int pixels, int incs, int factor, int factor2 )
+{
+    __m256i amask = _mm256_set1_epi32( 0xff000000 ) ;
+    __m256i t, s, f, f2, c ;
+
+    for ( ; pixels >= 8 ; pixels -= 8, scr += 8, tex += 8 * incs )
+    {
+        t = avx2_load32( tex, incs ) ;
+        s = _mm256_loadu_si256(( __m256i * ) scr ) ;
+        avx2_factors( t, factor, factor2, &f, &f2 ) ;
+
+        c = avx2_mix( t, s, f, f2 ) ;
+        c = _mm256_blendv_epi8( c, _mm256_max_epu8( t, s ), amask ) ;
+        c = _mm256_blendv_epi8( c, s, _mm256_cmpeq_epi32( t, _mm256_setzero_si256() ) ) ;
+
+        _mm256_storeu_si256(( __m256i * ) scr, c ) ;
+    }
+
+    for ( ; pixels-- ; scr++, tex += incs ) *scr = px_translucent32( *tex, *scr, factor, factor2 ) ;
+}
+
+static TARGET_AVX2 void avx2_blend32( uint32_t * scr, uint32_t * tex, int pixels, int incs, int op, int factor, int factor2 )
+{
+    __m256i amask = _mm256_set1_epi32( 0xff000000 ) ;
+    __m256i t, s, a, b, c ;
+
+    for ( ; pixels >= 8 ; pixels -= 8, scr += 8, tex += 8 * incs )
+    {
+        t = avx2_load32( tex, incs ) ;
+        s = _mm256_loadu_si256(( __m256i * ) scr ) ;
+        a = _mm256_srli_epi32( t, 24 ) ;
+        b = avx2_op( t, s, op ) ;
+
+        c = avx2_mix( b, s, a, _mm256_sub_epi32( _mm256_set1_epi32( 255 ), a ) ) ;
+        c = _mm256_blendv_epi8( c, s, amask ) ;
+        c = _mm256_blendv_epi8( c, _mm256_or_si256( b, amask ), _mm256_cmpeq_epi32( t, amask ) ) ;
+        c = _mm256_blendv_epi8( c, s, _mm256_cmpeq_epi32( t, _mm256_setzero_si256() ) ) ;
+
+        _mm256_storeu_si256(( __m256i * ) scr, c ) ;
+    }
+
+    for ( ; pixels-- ; scr++, tex += incs ) *scr = px_blend32( *tex, *scr, op ) ;
+}
+
+static TARGET_AVX2 void avx2_tblend32( uint32_t * scr, uint32_t * tex, int pixels, int incs, int op, int factor, int factor2 )
+{
+    __m256i amask = _mm256_set1_epi32( 0xff000000 ) ;
+    __m256i t, s, f, f2, c ;
+
+    for ( ; pixels >= 8 ; pixels -= 8, scr += 8, tex += 8 * incs )
+    {
+        t = avx2_load32( tex, incs ) ;
+        s = _mm256_loadu_si256(( __m256i * ) scr ) ;
+        avx2_factors( t, factor, factor2, &f, &f2 ) ;
+
+        c = avx2_mix( avx2_op( t, s, op ), s, f, f2 ) ;
+        c = _mm256_blendv_epi8( c, s, amask ) ;
+        c = _mm256_blendv_epi8( c, s, _mm256_cmpeq_epi32( t, _mm256_setzero_si256() ) ) ;
+
+        _mm256_storeu_si256(( __m256i * ) scr, c ) ;
+    }
+
+    for ( ; pixels-- ; scr++, tex += incs ) *scr = px_tblend32( *tex, *scr, op, factor, factor2 ) ;
+}
+
+#endif
+
+/* --------------------------------------------------------------------------- */
+/* NEON                                                                        */
+/* --------------------------------------------------------------------------- */
+
+#ifdef BLIT_SIMD_ARM
+
+static uint32x4_t neon_load32( uint32_t * tex, int incs )
+{
+    uint32x4_t v ;
+
+    if ( incs > 0 ) return vld1q_u32( tex ) ;
+    v = vrev64q_u32( vld1q_u32( tex - 3 ) ) ;
+    return vcombine_u32( vget_high_u32( v ), vget_low_u32( v ) ) ;
+}
+
+static uint32x4_t neon_mix( uint32x4_t c, uint32x4_t s, uint32x4_t f, uint32x4_t f2 )
+{
+    uint8x16_t c8 = vreinterpretq_u8_u32( c ), s8 = vreinterpretq_u8_u32( s ) ;
+    uint16x8x2_t ff, ff2 ;
+    uint16x8_t lo, hi ;
+
+    f  = vorrq_u32( f,  vshlq_n_u32( f,  16 ) ) ;
+    f2 = vorrq_u32( f2, vshlq_n_u32( f2, 16 ) ) ;
+    ff  = vzipq_u16( vreinterpretq_u16_u32( f ),  vreinterpretq_u16_u32( f ) ) ;
+    ff2 = vzipq_u16( vreinterpretq_u16_u32( f2 ), vreinterpretq_u16_u32( f2 ) ) ;
+
+    lo = vmlaq_u16( vmulq_u16( vmovl_u8( vget_low_u8( c8 ) ),  ff.val[0] ), vmovl_u8( vget_low_u8( s8 ) ),  ff2.val[0] ) ;
+    hi = vmlaq_u16( vmulq_u16( vmovl_u8( vget_high_u8( c8 ) ), ff.val[1] ), vmovl_u8( vget_high_u8( s8 ) ), ff2.val[1] ) ;
+
+    return vreinterpretq_u32_u8( vcombine_u8( vshrn_n_u16( lo, 8 ), vshrn_n_u16( hi, 8 ) ) ) ;
+}
+
+static void neon_factors( uint32x4_t t, int factor, int factor2, uint32x4_t * f, uint32x4_t * f2 )
+{
+    uint32x4_t a = vshrq_n_u32( t, 24 ) ;
+    uint32x4_t c255 = vdupq_n_u32( 255 ) ;
+    uint32x4_t opaque = vceqq_u32( a, c255 ) ;
+    uint32x4_t x = vmulq_n_u32( a, factor ) ;
+
+    x = vshrq_n_u32( vaddq_u32( vaddq_u32( x, vdupq_n_u32( 1 ) ), vshrq_n_u32( x, 8 ) ), 8 ) ;
+
+    *f  = vbslq_u32( opaque, vdupq_n_u32( factor ), x ) ;
+    *f2 = vbslq_u32( opaque, vdupq_n_u32( factor2 ), vsubq_u32( c255, x ) ) ;
+}
+
+static uint32x4_t neon_op( uint32x4_t t, uint32x4_t s, int op )
+{
+    uint8x16_t c ;
+
+    if ( op == BLIT_SIMD_SUB )
+        c = vqsubq_u8( vqsubq_u8( vreinterpretq_u8_u32( s ), vmvnq_u8( vreinterpretq_u8_u32( t ) ) ), vdupq_n_u8( 1 ) ) ;
+    else
+        c = vqaddq_u8( vreinterpretq_u8_u32( t ), vreinterpretq_u8_u32( s ) ) ;
+
+    return vandq_u32( vreinterpretq_u32_u8( c ), vdupq_n_u32( 0x00ffffff ) ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static void neon_key16( uint16_t * scr, uint16_t * tex, int pixels, int incs )
+{
+    uint16x8_t t, s ;
+
+    for ( ; pixels >= 8 ; pixels -= 8, scr += 8, tex += 8 * incs )
+    {
+        if ( incs > 0 )
+            t = vld1q_u16( tex ) ;
+        else
+        {
+            t = vrev64q_u16( vld1q_u16( tex - 7 ) ) ;
+            t = vcombine_u16( vget_high_u16( t ), vget_low_u16( t ) ) ;
+        }
+        s = vld1q_u16( scr ) ;
+        vst1q_u16( scr, vbslq_u16( vceqq_u16( t, vdupq_n_u16( 0 ) ), s, t ) ) ;
+    }
+
+    for ( ; pixels-- ; scr++, tex += incs ) if ( *tex ) *scr = *tex ;
+}
+
+static void neon_alpha32( uint32_t * scr, uint32_t * tex, int pixels, int incs )
+{
+    uint32x4_t amask = vdupq_n_u32( 0xff000000 ) ;
+    uint32x4_t t, s, a, c ;
+
+    for ( ; pixels >= 4 ; pixels -= 4, scr += 4, tex += 4 * incs )
+    {
+        t = neon_load32( tex, incs ) ;
+        s = vld1q_u32( scr ) ;
+        a = vshrq_n_u32( t, 24 ) ;
+
+        c = neon_mix( t, s, a, vsubq_u32( vdupq_n_u32( 255 ), a ) ) ;
+        c = vbslq_u32( amask, vreinterpretq_u32_u8( vmaxq_u8( vreinterpretq_u8_u32( t ), vreinterpretq_u8_u32( s ) ) ), c ) ;
+        c = vbslq_u32( vceqq_u32( t, amask ), t, c ) ;
+        c = vbslq_u32( vceqq_u32( t, vdupq_n_u32( 0 ) ), s, c ) ;
+
+        vst1q_u32( scr, c ) ;
+    }
+
+    for ( ; pixels-- ; scr++, tex += incs ) *scr = px_alpha32( *tex, *scr ) ;
+}
+
+static void neon_translucent32( uint32_t * scr, uint32_t * tex, int pixels, int incs, int factor, int factor2 )
+{
+    uint32x4_t amask = vdupq_n_u32( 0xff000000 ) ;
+    uint32x4_t t, s, f, f2, c ;
+
+    for ( ; pixels >= 4 ; pixels -= 4, scr += 4, tex += 4 * incs )
+    {
+        t = neon_load32( tex, incs ) ;
+        s = vld1q_u32( scr ) ;
+        neon_factors( t, factor, factor2, &f, &f2 ) ;
+
+        c = neon_mix( t, s, f, f2 ) ;
+        c = vbslq_u32( amask, vreinterpretq_u32_u8( vmaxq_u8( vreinterpretq_u8_u32( t ), vreinterpretq_u8_u32( s ) ) ), c ) ;
+        c = vbslq_u32( vceqq_u32( t, vdupq_n_u32( 0 ) ), s, c ) ;
+
+        vst1q_u32( scr, c ) ;
+    }
+
+    for ( ; pixels-- ; scr++, tex += incs ) *scr = px_translucent32( *tex, *scr, factor, factor2 ) ;
+}
+
+static void neon_blend32( uint32_t * scr, uint32_t * tex, int pixels, int incs, int op, int factor, int factor2 )
+{
+    uint32x4_t amask = vdupq_n_u32( 0xff000000 ) ;
+    uint32x4_t t, s, a, b, c ;
+
+    for ( ; pixels >= 4 ; pixels -= 4, scr += 4, tex += 4 * incs )
+    {
+        t = neon_load32( tex, incs ) ;
+        s = vld1q_u32( scr ) ;
+        a = vshrq_n_u32( t, 24 ) ;
+        b = neon_op( t, s, op ) ;
+
+        c = neon_mix( b, s, a, vsubq_u32( vdupq_n_u32( 255 ), a ) ) ;
+        c = vbslq_u32( amask, s, c ) ;
+        c = vbslq_u32( vceqq_u32( t, amask ), vorrq_u32( b, amask ), c ) ;
+        c = vbslq_u32( vceqq_u32( t, vdupq_n_u32( 0 ) ), s, c ) ;
+
+        vst1q_u32( scr, c ) ;
+    }
+
+    for ( ; pixels-- ; scr++, tex += incs ) *scr = px_blend32( *tex, *scr, op ) ;
+}
+
+static void neon_tblend32( uint32_t * scr, uint32_t * tex, int pixels, int incs, int op, int factor, int factor2 )
+{
+    uint32x4_t amask = vdupq_n_u32( 0xff000000 ) ;
+    uint32x4_t t, s, f, f2, c ;
+
+    for ( ; pixels >= 4 ; pixels -= 4, scr += 4, tex += 4 * incs )
+    {
+        t = neon_load32( tex, incs ) ;
+        s = vld1q_u32( scr ) ;
+        neon_factors( t, factor, factor2, &f, &f2 ) ;
+
+        c = neon_mix( neon_op( t, s, op ), s, f, f2 ) ;
+        c = vbslq_u32( amask, s, c ) ;
+        c = vbslq_u32( vceqq_u32( t, vdupq_n_u32( 0 ) ), s, c ) ;
+
+        vst1q_u32( scr, c ) ;
+    }
+
+    for ( ; pixels-- ; scr++, tex += incs ) *scr = px_tblend32( *tex, *scr, op, factor, factor2 ) ;
+}
+
+#endif
+
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : gr_blit_simd_set
+ *
+ *  Select the instruction set used by the blitter spans
+ *
+ *  PARAMS :
+ *      level           BLIT_SIMD_AUTO for the best one the CPU supports,
+ *                      BLIT_SIMD_NONE for the C spans, or a BLIT_SIMD_XXX
+ *
+ *  RETURN VALUE :
+ *      The level in use; BLIT_SIMD_NONE if the requested one isn't
+ *      supported by this CPU or build
+ *
+ */
+
+int gr_blit_simd_set( int level )
+{
+    int best = BLIT_SIMD_NONE ;
+
+#if defined( BLIT_SIMD_X86 )
+    if ( SDL_HasSSE2() ) best = BLIT_SIMD_SSE2 ;
+    if ( SDL_HasAVX2() ) best = BLIT_SIMD_AVX2 ;
+#elif defined( BLIT_SIMD_ARM )
+    best = BLIT_SIMD_NEON ;
+#endif
+
+    if ( level == BLIT_SIMD_AUTO ) level = best ;
+
+    memset( &blit_simd, 0, sizeof( blit_simd ) ) ;
+
+    switch ( level )
+    {
+#if defined( BLIT_SIMD_X86 )
+        case BLIT_SIMD_SSE2:
+            if ( best < BLIT_SIMD_SSE2 ) break ;
+            blit_simd.level         = BLIT_SIMD_SSE2 ;
+            blit_simd.key16         = sse2_key16 ;
+            blit_simd.alpha32       = sse2_alpha32 ;
+            blit_simd.translucent32 = sse2_translucent32 ;
+            blit_simd.blend32       = sse2_blend32 ;
+            blit_simd.tblend32      = sse2_tblend32 ;
+            break ;
+
+        case BLIT_SIMD_AVX2:
+            if ( best < BLIT_SIMD_AVX2 ) break ;
+            blit_simd.level         = BLIT_SIMD_AVX2 ;
+            blit_simd.key16         = avx2_key16 ;
+            blit_simd.alpha32       = avx2_alpha32 ;
+            blit_simd.translucent32 = avx2_translucent32 ;
+            blit_simd.blend32       = avx2_blend32 ;
+            blit_simd.tblend32      = avx2_tblend32 ;
+            break ;
+#elif defined( BLIT_SIMD_ARM )
+        case BLIT_SIMD_NEON:
+            blit_simd.level         = BLIT_SIMD_NEON ;
+            blit_simd.key16         = neon_key16 ;
+            blit_simd.alpha32       = neon_alpha32 ;
+            blit_simd.translucent32 = neon_translucent32 ;
+            blit_simd.blend32       = neon_blend32 ;
+            blit_simd.tblend32      = neon_tblend32 ;
+            break ;
+#endif
+    }
+
+    return blit_simd.level ;
+}
+
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : gr_blit_simd_level
+ *
+ *  Return the instruction set used by the blitter spans, detecting
+ *  the best one the first time
+ *
+ *  PARAMS :
+ *      None
+ *
+ *  RETURN VALUE :
+ *      A BLIT_SIMD_XXX value
+ *
+ */
+
+int gr_blit_simd_level( void )
+{
+    if ( blit_simd.level == BLIT_SIMD_AUTO ) gr_blit_simd_set( BLIT_SIMD_AUTO ) ;
+    return blit_simd.level ;
+}
+
+/* --------------------------------------------------------------------------- */
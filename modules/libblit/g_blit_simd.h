@@ -0,0 +1,81 @@
+/*
+ *  Copyright (C) 2014-2015 Joseba García Etxebarria <joseba.gar@gmail.com>
+ *  Copyright (C) 2006-2012 SplinterGU (Fenix/Bennugd)
+ *  Copyright (C) 2002-2006 Fenix Team (Fenix)
+ *  Copyright (C) 1999-2002 José Luis Cebrián Pagüe (Fenix)
+ *
+ *  This file is part of PixTudio
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty. In no event will the authors be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *     1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *
+ *     2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ *
+ */
+
+#ifndef __BLIT_SIMD_H
+#define __BLIT_SIMD_H
+
+/* --------------------------------------------------------------------------- */
+
+#include <stdint.h>
+
+/* --------------------------------------------------------------------------- */
+/* Instruction sets the span kernels can use                                   */
+
+#define BLIT_SIMD_AUTO      -1
+#define BLIT_SIMD_NONE      0
+#define BLIT_SIMD_SSE2      1
+#define BLIT_SIMD_AVX2      2
+#define BLIT_SIMD_NEON      3
+
+/* Blend operations for the blend32 / tblend32 kernels */
+
+#define BLIT_SIMD_ADD       0
+#define BLIT_SIMD_SUB       1
+
+/* --------------------------------------------------------------------------- */
+
+/* All the kernels draw a single row, reading the texture forward (incs = 1)
+   or backwards (incs = -1). The results are the same of the C spans. */
+
+typedef void ( BLIT_SPAN16 )( uint16_t * scr, uint16_t * tex, int pixels, int incs ) ;
+typedef void ( BLIT_SPAN32 )( uint32_t * scr, uint32_t * tex, int pixels, int incs ) ;
+typedef void ( BLIT_SPAN32_F )( uint32_t * scr, uint32_t * tex, int pixels, int incs, int factor, int factor2 ) ;
+typedef void ( BLIT_SPAN32_OP )( uint32_t * scr, uint32_t * tex, int pixels, int incs, int op, int factor, int factor2 ) ;
+
+typedef struct
+{
+    int              level ;            /* BLIT_SIMD_XXX in use */
+    BLIT_SPAN16    * key16 ;            /* Colorkey copy */
+    BLIT_SPAN32    * alpha32 ;          /* Colorkey copy with per pixel alpha */
+    BLIT_SPAN32_F  * translucent32 ;    /* Alpha blend with a global factor */
+    BLIT_SPAN32_OP * blend32 ;          /* Additive/substractive blend */
+    BLIT_SPAN32_OP * tblend32 ;         /* Additive/substractive blend with a global factor */
+}
+BLIT_SIMD_KERNELS ;
+
+/* --------------------------------------------------------------------------- */
+
+extern BLIT_SIMD_KERNELS blit_simd ;
+
+extern int gr_blit_simd_set( int level ) ;
+extern int gr_blit_simd_level( void ) ;
+
+/* --------------------------------------------------------------------------- */
+
+#endif
@@ -62,6 +62,8 @@ int gr_get_pixel( GRAPH * dest, int x, int y )
 {
     if ( x < 0 || y < 0 || x >= ( int ) dest->width || y >= ( int ) dest->height ) return -1 ;
 
+    bitmap_sync_data( dest ) ;
+
     switch ( dest->format->depth )
     {
         case 1:
@@ -100,6 +102,8 @@ void gr_put_pixel( GRAPH * dest, int x, int y, int color, int update_texture )
 {
     if ( x < 0 || y < 0 || x >= ( int ) dest->width || y >= ( int ) dest->height ) return ;
 
+    bitmap_sync_data( dest ) ;
+
     switch ( dest->format->depth )
     {
         case 1:
@@ -173,8 +177,10 @@ void gr_put_pixel( GRAPH * dest, int x, int y, int color, int update_texture )
         dest->info_flags &= ~GI_NOCOLORKEY;
     }
 
-    if(update_texture) {
-        bitmap_update_texture(dest);
+    {
+        REGION region = { x, y, x, y } ;
+        if ( update_texture ) bitmap_mark_dirty( dest, &region ) ;
+        bitmap_changed( dest, &region ) ;
     }
 }
 
@@ -50,6 +50,13 @@ DLCONSTANT __bgdexport( libblit, constants_def )[] =
     { "B_SBLEND"            , TYPE_DWORD, B_SBLEND      },
     { "B_NOCOLORKEY"        , TYPE_DWORD, B_NOCOLORKEY  },
 
+    /* Instruction sets for blit_simd() */
+    { "BLIT_SIMD_AUTO"      , TYPE_INT  , BLIT_SIMD_AUTO },
+    { "BLIT_SIMD_NONE"      , TYPE_INT  , BLIT_SIMD_NONE },
+    { "BLIT_SIMD_SSE2"      , TYPE_INT  , BLIT_SIMD_SSE2 },
+    { "BLIT_SIMD_AVX2"      , TYPE_INT  , BLIT_SIMD_AVX2 },
+    { "BLIT_SIMD_NEON"      , TYPE_INT  , BLIT_SIMD_NEON },
+
     { NULL                  , 0         ,  0            }
 } ;
 
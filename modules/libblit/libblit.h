@@ -33,6 +33,8 @@
 #include "libgrbase.h"
 
 #include "g_blit.h"
+#include "g_blit_simd.h"
 #include "g_pixel.h"
+#include "g_batch.h"
 
 #endif
@@ -42,6 +42,12 @@
 #define B_SBLEND        0x0020
 #define B_NOCOLORKEY    0x0080
 
+#define BLIT_SIMD_AUTO  -1
+#define BLIT_SIMD_NONE  0
+#define BLIT_SIMD_SSE2  1
+#define BLIT_SIMD_AVX2  2
+#define BLIT_SIMD_NEON  3
+
 DLCONSTANT __bgdexport( libblit, constants_def )[] =
 {
     /* Flags para gr_blit */
@@ -53,6 +59,13 @@ DLCONSTANT __bgdexport( libblit, constants_def )[] =
     { "B_SBLEND"            , TYPE_DWORD, B_SBLEND      },
     { "B_NOCOLORKEY"        , TYPE_DWORD, B_NOCOLORKEY  },
 
+    /* Instruction sets for blit_simd() */
+    { "BLIT_SIMD_AUTO"      , TYPE_INT  , BLIT_SIMD_AUTO },
+    { "BLIT_SIMD_NONE"      , TYPE_INT  , BLIT_SIMD_NONE },
+    { "BLIT_SIMD_SSE2"      , TYPE_INT  , BLIT_SIMD_SSE2 },
+    { "BLIT_SIMD_AVX2"      , TYPE_INT  , BLIT_SIMD_AVX2 },
+    { "BLIT_SIMD_NEON"      , TYPE_INT  , BLIT_SIMD_NEON },
+
     { NULL                  , 0         ,  0            }
 } ;
 #else
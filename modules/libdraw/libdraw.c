@@ -45,6 +45,44 @@
 
 uint32_t drawing_stipple = 0xFFFFFFFF;
 
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : draw_mark_dirty
+ *
+ *  Queue the texture upload of the area touched by a primitive
+ *
+ *  PARAMS :
+ *      dest            Destination bitmap or NULL for screen
+ *      clip            Clipping region or NULL for the whole screen
+ *      x, y, x2, y2    Bounding box of the primitive, in any order
+ *
+ *  RETURN VALUE :
+ *      None
+ *
+ */
+
+static void draw_mark_dirty( GRAPH * dest, REGION * clip, int x, int y, int x2, int y2 )
+{
+    REGION region ;
+
+    if ( !dest ) dest = scrbitmap ;
+
+    region.x  = MIN( x, x2 ) ;
+    region.y  = MIN( y, y2 ) ;
+    region.x2 = MAX( x, x2 ) ;
+    region.y2 = MAX( y, y2 ) ;
+
+    if ( clip )
+    {
+        region.x  = MAX( region.x,  MIN( clip->x, clip->x2 ) ) ;
+        region.y  = MAX( region.y,  MIN( clip->y, clip->y2 ) ) ;
+        region.x2 = MIN( region.x2, MAX( clip->x, clip->x2 ) ) ;
+        region.y2 = MIN( region.y2, MAX( clip->y, clip->y2 ) ) ;
+    }
+
+    bitmap_mark_dirty( dest, &region ) ;
+}
+
 /* --------------------------------------------------------------------------- */
 
 #ifdef __GNUC__
@@ -288,6 +326,8 @@ void draw_vline(GRAPH * dest, REGION * clip, int x, int y, int h , int update_te
     int old_stipple = drawing_stipple;
 
     if ( !dest ) dest = scrbitmap ;
+    bitmap_sync_data( dest ) ;
+    if ( update_texture ) draw_mark_dirty( dest, clip, x, y, x, y + h ) ;
     if ( !clip )
     {
         clip = &base_clip ;
@@ -547,9 +587,6 @@ void draw_vline(GRAPH * dest, REGION * clip, int x, int y, int h , int update_te
 
     drawing_stipple = old_stipple;
 
-    if(update_texture) {
-        bitmap_update_texture(dest);
-    }
 }
 
 /* --------------------------------------------------------------------------- */
@@ -575,6 +612,8 @@ void draw_hline( GRAPH * dest, REGION * clip, int x, int y, int w, int update_te
     int old_stipple = drawing_stipple;
 
     if ( !dest ) dest = scrbitmap ;
+    bitmap_sync_data( dest ) ;
+    if ( update_texture ) draw_mark_dirty( dest, clip, x, y, x + w, y ) ;
     if ( !clip )
     {
         clip = &base_clip ;
@@ -687,9 +726,6 @@ void draw_hline( GRAPH * dest, REGION * clip, int x, int y, int w, int update_te
 
     drawing_stipple = old_stipple;
 
-    if(update_texture) {
-        bitmap_update_texture(dest);
-    }
 }
 
 /* --------------------------------------------------------------------------- */
@@ -715,6 +751,8 @@ void draw_box( GRAPH * dest, REGION * clip, int x, int y, int w, int h )
     REGION base_clip ;
 
     if ( !dest ) dest = scrbitmap ;
+    bitmap_sync_data( dest ) ;
+    draw_mark_dirty( dest, clip, x, y, x + w, y + h ) ;
 
     if ( !clip )
     {
@@ -799,8 +837,6 @@ void draw_box( GRAPH * dest, REGION * clip, int x, int y, int w, int h )
         }
         break;
     }
-
-    bitmap_update_texture(dest);
 }
 
 /* --------------------------------------------------------------------------- */
@@ -836,7 +872,7 @@ void draw_rectangle( GRAPH * dest, REGION * clip, int x, int y, int w, int h )
 
     drawing_stipple = stipple ;
 
-    bitmap_update_texture(dest);
+    draw_mark_dirty( dest, clip, x, y, x + w, y + h ) ;
 }
 
 /* --------------------------------------------------------------------------- */
@@ -867,6 +903,7 @@ void draw_circle( GRAPH * dest, REGION * clip, int x, int y, int r )
     if ( !dest ) {
         dest = scrbitmap ;
     }
+    bitmap_sync_data( dest ) ;
 
     if ( !clip ) {
         clip = &base_clip ;
@@ -926,7 +963,7 @@ void draw_circle( GRAPH * dest, REGION * clip, int x, int y, int r )
 
     drawing_stipple = old_stipple;
 
-    bitmap_update_texture(dest);
+    draw_mark_dirty( dest, clip, x - r, y - r, x + r, y + r ) ;
 }
 
 /* --------------------------------------------------------------------------- */
@@ -971,7 +1008,7 @@ void draw_fcircle( GRAPH * dest, REGION * clip, int x, int y, int r ) {
 
     drawing_stipple = old_stipple;
 
-    bitmap_update_texture(dest);
+    draw_mark_dirty( dest, clip, x - r, y - r, x + r, y + r ) ;
 }
 
 /* --------------------------------------------------------------------------- */
@@ -1012,6 +1049,8 @@ void draw_line( GRAPH * dest, REGION * clip, int x, int y, int w, int h, int upd
     }
 
     if ( !dest ) dest = scrbitmap ;
+    bitmap_sync_data( dest ) ;
+    if ( update_texture ) draw_mark_dirty( dest, clip, x, y, x + w, y + h ) ;
     if ( !clip )
     {
         clip = &base_clip ;
@@ -1552,9 +1591,6 @@ void draw_line( GRAPH * dest, REGION * clip, int x, int y, int w, int h, int upd
 
     drawing_stipple = old_stipple;
 
-    if(update_texture) {
-        bitmap_update_texture(dest);
-    }
 }
 
 /* --------------------------------------------------------------------------- */
@@ -1636,7 +1672,9 @@ void draw_bezier( GRAPH * dest, REGION * clip, int x1, int y1, int x2, int y2, i
         yp = y;
     }
 
-    bitmap_update_texture(dest);
+    /* The curve lies inside the hull of its control points */
+    draw_mark_dirty( dest, clip, MIN( MIN( x1, x2 ), MIN( x3, x4 ) ), MIN( MIN( y1, y2 ), MIN( y3, y4 ) ),
+                                 MAX( MAX( x1, x2 ), MAX( x3, x4 ) ), MAX( MAX( y1, y2 ), MAX( y3, y4 ) ) ) ;
 }
 
 /* --------------------------------------------------------------------------- */
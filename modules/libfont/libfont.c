@@ -44,6 +44,8 @@
 FONT * fonts[MAX_FONTS] = { 0 } ;
 int    font_count = 0 ;  /* Fuente 0 reservada para sistema */
 
+static int font_serial = 0 ;
+
 unsigned char default_font[256*8] =
 {
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
@@ -343,6 +345,7 @@ int gr_font_new( int charset, uint32_t bpp )
     f->bpp = bpp; // 8
     f->maxwidth = 0;
     f->maxheight = 0;
+    f->serial = ++font_serial;
 
     fonts[font_count] = f ;
     return font_count++ ;
@@ -693,12 +696,76 @@ void gr_font_destroy( int fontid )
             if ( fonts[fontid]->glyph[n].bitmap )
                 bitmap_destroy( fonts[fontid]->glyph[n].bitmap ) ;
 
+        atlas_destroy( fonts[fontid]->atlas ) ;
         free( fonts[fontid] ) ;
         fonts[fontid] = NULL ;
         while ( font_count > 0 && fonts[font_count-1] == 0 ) font_count-- ;
     }
 }
 
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : gr_font_changed
+ *
+ *  Tell the font its glyphs were replaced, so they are packed again
+ *  and the texts using it are laid out again
+ *
+ *  PARAMS :
+ *  fontid  ID of the font
+ *
+ *  RETURN VALUE :
+ *      None
+ *
+ */
+
+void gr_font_changed( int fontid )
+{
+    FONT * f = gr_font_get( fontid ) ;
+
+    if ( !f ) return ;
+
+    f->packed = 0 ;
+    f->serial = ++font_serial ;
+}
+
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : gr_font_pack
+ *
+ *  Put the 16 and 32 bits glyphs of a font in a shared texture, so a
+ *  text is drawn with a single texture, and find the font height if it
+ *  is still unknown. Called before drawing, once the renderer exists.
+ *
+ *  PARAMS :
+ *  f       Pointer to the font
+ *
+ *  RETURN VALUE :
+ *      None
+ *
+ */
+
+void gr_font_pack( FONT * f )
+{
+    GRAPH * maps[256] ;
+    int c ;
+
+    if ( !f || f->packed ) return ;
+
+    f->packed = 1 ;
+
+    for ( c = 0 ; c < 256 ; c++ )
+    {
+        maps[c] = f->glyph[c].bitmap ;
+        if ( !maps[c] ) continue ;
+        if ( f->maxheight < ( int )maps[c]->height + f->glyph[c].yoffset )
+            f->maxheight = ( int )maps[c]->height + f->glyph[c].yoffset ;
+    }
+
+    /* The atlas leaves alone the glyphs it can't take */
+    if ( !f->atlas && !( f->atlas = atlas_new() ) ) return ;
+    atlas_repack( f->atlas, maps, 256 ) ;
+}
+
 /* --------------------------------------------------------------------------- */
 /*
  *  FUNCTION : gr_font_get
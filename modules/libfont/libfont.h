@@ -65,6 +65,10 @@ typedef struct _font
 
     int         maxheight;
     int         maxwidth;
+
+    ATLAS *     atlas;      /* Shared texture of the glyphs */
+    int         packed;     /* Glyphs are in the atlas, if they can be */
+    int         serial;     /* Changes each time the glyphs do */
 }
 FONT ;
 
@@ -84,6 +88,8 @@ extern FONT * gr_font_get( int id );
 extern int gr_font_new( int charset, uint32_t bpp ) ;
 extern int gr_font_newfrombitmap( GRAPH * map, int charset, int width, int height, int first, int last, int options ) ;
 extern int gr_font_systemfont( char * chardata ) ;
+extern void gr_font_changed( int fontid ) ;
+extern void gr_font_pack( FONT * f ) ;
 
 /* -------------------------------------------------------------------------- */
 
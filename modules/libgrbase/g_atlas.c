@@ -0,0 +1,463 @@
+/*
+ *  Copyright (C) 2014-2015 Joseba García Etxebarria <joseba.gar@gmail.com>
+ *  Copyright (C) 2006-2012 SplinterGU (Fenix/Bennugd)
+ *  Copyright (C) 2002-2006 Fenix Team (Fenix)
+ *  Copyright (C) 1999-2002 José Luis Cebrián Pagüe (Fenix)
+ *
+ *  This file is part of PixTudio
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty. In no event will the authors be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *     1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *
+ *     2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ *
+ */
+
+/* --------------------------------------------------------------------------- */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "libgrbase.h"
+#include "g_video.h"
+
+#include <SDL_render.h>
+#include <SDL_log.h>
+
+/* --------------------------------------------------------------------------- */
+
+/* Maps of a library can share a few big textures (pages) instead of
+ * having one each. A packed map keeps its pixels in map->data, as usual,
+ * and its texture field points to the page, with map->atlas_rect being
+ * the part of the page it uses. Pages are filled with a shelf packer;
+ * the space of a released map is only recovered when its page is
+ * empty, or when the library repacks it.
+ */
+
+/* --------------------------------------------------------------------------- */
+
+static Uint32 atlas_format( GRAPH * map )
+{
+    return ( map->format->depth == 16 ) ? SDL_PIXELFORMAT_RGB565 : SDL_PIXELFORMAT_ARGB8888 ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static int atlas_own_texture( GRAPH * map )
+{
+    map->texture = SDL_CreateTexture( renderer, atlas_format( map ), SDL_TEXTUREACCESS_STATIC, map->width, map->height ) ;
+    if ( !map->texture )
+    {
+        SDL_Log( "atlas_own_texture: Could not create GRAPH texture (%s)", SDL_GetError() ) ;
+        return 0 ;
+    }
+
+    bitmap_update_texture( map ) ;
+    return 1 ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static int atlas_compare_height( const void * a, const void * b )
+{
+    const GRAPH * ma = *( const GRAPH ** ) a, * mb = *( const GRAPH ** ) b ;
+
+    if ( ma->height != mb->height ) return ma->height > mb->height ? -1 : 1 ;
+    return ma->width > mb->width ? -1 : ( ma->width < mb->width ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Static textures start undefined. The padding around each map is never
+ * written, so the page is cleared once, band by band, to keep filtering
+ * from bleeding garbage into the edges of the maps */
+
+static int atlas_clear_page( ATLAS_PAGE * page )
+{
+    SDL_Rect rect ;
+    void * zeros ;
+    int rows = 64 ;
+
+    zeros = calloc( rows, page->width * 4 ) ;
+    if ( !zeros ) return 0 ;
+
+    rect.x = 0 ;
+    rect.w = page->width ;
+
+    for ( rect.y = 0 ; rect.y < page->height ; rect.y += rows )
+    {
+        rect.h = MIN( rows, page->height - rect.y ) ;
+        if ( SDL_UpdateTexture( page->texture, &rect, zeros, page->width * SDL_BYTESPERPIXEL( page->format ) ) < 0 )
+        {
+            SDL_Log( "atlas_clear_page: Error updating texture: %s", SDL_GetError() ) ;
+            free( zeros ) ;
+            return 0 ;
+        }
+    }
+
+    free( zeros ) ;
+    return 1 ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* ATLAS_PAGE_SIZE, or the renderer limit if lower */
+
+static void atlas_page_size( int * width, int * height )
+{
+    *width = ATLAS_PAGE_SIZE ;
+    *height = ATLAS_PAGE_SIZE ;
+    if ( renderer_info.max_texture_width && *width > renderer_info.max_texture_width ) *width = renderer_info.max_texture_width ;
+    if ( renderer_info.max_texture_height && *height > renderer_info.max_texture_height ) *height = renderer_info.max_texture_height ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static ATLAS_PAGE * atlas_new_page( ATLAS * atlas, Uint32 format )
+{
+    ATLAS_PAGE * page ;
+
+    page = ( ATLAS_PAGE * ) malloc( sizeof( ATLAS_PAGE ) ) ;
+    if ( !page ) return NULL ;
+
+    atlas_page_size( &page->width, &page->height ) ;
+
+    page->texture = SDL_CreateTexture( renderer, format, SDL_TEXTUREACCESS_STATIC, page->width, page->height ) ;
+    if ( !page->texture )
+    {
+        SDL_Log( "atlas_new_page: Could not create atlas texture (%s)", SDL_GetError() ) ;
+        free( page ) ;
+        return NULL ;
+    }
+
+    page->format = format ;
+    if ( !atlas_clear_page( page ) )
+    {
+        SDL_DestroyTexture( page->texture ) ;
+        free( page ) ;
+        return NULL ;
+    }
+
+    page->shelf_x = 0 ;
+    page->shelf_y = 0 ;
+    page->shelf_h = 0 ;
+    page->maps = 0 ;
+    page->used = 0 ;
+    page->released = 0 ;
+
+    page->atlas = atlas ;
+    page->next = atlas->pages ;
+    atlas->pages = page ;
+    atlas->npages++ ;
+
+    return page ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static void atlas_free_page( ATLAS_PAGE * page )
+{
+    ATLAS_PAGE ** p ;
+
+    for ( p = &page->atlas->pages ; *p ; p = &( *p )->next )
+    {
+        if ( *p == page )
+        {
+            *p = page->next ;
+            break ;
+        }
+    }
+    page->atlas->npages-- ;
+
+    SDL_DestroyTexture( page->texture ) ;
+    free( page ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static int atlas_page_fit( ATLAS_PAGE * page, int w, int h, SDL_Rect * rect )
+{
+    /* Next shelf if this one is full */
+    if ( page->shelf_x + w > page->width )
+    {
+        page->shelf_y += page->shelf_h ;
+        page->shelf_x = 0 ;
+        page->shelf_h = 0 ;
+    }
+
+    if ( page->shelf_y + h > page->height || w > page->width ) return 0 ;
+
+    rect->x = page->shelf_x + ATLAS_PADDING ;
+    rect->y = page->shelf_y + ATLAS_PADDING ;
+
+    page->shelf_x += w ;
+    if ( h > page->shelf_h ) page->shelf_h = h ;
+
+    return 1 ;
+}
+
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : atlas_new
+ *
+ *  Create an empty atlas
+ *
+ *  PARAMS :
+ *      None
+ *
+ *  RETURN VALUE :
+ *      Pointer to the new atlas, or NULL if not enough memory
+ *
+ */
+
+ATLAS * atlas_new()
+{
+    ATLAS * atlas = ( ATLAS * ) malloc( sizeof( ATLAS ) ) ;
+    if ( !atlas ) return NULL ;
+
+    atlas->pages = NULL ;
+    atlas->npages = 0 ;
+
+    return atlas ;
+}
+
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : atlas_destroy
+ *
+ *  Free an atlas. Its maps must have been unpacked or destroyed first
+ *
+ *  PARAMS :
+ *      atlas           Pointer to the atlas
+ *
+ *  RETURN VALUE :
+ *      None
+ *
+ */
+
+void atlas_destroy( ATLAS * atlas )
+{
+    if ( !atlas ) return ;
+
+    while ( atlas->pages ) atlas_free_page( atlas->pages ) ;
+    free( atlas ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : atlas_add_map
+ *
+ *  Move the texture of a map to the atlas. Only 16 and 32 bits maps,
+ *  not split in pieces and up to half a page are packed
+ *
+ *  PARAMS :
+ *      atlas           Pointer to the atlas
+ *      map             Pointer to the map
+ *
+ *  RETURN VALUE :
+ *      1 if the map was packed, 0 otherwise
+ *
+ */
+
+int atlas_add_map( ATLAS * atlas, GRAPH * map )
+{
+    ATLAS_PAGE * page ;
+    SDL_Rect rect ;
+    Uint32 format ;
+    int w, h, page_w, page_h ;
+
+    if ( !atlas || !renderer || map->atlas_page || map->next_piece || !map->data ) return 0 ;
+    if ( map->info_flags & ( GI_EXTERNAL_DATA | GI_TARGET ) ) return 0 ;
+    if ( map->format->depth != 16 && map->format->depth != 32 ) return 0 ;
+
+    w = map->width + ATLAS_PADDING * 2 ;
+    h = map->height + ATLAS_PADDING * 2 ;
+    atlas_page_size( &page_w, &page_h ) ;
+    if ( w > page_w / 2 || h > page_h / 2 ) return 0 ;
+
+    format = atlas_format( map ) ;
+
+    for ( page = atlas->pages ; page ; page = page->next )
+        if ( page->format == format && atlas_page_fit( page, w, h, &rect ) ) break ;
+
+    if ( !page )
+    {
+        page = atlas_new_page( atlas, format ) ;
+        if ( !page || !atlas_page_fit( page, w, h, &rect ) ) return 0 ;
+    }
+
+    rect.w = map->width ;
+    rect.h = map->height ;
+
+    if ( SDL_UpdateTexture( page->texture, &rect, map->data, map->pitch ) < 0 )
+    {
+        SDL_Log( "atlas_add_map: Error updating texture: %s", SDL_GetError() ) ;
+        return 0 ;
+    }
+
+    if ( map->texture ) SDL_DestroyTexture( map->texture ) ;
+    map->texture = page->texture ;
+    map->atlas_page = page ;
+    map->atlas_rect = rect ;
+
+    page->maps++ ;
+    page->used += w * h ;
+
+    return 1 ;
+}
+
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : atlas_release_map
+ *
+ *  Take a map out of its page, leaving it without texture. The page
+ *  is freed when no map uses it
+ *
+ *  PARAMS :
+ *      map             Pointer to the map
+ *
+ *  RETURN VALUE :
+ *      None
+ *
+ */
+
+void atlas_release_map( GRAPH * map )
+{
+    ATLAS_PAGE * page = map->atlas_page ;
+
+    if ( !page ) return ;
+
+    map->atlas_page = NULL ;
+    map->texture = NULL ;
+
+    page->used -= ( map->width + ATLAS_PADDING * 2 ) * ( map->height + ATLAS_PADDING * 2 ) ;
+    page->released += ( map->width + ATLAS_PADDING * 2 ) * ( map->height + ATLAS_PADDING * 2 ) ;
+    if ( !--page->maps ) atlas_free_page( page ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : atlas_unpack_map
+ *
+ *  Give a packed map a texture of its own again
+ *
+ *  PARAMS :
+ *      map             Pointer to the map
+ *
+ *  RETURN VALUE :
+ *      1 if the map has its own texture, 0 if error
+ *
+ */
+
+int atlas_unpack_map( GRAPH * map )
+{
+    if ( !map->atlas_page ) return 1 ;
+
+    atlas_release_map( map ) ;
+    return atlas_own_texture( map ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : atlas_repack
+ *
+ *  Pack again a set of maps from scratch, tallest first, freeing all
+ *  the old pages of the atlas. Maps that don't fit get their own texture
+ *
+ *  PARAMS :
+ *      atlas           Pointer to the atlas
+ *      maps            Array of maps (NULL entries are skipped)
+ *      count           Number of entries in the array
+ *
+ *  RETURN VALUE :
+ *      Number of pages used
+ *
+ */
+
+int atlas_repack( ATLAS * atlas, GRAPH ** maps, int count )
+{
+    GRAPH ** sorted ;
+    int n, nsorted = 0 ;
+
+    if ( !atlas ) return 0 ;
+
+    sorted = ( GRAPH ** ) malloc( sizeof( GRAPH * ) * ( count + 1 ) ) ;
+    if ( !sorted ) return atlas->npages ;
+
+    for ( n = 0 ; n < count ; n++ )
+    {
+        if ( !maps[ n ] ) continue ;
+
+        /* Forget the old place, the pages go away below */
+        if ( maps[ n ]->atlas_page && maps[ n ]->atlas_page->atlas == atlas )
+        {
+            maps[ n ]->atlas_page = NULL ;
+            maps[ n ]->texture = NULL ;
+        }
+        sorted[ nsorted++ ] = maps[ n ] ;
+    }
+
+    while ( atlas->pages ) atlas_free_page( atlas->pages ) ;
+
+    qsort( sorted, nsorted, sizeof( GRAPH * ), atlas_compare_height ) ;
+
+    for ( n = 0 ; n < nsorted ; n++ )
+    {
+        if ( atlas_add_map( atlas, sorted[ n ] ) ) continue ;
+
+        /* Was packed and doesn't fit now */
+        if ( !sorted[ n ]->texture && !sorted[ n ]->atlas_page &&
+             ( sorted[ n ]->format->depth == 16 || sorted[ n ]->format->depth == 32 ) ) atlas_own_texture( sorted[ n ] ) ;
+    }
+
+    free( sorted ) ;
+
+    return atlas->npages ;
+}
+
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : atlas_waste
+ *
+ *  Percentage of the packed area that belongs to released maps, and
+ *  can't be used again until the atlas is repacked
+ *
+ *  PARAMS :
+ *      atlas           Pointer to the atlas
+ *
+ *  RETURN VALUE :
+ *      0 to 100
+ *
+ */
+
+int atlas_waste( ATLAS * atlas )
+{
+    ATLAS_PAGE * page ;
+    double used = 0, released = 0 ;
+
+    if ( !atlas ) return 0 ;
+
+    for ( page = atlas->pages ; page ; page = page->next )
+    {
+        used += page->used ;
+        released += page->released ;
+    }
+
+    return ( used + released ) > 0 ? ( int )( released * 100 / ( used + released ) ) : 0 ;
+}
+
+/* --------------------------------------------------------------------------- */
@@ -0,0 +1,83 @@
+/*
+ *  Copyright (C) 2014-2015 Joseba García Etxebarria <joseba.gar@gmail.com>
+ *  Copyright (C) 2006-2012 SplinterGU (Fenix/Bennugd)
+ *  Copyright (C) 2002-2006 Fenix Team (Fenix)
+ *  Copyright (C) 1999-2002 José Luis Cebrián Pagüe (Fenix)
+ *
+ *  This file is part of PixTudio
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty. In no event will the authors be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *     1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *
+ *     2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ *
+ */
+
+#ifndef __ATLAS_H
+#define __ATLAS_H
+
+/* --------------------------------------------------------------------------- */
+
+#include <SDL_render.h>
+
+/* --------------------------------------------------------------------------- */
+
+#define ATLAS_PAGE_SIZE     2048    /* Or the renderer limit, if lower */
+#define ATLAS_PADDING       1       /* Free pixels around each map */
+
+/* --------------------------------------------------------------------------- */
+
+typedef struct _atlas_page
+{
+    SDL_Texture * texture ;
+    Uint32 format ;
+    int width ;
+    int height ;
+
+    int shelf_x ;                   /* Free position in the current shelf */
+    int shelf_y ;
+    int shelf_h ;
+
+    int maps ;                      /* Maps using the page */
+    int used ;                      /* Area of those maps */
+    int released ;                  /* Area of maps gone since the page was created */
+
+    struct _atlas * atlas ;
+    struct _atlas_page * next ;
+}
+ATLAS_PAGE ;
+
+typedef struct _atlas
+{
+    ATLAS_PAGE * pages ;
+    int npages ;
+}
+ATLAS ;
+
+/* --------------------------------------------------------------------------- */
+
+extern ATLAS * atlas_new() ;
+extern void atlas_destroy( ATLAS * atlas ) ;
+extern int atlas_add_map( ATLAS * atlas, GRAPH * map ) ;
+extern int atlas_unpack_map( GRAPH * map ) ;
+extern int atlas_repack( ATLAS * atlas, GRAPH ** maps, int count ) ;
+extern void atlas_release_map( GRAPH * map ) ;
+extern int atlas_waste( ATLAS * atlas ) ;
+
+/* --------------------------------------------------------------------------- */
+
+#endif
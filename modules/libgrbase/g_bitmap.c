@@ -38,6 +38,7 @@
 #include "g_blit.h"
 
 #include <SDL_render.h>
+#include <SDL_atomic.h>
 
 /* --------------------------------------------------------------------------- */
 
@@ -139,6 +140,9 @@ GRAPH * bitmap_new_ex( int code, int w, int h, int depth, void * data, int pitch
     gr->data = data ;
     gr->texture = NULL ;
     gr->next_piece = NULL ;
+    gr->atlas_page = NULL ;
+    gr->dirty_queued = 0 ;
+    gr->texture_queued = 0 ;
 
     // Create associated textures only for graphs with bpp >= 16
     if( depth == 16 || depth == 32 ) {
@@ -187,40 +191,15 @@ GRAPH * bitmap_new_ex( int code, int w, int h, int depth, void * data, int pitch
 
 /* --------------------------------------------------------------------------- */
 
-GRAPH * bitmap_new( int code, int w, int h, int depth )
+/* Create the texture (or texture pieces) of a new graph */
+
+static int bitmap_create_texture( GRAPH * gr, int w, int h, int depth )
 {
-    GRAPH * gr ;
-    int bytesPerRow, wb ;
     int nx, ny, i, j, i_0;
     int _w, _h ;
     Uint32 format ;
     TEXTURE_PIECE * piece = NULL;
 
-    if ( w < 1 || h < 1 ) return NULL;
-
-    /* Create and fill the struct */
-
-    gr = ( GRAPH * ) malloc( sizeof( GRAPH ) ) ;
-    if ( !gr ) return NULL; // sin memoria
-
-    /* Calculate the row size (dword-aligned) */
-
-    wb = w * depth / 8;
-    if (( wb * 8 / depth ) < w ) wb++;
-
-    bytesPerRow = wb;
-    if ( bytesPerRow & 0x03 ) bytesPerRow = ( bytesPerRow & ~3 ) + 4;
-
-    gr->data = ( char * ) malloc( h * bytesPerRow ) ;
-    if ( !gr->data )   // Sin memoria
-    {
-        SDL_Log("bitmap_new: Could not allocate graphic data");
-        free( gr );
-        return NULL;
-    }
-
-    gr->texture = NULL ;
-
     // Create associated textures only for graphs with bpp >= 16
     if( depth == 16 || depth == 32 ) {
         format = SDL_PIXELFORMAT_ARGB8888;
@@ -233,10 +212,8 @@ GRAPH * bitmap_new( int code, int w, int h, int depth )
         if(w <= renderer_info.max_texture_width && h <= renderer_info.max_texture_height) {
             gr->texture = SDL_CreateTexture(renderer, format, SDL_TEXTUREACCESS_STATIC|SDL_RENDERER_TARGETTEXTURE, w, h) ;
             if (! gr->texture) {
-                if ( gr->data ) free( gr->data ) ;
-                free( gr ) ;
                 SDL_Log("bitmap_new: Could not create GRAPH texture (%s)", SDL_GetError());
-                return NULL;
+                return 0;
             }
             gr->next_piece = NULL;
         } else {
@@ -248,10 +225,8 @@ GRAPH * bitmap_new( int code, int w, int h, int depth )
             _h = MIN(renderer_info.max_texture_height, h);
             gr->texture = SDL_CreateTexture(renderer, format, SDL_TEXTUREACCESS_STATIC|SDL_RENDERER_TARGETTEXTURE, _w, _h);
             if(! gr->texture) {
-                if ( gr->data ) free( gr->data ) ;
-                free( gr ) ;
                 SDL_Log("bitmap_new: Could not create GRAPH texture (%s)", SDL_GetError());
-                return NULL;
+                return 0;
             }
 
             i_0 = 1;
@@ -297,6 +272,61 @@ GRAPH * bitmap_new( int code, int w, int h, int depth )
         }
     }
 
+    return 1;
+}
+
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : bitmap_new_deferred
+ *
+ *  Create a new graph without a texture. Any thread can call it, the
+ *  texture is created later by the main thread: fill the data and then
+ *  call bitmap_queue_texture(). 1 and 8 bits graphs never get one.
+ *
+ *  PARAMS :
+ *      code            Code of the new graph
+ *      w, h            Size of the graph
+ *      depth           Color depth
+ *
+ *  RETURN VALUE :
+ *      Pointer to the new graph or NULL if there is no memory
+ *
+ */
+
+GRAPH * bitmap_new_deferred( int code, int w, int h, int depth )
+{
+    GRAPH * gr ;
+    int bytesPerRow, wb ;
+
+    if ( w < 1 || h < 1 ) return NULL;
+
+    /* Create and fill the struct */
+
+    gr = ( GRAPH * ) malloc( sizeof( GRAPH ) ) ;
+    if ( !gr ) return NULL; // sin memoria
+
+    /* Calculate the row size (dword-aligned) */
+
+    wb = w * depth / 8;
+    if (( wb * 8 / depth ) < w ) wb++;
+
+    bytesPerRow = wb;
+    if ( bytesPerRow & 0x03 ) bytesPerRow = ( bytesPerRow & ~3 ) + 4;
+
+    gr->data = ( char * ) malloc( h * bytesPerRow ) ;
+    if ( !gr->data )   // Sin memoria
+    {
+        SDL_Log("bitmap_new: Could not allocate graphic data");
+        free( gr );
+        return NULL;
+    }
+
+    gr->texture = NULL ;
+    gr->next_piece = NULL ;
+    gr->atlas_page = NULL ;
+    gr->dirty_queued = 0 ;
+    gr->texture_queued = 0 ;
+
     gr->width = w ;
     gr->height = h ;
 
@@ -321,6 +351,25 @@ GRAPH * bitmap_new( int code, int w, int h, int depth )
     return gr ;
 }
 
+/* --------------------------------------------------------------------------- */
+
+GRAPH * bitmap_new( int code, int w, int h, int depth )
+{
+    GRAPH * gr = bitmap_new_deferred( code, w, h, depth ) ;
+
+    if ( !gr ) return NULL;
+
+    if ( !bitmap_create_texture( gr, w, h, depth ) )
+    {
+        free( gr->format ) ;
+        free( gr->data ) ;
+        free( gr ) ;
+        return NULL;
+    }
+
+    return gr ;
+}
+
 /* --------------------------------------------------------------------------- */
 // Create a new graph with a SDL_TEXTURE_STREAMING flag
 // You're responsible for ensuring's this map's texture is not bigger than
@@ -350,6 +399,9 @@ GRAPH * bitmap_new_streaming( int code, int w, int h, int depth )
     gr->data = NULL ;
     gr->texture = NULL ;
     gr->next_piece = NULL ;
+    gr->atlas_page = NULL ;
+    gr->dirty_queued = 0 ;
+    gr->texture_queued = 0 ;
 
     // Create associated textures only for graphs with bpp >= 16
     if( depth == 16 || depth == 32 ) {
@@ -389,6 +441,55 @@ GRAPH * bitmap_new_streaming( int code, int w, int h, int depth )
     return gr ;
 }
 
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : bitmap_new_target
+ *
+ *  Create a graph whose texture is a render target. Blits into it are done
+ *  by the renderer, as the blits to the screen, and its pixels are only read
+ *  back into the data when they are needed (see bitmap_sync_data).
+ *
+ *  PARAMS :
+ *      code            Code of the new graph
+ *      w, h            Size of the graph
+ *      depth           Color depth, 16 or 32 bits
+ *
+ *  RETURN VALUE :
+ *      The new graph, or NULL if the renderer can't draw into it
+ *
+ */
+
+GRAPH * bitmap_new_target( int code, int w, int h, int depth )
+{
+    GRAPH * gr ;
+    SDL_Texture * texture ;
+    Uint32 format ;
+
+    if ( !renderer || !( renderer_info.flags & SDL_RENDERER_TARGETTEXTURE ) ) return NULL ;
+    if ( depth != 16 && depth != 32 ) return NULL ;
+
+    // A render target must be a single texture
+    if ( w > renderer_info.max_texture_width || h > renderer_info.max_texture_height ) return NULL ;
+
+    gr = bitmap_new( code, w, h, depth ) ;
+    if ( !gr ) return NULL ;
+
+    SDL_QueryTexture( gr->texture, &format, NULL, NULL, NULL ) ;
+    texture = SDL_CreateTexture( renderer, format, SDL_TEXTUREACCESS_TARGET, w, h ) ;
+    if ( !texture )
+    {
+        SDL_Log( "bitmap_new_target: Could not create GRAPH texture (%s)", SDL_GetError() ) ;
+        bitmap_destroy( gr ) ;
+        return NULL ;
+    }
+
+    SDL_DestroyTexture( gr->texture ) ;
+    gr->texture = texture ;
+    gr->info_flags |= GI_TARGET ;
+
+    return gr ;
+}
+
 /* --------------------------------------------------------------------------- */
 
 GRAPH * bitmap_clone( GRAPH * map )
@@ -400,6 +501,8 @@ GRAPH * bitmap_clone( GRAPH * map )
     gr = bitmap_new( 0, map->width, map->height, map->format->depth ) ;
     if ( gr == NULL ) return NULL;
 
+    bitmap_sync_data( map ) ;
+
     // Copy the data either from the display renderer or from the original map
     if( scrbitmap && map->code == scrbitmap->code ) {
         format = SDL_PIXELFORMAT_ARGB8888 ;
@@ -423,7 +526,7 @@ GRAPH * bitmap_clone( GRAPH * map )
     }
 
     gr->blend_table = map->blend_table;
-    gr->info_flags = map->info_flags & ~GI_EXTERNAL_DATA ;
+    gr->info_flags = map->info_flags & ~( GI_EXTERNAL_DATA | GI_TARGET | GI_TARGET_DRAWN ) ;
     gr->modified = map->modified ;
     gr->format->palette = map->format->palette ;
     pal_use( map->format->palette );
@@ -449,6 +552,17 @@ void bitmap_update_texture( GRAPH * map )
         return;
     }
 
+    // A full upload also covers any pending dirty region
+    if(map->dirty_queued) map->dirty_queued = 2;
+
+    // Packed maps only own a part of the atlas page
+    if(map->atlas_page) {
+        if(SDL_UpdateTexture(map->texture, &map->atlas_rect, map->data, map->pitch) < 0) {
+            SDL_Log("Error updating texture: %s", SDL_GetError());
+        }
+        return;
+    }
+
     if(SDL_UpdateTexture(map->texture, NULL, map->data, map->pitch) < 0) {
         SDL_Log("Error updating texture: %s", SDL_GetError());
     }
@@ -500,6 +614,363 @@ void bitmap_update_texture( GRAPH * map )
     }
 }
 
+/* --------------------------------------------------------------------------- */
+/* Deferred texture uploads */
+
+static GRAPH ** dirty_maps = NULL ;
+static int dirty_maps_count = 0 ;
+static int dirty_maps_allocated = 0 ;
+
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : bitmap_mark_dirty
+ *
+ *  Record that some pixels of a map changed, so its texture gets the
+ *  region uploaded at the next bitmap_flush_textures() instead of a
+ *  full SDL_UpdateTexture() for each change
+ *
+ *  PARAMS :
+ *      map             Changed map
+ *      region          Changed pixels (inclusive) or NULL for the whole map
+ *
+ *  RETURN VALUE :
+ *      None
+ *
+ */
+
+void bitmap_mark_dirty( GRAPH * map, REGION * region )
+{
+    REGION r ;
+
+    if ( !map || !map->texture || !map->data ) return ;
+
+    if ( region )
+    {
+        r.x  = MAX( MIN( region->x, region->x2 ), 0 ) ;
+        r.y  = MAX( MIN( region->y, region->y2 ), 0 ) ;
+        r.x2 = MIN( MAX( region->x, region->x2 ), ( int ) map->width - 1 ) ;
+        r.y2 = MIN( MAX( region->y, region->y2 ), ( int ) map->height - 1 ) ;
+        if ( r.x > r.x2 || r.y > r.y2 ) return ;
+    }
+    else
+    {
+        r.x = 0 ;
+        r.y = 0 ;
+        r.x2 = map->width - 1 ;
+        r.y2 = map->height - 1 ;
+    }
+
+    if ( map->dirty_queued == 1 )
+    {
+        if ( map->dirty.x  > r.x  ) map->dirty.x  = r.x ;
+        if ( map->dirty.y  > r.y  ) map->dirty.y  = r.y ;
+        if ( map->dirty.x2 < r.x2 ) map->dirty.x2 = r.x2 ;
+        if ( map->dirty.y2 < r.y2 ) map->dirty.y2 = r.y2 ;
+        return ;
+    }
+
+    if ( !map->dirty_queued )
+    {
+        if ( dirty_maps_count >= dirty_maps_allocated )
+        {
+            GRAPH ** list = ( GRAPH ** ) realloc( dirty_maps, ( dirty_maps_allocated + 64 ) * sizeof( GRAPH * ) ) ;
+            if ( !list )
+            {
+                bitmap_update_texture( map ) ;
+                return ;
+            }
+            dirty_maps = list ;
+            dirty_maps_allocated += 64 ;
+        }
+        dirty_maps[ dirty_maps_count++ ] = map ;
+    }
+
+    map->dirty = r ;
+    map->dirty_queued = 1 ;
+}
+
+/* Upload the dirty region of a map to its texture */
+
+static void bitmap_upload_dirty( GRAPH * map )
+{
+    SDL_Rect rect ;
+
+    if ( map->next_piece )
+    {
+        /* Split textures are rebuilt piece by piece */
+        bitmap_update_texture( map ) ;
+        return ;
+    }
+
+    rect.x = map->dirty.x ;
+    rect.y = map->dirty.y ;
+    rect.w = map->dirty.x2 - map->dirty.x + 1 ;
+    rect.h = map->dirty.y2 - map->dirty.y + 1 ;
+
+    if ( map->atlas_page )
+    {
+        rect.x += map->atlas_rect.x ;
+        rect.y += map->atlas_rect.y ;
+    }
+
+    if ( SDL_UpdateTexture( map->texture, &rect,
+                            ( uint8_t * ) map->data + map->dirty.y * map->pitch + map->dirty.x * map->format->depthb,
+                            map->pitch ) < 0 )
+    {
+        SDL_Log( "Error updating texture: %s", SDL_GetError() );
+    }
+}
+
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : bitmap_flush_texture
+ *
+ *  Upload at once the dirty region of a single map, because the renderer
+ *  is going to draw into it or from it before the next
+ *  bitmap_flush_textures(). The map stays in the list, marked as already
+ *  uploaded.
+ *
+ *  PARAMS :
+ *      map             Map to upload
+ *
+ *  RETURN VALUE :
+ *      None
+ *
+ */
+
+void bitmap_flush_texture( GRAPH * map )
+{
+    if ( !map || map->dirty_queued != 1 ) return ;
+
+    bitmap_upload_dirty( map ) ;
+    map->dirty_queued = 2 ;
+}
+
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : bitmap_flush_textures
+ *
+ *  Upload the dirty region of every map marked with bitmap_mark_dirty()
+ *  to its texture. Called once per frame, before rendering.
+ *
+ *  PARAMS :
+ *      None
+ *
+ *  RETURN VALUE :
+ *      None
+ *
+ */
+
+void bitmap_flush_textures( void )
+{
+    GRAPH * map ;
+    int n ;
+
+    for ( n = 0 ; n < dirty_maps_count ; n++ )
+    {
+        map = dirty_maps[ n ] ;
+        if ( map->dirty_queued == 1 ) bitmap_upload_dirty( map ) ;
+        map->dirty_queued = 0 ;
+    }
+
+    dirty_maps_count = 0 ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Maps created by bitmap_new_deferred() waiting for their texture, from
+ * upload_maps_first to upload_maps_count, oldest first. Each queued map
+ * keeps its position + 1 in texture_queued, so it can leave the queue
+ * without a search; its slot is just cleared. Loaders running in other
+ * threads add to the queue, so it is guarded by a lock, but the textures
+ * are created with the lock released */
+
+static GRAPH ** upload_maps = NULL ;
+static int upload_maps_first = 0 ;
+static int upload_maps_count = 0 ;
+static int upload_maps_allocated = 0 ;
+static SDL_SpinLock upload_lock = 0 ;
+
+/* Take a map out of the queue, with the lock held */
+
+static void bitmap_unqueue_texture( GRAPH * map )
+{
+    upload_maps[ map->texture_queued - 1 ] = NULL ;
+    map->texture_queued = 0 ;
+
+    while ( upload_maps_first < upload_maps_count && !upload_maps[ upload_maps_first ] ) upload_maps_first++ ;
+    if ( upload_maps_first == upload_maps_count ) upload_maps_first = upload_maps_count = 0 ;
+}
+
+/* Create the texture of a map already taken out of the queue. Main thread
+ * only, without the lock. Returns the bytes uploaded */
+
+static int bitmap_upload_unqueued( GRAPH * map )
+{
+    /* Packed into an atlas meanwhile, or no texture at all for this depth */
+    if ( map->texture || map->atlas_page || ( map->format->depth != 16 && map->format->depth != 32 ) ) return 0 ;
+
+    if ( !bitmap_create_texture( map, map->width, map->height, map->format->depth ) ) return 0 ;
+
+    bitmap_update_texture( map ) ;
+    return map->pitch * map->height ;
+}
+
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : bitmap_queue_texture
+ *
+ *  Queue the texture of a map created by bitmap_new_deferred(), once its
+ *  data is ready. Can be called from any thread.
+ *
+ *  PARAMS :
+ *      map             Map to queue
+ *
+ *  RETURN VALUE :
+ *      None
+ *
+ */
+
+void bitmap_queue_texture( GRAPH * map )
+{
+    int n, count ;
+
+    if ( !map || map->texture || map->texture_queued ) return ;
+    if ( map->format->depth != 16 && map->format->depth != 32 ) return ;
+
+    SDL_AtomicLock( &upload_lock ) ;
+
+    if ( upload_maps_count >= upload_maps_allocated && upload_maps_first >= upload_maps_allocated / 2 )
+    {
+        /* Most of the array is already consumed: move the rest to the start */
+        for ( n = upload_maps_first, count = 0 ; n < upload_maps_count ; n++ )
+        {
+            if ( !upload_maps[ n ] ) continue ;
+            upload_maps[ count++ ] = upload_maps[ n ] ;
+            upload_maps[ count - 1 ]->texture_queued = count ;
+        }
+        upload_maps_first = 0 ;
+        upload_maps_count = count ;
+    }
+
+    if ( upload_maps_count >= upload_maps_allocated )
+    {
+        GRAPH ** list = ( GRAPH ** ) realloc( upload_maps, ( upload_maps_allocated * 2 + 256 ) * sizeof( GRAPH * ) ) ;
+        if ( !list )
+        {
+            SDL_AtomicUnlock( &upload_lock ) ;
+            return ;
+        }
+        upload_maps = list ;
+        upload_maps_allocated = upload_maps_allocated * 2 + 256 ;
+    }
+
+    upload_maps[ upload_maps_count++ ] = map ;
+    map->texture_queued = upload_maps_count ;
+
+    SDL_AtomicUnlock( &upload_lock ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : bitmap_upload_texture
+ *
+ *  Create at once the texture of a map still in the upload queue, because
+ *  it is going to be drawn. Main thread only.
+ *
+ *  PARAMS :
+ *      map             Map to upload
+ *
+ *  RETURN VALUE :
+ *      None
+ *
+ */
+
+void bitmap_upload_texture( GRAPH * map )
+{
+    if ( !map || !map->texture_queued ) return ;
+
+    SDL_AtomicLock( &upload_lock ) ;
+    bitmap_unqueue_texture( map ) ;
+    SDL_AtomicUnlock( &upload_lock ) ;
+
+    bitmap_upload_unqueued( map ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : bitmap_upload_textures
+ *
+ *  Create the textures of the queued maps, oldest first, up to
+ *  TEXTURE_UPLOAD_BUDGET bytes (but at least one map). Called once per
+ *  frame, before rendering, so loading many maps doesn't stall a frame.
+ *  The lock is held only to take each map out of the queue; the maps the
+ *  budget doesn't reach stay queued for the next frame.
+ *
+ *  PARAMS :
+ *      None
+ *
+ *  RETURN VALUE :
+ *      None
+ *
+ */
+
+void bitmap_upload_textures( void )
+{
+    int budget = TEXTURE_UPLOAD_BUDGET ;
+    GRAPH * map ;
+
+    while ( budget > 0 && upload_maps_count )
+    {
+        SDL_AtomicLock( &upload_lock ) ;
+        map = ( upload_maps_first < upload_maps_count ) ? upload_maps[ upload_maps_first ] : NULL ;
+        if ( map ) bitmap_unqueue_texture( map ) ;
+        SDL_AtomicUnlock( &upload_lock ) ;
+
+        if ( !map ) break ;
+
+        budget -= bitmap_upload_unqueued( map ) ;
+    }
+}
+
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : bitmap_sync_data
+ *
+ *  Read back the pixels of a render target graph drawn by the renderer,
+ *  so its data is current. Must be called before reading or changing the
+ *  data of a graph that can be a render target. Does nothing for other
+ *  graphs or if the data is already current.
+ *
+ *  PARAMS :
+ *      map             Graph to update
+ *
+ *  RETURN VALUE :
+ *      None
+ *
+ */
+
+void bitmap_sync_data( GRAPH * map )
+{
+    SDL_Texture * target ;
+    Uint32 format ;
+
+    if ( !map || !( map->info_flags & GI_TARGET_DRAWN ) ) return ;
+
+    map->info_flags &= ~GI_TARGET_DRAWN ;
+
+    target = SDL_GetRenderTarget( renderer ) ;
+    SDL_QueryTexture( map->texture, &format, NULL, NULL, NULL ) ;
+
+    if ( SDL_SetRenderTarget( renderer, map->texture ) < 0 ||
+         SDL_RenderReadPixels( renderer, NULL, format, map->data, map->pitch ) < 0 )
+    {
+        SDL_Log( "bitmap_sync_data: Could not read the GRAPH texture (%s)", SDL_GetError() ) ;
+    }
+
+    SDL_SetRenderTarget( renderer, target ) ;
+}
+
 /* --------------------------------------------------------------------------- */
 
 void bitmap_add_cpoint( GRAPH * map, int x, int y )
@@ -547,6 +1018,56 @@ void bitmap_set_cpoint( GRAPH * map, uint32_t point, int x, int y )
     map->cpoints[ point ].y = y;
 }
 
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : bitmap_add_change_hook
+ *
+ *  Register a function to be called each time bitmap_changed() is
+ *  used, so modules can keep data derived from map pixels up to date
+ *
+ *  PARAMS :
+ *      hook            Function to call
+ *
+ *  RETURN VALUE :
+ *      None
+ *
+ */
+
+#define MAX_BITMAP_CHANGE_HOOKS 8
+
+static BITMAP_CHANGE_HOOK bitmap_change_hooks[ MAX_BITMAP_CHANGE_HOOKS ] ;
+static int bitmap_change_hook_count = 0 ;
+
+void bitmap_add_change_hook( BITMAP_CHANGE_HOOK hook )
+{
+    int n ;
+
+    for ( n = 0 ; n < bitmap_change_hook_count ; n++ ) if ( bitmap_change_hooks[ n ] == hook ) return ;
+    if ( bitmap_change_hook_count < MAX_BITMAP_CHANGE_HOOKS ) bitmap_change_hooks[ bitmap_change_hook_count++ ] = hook ;
+}
+
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : bitmap_changed
+ *
+ *  Notify the registered hooks that some pixels of a map changed
+ *
+ *  PARAMS :
+ *      map             Changed map
+ *      region          Changed region, or NULL if the map is being destroyed
+ *
+ *  RETURN VALUE :
+ *      None
+ *
+ */
+
+void bitmap_changed( GRAPH * map, REGION * region )
+{
+    int n ;
+
+    for ( n = 0 ; n < bitmap_change_hook_count ; n++ ) bitmap_change_hooks[ n ]( map, region ) ;
+}
+
 /* --------------------------------------------------------------------------- */
 
 void bitmap_destroy( GRAPH * map )
@@ -556,11 +1077,34 @@ void bitmap_destroy( GRAPH * map )
 
     if ( !map ) return ;
 
+    bitmap_changed( map, NULL ) ;
+
+    /* Only maps with a texture get dirty, and textures are only created in
+       the main thread, so maps destroyed by loader threads never are here */
+    if ( map->dirty_queued )
+    {
+        int n ;
+
+        for ( n = 0 ; n < dirty_maps_count ; n++ )
+        {
+            if ( dirty_maps[ n ] == map )
+            {
+                dirty_maps[ n ] = dirty_maps[ --dirty_maps_count ] ;
+                break ;
+            }
+        }
+    }
+
+    SDL_AtomicLock( &upload_lock ) ;
+    if ( map->texture_queued ) bitmap_unqueue_texture( map ) ;
+    SDL_AtomicUnlock( &upload_lock ) ;
+
     if ( map->cpoints ) free( map->cpoints ) ;
 
     if ( map->code > 999 ) bit_clr( map_code_bmp, map->code - 1000 );
 
     if ( map->data && !( map->info_flags & GI_EXTERNAL_DATA ) ) free( map->data ) ;
+    if ( map->atlas_page ) atlas_release_map( map ) ;
     if ( map->texture && !( map->info_flags & GI_EXTERNAL_DATA ) ) {
         SDL_DestroyTexture( map->texture ) ;
         piece = map->next_piece;
@@ -590,6 +1134,8 @@ void bitmap_analyze( GRAPH * bitmap )
 
     if ( bitmap->modified > 1 ) bitmap->modified = 1 ;
 
+    bitmap_sync_data( bitmap ) ;
+
     bitmap->info_flags &= ~GI_ANALIZE_MASK ;
 
     /* Search for transparent pixels (value 0).
@@ -712,3 +1258,20 @@ GRAPH * bitmap_new_syslib( int w, int h, int depth )
 }
 
 /* --------------------------------------------------------------------------- */
+
+GRAPH * bitmap_new_target_syslib( int w, int h, int depth )
+{
+    GRAPH * gr ;
+
+    if ( !syslib ) return NULL;
+
+    gr = bitmap_new_target( 0, w, h, depth ) ;
+    if ( !gr ) return NULL;
+
+    gr->code = bitmap_next_code() ;
+    grlib_add_map( 0, gr ) ;
+
+    return gr ;
+}
+
+/* --------------------------------------------------------------------------- */
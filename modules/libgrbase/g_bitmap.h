@@ -31,11 +31,14 @@
 #define __BITMAP_H
 
 #include "g_pal.h"
+#include "g_region.h"
 #include <SDL_render.h>
 
 /* --------------------------------------------------------------------------- */
 
 #define GI_NOCOLORKEY       0x00000001  /* info_flags bits */
+#define GI_TARGET_DRAWN     0x10000000  /* the render target texture is newer than the data */
+#define GI_TARGET           0x20000000  /* the texture is a render target (see bitmap_new_target) */
 #define GI_CLEAN            0x40000000  /* the graphic is clean (no data) */
 #define GI_EXTERNAL_DATA    0x80000000  /* data area is external, it don't belong to bitmap */
 
@@ -43,6 +46,8 @@
 
 #define CPOINT_UNDEFINED    32767       /* It's enough if X is set to this value */
 
+#define TEXTURE_UPLOAD_BUDGET   ( 4 * 1024 * 1024 ) /* Bytes of queued textures created per frame */
+
 /* --------------------------------------------------------------------------- */
 
 typedef struct _cpoint
@@ -108,6 +113,16 @@ typedef struct _bitmap
     SDL_Texture *texture;   /* Pointer to the SDL Texture for this graph */
     TEXTURE_PIECE *next_piece;
 
+    struct _atlas_page * atlas_page;    /* Atlas page holding the texture, if packed */
+    SDL_Rect atlas_rect;                /* Part of the page texture used by this graph */
+
+    REGION dirty;           /* Pixels changed since the last texture upload */
+    int dirty_queued;       /* 0 - not queued for bitmap_flush_textures()
+                               1 - queued, dirty region pending
+                               2 - queued, already uploaded
+                             */
+    int texture_queued;     /* Position + 1 in the queue of bitmap_upload_textures(), 0 if not queued */
+
     uint32_t ncpoints;        /* Number of control points */
     CPOINT * cpoints;       /* Pointer to the control points ([0] = center) */
 
@@ -124,12 +139,29 @@ GRAPH;
 
 /* --------------------------------------------------------------------------- */
 
+/* Called when the pixels of a map change, with the changed region or
+   NULL when the map is about to be destroyed */
+
+typedef void ( * BITMAP_CHANGE_HOOK )( GRAPH * map, REGION * region );
+
+/* --------------------------------------------------------------------------- */
+
 extern GRAPH * bitmap_new( int code, int w, int h, int depth );
 extern GRAPH * bitmap_new_ex( int code, int w, int h, int depth, void * data, int pitch );
 extern GRAPH * bitmap_new_streaming( int code, int w, int h, int depth );
+extern GRAPH * bitmap_new_target( int code, int w, int h, int depth );
+extern GRAPH * bitmap_new_deferred( int code, int w, int h, int depth );
 extern GRAPH * bitmap_clone( GRAPH * t );
 extern void bitmap_update_texture( GRAPH * map );
+extern void bitmap_mark_dirty( GRAPH * map, REGION * region );
+extern void bitmap_flush_texture( GRAPH * map );
+extern void bitmap_flush_textures( void );
+extern void bitmap_queue_texture( GRAPH * map );
+extern void bitmap_upload_texture( GRAPH * map );
+extern void bitmap_upload_textures( void );
+extern void bitmap_sync_data( GRAPH * map );
 extern GRAPH * bitmap_new_syslib( int w, int h, int depth );
+extern GRAPH * bitmap_new_target_syslib( int w, int h, int depth );
 extern void bitmap_destroy( GRAPH * map );
 extern void bitmap_destroy_fake( GRAPH * map );
 extern void bitmap_add_cpoint( GRAPH *map, int x, int y );
@@ -138,6 +170,9 @@ extern void bitmap_analyze( GRAPH * bitmap );
 
 extern PIXEL_FORMAT * bitmap_create_format( int bpp );
 
+extern void bitmap_add_change_hook( BITMAP_CHANGE_HOOK hook );
+extern void bitmap_changed( GRAPH * map, REGION * region );
+
 extern int bitmap_next_code();
 
 /* --------------------------------------------------------------------------- */
@@ -51,8 +51,14 @@
 
 void gr_clear( GRAPH * dest )
 {
+    REGION region = { 0, 0, dest->width - 1, dest->height - 1 } ;
+
+    /* All the pixels change, nothing to read back from a render target */
+    dest->info_flags &= ~GI_TARGET_DRAWN ;
+
     memset( dest->data, 0, dest->pitch * dest->height ) ;
-    bitmap_update_texture(dest);
+    bitmap_mark_dirty( dest, &region ) ;
+    bitmap_changed( dest, &region ) ;
 
     dest->modified = 1 ; /* Doesn't need analysis */
 
@@ -77,6 +83,7 @@ void gr_clear( GRAPH * dest )
 
 void gr_clear_as( GRAPH * dest, int color )
 {
+    REGION region = { 0, 0, dest->width - 1, dest->height - 1 } ;
     uint32_t y;
 
     if ( !color )
@@ -85,6 +92,8 @@ void gr_clear_as( GRAPH * dest, int color )
         return;
     }
 
+    dest->info_flags &= ~GI_TARGET_DRAWN ;
+
     switch ( dest->format->depth )
     {
         case 8:
@@ -133,7 +142,8 @@ void gr_clear_as( GRAPH * dest, int color )
         }
     }
 
-    bitmap_update_texture(dest);
+    bitmap_mark_dirty( dest, &region ) ;
+    bitmap_changed( dest, &region ) ;
 
     dest->modified = 1 ; /* Doesn't need analysis */
     if ( dest->format->depth != 32 || ( color & 0xff000000 ) == 0xff000000 )
@@ -180,8 +190,11 @@ void gr_clear_region( GRAPH * dest, REGION * region )
         region->y = MAX( MIN( region->y, region->y2 ), 0 ) ;
         region->x2 = MIN( MAX( region->x, region->x2 ), dest->width - 1 ) ;
         region->y2 = MIN( MAX( region->y, region->y2 ), dest->height - 1 ) ;
+        if ( region->x > region->x2 || region->y > region->y2 ) return ;
     }
 
+    bitmap_sync_data( dest ) ;
+
     switch ( dest->format->depth )
     {
         case 8:
@@ -215,6 +228,9 @@ void gr_clear_region( GRAPH * dest, REGION * region )
             return;
     }
 
+    bitmap_mark_dirty( dest, region ) ;
+    bitmap_changed( dest, region ) ;
+
     dest->modified = 1 ; /* Doesn't need analysis */
     dest->info_flags &= ~GI_NOCOLORKEY;
 }
@@ -154,6 +154,7 @@ static GRLIB * grlib_create()
 
     lib->name[ 0 ] = 0 ;
     lib->map_reserved = 32 ;
+    lib->atlas = NULL ;
 
     return lib ;
 }
@@ -200,6 +201,7 @@ void grlib_destroy( int libid )
 
     for ( i = 0; i < lib->map_reserved; i++ ) bitmap_destroy( lib->maps[ i ] ) ;
 
+    atlas_destroy( lib->atlas ) ;
     free( lib->maps ) ;
     free( lib ) ;
 
@@ -236,6 +238,10 @@ int grlib_unload_map( int libid, int mapcode )
 
     bitmap_destroy( lib->maps[ mapcode ] ) ;
     lib->maps[ mapcode ] = 0 ;
+
+    /* Recover the space of the unloaded maps once it's most of the atlas */
+    if ( lib->atlas && atlas_waste( lib->atlas ) > 50 ) atlas_repack( lib->atlas, lib->maps, lib->map_reserved ) ;
+
     return 1 ;
 }
 
@@ -284,9 +290,51 @@ int grlib_add_map( int libid, GRAPH * map )
 
     lib->maps[ map->code ] = map ;
 
+    if ( lib->atlas ) atlas_add_map( lib->atlas, map ) ;
+
     return map->code ;
 }
 
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : grlib_atlas
+ *
+ *  Pack the textures of all the maps of a library in a few shared
+ *  textures, or give them their own textures back. While enabled,
+ *  maps added to the library are packed too
+ *
+ *  PARAMS :
+ *  libid   ID of the library
+ *  enable  1 to pack the maps, 0 to unpack them
+ *
+ *  RETURN VALUE :
+ *      Number of atlas pages used, or -1 if error
+ */
+
+int grlib_atlas( int libid, int enable )
+{
+    GRLIB * lib = grlib_get( libid ) ;
+    int i ;
+
+    if ( !lib ) return -1 ;
+
+    if ( !enable )
+    {
+        if ( !lib->atlas ) return 0 ;
+
+        for ( i = 0; i < lib->map_reserved; i++ )
+            if ( lib->maps[ i ] ) atlas_unpack_map( lib->maps[ i ] ) ;
+
+        atlas_destroy( lib->atlas ) ;
+        lib->atlas = NULL ;
+        return 0 ;
+    }
+
+    if ( !lib->atlas && !( lib->atlas = atlas_new() ) ) return -1 ;
+
+    return atlas_repack( lib->atlas, lib->maps, lib->map_reserved ) ;
+}
+
 /* --------------------------------------------------------------------------- */
 /*
  *  FUNCTION : bitmap_get
@@ -37,6 +37,7 @@ typedef struct _grlib
     GRAPH ** maps ;
     int map_reserved ;
     char name[ 64 ];
+    ATLAS * atlas ;     /* Shared textures of the maps, if any */
 }
 GRLIB ;
 
@@ -49,5 +50,6 @@ extern int grlib_new() ;
 extern void grlib_destroy( int libid ) ;
 extern int grlib_add_map( int libid, GRAPH * map ) ;
 extern int grlib_unload_map( int libid, int mapcode ) ;
+extern int grlib_atlas( int libid, int enable ) ;
 
 #endif
@@ -43,6 +43,7 @@
 
 #include "g_pal.h"
 #include "g_bitmap.h"
+#include "g_atlas.h"
 #include "g_clear.h"
 #include "g_grlib.h"
 #include "g_region.h"
@@ -37,34 +37,127 @@ static int sequencer = 0;
 
 CONTAINER * sorted_object_list = NULL;
 
+/* Containers are also kept in a treap by key, so looking up a Z value
+ * doesn't walk the whole list. The list still gives the drawing order. */
+
+static CONTAINER * container_tree = NULL;
+static uint32_t container_seed = 0x9e3779b9;
+
 /* --------------------------------------------------------------------------- */
 
-CONTAINER * search_container( int key )
+static uint32_t container_priority( void )
 {
-    CONTAINER * ctr = NULL;
+    /* xorshift, don't touch the rand() sequence of the game */
+    container_seed ^= container_seed << 13;
+    container_seed ^= container_seed >> 17;
+    container_seed ^= container_seed << 5;
+    return container_seed;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static CONTAINER * container_tree_insert( CONTAINER * root, CONTAINER * ctr )
+{
+    CONTAINER * pivot;
+
+    if ( !root ) return ctr;
+
+    if ( ctr->key < root->key )
+    {
+        root->left = container_tree_insert( root->left, ctr );
+        if ( root->left->priority > root->priority )
+        {
+            pivot = root->left;
+            root->left = pivot->right;
+            pivot->right = root;
+            return pivot;
+        }
+    }
+    else
+    {
+        root->right = container_tree_insert( root->right, ctr );
+        if ( root->right->priority > root->priority )
+        {
+            pivot = root->right;
+            root->right = pivot->left;
+            pivot->left = root;
+            return pivot;
+        }
+    }
+
+    return root;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static CONTAINER * container_tree_remove( CONTAINER * root, CONTAINER * ctr )
+{
+    CONTAINER * pivot;
+
+    if ( !root ) return NULL;
+
+    if ( root != ctr )
+    {
+        if ( ctr->key < root->key )
+            root->left = container_tree_remove( root->left, ctr );
+        else
+            root->right = container_tree_remove( root->right, ctr );
+        return root;
+    }
+
+    /* Rotate it down until it has a free side */
+    if ( !root->left ) return root->right;
+    if ( !root->right ) return root->left;
+
+    if ( root->left->priority > root->right->priority )
+    {
+        pivot = root->left;
+        root->left = pivot->right;
+        pivot->right = container_tree_remove( root, ctr );
+    }
+    else
+    {
+        pivot = root->right;
+        root->right = pivot->left;
+        pivot->left = container_tree_remove( root, ctr );
+    }
+
+    return pivot;
+}
 
-    if ( !sorted_object_list ) return NULL;
+/* --------------------------------------------------------------------------- */
 
-    for ( ctr = sorted_object_list; ctr && ctr->key > key; ctr = ctr->next );
+CONTAINER * search_container( int key )
+{
+    CONTAINER * ctr = container_tree;
 
-    if ( ctr && ctr->key == key ) return ctr;
+    while ( ctr && ctr->key != key ) ctr = ( key < ctr->key ) ? ctr->left : ctr->right;
 
-    return NULL;
+    return ctr;
 }
 
 /* --------------------------------------------------------------------------- */
 
 CONTAINER * get_container( int key )
 {
-    CONTAINER * ctr = NULL, * prev_ctr = NULL, * new_ctr = NULL;
+    CONTAINER * ctr = container_tree, * prev_ctr = NULL, * next_ctr = NULL, * new_ctr = NULL;
 
-    if ( sorted_object_list )
+    /* The list goes from the biggest key to the lowest, so the previous
+       container is the lowest bigger key and the next one the biggest lower key */
+    while ( ctr )
     {
-        for ( ctr = sorted_object_list; ctr && ctr->key > key; ctr = ctr->next )
+        if ( ctr->key == key ) return ctr;
+
+        if ( key < ctr->key )
         {
             prev_ctr = ctr;
+            ctr = ctr->left;
+        }
+        else
+        {
+            next_ctr = ctr;
+            ctr = ctr->right;
         }
-        if ( ctr && ctr->key == key ) return ctr;
     }
 
     new_ctr = ( CONTAINER * ) malloc( sizeof( CONTAINER ) );
@@ -72,36 +165,17 @@ CONTAINER * get_container( int key )
 
     new_ctr->key = key;
     new_ctr->first_in_key = NULL;
+    new_ctr->left = NULL;
+    new_ctr->right = NULL;
+    new_ctr->priority = container_priority();
 
-    if ( ctr == sorted_object_list )
-    {
-        if ( !sorted_object_list )
-        {
-            /* Only happen "!sorted_object_list" when "ctr == sorted_object_list" (NULL) */
-            sorted_object_list = new_ctr;
-            new_ctr->next = NULL;
-            new_ctr->prev = NULL;
-
-            return new_ctr;
-        }
-
-        sorted_object_list = new_ctr;
-    }
+    new_ctr->prev = prev_ctr;
+    new_ctr->next = next_ctr;
+    if ( prev_ctr ) prev_ctr->next = new_ctr;
+    else            sorted_object_list = new_ctr;
+    if ( next_ctr ) next_ctr->prev = new_ctr;
 
-    if ( ctr )
-    {
-        new_ctr->next = ctr;
-        new_ctr->prev = ctr->prev;
-        if ( ctr->prev ) ctr->prev->next = new_ctr;
-        ctr->prev = new_ctr;
-    }
-    else
-    {
-        // prev_ctr implicit exist
-        new_ctr->next = NULL;
-        new_ctr->prev = prev_ctr;
-        prev_ctr->next = new_ctr;
-    }
+    container_tree = container_tree_insert( container_tree, new_ctr );
 
     return new_ctr;
 }
@@ -114,6 +188,8 @@ void destroy_container( CONTAINER * ctr )
     if ( ctr->prev ) ctr->prev->next = ctr->next;
     if ( ctr == sorted_object_list ) sorted_object_list = ctr->next ;
 
+    container_tree = container_tree_remove( container_tree, ctr );
+
     free( ctr );
 }
 
@@ -316,9 +392,13 @@ void gr_draw_objects( REGION * updaterects, int count )
     REGION * prect;
     int n;
 
+    gr_batch_begin();
+
     ctr = sorted_object_list;
     while ( ctr )
     {
+        gr_batch_band();
+
         object = ctr->first_in_key;
         while ( object )
         {
@@ -339,6 +419,8 @@ void gr_draw_objects( REGION * updaterects, int count )
         }
         ctr = ctr->next ;
     }
+
+    gr_batch_end();
 }
 
 /* --------------------------------------------------------------------------- */
@@ -348,9 +430,13 @@ void gr_draw_objects_complete( void )
     CONTAINER * ctr = NULL;
     OBJECT * object;
 
+    gr_batch_begin();
+
     ctr = sorted_object_list;
     while ( ctr )
     {
+        gr_batch_band();
+
         object = ctr->first_in_key;
         while ( object )
         {
@@ -360,6 +446,8 @@ void gr_draw_objects_complete( void )
         }
         ctr = ctr->next ;
     }
+
+    gr_batch_end();
 }
 
 /* --------------------------------------------------------------------------- */
@@ -58,6 +58,11 @@ typedef struct _container
 
     struct _container * prev ;
     struct _container * next ;
+
+    /* Search tree by key (treap) */
+    struct _container * left ;
+    struct _container * right ;
+    uint32_t priority ;
 }
 CONTAINER ;
 
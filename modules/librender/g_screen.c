@@ -86,6 +86,11 @@ void gr_draw_screen( GRAPH * dest, int restore_type, int dump_type )
     updaterects[ 0 ].x2 = scr_width - 1;
     updaterects[ 0 ].y2 = scr_height - 1;
 
+    /* Create the textures of maps loaded meanwhile, then upload the
+       pixels changed since the last frame */
+    bitmap_upload_textures();
+    bitmap_flush_textures();
+
     /* Dump everything */
     gr_draw_objects_complete();
 
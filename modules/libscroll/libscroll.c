@@ -69,7 +69,9 @@ enum {
     COORDX,
     COORDY,
     COORDZ,
-    RESOLUTION
+    RESOLUTION,
+    OBJECTID,
+    MEMBER
 };
 
 /* Globals */
@@ -102,7 +104,10 @@ DLCONSTANT __bgdexport( libscroll, constants_def )[] =
 
 char * __bgdexport( libscroll, locals_def ) =
     "ctype;\n"
-    "cnumber;\n";
+    "cnumber;\n"
+    "STRUCT _scroll_reserved_\n"
+    "member=0;\n"
+    "END\n";
 
 /* --------------------------------------------------------------------------- */
 
@@ -135,6 +140,8 @@ DLVARFIXUP __bgdexport( libscroll, locals_fixup )[] =
     { "y" , NULL, -1, -1 },
     { "z" , NULL, -1, -1 },
     { "resolution" , NULL, -1, -1 },
+    { "_render_reserved_.object_id" , NULL, -1, -1 },
+    { "_scroll_reserved_.member" , NULL, -1, -1 },
     { NULL , NULL, -1, -1 }
 };
 
@@ -153,6 +160,117 @@ static int info_scroll( int n, REGION * clip, int * z, int * drawme );
 
 /* --------------------------------------------------------------------------- */
 
+/* Every instance has a member record, created by instance_create_hook. The
+ * records of the instances with ctype == C_SCROLL are kept in the list of
+ * each scroll they are drawn in, in the order of the last frame, so the lists
+ * only need small fixes to be sorted again. */
+
+typedef struct _scroll_member
+{
+    INSTANCE * instance ;   /* NULL once the instance is destroyed */
+    int scrolls ;           /* Bit n set if the instance belongs to scroll n */
+    int listed ;            /* Bit n set if the record is in scroll_lists[n] */
+    int index ;             /* Position in scroll_members */
+    int z ;                 /* Sort keys, read from the instance before sorting */
+    int id ;
+}
+SCROLL_MEMBER ;
+
+typedef struct
+{
+    SCROLL_MEMBER ** list ;
+    int count ;
+    int reserved ;
+}
+SCROLL_LIST ;
+
+static SCROLL_MEMBER ** scroll_members = NULL ;
+static int scroll_members_count = 0 ;
+static int scroll_members_reserved = 0 ;
+static uint32_t scroll_members_frame = 0xFFFFFFFF ;
+
+static SCROLL_LIST scroll_lists[ 10 ] ;
+
+/* --------------------------------------------------------------------------- */
+
+static void scroll_list_add( int n, SCROLL_MEMBER * m )
+{
+    SCROLL_LIST * l = &scroll_lists[n] ;
+
+    if ( l->count == l->reserved )
+    {
+        l->reserved = l->reserved ? l->reserved * 2 : 64 ;
+        l->list = ( SCROLL_MEMBER ** ) realloc( l->list, sizeof( SCROLL_MEMBER * ) * l->reserved ) ;
+    }
+
+    l->list[l->count++] = m ;
+    m->listed |= 1 << n ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static void scroll_list_drop( int n, SCROLL_MEMBER * m )
+{
+    m->listed &= ~( 1 << n ) ;
+    if ( !m->instance && !m->listed ) free( m ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : scroll_refresh_members
+ *
+ *  Puts the instances that changed their ctype or cnumber in the lists of
+ *  their new scrolls, and drops from every list the instances that left
+ *  the scroll or were destroyed, and the records of inactive scrolls. This
+ *  keeps the lists of the scrolls that are not drawn from growing. Called
+ *  once per frame: nothing tells when a process changes its ctype or
+ *  cnumber, so they are read for every instance, but only from the compact
+ *  array of records.
+ *
+ */
+
+static void scroll_refresh_members( void )
+{
+    SCROLL_MEMBER * m ;
+    int i, n, cnumber, added, count, active = 0 ;
+
+    for ( n = 0 ; n < 10 ; n++ ) if ( scrolls[n].active ) active |= 1 << n ;
+
+    for ( i = 0 ; i < scroll_members_count ; i++ )
+    {
+        m = scroll_members[i] ;
+        m->scrolls = 0 ;
+
+        if ( LOCDWORD( libscroll, m->instance, CTYPE ) == C_SCROLL )
+        {
+            cnumber = LOCDWORD( libscroll, m->instance, CNUMBER ) ;
+            m->scrolls = ( cnumber ? cnumber : ~0 ) & active ;
+        }
+
+        if ( !( added = m->scrolls & ~m->listed ) ) continue ;
+
+        for ( n = 0 ; n < 10 ; n++ )
+            if ( added & ( 1 << n ) ) scroll_list_add( n, m ) ;
+    }
+
+    /* The kept records stay in the order of the last frame */
+
+    for ( n = 0 ; n < 10 ; n++ )
+    {
+        SCROLL_LIST * l = &scroll_lists[n] ;
+
+        for ( i = 0, count = 0 ; i < l->count ; i++ )
+        {
+            m = l->list[i] ;
+            if ( m->scrolls & ( 1 << n ) ) l->list[count++] = m ;
+            else                           scroll_list_drop( n, m ) ;
+        }
+        l->count = count ;
+    }
+}
+
+/* --------------------------------------------------------------------------- */
+
 void scroll_region( int n, REGION * r )
 {
     if ( n < 0 || n > 9 ) return ;
@@ -182,6 +300,7 @@ void scroll_start( int n, int fileid, int graphid, int backid, int region, int f
         scrolls[n].flags    = flags ;
         scrolls[n].destfile = destfile;
         scrolls[n].destid   = destid;
+        scrolls[n].tiles    = NULL ;
 
         data = &(( SCROLL_EXTRA_DATA * ) &GLODWORD( libscroll, SCROLLS ) )[n] ;
 
@@ -195,6 +314,41 @@ void scroll_start( int n, int fileid, int graphid, int backid, int region, int f
     }
 }
 
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : scroll_start_tilemap
+ *
+ *  Starts a scroll whose foreground is a grid of tiles instead of a single
+ *  graph, so big levels don't need a huge bitmap (which would be split in
+ *  several textures). The tile array is read every frame, so the program
+ *  can change it while the scroll runs, but it must stay allocated.
+ *
+ *  PARAMS :
+ *      n               Scroll number
+ *      fileid          Library of the tiles and the background
+ *      tiles           Graph codes of the tiles, row by row (0 = empty)
+ *      columns, rows   Tilemap size, in tiles
+ *      tile_w, tile_h  Tile size, in pixels
+ *      backid          Background graph or 0
+ *      region, flags   As in scroll_start
+ *      destfile, destid
+ *
+ */
+
+void scroll_start_tilemap( int n, int fileid, int32_t * tiles, int columns, int rows, int tile_w, int tile_h, int backid, int region, int flags, int destfile, int destid )
+{
+    if ( n < 0 || n > 9 ) return ;
+    if ( !tiles || columns <= 0 || rows <= 0 || tile_w <= 0 || tile_h <= 0 ) return ;
+
+    scroll_start( n, fileid, 0, backid, region, flags, destfile, destid ) ;
+
+    scrolls[n].tiles    = tiles ;
+    scrolls[n].tiles_w  = columns ;
+    scrolls[n].tiles_h  = rows ;
+    scrolls[n].tile_w   = tile_w ;
+    scrolls[n].tile_h   = tile_h ;
+}
+
 /* --------------------------------------------------------------------------- */
 
 void scroll_stop( int n )
@@ -207,6 +361,8 @@ void scroll_stop( int n )
             scrolls_objects[n] = 0;
             scrolls[n].active = 0 ;
         }
+
+        while ( scroll_lists[n].count ) scroll_list_drop( n, scroll_lists[n].list[--scroll_lists[n].count] ) ;
     }
 }
 
@@ -214,7 +370,7 @@ void scroll_stop( int n )
 
 void scroll_update( int n )
 {
-    int x0, y0, x1, y1, cx, cy, w, h, speed ;
+    int x0, y0, x1, y1, cx, cy, w, h, gw, gh, speed ;
 
     REGION bbox;
     GRAPH * gr, * graph, * back;
@@ -223,14 +379,27 @@ void scroll_update( int n )
 
     if ( n < 0 || n > 9 ) return ;
 
-    if ( !scrolls[n].active || !scrolls[n].region || !scrolls[n].graphid ) return ;
+    if ( !scrolls[n].active || !scrolls[n].region || ( !scrolls[n].graphid && !scrolls[n].tiles ) ) return ;
 
     graph = scrolls[n].graphid ? bitmap_get( scrolls[n].fileid, scrolls[n].graphid ) : 0 ;
     back  = scrolls[n].backid  ? bitmap_get( scrolls[n].fileid, scrolls[n].backid )  : 0 ;
 
-    if (                        !graph ) return ; // El fondo de scroll no existe
+    if (  scrolls[n].graphid && !graph ) return ; // El fondo de scroll no existe
     if (  scrolls[n].backid  && !back  ) return ; // Grafico no existe
 
+    /* Tamaño del primer plano: un grafico o un mapa de tiles */
+
+    if ( graph )
+    {
+        gw = graph->width ;
+        gh = graph->height ;
+    }
+    else
+    {
+        gw = scrolls[n].tiles_w * scrolls[n].tile_w ;
+        gh = scrolls[n].tiles_h * scrolls[n].tile_h ;
+    }
+
     data = &(( SCROLL_EXTRA_DATA * ) &GLODWORD( libscroll, SCROLLS ) )[n] ;
 
     w = scrolls[n].region->x2 - scrolls[n].region->x + 1 ;
@@ -327,11 +496,8 @@ void scroll_update( int n )
 
     /* Scrolls no cíclicos y posición del background */
 
-    if ( graph )
-    {
-        if ( !( scrolls[n].flags & GRAPH_HWRAP ) ) data->x0 = MAX( 0, MIN( data->x0, ( int )graph->width  - w ) ) ;
-        if ( !( scrolls[n].flags & GRAPH_VWRAP ) ) data->y0 = MAX( 0, MIN( data->y0, ( int )graph->height - h ) ) ;
-    }
+    if ( !( scrolls[n].flags & GRAPH_HWRAP ) ) data->x0 = MAX( 0, MIN( data->x0, gw - w ) ) ;
+    if ( !( scrolls[n].flags & GRAPH_VWRAP ) ) data->y0 = MAX( 0, MIN( data->y0, gh - h ) ) ;
 
     if ( scrolls[n].ratio )
     {
@@ -349,11 +515,11 @@ void scroll_update( int n )
 
     scrolls[n].posx0 = data->x0 ;
     scrolls[n].posy0 = data->y0 ;
-    scrolls[n].x0 = data->x0 % ( int32_t ) graph->width ;
-    scrolls[n].y0 = data->y0 % ( int32_t ) graph->height ;
+    scrolls[n].x0 = data->x0 % gw ;
+    scrolls[n].y0 = data->y0 % gh ;
 
-    if ( scrolls[n].x0 < 0 ) scrolls[n].x0 += graph->width ;
-    if ( scrolls[n].y0 < 0 ) scrolls[n].y0 += graph->height ;
+    if ( scrolls[n].x0 < 0 ) scrolls[n].x0 += gw ;
+    if ( scrolls[n].y0 < 0 ) scrolls[n].y0 += gh ;
 
     if ( back )
     {
@@ -366,27 +532,165 @@ void scroll_update( int n )
 
 /* --------------------------------------------------------------------------- */
 
-static int compare_instances( const void * ptr1, const void * ptr2 )
+static int compare_members( const void * ptr1, const void * ptr2 )
+{
+    const SCROLL_MEMBER * m1 = *( const SCROLL_MEMBER ** )ptr1 ;
+    const SCROLL_MEMBER * m2 = *( const SCROLL_MEMBER ** )ptr2 ;
+
+    int ret = m2->z - m1->z;
+
+    return !ret ? m1->id - m2->id : ret;
+}
+
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : scroll_sort_list
+ *
+ *  Drops the instances that left the scroll since the last call to
+ *  scroll_refresh_members, if any, and sorts the list by Z. The
+ *  list keeps the order of the last frame, so an insertion sort is almost
+ *  linear. If too many instances moved, it falls back to qsort.
+ *
+ *  PARAMS :
+ *      n           Scroll number
+ *
+ */
+
+static void scroll_sort_list( int n )
+{
+    SCROLL_LIST * l = &scroll_lists[n] ;
+    SCROLL_MEMBER * m ;
+    int i, j, count = 0, moves = 0 ;
+
+    for ( i = 0 ; i < l->count ; i++ )
+    {
+        m = l->list[i] ;
+        if ( !( m->scrolls & ( 1 << n ) ) )
+        {
+            scroll_list_drop( n, m ) ;
+            continue ;
+        }
+
+        m->z  = LOCDWORD( libscroll, m->instance, COORDZ ) ;
+        m->id = LOCDWORD( libscroll, m->instance, PROCESS_ID ) ;
+
+        /* Insertion sort */
+        for ( j = count ; j > 0 && compare_members( &l->list[j - 1], &m ) > 0 ; j-- ) l->list[j] = l->list[j - 1] ;
+        l->list[j] = m ;
+        moves += count++ - j ;
+
+        if ( moves > 4 * l->count ) break ;
+    }
+
+    if ( i == l->count )
+    {
+        l->count = count ;
+        return ;
+    }
+
+    /* Too many changes: read the keys of the rest and sort everything */
+
+    for ( i++ ; i < l->count ; i++ )
+    {
+        m = l->list[i] ;
+        if ( !( m->scrolls & ( 1 << n ) ) )
+        {
+            scroll_list_drop( n, m ) ;
+            continue ;
+        }
+
+        m->z  = LOCDWORD( libscroll, m->instance, COORDZ ) ;
+        m->id = LOCDWORD( libscroll, m->instance, PROCESS_ID ) ;
+        l->list[count++] = m ;
+    }
+
+    l->count = count ;
+    qsort( l->list, l->count, sizeof( SCROLL_MEMBER * ), compare_members ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : scroll_draw_tiles
+ *
+ *  Draws the tiles of a tilemap scroll that fall inside the clipping
+ *  region. The tilemap repeats like the foreground graph of a normal
+ *  scroll. Empty or missing tiles are skipped.
+ *
+ *  PARAMS :
+ *      n           Scroll number
+ *      dest        Destination map or NULL for the screen
+ *      clip        Clipping region
+ *      flags       Blit flags
+ *
+ */
+
+static void scroll_draw_tiles( int n, GRAPH * dest, REGION * clip, int flags )
 {
-    const INSTANCE * i1 = *( const INSTANCE ** )ptr1 ;
-    const INSTANCE * i2 = *( const INSTANCE ** )ptr2 ;
+    scrolldata * s = &scrolls[n] ;
+    GRAPH * tile = NULL ;
+    int32_t * line ;
+    int code, last = 0, x, y, x0, y0, col, col0, row ;
+
+    /* Tile and screen position of the first visible tile. x0 and y0
+       are already inside the tilemap */
+
+    col0 = s->x0 / s->tile_w ;
+    row  = s->y0 / s->tile_h ;
+    x0   = s->region->x - s->x0 % s->tile_w ;
+    y0   = s->region->y - s->y0 % s->tile_h ;
+
+    /* Skip the rows and columns out of the clipping region */
+
+    while ( x0 + s->tile_w <= clip->x )
+    {
+        x0 += s->tile_w ;
+        if ( ++col0 == s->tiles_w ) col0 = 0 ;
+    }
+
+    while ( y0 + s->tile_h <= clip->y )
+    {
+        y0 += s->tile_h ;
+        if ( ++row == s->tiles_h ) row = 0 ;
+    }
+
+    for ( y = y0 ; y <= clip->y2 ; y += s->tile_h )
+    {
+        line = s->tiles + row * s->tiles_w ;
+
+        for ( x = x0, col = col0 ; x <= clip->x2 ; x += s->tile_w )
+        {
+            /* Runs of the same tile are common, so keep the last one */
+            code = line[col] ;
+            if ( code != last )
+            {
+                last = code ;
+                tile = code ? bitmap_get( s->fileid, code ) : NULL ;
+            }
+
+            if ( tile )
+            {
+                if ( tile->ncpoints > 0 && tile->cpoints[0].x >= 0 )
+                    gr_blit( dest, clip, x + tile->cpoints[0].x, y + tile->cpoints[0].y, flags, tile, 1 ) ;
+                else
+                    gr_blit( dest, clip, x + tile->width / 2, y + tile->height / 2, flags, tile, 1 ) ;
+            }
 
-    int ret = LOCDWORD( libscroll, i2, COORDZ ) - LOCDWORD( libscroll, i1, COORDZ );
+            if ( ++col == s->tiles_w ) col = 0 ;
+        }
 
-    return !ret ? LOCDWORD( libscroll, i1, PROCESS_ID ) - LOCDWORD( libscroll, i2, PROCESS_ID ) : ret;
+        if ( ++row == s->tiles_h ) row = 0 ;
+    }
 }
 
 /* --------------------------------------------------------------------------- */
 
 void scroll_draw( int n, REGION * clipping )
 {
-    int nproc, x, y, cx, cy ;
+    int nproc, x, y, cx, cy, dx, dy, z = 0, drawn ;
 
-    static INSTANCE ** proclist = 0;
-    static int proclist_reserved = 0;
-    int proclist_count;
     REGION r;
     int status;
+    OBJECT * object;
 
     GRAPH * graph, * back, * dest = NULL;
 
@@ -395,12 +699,12 @@ void scroll_draw( int n, REGION * clipping )
 
     if ( n < 0 || n > 9 ) return ;
 
-    if ( !scrolls[n].active || !scrolls[n].region || !scrolls[n].graphid ) return ;
+    if ( !scrolls[n].active || !scrolls[n].region || ( !scrolls[n].graphid && !scrolls[n].tiles ) ) return ;
 
     graph = scrolls[n].graphid ? bitmap_get( scrolls[n].fileid, scrolls[n].graphid ) : NULL ;
     back  = scrolls[n].backid  ? bitmap_get( scrolls[n].fileid, scrolls[n].backid )  : NULL ;
 
-    if (                        !graph ) return ; // El fondo de scroll no existe
+    if (  scrolls[n].graphid && !graph ) return ; // El fondo de scroll no existe
     if (  scrolls[n].backid  && !back  ) return ; // Grafico no existe
 
     dest = scrolls[n].destid ? bitmap_get( scrolls[n].destfile, scrolls[n].destid ) : NULL ;
@@ -441,76 +745,81 @@ void scroll_draw( int n, REGION * clipping )
 
     /* Dibuja el primer plano */
 
-    if ( graph->ncpoints > 0 && graph->cpoints[0].x >= 0 )
+    gr_batch_band() ;
+
+    if ( !graph )
     {
-        cx = graph->cpoints[0].x ;
-        cy = graph->cpoints[0].y ;
+        scroll_draw_tiles( n, dest, &r, data->flags1 ) ;
     }
     else
     {
-        cx = graph->width / 2 ;
-        cy = graph->height / 2 ;
-    }
-
-    y = scrolls[n].region->y - scrolls[n].y0 ;
-    while ( y < scrolls[n].region->y2 )
-    {
-        x = scrolls[n].region->x - scrolls[n].x0 ;
-        while ( x < scrolls[n].region->x2 )
+        if ( graph->ncpoints > 0 && graph->cpoints[0].x >= 0 )
         {
-            gr_blit( dest, &r, x + cx, y + cy, data->flags1, graph, 1 ) ;
-            x += graph->width ;
+            cx = graph->cpoints[0].x ;
+            cy = graph->cpoints[0].y ;
+        }
+        else
+        {
+            cx = graph->width / 2 ;
+            cy = graph->height / 2 ;
         }
-        y += graph->height ;
-    }
-
-    /* Crea una lista ordenada de instancias a dibujar */
 
-    i = first_instance ;
-    proclist_count = 0 ;
-    while ( i )
-    {
-        if ( LOCDWORD( libscroll, i, CTYPE ) == C_SCROLL &&
-                (
-                    (( status = LOCDWORD( libscroll, i, STATUS ) ) & ~STATUS_WAITING_MASK ) == STATUS_RUNNING ||
-                    ( status & ~STATUS_WAITING_MASK ) == STATUS_FROZEN
-                )
-           )
+        y = scrolls[n].region->y - scrolls[n].y0 ;
+        while ( y < scrolls[n].region->y2 )
         {
-            if ( LOCDWORD( libscroll, i, CNUMBER ) && !( LOCDWORD( libscroll, i, CNUMBER ) & ( 1 << n ) ) )
+            x = scrolls[n].region->x - scrolls[n].x0 ;
+            while ( x < scrolls[n].region->x2 )
             {
-                i = i->next ;
-                continue ;
+                gr_blit( dest, &r, x + cx, y + cy, data->flags1, graph, 1 ) ;
+                x += graph->width ;
             }
+            y += graph->height ;
+        }
+    }
 
-            if ( proclist_count == proclist_reserved )
-            {
-                proclist_reserved += 16 ;
-                proclist = ( INSTANCE ** ) realloc( proclist, sizeof( INSTANCE * ) * proclist_reserved ) ;
-            }
+    /* Ordena la lista de instancias a dibujar */
 
-            proclist[proclist_count++] = i ;
-        }
-        i = i->next ;
+    if ( scroll_members_frame != frame_count )
+    {
+        scroll_members_frame = frame_count ;
+        scroll_refresh_members() ;
     }
 
-    if ( proclist_count )
+    scroll_sort_list( n ) ;
+
+    /* Visualiza los procesos */
+
+    dx = scrolls[n].region->x - scrolls[n].posx0 ;
+    dy = scrolls[n].region->y - scrolls[n].posy0 ;
+
+    for ( nproc = 0, drawn = 0 ; nproc < scroll_lists[n].count ; nproc++ )
     {
-        /* Ordena la listilla */
+        i = scroll_lists[n].list[nproc]->instance ;
 
-        qsort( proclist, proclist_count, sizeof( INSTANCE * ), compare_instances ) ;
+        status = LOCDWORD( libscroll, i, STATUS ) & ~STATUS_WAITING_MASK ;
+        if ( status != STATUS_RUNNING && status != STATUS_FROZEN ) continue ;
 
-        /* Visualiza los procesos */
+        /* Skip the instances out of the clipping region. librender keeps their
+           bounding box, in scroll coordinates, updated every frame */
 
-        for ( nproc = 0 ; nproc < proclist_count ; nproc++ )
-        {
-            x = LOCDWORD( libscroll, proclist[nproc], COORDX ) ;
-            y = LOCDWORD( libscroll, proclist[nproc], COORDY ) ;
+        object = ( OBJECT * ) LOCDWORD( libscroll, i, OBJECTID ) ;
+        if ( object &&
+                (
+                    object->bbox.x2 + dx < r.x || object->bbox.x + dx > r.x2 ||
+                    object->bbox.y2 + dy < r.y || object->bbox.y + dy > r.y2
+                )
+           ) continue ;
 
-            RESOLXY( libscroll, proclist[nproc], x, y );
+        /* Draws of different Z are never reordered by the render batch */
+        if ( !drawn++ || scroll_lists[n].list[nproc]->z != z ) gr_batch_band() ;
+        z = scroll_lists[n].list[nproc]->z ;
 
-            draw_instance_at( proclist[nproc], &r, x - scrolls[n].posx0 + scrolls[n].region->x, y - scrolls[n].posy0 + scrolls[n].region->y, dest ) ;
-        }
+        x = LOCDWORD( libscroll, i, COORDX ) ;
+        y = LOCDWORD( libscroll, i, COORDY ) ;
+
+        RESOLXY( libscroll, i, x, y );
+
+        draw_instance_at( i, &r, x + dx, y + dy, dest ) ;
     }
 }
 
@@ -531,6 +840,66 @@ static int info_scroll( int n, REGION * clip, int * z, int * drawme )
 
 /* --------------------------------------------------------------------------- */
 
+/* ----------------------------------------------------------------------
+ Dlls Hooks
+   ---------------------------------------------------------------------- */
+
+/*
+ *  FUNCTION : instance_create_hook
+ *
+ *  PARAMS :
+ *      r           Pointer to the instance
+ *
+ *  RETURN VALUE :
+ *      None
+ */
+
+void __bgdexport( libscroll, instance_create_hook )( INSTANCE * r )
+{
+    SCROLL_MEMBER * m = ( SCROLL_MEMBER * ) calloc( 1, sizeof( SCROLL_MEMBER ) ) ;
+
+    LOCDWORD( libscroll, r, MEMBER ) = ( int ) m ;
+    if ( !m ) return ;
+
+    if ( scroll_members_count == scroll_members_reserved )
+    {
+        scroll_members_reserved = scroll_members_reserved ? scroll_members_reserved * 2 : 64 ;
+        scroll_members = ( SCROLL_MEMBER ** ) realloc( scroll_members, sizeof( SCROLL_MEMBER * ) * scroll_members_reserved ) ;
+    }
+
+    m->instance = r ;
+    m->index = scroll_members_count ;
+    scroll_members[scroll_members_count++] = m ;
+}
+
+/*
+ *  FUNCTION : instance_destroy_hook
+ *
+ *  PARAMS :
+ *      r           Pointer to the instance
+ *
+ *  RETURN VALUE :
+ *      None
+ */
+
+void __bgdexport( libscroll, instance_destroy_hook )( INSTANCE * r )
+{
+    SCROLL_MEMBER * m = ( SCROLL_MEMBER * ) LOCDWORD( libscroll, r, MEMBER ) ;
+
+    if ( !m ) return ;
+    LOCDWORD( libscroll, r, MEMBER ) = 0 ;
+
+    scroll_members[m->index] = scroll_members[--scroll_members_count] ;
+    scroll_members[m->index]->index = m->index ;
+
+    /* The scroll lists drop the record when they see it */
+    m->instance = NULL ;
+    m->scrolls = 0 ;
+    if ( !m->listed ) free( m ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+
 char * __bgdexport( libscroll, modules_dependency )[] =
 {
     "libgrbase",
@@ -73,6 +73,10 @@ typedef struct _scrolldata
     int active ;
 
     struct _scrolldata * follows ;
+
+    int32_t * tiles ;           /* Tilemap scrolls: graph codes, row by row (0 = empty) */
+    int tiles_w, tiles_h ;      /* Tilemap size, in tiles */
+    int tile_w, tile_h ;        /* Tile size, in pixels */
 }
 __PACKED
 scrolldata ;
@@ -108,6 +112,7 @@ extern scrolldata  scrolls[10] ;
 /* --------------------------------------------------------------------------- */
 
 extern void scroll_start( int n, int fileid, int graphid, int backid, int region, int flags, int destfile, int destid ) ;
+extern void scroll_start_tilemap( int n, int fileid, int32_t * tiles, int columns, int rows, int tile_w, int tile_h, int backid, int region, int flags, int destfile, int destid ) ;
 extern void scroll_stop( int n ) ;
 extern void scroll_update( int n );
 extern void scroll_draw( int n, REGION * clipping ) ;
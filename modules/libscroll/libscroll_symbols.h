@@ -57,7 +57,10 @@ DLCONSTANT __bgdexport( libscroll, constants_def )[] =
 
 char __bgdexport( libscroll, locals_def )[] =
     "ctype;\n"
-    "cnumber;\n";
+    "cnumber;\n"
+    "STRUCT _scroll_reserved_\n"
+    "member=0;\n"
+    "END\n";
 
 /* --------------------------------------------------------------------------- */
 
@@ -94,6 +97,8 @@ extern char __bgdexport( libscroll, globals_def )[];
 extern DLVARFIXUP __bgdexport( libscroll, locals_fixup )[];
 extern DLVARFIXUP __bgdexport( libscroll, globals_fixup )[];
 extern char __bgdexport( libscroll, modules_dependency )[];
+extern void __bgdexport( libscroll, instance_create_hook )( INSTANCE * r );
+extern void __bgdexport( libscroll, instance_destroy_hook )( INSTANCE * r );
 #endif
 
 #endif
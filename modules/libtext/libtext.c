@@ -52,6 +52,13 @@ int fntcolor32 = 0xFFFFFFFF;
 
 /* --------------------------------------------------------------------------- */
 
+typedef struct _text_glyph
+{
+    GRAPH * bitmap ;
+    int x ;
+    int y ;
+} TEXT_GLYPH;
+
 typedef struct _text
 {
     int id ;
@@ -77,6 +84,16 @@ typedef struct _text
     int _y ;
     int _width;
     int _height;
+    /* Layout of the last string drawn, relative to x, y */
+    char * _str ;
+    int _fontid ;
+    int _serial ;
+    int _alignment ;
+    int _dx ;
+    int _dy ;
+    TEXT_GLYPH * _glyphs ;
+    int _nglyphs ;
+    int _allocated ;
 } TEXT;
 
 TEXT texts[MAX_TEXTS] ;
@@ -194,89 +211,120 @@ static const char * get_text( TEXT * text )
     return NULL;
 }
 
+/* --------------------------------------------------------------------------- */
+/* Set the color used for 1 bit glyphs, white if none was given */
+
+static void text_setcolor( GRAPH * dest, int color8, int color16, int color32 )
+{
+    if ( color8 == -1 )
+    {
+        gr_setcolor(( dest->format->depth == 8 ) ? gr_find_nearest_color( 255, 255, 255 ) : gr_rgb_depth( dest->format->depth, 255, 255, 255 ) );
+    }
+    else
+    {
+        pixel_color8 = color8;
+        pixel_color16 = color16;
+        pixel_color32 = color32;
+    }
+}
+
 /* --------------------------------------------------------------------------- */
 /*
- *  FUNCTION : info_text
+ *  FUNCTION : text_layout
  *
- *  Returns information about a text object
+ *  Finds the size of a text object and the position of each glyph,
+ *  unless the string, font and alignment are the ones of the last call
  *
  *  PARAMS :
  *  text   Pointer to the text object
- *  bbox   Region to update with the text bounding box
+ *  font   Font of the text
+ *  str    String to show
  *
  *  RETURN VALUE :
- *      1 if the text has changed since last frame
+ *      0 if there is no memory for the layout, 1 otherwise
  *
  */
 
-static int info_text( TEXT * text, REGION * bbox, int * z, int * drawme )
+static int text_layout( TEXT * text, FONT * font, const char * str )
 {
-    const char * str = get_text( text );
-    REGION prev = *bbox;
-    FONT * font;
-    int changed = 0;
+    const unsigned char * ptr ;
+    unsigned char c ;
+    int len, x, height ;
 
-    * drawme = 0;
+    /* Pack the glyphs on first use, the renderer exists by now */
 
-    // Splinter
-    if ( !str || !*str )
-    {
-        /*        bbox->x = -2;
-                bbox->y = -2;
-                bbox->x2 = -2;
-                bbox->y2 = -2; */
-        return 0;
-    }
+    if ( !font->packed ) gr_font_pack( font ) ;
 
-    font = gr_font_get( text->fontid );
-    if ( !font )
-    {
-        /*        bbox->x = -2;
-                bbox->y = -2;
-                bbox->x2 = -2;
-                bbox->y2 = -2; */
-        return 0;
-    }
+    if ( text->_str &&
+         text->_fontid == text->fontid &&
+         text->_serial == font->serial &&
+         text->_alignment == text->alignment &&
+         !strcmp( text->_str, str ) ) return 1 ;
 
-    * drawme = 1;
+    len = strlen( str ) ;
 
-    * z = text->z;
+    if ( text->_str ) free( text->_str ) ;
+    text->_str = strdup( str ) ;
+    if ( !text->_str ) return 0 ;
 
-    /* Calculate the text dimensions */
+    if ( len > text->_allocated )
+    {
+        TEXT_GLYPH * glyphs = ( TEXT_GLYPH * ) realloc( text->_glyphs, len * sizeof( TEXT_GLYPH ) ) ;
+        if ( !glyphs )
+        {
+            free( text->_str ) ;
+            text->_str = NULL ;
+            return 0 ;
+        }
+        text->_glyphs = glyphs ;
+        text->_allocated = len ;
+    }
 
-    text->_x = text->x;
-    text->_y = text->y;
-    text->_width = gr_text_width( text->fontid, ( const unsigned char * ) str );
-    text->_height = gr_text_height_no_margin( text->fontid, ( const unsigned char * ) str );
+    text->_fontid = text->fontid ;
+    text->_serial = font->serial ;
+    text->_alignment = text->alignment ;
+    text->_nglyphs = 0 ;
 
-    /* Update the font's maxheight (if needed) */
+    x = 0 ;
+    height = 0 ;
 
-    if ( !font->maxheight )
+    for ( ptr = ( const unsigned char * ) str ; *ptr ; ptr++ )
     {
-        int c;
+        c = ( font->charset == CHARSET_ISO8859 ) ? dos_to_win[*ptr] : *ptr ;
 
-        for ( c = 0 ; c < 256 ; c++ )
+        if ( font->glyph[c].bitmap )
         {
-            if ( !font->glyph[c].bitmap ) continue;
-            if ( font->maxheight < ( int )font->glyph[c].bitmap->height + font->glyph[c].yoffset )
-                font->maxheight = ( int )font->glyph[c].bitmap->height + font->glyph[c].yoffset;
+            text->_glyphs[text->_nglyphs].bitmap = font->glyph[c].bitmap ;
+            text->_glyphs[text->_nglyphs].x = x + font->glyph[c].xoffset ;
+            text->_glyphs[text->_nglyphs].y = font->glyph[c].yoffset ;
+            text->_nglyphs++ ;
+
+            if ( height < font->glyph[c].yoffset + ( int )font->glyph[c].bitmap->height )
+                height = font->glyph[c].yoffset + ( int )font->glyph[c].bitmap->height ;
         }
+        x += font->glyph[c].xadvance ;
     }
 
+    text->_width = x ;
+    text->_height = height ;
+
     /* Adjust top-left coordinates for text alignment */
 
+    text->_dx = 0 ;
+    text->_dy = 0 ;
+
     switch ( text->alignment )
     {
         case ALIGN_TOP:             // 1
         case ALIGN_CENTER:          // 4
         case ALIGN_BOTTOM:          // 7
-            text->_x -= text->_width / 2;
+            text->_dx = -( text->_width / 2 );
             break;
 
         case ALIGN_TOP_RIGHT:       // 2
         case ALIGN_CENTER_RIGHT:    // 5
         case ALIGN_BOTTOM_RIGHT:    // 8
-            text->_x -= text->_width - 1;
+            text->_dx = -( text->_width - 1 );
             break;
     }
 
@@ -285,16 +333,78 @@ static int info_text( TEXT * text, REGION * bbox, int * z, int * drawme )
         case ALIGN_CENTER_LEFT:     // 3
         case ALIGN_CENTER:          // 4
         case ALIGN_CENTER_RIGHT:    // 5
-            text->_y -= font->maxheight / 2;
+            text->_dy = -( font->maxheight / 2 );
             break;
 
         case ALIGN_BOTTOM_LEFT:     // 6
         case ALIGN_BOTTOM:          // 7
         case ALIGN_BOTTOM_RIGHT:    // 8
-            text->_y -= font->maxheight - 1;
+            text->_dy = -( font->maxheight - 1 );
             break;
     }
 
+    return 1 ;
+}
+
+/* --------------------------------------------------------------------------- */
+/*
+ *  FUNCTION : info_text
+ *
+ *  Returns information about a text object
+ *
+ *  PARAMS :
+ *  text   Pointer to the text object
+ *  bbox   Region to update with the text bounding box
+ *
+ *  RETURN VALUE :
+ *      1 if the text has changed since last frame
+ *
+ */
+
+static int info_text( TEXT * text, REGION * bbox, int * z, int * drawme )
+{
+    const char * str = get_text( text );
+    REGION prev = *bbox;
+    FONT * font;
+    int changed = 0;
+
+    * drawme = 0;
+
+    // Splinter
+    if ( !str || !*str )
+    {
+        /*        bbox->x = -2;
+                bbox->y = -2;
+                bbox->x2 = -2;
+                bbox->y2 = -2; */
+        return 0;
+    }
+
+    font = gr_font_get( text->fontid );
+    if ( !font )
+    {
+        /*        bbox->x = -2;
+                bbox->y = -2;
+                bbox->x2 = -2;
+                bbox->y2 = -2; */
+        return 0;
+    }
+
+    /* Lay the text out again only if the string, font or alignment changed */
+
+    if ( !text_layout( text, font, str ) )
+    {
+        * drawme = 0;
+        return 0;
+    }
+
+    * drawme = 1;
+
+    * z = text->z;
+
+    text->_x = text->x + text->_dx;
+    text->_y = text->y + text->_dy;
+
     /* Fill the bounding box */
 
     bbox->x = text->_x;
@@ -368,35 +478,36 @@ static int info_text( TEXT * text, REGION * bbox, int * z, int * drawme )
 
 void draw_text( TEXT * text, REGION * clip )
 {
-    const char * str = get_text( text );
+    TEXT_GLYPH * glyph;
     int save8, save16, save32;
-    FONT * font;
+    int flags, n;
 
-    // Splinter
-    if ( !str ) return;
-
-    font = gr_font_get( text->fontid );
-    if ( !font )
+    if ( !gr_font_get( text->fontid ) )
     {
         gr_text_destroy( text->id );
         return;
     }
 
-    /* Draw the text */
+    // Splinter
+    if ( !text->_str ) return;
 
-    save8 = fntcolor8;
-    save16 = fntcolor16;
-    save32 = fntcolor32;
+    /* Draw the glyphs laid out by info_text. Packed glyphs share a texture,
+       so the whole text goes to the renderer as one batched draw */
 
-    fntcolor8 = text->color8;
-    fntcolor16 = text->color16;
-    fntcolor32 = text->color32;
+    flags = GLODWORD( libtext, TEXT_FLAGS );
 
-    if ( !gr_text_put( 0, clip, text->fontid, text->_x, text->_y, ( const unsigned char * ) str ) ) gr_text_destroy( text->id );
+    save8 = pixel_color8;
+    save16 = pixel_color16;
+    save32 = pixel_color32;
 
-    fntcolor8 = save8;
-    fntcolor16 = save16;
-    fntcolor32 = save32;
+    text_setcolor( scrbitmap, text->color8, text->color16, text->color32 );
+
+    for ( glyph = text->_glyphs, n = text->_nglyphs ; n-- ; glyph++ )
+        gr_blit( scrbitmap, clip, text->_x + glyph->x, text->_y + glyph->y, flags, glyph->bitmap, 1 ) ;
+
+    pixel_color8 = save8;
+    pixel_color16 = save16;
+    pixel_color32 = save32;
 }
 
 /* --------------------------------------------------------------------------- */
@@ -518,6 +629,18 @@ void gr_text_move2( int textid, int x, int y, int z )
 
 /* --------------------------------------------------------------------------- */
 
+static void text_free_layout( TEXT * text )
+{
+    if ( text->_str ) free( text->_str ) ;
+    if ( text->_glyphs ) free( text->_glyphs ) ;
+    text->_str = NULL ;
+    text->_glyphs = NULL ;
+    text->_nglyphs = 0 ;
+    text->_allocated = 0 ;
+}
+
+/* --------------------------------------------------------------------------- */
+
 void gr_text_destroy( int textid )
 {
     if ( !textid )
@@ -528,6 +651,7 @@ void gr_text_destroy( int textid )
             {
                 gr_destroy_object( texts[textid].objectid );
                 if ( texts[textid].text ) free( texts[textid].text ) ;
+                text_free_layout( &texts[textid] ) ;
                 texts[textid].on = 0 ;
             }
         }
@@ -541,6 +665,7 @@ void gr_text_destroy( int textid )
 
         gr_destroy_object( texts[textid].objectid );
         if ( texts[textid].text ) free( texts[textid].text ) ;
+        text_free_layout( &texts[textid] ) ;
         texts[textid].on = 0 ;
         if ( textid == text_nextid - 1 )
         {
@@ -687,16 +812,7 @@ int gr_text_put( GRAPH * dest, REGION * clip, int fontid, int x, int y, const un
     save16 = pixel_color16;
     save32 = pixel_color32;
 
-    if ( fntcolor8 == -1 )
-    {
-        gr_setcolor(( dest->format->depth == 8 ) ? gr_find_nearest_color( 255, 255, 255 ) : gr_rgb_depth( dest->format->depth, 255, 255, 255 ) );
-    }
-    else
-    {
-        pixel_color8 = fntcolor8;
-        pixel_color16 = fntcolor16;
-        pixel_color32 = fntcolor32;
-    }
+    text_setcolor( dest, fntcolor8, fntcolor16, fntcolor32 );
 
     while ( *text )
     {
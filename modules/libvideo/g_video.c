@@ -320,6 +320,9 @@ int gr_set_mode( int width, int height, int depth )
 
     // Store the renderer info too
     SDL_GetRendererInfo(renderer, &renderer_info);
+    // The software renderer has no texture size limit, and reports 0
+    if (!renderer_info.max_texture_width) renderer_info.max_texture_width = 65536;
+    if (!renderer_info.max_texture_height) renderer_info.max_texture_height = 65536;
     // Store the renderer resolution
     SDL_GetRendererOutputSize(renderer, &renderer_width, &renderer_height);
 
@@ -2272,6 +2272,7 @@ static void console_do( const char * command )
                     LOCDWORD( mod_debug, i, STATUS ) = ( LOCDWORD( mod_debug, i, STATUS ) & STATUS_WAITING_MASK ) | STATUS_FROZEN ;
                     break;
             }
+            instance_status_changed( i );
             strcpy( action, oaction );
             ptr = optr;
         }
@@ -2309,6 +2310,7 @@ static void console_do( const char * command )
                 LOCDWORD( mod_debug, i, STATUS ) = ( LOCDWORD( mod_debug, i, STATUS ) & STATUS_WAITING_MASK ) | STATUS_FROZEN ;
                 break;
         }
+        instance_status_changed( i );
         console_printf( "¬07OK" );
         return ;
     }
@@ -61,6 +61,7 @@ enum {
     GRPROC_TYPE_SCAN = 0,
     GRPROC_ID_SCAN,
     GRPROC_CONTEXT,
+    GRPROC_BROADPHASE,
     PROCESS_ID,
     PROCESS_TYPE,
     STATUS,
@@ -93,6 +94,7 @@ char * __bgdexport( mod_grproc, locals_def ) =
     "int type_scan;\n"
     "int id_scan;\n"
     "int context;\n"
+    "int broadphase;\n"
     "END\n";
 
 /* ----------------------------------------------------------------- */
@@ -103,6 +105,7 @@ DLVARFIXUP __bgdexport( mod_grproc, locals_fixup )[]  =
     { "_mod_grproc_reserved.type_scan"  , NULL, -1, -1 },
     { "_mod_grproc_reserved.id_scan"    , NULL, -1, -1 },
     { "_mod_grproc_reserved.context"    , NULL, -1, -1 },
+    { "_mod_grproc_reserved.broadphase" , NULL, -1, -1 },
 
     { "id"                              , NULL, -1, -1 },
     { "reserved.process_type"           , NULL, -1, -1 },
@@ -850,6 +853,375 @@ static int check_collision( INSTANCE * proc1, GRAPH * bmp1, REGION * bbox3, INST
     return 0;
 }
 
+/* --------------------------------------------------------------------------- */
+/* Broadphase                                                                  */
+/* --------------------------------------------------------------------------- */
+
+/* Uniform grid of (1 << BP_CELL_SHIFT) pixel cells, hashed into BP_BUCKETS
+ * buckets. Every instance owns an entry whose index + 1 is kept in the
+ * _mod_grproc_reserved.broadphase local. Entries are refreshed lazily: an
+ * instance is marked dirty when it's created or about to run, and the dirty
+ * list is flushed before each query. Every entry is also revalidated at the
+ * start of each frame, so the whole index costs O(n) per frame.
+ *
+ * Frozen or sleeping processes, and positions changed from another process
+ * (father.x = ...), are seen from the next frame on, so the index is off by
+ * default and COLLISION_BROADPHASE(1) turns it on.
+ */
+
+#define BP_CELL_SHIFT       6
+#define BP_BUCKETS          4096
+#define BP_MAX_CELLS        64
+
+#define BP_CELL_HASH(cx,cy) (((( unsigned int )(cx) * 73856093U ) ^ (( unsigned int )(cy) * 19349663U )) & ( BP_BUCKETS - 1 ))
+
+typedef struct
+{
+    INSTANCE * inst ;
+    REGION     box ;                /* Collision bbox, grown to hold the collision circle */
+    int        cx, cy, cx2, cy2 ;   /* Cells covered, cx > cx2 if not linked */
+    int        large ;              /* Linked on bp_large instead of the grid */
+    int        dirty ;
+    int        next_free ;
+    uint32_t   stamp ;
+    uint32_t   order ;              /* Creation order, first_instance has the highest */
+} BP_ENTRY ;
+
+typedef struct
+{
+    int * items ;
+    int   count ;
+    int   allocated ;
+} BP_LIST ;
+
+static int collision_broadphase = 0 ;
+
+static BP_ENTRY * bp_entries = NULL ;
+static int bp_entries_count = 0 ;
+static int bp_entries_allocated = 0 ;
+static int bp_first_free = -1 ;
+
+static BP_LIST bp_buckets[ BP_BUCKETS ] ;
+static BP_LIST bp_large = { NULL, 0, 0 } ;
+static BP_LIST bp_dirty = { NULL, 0, 0 } ;
+
+static uint32_t bp_stamp = 0 ;
+static uint32_t bp_order = 0 ;
+static INSTANCE * bp_running = NULL ;
+
+static int * bp_result = NULL ;
+static int bp_result_allocated = 0 ;
+
+/* --------------------------------------------------------------------------- */
+
+static void bp_list_add( BP_LIST * l, int e )
+{
+    if ( l->count >= l->allocated )
+    {
+        l->allocated = l->allocated ? l->allocated * 2 : 8 ;
+        l->items = ( int * ) realloc( l->items, l->allocated * sizeof( int ) ) ;
+    }
+    l->items[ l->count++ ] = e ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static void bp_list_remove( BP_LIST * l, int e )
+{
+    int n ;
+
+    for ( n = 0 ; n < l->count ; n++ )
+    {
+        if ( l->items[ n ] == e )
+        {
+            l->items[ n ] = l->items[ --l->count ] ;
+            return ;
+        }
+    }
+}
+
+/* --------------------------------------------------------------------------- */
+
+static void bp_unlink( int e )
+{
+    BP_ENTRY * entry = &bp_entries[ e ] ;
+    int cx, cy ;
+
+    if ( entry->large )
+        bp_list_remove( &bp_large, e ) ;
+    else
+        for ( cy = entry->cy ; cy <= entry->cy2 ; cy++ )
+            for ( cx = entry->cx ; cx <= entry->cx2 ; cx++ )
+                bp_list_remove( &bp_buckets[ BP_CELL_HASH( cx, cy ) ], e ) ;
+
+    entry->cx = 1 ; entry->cx2 = 0 ;
+    entry->cy = 1 ; entry->cy2 = 0 ;
+    entry->large = 0 ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static void bp_grow( REGION * bbox, REGION * dest )
+{
+    int dx = bbox->x2 - bbox->x + 1, dy = bbox->y2 - bbox->y + 1 ;
+    int cx = bbox->x + dx / 2, cy = bbox->y + dy / 2 ;
+    int r = ( dx + dy ) / 4 + 1 ;
+
+    dest->x  = MIN( bbox->x , cx - r ) ;
+    dest->y  = MIN( bbox->y , cy - r ) ;
+    dest->x2 = MAX( bbox->x2, cx + r ) ;
+    dest->y2 = MAX( bbox->y2, cy + r ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static void bp_update( int e )
+{
+    BP_ENTRY * entry = &bp_entries[ e ] ;
+    GRAPH * bmp ;
+    REGION bbox ;
+    int cx, cy, cx2, cy2 ;
+
+    bmp = instance_collision_graph( entry->inst ) ;
+    if ( !bmp )
+    {
+        bp_unlink( e ) ;
+        return ;
+    }
+
+    instance_get_bbox( entry->inst, bmp, &bbox ) ;
+    bp_grow( &bbox, &entry->box ) ;
+
+    cx  = entry->box.x  >> BP_CELL_SHIFT ;
+    cy  = entry->box.y  >> BP_CELL_SHIFT ;
+    cx2 = entry->box.x2 >> BP_CELL_SHIFT ;
+    cy2 = entry->box.y2 >> BP_CELL_SHIFT ;
+
+    /* Same cells, nothing to relink */
+    if ( cx == entry->cx && cy == entry->cy && cx2 == entry->cx2 && cy2 == entry->cy2 ) return ;
+
+    bp_unlink( e ) ;
+
+    entry->cx = cx ; entry->cx2 = cx2 ;
+    entry->cy = cy ; entry->cy2 = cy2 ;
+
+    if ( ( cx2 - cx + 1 ) * ( cy2 - cy + 1 ) > BP_MAX_CELLS )
+    {
+        entry->large = 1 ;
+        bp_list_add( &bp_large, e ) ;
+        return ;
+    }
+
+    for ( cy = entry->cy ; cy <= entry->cy2 ; cy++ )
+        for ( cx = entry->cx ; cx <= entry->cx2 ; cx++ )
+            bp_list_add( &bp_buckets[ BP_CELL_HASH( cx, cy ) ], e ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static int bp_entry( INSTANCE * r )
+{
+    int e = LOCDWORD( mod_grproc, r, GRPROC_BROADPHASE ) - 1 ;
+
+    if ( e >= 0 && e < bp_entries_count && bp_entries[ e ].inst == r ) return e ;
+    return -1 ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static void bp_mark_dirty( INSTANCE * r )
+{
+    int e = bp_entry( r ) ;
+
+    if ( e < 0 || bp_entries[ e ].dirty ) return ;
+
+    bp_entries[ e ].dirty = 1 ;
+    bp_list_add( &bp_dirty, e ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static void bp_flush()
+{
+    BP_ENTRY * entry ;
+    int n, e ;
+
+    for ( n = 0 ; n < bp_dirty.count ; n++ )
+    {
+        e = bp_dirty.items[ n ] ;
+        entry = &bp_entries[ e ] ;
+        entry->dirty = 0 ;
+
+        /* Destroyed while dirty, now it can be recycled */
+        if ( !entry->inst )
+        {
+            entry->next_free = bp_first_free ;
+            bp_first_free = e ;
+            continue ;
+        }
+
+        bp_update( e ) ;
+    }
+    bp_dirty.count = 0 ;
+
+    if ( bp_running && ( e = bp_entry( bp_running ) ) >= 0 ) bp_update( e ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Instances are added at the head of the instance list, so list order is
+   the reverse of creation order */
+
+static int bp_compare_order( const void * a, const void * b )
+{
+    uint32_t oa = bp_entries[ *( int * ) a ].order ;
+    uint32_t ob = bp_entries[ *( int * ) b ].order ;
+
+    return ( oa < ob ) - ( oa > ob ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static int bp_check_entry( int e, INSTANCE * my, REGION * box, int ctype, int type, int count )
+{
+    BP_ENTRY * entry = &bp_entries[ e ] ;
+    INSTANCE * ptr = entry->inst ;
+    int status ;
+
+    if ( entry->stamp == bp_stamp ) return count ;
+    entry->stamp = bp_stamp ;
+
+    if ( !ptr || ptr == my ||
+         entry->box.x > box->x2 || entry->box.x2 < box->x ||
+         entry->box.y > box->y2 || entry->box.y2 < box->y ||
+         ctype != LOCDWORD( mod_grproc, ptr, CTYPE ) ||
+         ( type && type != LOCDWORD( mod_grproc, ptr, PROCESS_TYPE ) ) ) return count ;
+
+    status = LOCDWORD( mod_grproc, ptr, STATUS ) & ~STATUS_WAITING_MASK ;
+    if ( status != STATUS_RUNNING && status != STATUS_FROZEN ) return count ;
+
+    if ( count >= bp_result_allocated )
+    {
+        bp_result_allocated = bp_result_allocated ? bp_result_allocated * 2 : 64 ;
+        bp_result = ( int * ) realloc( bp_result, bp_result_allocated * sizeof( int ) ) ;
+    }
+    bp_result[ count++ ] = e ;
+
+    return count ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Returns in bp_result the entries whose box overlaps with my collision
+   bbox, in instance list order */
+
+static int bp_query( INSTANCE * my, REGION * bbox, int ctype, int type )
+{
+    REGION box ;
+    BP_LIST * l ;
+    int cx, cy, cx2, cy2, n, count = 0 ;
+    int e ;
+
+    bp_flush() ;
+    if ( ( e = bp_entry( my ) ) >= 0 ) bp_update( e ) ;
+
+    if ( !++bp_stamp )
+    {
+        for ( n = 0 ; n < bp_entries_count ; n++ ) bp_entries[ n ].stamp = 0 ;
+        bp_stamp = 1 ;
+    }
+
+    bp_grow( bbox, &box ) ;
+
+    for ( n = 0 ; n < bp_large.count ; n++ )
+        count = bp_check_entry( bp_large.items[ n ], my, &box, ctype, type, count ) ;
+
+    cx  = box.x  >> BP_CELL_SHIFT ;
+    cy  = box.y  >> BP_CELL_SHIFT ;
+    cx2 = box.x2 >> BP_CELL_SHIFT ;
+    cy2 = box.y2 >> BP_CELL_SHIFT ;
+
+    if ( ( cx2 - cx + 1 ) * ( cy2 - cy + 1 ) > BP_BUCKETS )
+    {
+        /* Huge query, every bucket would be visited anyway */
+        for ( e = 0 ; e < bp_entries_count ; e++ )
+            if ( bp_entries[ e ].cx <= bp_entries[ e ].cx2 && !bp_entries[ e ].large )
+                count = bp_check_entry( e, my, &box, ctype, type, count ) ;
+    }
+    else
+    {
+        for ( ; cy <= cy2 ; cy++ )
+            for ( e = cx ; e <= cx2 ; e++ )
+            {
+                l = &bp_buckets[ BP_CELL_HASH( e, cy ) ] ;
+                for ( n = 0 ; n < l->count ; n++ )
+                    count = bp_check_entry( l->items[ n ], my, &box, ctype, type, count ) ;
+            }
+    }
+
+    if ( count > 1 ) qsort( bp_result, count, sizeof( int ), bp_compare_order ) ;
+
+    return count ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Scan mode: candidates are visited in instance list order, as the full
+   scan does. The last hit is kept in id_scan (its id, any type) or context
+   (its creation order, by type), so loops like
+   WHILE ( ( id = collision( TYPE enemy ) ) ) keep working */
+
+static int __collision_broadphase( INSTANCE * my, int id, int ( *colfunc )( INSTANCE *, GRAPH *, REGION *, INSTANCE * ), GRAPH * bmp1, REGION * bbox1, int ctype )
+{
+    BP_ENTRY * entry ;
+    INSTANCE * ptr ;
+    uint32_t last = 0 ;
+    int n, e, count ;
+
+    if ( !id )
+    {
+        LOCDWORD( mod_grproc, my, GRPROC_TYPE_SCAN ) = 0 ;
+        if ( LOCDWORD( mod_grproc, my, GRPROC_ID_SCAN ) )
+        {
+            /* Last hit is gone, the full scan ends here too */
+            if ( !( ptr = instance_get( LOCDWORD( mod_grproc, my, GRPROC_ID_SCAN ) ) ) || ( e = bp_entry( ptr ) ) < 0 ) return 0 ;
+            last = bp_entries[ e ].order ;
+        }
+    }
+    else
+    {
+        LOCDWORD( mod_grproc, my, GRPROC_ID_SCAN ) = 0 ;
+        if ( LOCDWORD( mod_grproc, my, GRPROC_TYPE_SCAN ) != id ) /* Check if type change from last call */
+        {
+            LOCDWORD( mod_grproc, my, GRPROC_CONTEXT ) = 0 ;
+            LOCDWORD( mod_grproc, my, GRPROC_TYPE_SCAN ) = id ;
+        }
+        last = LOCDWORD( mod_grproc, my, GRPROC_CONTEXT ) ;
+    }
+
+    count = bp_query( my, bbox1, ctype, id ) ;
+
+    for ( n = 0 ; n < count ; n++ )
+    {
+        entry = &bp_entries[ bp_result[ n ] ] ;
+        if ( last && entry->order >= last ) continue ;
+
+        if ( colfunc( my, bmp1, bbox1, entry->inst ) )
+        {
+            if ( !id )
+                LOCDWORD( mod_grproc, my, GRPROC_ID_SCAN ) = LOCDWORD( mod_grproc, entry->inst, PROCESS_ID ) ;
+            else
+                LOCDWORD( mod_grproc, my, GRPROC_CONTEXT ) = entry->order ;
+            return LOCDWORD( mod_grproc, entry->inst, PROCESS_ID ) ;
+        }
+    }
+
+    /* End of a scan by type, next call starts again */
+    if ( id ) LOCDWORD( mod_grproc, my, GRPROC_CONTEXT ) = 0 ;
+
+    return 0 ;
+}
+
 /* --------------------------------------------------------------------------- */
 
 static int __collision( INSTANCE * my, int id, int colltype )
@@ -888,6 +1260,8 @@ static int __collision( INSTANCE * my, int id, int colltype )
     /* Checks only for a single instance */
     if ( id >= FIRST_INSTANCE_ID ) return ( ( ( ptr = instance_get( id ) ) && ctype == LOCDWORD( mod_grproc, ptr, CTYPE ) ) ? colfunc( my, bmp1, &bbox1, ptr ) : 0 ) ;
 
+    if ( collision_broadphase ) return __collision_broadphase( my, id, colfunc, bmp1, &bbox1, ctype ) ;
+
     /* we must use full list of instances or get types from it */
     ptr = first_instance ;
 
@@ -968,25 +1342,130 @@ static int grproc_collision_circle( INSTANCE * my, int * params )
 
 /* ----------------------------------------------------------------- */
 
+static int grproc_collision_broadphase( INSTANCE * my, int * params )
+{
+    int old = collision_broadphase ;
+    INSTANCE * i ;
+
+    collision_broadphase = params[ 0 ] ? 1 : 0 ;
+
+    /* Scan state means different things in each mode, restart any scan */
+    if ( old != collision_broadphase )
+    {
+        for ( i = first_instance ; i ; i = i->next )
+        {
+            LOCDWORD( mod_grproc, i, GRPROC_ID_SCAN ) = 0;
+            LOCDWORD( mod_grproc, i, GRPROC_TYPE_SCAN ) = 0;
+            LOCDWORD( mod_grproc, i, GRPROC_CONTEXT ) = 0;
+
+            /* Boxes may have changed while the index was off */
+            if ( collision_broadphase ) bp_mark_dirty( i );
+        }
+    }
+
+    return old ;
+}
+
+/* ----------------------------------------------------------------- */
+
+/* Revalidates every entry at frame start, so processes that didn't run
+   last frame, or were moved by others, are found in their current cells */
+
+static void bp_frame_hook()
+{
+    int e ;
+
+    if ( !collision_broadphase ) return ;
+
+    bp_flush() ;
+    bp_running = NULL ;
+
+    for ( e = 0 ; e < bp_entries_count ; e++ )
+        if ( bp_entries[ e ].inst ) bp_update( e ) ;
+}
+
+/* ----------------------------------------------------------------- */
+
 void __bgdexport( mod_grproc, process_exec_hook )( INSTANCE * r )
 {
     LOCDWORD( mod_grproc, r, GRPROC_ID_SCAN ) = 0;
     LOCDWORD( mod_grproc, r, GRPROC_TYPE_SCAN ) = 0;
     LOCDWORD( mod_grproc, r, GRPROC_CONTEXT ) = 0;
+
+    /* The previous process is done, keep its last position */
+    if ( bp_running ) bp_mark_dirty( bp_running );
+    bp_mark_dirty( r );
+    bp_running = r;
+}
+
+/* ----------------------------------------------------------------- */
+
+void __bgdexport( mod_grproc, instance_create_hook )( INSTANCE * r )
+{
+    BP_ENTRY * entry ;
+    int e ;
+
+    if ( bp_first_free >= 0 )
+    {
+        e = bp_first_free ;
+        bp_first_free = bp_entries[ e ].next_free ;
+    }
+    else
+    {
+        if ( bp_entries_count >= bp_entries_allocated )
+        {
+            bp_entries_allocated = bp_entries_allocated ? bp_entries_allocated * 2 : 256 ;
+            bp_entries = ( BP_ENTRY * ) realloc( bp_entries, bp_entries_allocated * sizeof( BP_ENTRY ) ) ;
+        }
+        e = bp_entries_count++ ;
+    }
+
+    entry = &bp_entries[ e ] ;
+    memset( entry, 0, sizeof( BP_ENTRY ) ) ;
+    entry->inst = r ;
+    entry->order = ++bp_order ;
+    entry->cx = 1 ; entry->cx2 = 0 ;
+    entry->cy = 1 ; entry->cy2 = 0 ;
+
+    /* Clones inherit the father's locals, so always overwrite */
+    LOCDWORD( mod_grproc, r, GRPROC_BROADPHASE ) = e + 1 ;
+
+    bp_mark_dirty( r ) ;
+}
+
+/* ----------------------------------------------------------------- */
+
+void __bgdexport( mod_grproc, instance_destroy_hook )( INSTANCE * r )
+{
+    int e = bp_entry( r ) ;
+
+    if ( r == bp_running ) bp_running = NULL ;
+    if ( e < 0 ) return ;
+
+    bp_unlink( e ) ;
+    bp_entries[ e ].inst = NULL ;
+
+    /* Dirty entries are recycled by bp_flush() */
+    if ( !bp_entries[ e ].dirty )
+    {
+        bp_entries[ e ].next_free = bp_first_free ;
+        bp_first_free = e ;
+    }
 }
 
 /* ---------------------------------------------------------------------- */
 
 DLSYSFUNCS  __bgdexport( mod_grproc, functions_exports )[] =
 {
-    { "ADVANCE"             , "I"   , TYPE_INT  , grproc_advance            },
-    { "XADVANCE"            , "II"  , TYPE_INT  , grproc_xadvance           },
+    { "ADVANCE"             , "I"   , TYPE_INT  , grproc_advance            , SYSFUNC_THREADSAFE },
+    { "XADVANCE"            , "II"  , TYPE_INT  , grproc_xadvance           , SYSFUNC_THREADSAFE },
 
     { "GET_ANGLE"           , "I"   , TYPE_INT  , grproc_get_angle          },
     { "GET_DIST"            , "I"   , TYPE_INT  , grproc_get_dist           },
     { "COLLISION"           , "I"   , TYPE_INT  , grproc_collision          },
     { "COLLISION_BOX"       , "I"   , TYPE_INT  , grproc_collision_box      },
     { "COLLISION_CIRCLE"    , "I"   , TYPE_INT  , grproc_collision_circle   },
+    { "COLLISION_BROADPHASE", "I"   , TYPE_INT  , grproc_collision_broadphase },
 
     { "GET_REAL_POINT"      , "IPP" , TYPE_INT  , grproc_get_real_point     },
 
@@ -995,6 +1474,17 @@ DLSYSFUNCS  __bgdexport( mod_grproc, functions_exports )[] =
 
 /* --------------------------------------------------------------------------- */
 
+/* Bigest priority first execute
+   Lowest priority last execute */
+
+HOOK __bgdexport( mod_grproc, handler_hooks )[] =
+{
+    { 4000, bp_frame_hook },
+    {    0, NULL          }
+} ;
+
+/* --------------------------------------------------------------------------- */
+
 char * __bgdexport( mod_grproc, modules_dependency )[] =
 {
     "libmouse",
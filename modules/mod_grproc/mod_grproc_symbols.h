@@ -37,6 +37,7 @@ char __bgdexport( mod_grproc, locals_def )[] =
     "int type_scan;\n"
     "int id_scan;\n"
     "int context;\n"
+    "int broadphase;\n"
     "END\n";
 
 DLSYSFUNCS  __bgdexport( mod_grproc, functions_exports )[] =
@@ -49,6 +50,7 @@ DLSYSFUNCS  __bgdexport( mod_grproc, functions_exports )[] =
     { "COLLISION"           , "I"   , TYPE_INT  , 0 },
     { "COLLISION_BOX"       , "I"   , TYPE_INT  , 0 },
     { "COLLISION_CIRCLE"    , "I"   , TYPE_INT  , 0 },
+    { "COLLISION_BROADPHASE", "I"   , TYPE_INT  , 0 },
 
     { "GET_REAL_POINT"      , "IPP" , TYPE_INT  , 0 },
 
@@ -71,6 +73,9 @@ extern char __bgdexport( mod_grproc, locals_def )[];
 extern DLVARFIXUP __bgdexport( mod_grproc, locals_fixup )[];
 extern DLVARFIXUP __bgdexport( mod_grproc, globals_fixup )[];
 extern void __bgdexport( mod_grproc, process_exec_hook )( INSTANCE * r );
+extern void __bgdexport( mod_grproc, instance_create_hook )( INSTANCE * r );
+extern void __bgdexport( mod_grproc, instance_destroy_hook )( INSTANCE * r );
+extern HOOK __bgdexport( mod_grproc, handler_hooks )[];
 extern DLSYSFUNCS  __bgdexport( mod_grproc, functions_exports )[];
 extern char * __bgdexport( mod_grproc, modules_dependency )[];
 #endif
@@ -48,18 +48,47 @@ struct
 
 /* --------------------------------------------------------------------------- */
 
+/* Read the pixels of a map with a single read, then move the rows to
+ * their place in the (dword aligned) data, last one first */
+
+static int gr_read_pixels( file * fp, GRAPH * gr )
+{
+    uint8_t * data = ( uint8_t * ) gr->data ;
+    uint32_t y ;
+
+    if ( !file_read( fp, data, gr->widthb * gr->height ) ) return 0 ;
+
+    if ( gr->pitch != gr->widthb )
+        for ( y = gr->height - 1 ; y > 0 ; y-- )
+            memmove( data + gr->pitch * y, data + gr->widthb * y, gr->widthb ) ;
+
+    for ( y = 0 ; y < gr->height ; y++ )
+    {
+        if ( gr->format->depth == 32 )
+        {
+            ARRANGE_DWORDS( data + gr->pitch * y, gr->width ) ;
+        }
+        else if ( gr->format->depth == 16 )
+        {
+            ARRANGE_WORDS( data + gr->pitch * y, gr->width ) ;
+        }
+    }
+
+    return 1 ;
+}
+
+/* --------------------------------------------------------------------------- */
+
 /* Static convenience function */
 static int gr_read_lib( file * fp )
 {
     char header[8] ;
     short int px, py ;
     int bpp, libid, code;
-    uint32_t   y ;
     unsigned c;
     GRLIB * lib ;
     GRAPH * gr ;
     PALETTE * pal = NULL ;
-    int st = 0;
 
     libid = grlib_new() ;
     if ( libid < 0 ) return -1 ;
@@ -101,7 +130,8 @@ static int gr_read_lib( file * fp )
 
         /* Cabecera del gráfico */
 
-        gr = bitmap_new( chunk.code, chunk.width, chunk.height, bpp ) ;
+        /* The texture is created by the main thread, see below */
+        gr = bitmap_new_deferred( chunk.code, chunk.width, chunk.height, bpp ) ;
         if ( !gr )
         {
             grlib_destroy( libid ) ;
@@ -146,41 +176,29 @@ static int gr_read_lib( file * fp )
 
         /* Datos del gráfico */
 
-        for ( y = 0 ; y < gr->height ; y++ )
+        if ( !gr_read_pixels( fp, gr ) )
         {
-            uint8_t * line = ( uint8_t * )gr->data + gr->pitch * y;
-
-            switch ( bpp )
-            {
-                case    32:
-                    st = file_readUint32A( fp, ( uint32_t * ) line, gr->width );
-                    break;
-                case    16:
-                    st = file_readUint16A( fp, ( uint16_t * ) line, gr->width );
-                    break;
-                case    8:
-                case    1:
-                    st = file_read( fp, line, gr->widthb );
-                    break;
-            }
-
-            if ( !st ) {
-                bitmap_destroy( gr );
-                grlib_destroy( libid ) ;
-                if ( bpp == 8 ) pal_destroy( pal );
-                return -1 ;
-            }
+            bitmap_destroy( gr );
+            grlib_destroy( libid ) ;
+            if ( bpp == 8 ) pal_destroy( pal );
+            return -1 ;
         }
 
         code = grlib_add_map( libid, gr ) ;
-        if(bpp >= 16) {
-            bitmap_update_texture(gr);
-        }
         if ( bpp == 8 ) pal_map_assign( libid, code, pal ) ;
     }
 
     if ( bpp == 8 ) pal_destroy( pal ) ; // Elimino la instancia inicial
 
+    /* The textures are created before the next frame, or when first
+       drawn. This keeps SDL render calls out of background loads (LOAD_FPG
+       with an id pointer runs in its own thread). The maps are queued only
+       now: until the library is complete, an error destroys it here, and
+       the main thread must not be uploading any of its maps meanwhile */
+    lib = grlib_get( libid ) ;
+    for ( c = 0 ; c < ( unsigned ) lib->map_reserved ; c++ )
+        if ( lib->maps[c] ) bitmap_queue_texture( lib->maps[c] ) ;
+
     return libid ;
 }
 
@@ -368,6 +368,8 @@ int gr_save_png( GRAPH * gr, const char * filename )
 {
     if ( !gr ) return( 0 ) ;
 
+    bitmap_sync_data( gr ) ;
+
     FILE * file = fopen( filename, "wb" ) ;
     png_structp png_ptr ;
     png_infop info_ptr ;
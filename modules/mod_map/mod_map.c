@@ -56,6 +56,7 @@
 #define G_DEPTH         5
 
 #define B_CLEAR         0x00000001
+#define B_TARGET        0x00000002
 
 /* --------------------------------------------------------------------------- */
 
@@ -71,6 +72,7 @@ DLCONSTANT __bgdexport( mod_map, constants_def )[] =
     { "G_DEPTH"         , TYPE_INT, G_DEPTH             },
 
     { "B_CLEAR"         , TYPE_INT, B_CLEAR             },
+    { "B_TARGET"        , TYPE_INT, B_TARGET            },
 
     { "CHARSET_ISO8859" , TYPE_INT, CHARSET_ISO8859     },
     { "CHARSET_CP850"   , TYPE_INT, CHARSET_CP850       },
@@ -216,9 +218,57 @@ static int modmap_map_buffer( INSTANCE * my, int * params )
     else
         map = background ;
 
+    if ( map ) bitmap_sync_data( map ) ;
+
     return map ? ( int )map->data : 0 ;
 }
 
+/* ---------------------------------------------------------------------- */
+/**
+   int MAP_CHECKSUM(INT FILE, INT GRAPH)
+   Returns a hash (FNV-1a) of the pixels of the graphic, to compare
+   drawing results between runs or blitter versions
+ **/
+
+static int modmap_map_checksum( INSTANCE * my, int * params )
+{
+    GRAPH * map = bitmap_get( params[0], params[1] ) ;
+    uint32_t hash = 2166136261u ;
+    uint8_t * ptr, * end ;
+    uint32_t y ;
+
+    if ( !map || !map->data ) return 0 ;
+
+    bitmap_sync_data( map ) ;
+
+    for ( y = 0 ; y < map->height ; y++ )
+    {
+        ptr = ( uint8_t * ) map->data + y * map->pitch ;
+        end = ptr + map->widthb ;
+        while ( ptr < end ) hash = ( hash ^ *ptr++ ) * 16777619u ;
+    }
+
+    return ( int ) hash ;
+}
+
+/* ---------------------------------------------------------------------- */
+/**
+   int BLIT_SIMD(INT LEVEL)
+   Selects the instruction set of the software blitter (BLIT_SIMD_NONE
+   for the plain C version, BLIT_SIMD_AUTO for the best one available).
+   Returns the one in use.
+ **/
+
+static int modmap_blit_simd( INSTANCE * my, int * params )
+{
+    return gr_blit_simd_set( params[0] ) ;
+}
+
+static int modmap_blit_simd_get( INSTANCE * my, int * params )
+{
+    return gr_blit_simd_level() ;
+}
+
 /* --------------------------------------------------------------------------- */
 
 static int modmap_map_clear( INSTANCE * my, int * params )
@@ -242,9 +292,13 @@ static int modmap_new_map( INSTANCE * my, int * params )
 
 static int modmap_new_map_extend( INSTANCE * my, int * params )
 {
-    GRAPH * map ;
-    map = bitmap_new_syslib( params[0], params[1], params[2] ) ;
-    if ( map && ( params[3] & B_CLEAR )) gr_clear( map );
+    GRAPH * map = NULL ;
+
+    /* Drawn by the renderer if it can, as a normal map otherwise */
+    if ( params[3] & B_TARGET ) map = bitmap_new_target_syslib( params[0], params[1], params[2] ) ;
+    if ( !map ) map = bitmap_new_syslib( params[0], params[1], params[2] ) ;
+
+    if ( map && ( params[3] & ( B_CLEAR | B_TARGET ) ) ) gr_clear( map );
     return map ? map->code : 0 ;
 }
 
@@ -580,6 +634,20 @@ static int modmap_unload_fpg( INSTANCE * my, int * params )
 
 /* --------------------------------------------------------------------------- */
 
+static int modmap_fpg_atlas( INSTANCE * my, int * params )
+{
+    return grlib_atlas( params[0], 1 ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static int modmap_fpg_atlas2( INSTANCE * my, int * params )
+{
+    return grlib_atlas( params[0], params[1] ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+
 static int modmap_fpg_exists( INSTANCE * my, int * params )
 {
     GRLIB * lib = grlib_get( params[0] );
@@ -751,6 +819,7 @@ static int modmap_set_glyph( INSTANCE * my, int * params )
             }
             grlib_add_map( 0, font->glyph[c].bitmap );
         }
+        gr_font_changed( params[0] );
     }
     return 0;
 }
@@ -832,6 +901,9 @@ DLSYSFUNCS  __bgdexport( mod_map, functions_exports )[] =
     { "MAP_LOAD"            , "SP"          , TYPE_INT      , modmap_bgload_map         },
     { "MAP_SAVE"            , "IIS"         , TYPE_INT      , modmap_save_map           },
     { "MAP_BUFFER"          , "II"          , TYPE_POINTER  , modmap_map_buffer         },
+    { "MAP_CHECKSUM"        , "II"          , TYPE_INT      , modmap_map_checksum       },
+    { "BLIT_SIMD"           , "I"           , TYPE_INT      , modmap_blit_simd          },
+    { "BLIT_SIMD"           , ""            , TYPE_INT      , modmap_blit_simd_get      },
 
     /* FPG */
     { "FPG_ADD"             , "IIII"        , TYPE_INT      , modmap_fpg_add            },
@@ -842,6 +914,8 @@ DLSYSFUNCS  __bgdexport( mod_map, functions_exports )[] =
     { "FPG_SAVE"            , "IS"          , TYPE_INT      , modmap_save_fpg           },
     { "FPG_DEL"             , "I"           , TYPE_INT      , modmap_unload_fpg         },
     { "FPG_UNLOAD"          , "I"           , TYPE_INT      , modmap_unload_fpg         },
+    { "FPG_ATLAS"           , "I"           , TYPE_INT      , modmap_fpg_atlas          },
+    { "FPG_ATLAS"           , "II"          , TYPE_INT      , modmap_fpg_atlas2         },
 
     { "RGB"                 , "BBBI"        , TYPE_INT      , modmap_rgb_depth          },
     { "RGBA"                , "BBBBI"       , TYPE_INT      , modmap_rgba_depth         },
@@ -41,6 +41,7 @@
 #define G_PITCH         4
 #define G_DEPTH         5
 #define B_CLEAR         0x00000001
+#define B_TARGET        0x00000002
 #define CHARSET_ISO8859 0
 #define CHARSET_CP850   1
 #define NFB_FIXEDWIDTH  1
@@ -56,6 +57,7 @@ DLCONSTANT __bgdexport( mod_map, constants_def )[] =
     { "G_PITCH"         , TYPE_INT, G_PITCH             },
     { "G_DEPTH"         , TYPE_INT, G_DEPTH             },
     { "B_CLEAR"         , TYPE_INT, B_CLEAR             },
+    { "B_TARGET"        , TYPE_INT, B_TARGET            },
     { "CHARSET_ISO8859" , TYPE_INT, CHARSET_ISO8859     },
     { "CHARSET_CP850"   , TYPE_INT, CHARSET_CP850       },
     { "NFB_VARIABLEWIDTH", TYPE_INT, 0                  },
@@ -84,6 +86,9 @@ DLSYSFUNCS  __bgdexport( mod_map, functions_exports )[] =
     { "MAP_LOAD"            , "SP"          , TYPE_INT      , 0 },
     { "MAP_SAVE"            , "IIS"         , TYPE_INT      , 0 },
     { "MAP_BUFFER"          , "II"          , TYPE_POINTER  , 0 },
+    { "MAP_CHECKSUM"        , "II"          , TYPE_INT      , 0 },
+    { "BLIT_SIMD"           , "I"           , TYPE_INT      , 0 },
+    { "BLIT_SIMD"           , ""            , TYPE_INT      , 0 },
     { "FPG_ADD"             , "IIII"        , TYPE_INT      , 0 },
     { "FPG_NEW"             , ""            , TYPE_INT      , 0 },
     { "FPG_EXISTS"          , "I"           , TYPE_INT      , 0 },
@@ -92,6 +97,8 @@ DLSYSFUNCS  __bgdexport( mod_map, functions_exports )[] =
     { "FPG_SAVE"            , "IS"          , TYPE_INT      , 0 },
     { "FPG_DEL"             , "I"           , TYPE_INT      , 0 },
     { "FPG_UNLOAD"          , "I"           , TYPE_INT      , 0 },
+    { "FPG_ATLAS"           , "I"           , TYPE_INT      , 0 },
+    { "FPG_ATLAS"           , "II"          , TYPE_INT      , 0 },
     { "RGB"                 , "BBBI"        , TYPE_INT      , 0 },
     { "RGBA"                , "BBBBI"       , TYPE_INT      , 0 },
     { "RGB_GET"             , "IPPPI"       , TYPE_INT      , 0 },
@@ -238,27 +238,27 @@ static int math_get_disty( INSTANCE * my, int * params )
 
 DLSYSFUNCS __bgdexport( mod_math, functions_exports )[] =
 {
-    { "ABS"         , "F"       , TYPE_FLOAT    , math_abs          },
-    { "POW"         , "FF"      , TYPE_FLOAT    , math_pow          },
-    { "SQRT"        , "F"       , TYPE_FLOAT    , math_sqrt         },
-
-    { "COS"         , "F"       , TYPE_FLOAT    , math_cos          },
-    { "SIN"         , "F"       , TYPE_FLOAT    , math_sin          },
-    { "TAN"         , "F"       , TYPE_FLOAT    , math_tan          },
-    { "ACOS"        , "F"       , TYPE_FLOAT    , math_acos         },
-    { "ASIN"        , "F"       , TYPE_FLOAT    , math_asin         },
-    { "ATAN"        , "F"       , TYPE_FLOAT    , math_atan         },
-    { "ATAN2"       , "FF"      , TYPE_FLOAT    , math_atan2        },
-
-    { "ISINF"       , "F"       , TYPE_INT      , math_isinf        },
-    { "ISNAN"       , "F"       , TYPE_INT      , math_isnan        },
-    { "FINITE"      , "F"       , TYPE_INT      , math_finite       },
-
-    { "FGET_ANGLE"  , "IIII"    , TYPE_INT      , math_fget_angle   },
-    { "FGET_DIST"   , "IIII"    , TYPE_INT      , math_fget_dist    },
-    { "NEAR_ANGLE"  , "III"     , TYPE_INT      , math_near_angle   },
-    { "GET_DISTX"   , "II"      , TYPE_INT      , math_get_distx    },
-    { "GET_DISTY"   , "II"      , TYPE_INT      , math_get_disty    },
+    { "ABS"         , "F"       , TYPE_FLOAT    , math_abs          , SYSFUNC_THREADSAFE },
+    { "POW"         , "FF"      , TYPE_FLOAT    , math_pow          , SYSFUNC_THREADSAFE },
+    { "SQRT"        , "F"       , TYPE_FLOAT    , math_sqrt         , SYSFUNC_THREADSAFE },
+
+    { "COS"         , "F"       , TYPE_FLOAT    , math_cos          , SYSFUNC_THREADSAFE },
+    { "SIN"         , "F"       , TYPE_FLOAT    , math_sin          , SYSFUNC_THREADSAFE },
+    { "TAN"         , "F"       , TYPE_FLOAT    , math_tan          , SYSFUNC_THREADSAFE },
+    { "ACOS"        , "F"       , TYPE_FLOAT    , math_acos         , SYSFUNC_THREADSAFE },
+    { "ASIN"        , "F"       , TYPE_FLOAT    , math_asin         , SYSFUNC_THREADSAFE },
+    { "ATAN"        , "F"       , TYPE_FLOAT    , math_atan         , SYSFUNC_THREADSAFE },
+    { "ATAN2"       , "FF"      , TYPE_FLOAT    , math_atan2        , SYSFUNC_THREADSAFE },
+
+    { "ISINF"       , "F"       , TYPE_INT      , math_isinf        , SYSFUNC_THREADSAFE },
+    { "ISNAN"       , "F"       , TYPE_INT      , math_isnan        , SYSFUNC_THREADSAFE },
+    { "FINITE"      , "F"       , TYPE_INT      , math_finite       , SYSFUNC_THREADSAFE },
+
+    { "FGET_ANGLE"  , "IIII"    , TYPE_INT      , math_fget_angle   , SYSFUNC_THREADSAFE },
+    { "FGET_DIST"   , "IIII"    , TYPE_INT      , math_fget_dist    , SYSFUNC_THREADSAFE },
+    { "NEAR_ANGLE"  , "III"     , TYPE_INT      , math_near_angle   , SYSFUNC_THREADSAFE },
+    { "GET_DISTX"   , "II"      , TYPE_INT      , math_get_distx    , SYSFUNC_THREADSAFE },
+    { "GET_DISTY"   , "II"      , TYPE_INT      , math_get_disty    , SYSFUNC_THREADSAFE },
 
     { 0             , 0         , 0             , 0                 }
 };
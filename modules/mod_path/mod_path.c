@@ -31,314 +31,1498 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+#include <SDL.h>
 
 #include "bgddl.h"
 #include "bgdrtm.h"
+#include "dlvaracc.h"
+
+#include "libgrbase.h"
+
+/* --------------------------------------------------------------------------- */
+
+#define PF_NODIAG       1
+#define PF_REVERSE      2
+
+/* PATH_STATUS values */
+
+#define PF_NOTFOUND     0
+#define PF_FOUND        1
+#define PF_PENDING      2
+
+/* --------------------------------------------------------------------------- */
+
+/* Nodes live in a pool reused across searches and are addressed by index.
+ * Every map cell keeps the index of its node, stamped with the search that
+ * created it, so membership tests are O(1) and nothing has to be cleared
+ * between searches.
+ */
+
+typedef struct _node
+{
+    int x, y ;
+    double f, g, h ;
+    int parent ;                    /* Pool index, -1 for the start node */
+    int heap_pos ;                  /* Position in the open heap, -1 when closed */
+    uint32_t seq ;                  /* Insertion order, ties on f are popped FIFO */
+} node ;
+
+typedef struct
+{
+    GRAPH * map ;
+    int destination_x, destination_y ;
+    int options ;
+    int block_if ;
+
+    node * nodes ;
+    int nodes_count ;
+    int nodes_allocated ;
+
+    int * heap ;                    /* Open set, binary heap of pool indexes */
+    int heap_count ;
+    int heap_allocated ;
+    uint32_t seq ;
+
+    uint32_t * cell_stamp ;
+    int * cell_node ;
+    int cells_allocated ;
+    uint32_t outside_stamp ;
+    int outside_node ;
+    uint32_t stamp ;
+
+    int expanded ;                  /* Nodes taken from the open set */
+} pf_search ;
+
+/* --------------------------------------------------------------------------- */
+
+static int  * path_result = NULL ;
+static int  * path_result_pointer = NULL ;
+
+static pf_search search = { 0 } ;
+
+static int block_if = 1 ;
+
+static int path_expanded = 0 ;      /* Nodes expanded by the last PATH_FIND or finished request */
+
+/* --------------------------------------------------------------------------- */
+
+DLCONSTANT __bgdexport( mod_path, constants_def )[] =
+{
+    { "PF_NODIAG"   , TYPE_INT, PF_NODIAG   }, /* Prohibit the pathfinding from using diagonal paths. */
+    { "PF_REVERSE"  , TYPE_INT, PF_REVERSE  }, /* Return the path found in reverse order.             */
+
+    { "PF_NOTFOUND" , TYPE_INT, PF_NOTFOUND }, /* PATH_STATUS: no path to the destination.           */
+    { "PF_FOUND"    , TYPE_INT, PF_FOUND    }, /* PATH_STATUS: path ready for PATH_GET_HANDLE_XY.     */
+    { "PF_PENDING"  , TYPE_INT, PF_PENDING  }, /* PATH_STATUS: still queued or searching.            */
+
+    { NULL          , 0       , 0           }
+} ;
+
+/* --------------------------------------------------------------------------- */
+
+/* Locals */
+
+enum {
+    PROCESS_ID = 0,
+    PATH_REQUESTS
+};
+
+char * __bgdexport( mod_path, locals_def ) =
+    "STRUCT _mod_path_reserved\n"
+    "int requests;\n"
+    "END\n";
+
+DLVARFIXUP __bgdexport( mod_path, locals_fixup )[] =
+{
+    /* Nombre de variable local, offset al dato, tamaño del elemento, cantidad de elementos */
+    { "id"                              , NULL, -1, -1 },
+    { "_mod_path_reserved.requests"     , NULL, -1, -1 },
+
+    { NULL                              , NULL, -1, -1 }
+};
+
+/* --------------------------------------------------------------------------- */
+
+static double heuristic( pf_search * s, int x, int y ) {
+    int dx, dy ;
+    uint8_t block ;
+
+    if ( x == s->destination_x && y == s->destination_y ) return 0 ;
+    if ( x < 0 || y < 0 || x >= ( int )s->map->width || y >= ( int )s->map->height ) return 1073741824.0 ;
+
+    block = (( uint8_t* )s->map->data )[s->map->pitch*y+x] ;
+    if ( block >= s->block_if ) return 1073741824.0 ;
+
+    dx = abs( s->destination_x - x ) ;
+    dy = abs( s->destination_y - y ) ;
+    return ( double )block + ( double )dx*dx + ( double )dy*dy ;
+}
+
+/* --------------------------------------------------------------------------- */
+/* Open set                                                                    */
+/* --------------------------------------------------------------------------- */
+
+#define NODE_LESS(a,b)  ( (a)->f < (b)->f || ( (a)->f == (b)->f && (a)->seq < (b)->seq ) )
+
+static void heap_set( pf_search * s, int pos, int n ) {
+    s->heap[pos] = n ;
+    s->nodes[n].heap_pos = pos ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static void heap_up( pf_search * s, int pos ) {
+    int n = s->heap[pos], parent ;
+
+    while ( pos > 0 )
+    {
+        parent = ( pos - 1 ) / 2 ;
+        if ( !NODE_LESS( &s->nodes[n], &s->nodes[s->heap[parent]] ) ) break ;
+        heap_set( s, pos, s->heap[parent] ) ;
+        pos = parent ;
+    }
+    heap_set( s, pos, n ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static void heap_down( pf_search * s, int pos ) {
+    int n = s->heap[pos], child ;
+
+    while ( ( child = pos * 2 + 1 ) < s->heap_count )
+    {
+        if ( child + 1 < s->heap_count && NODE_LESS( &s->nodes[s->heap[child + 1]], &s->nodes[s->heap[child]] ) ) child++ ;
+        if ( !NODE_LESS( &s->nodes[s->heap[child]], &s->nodes[n] ) ) break ;
+        heap_set( s, pos, s->heap[child] ) ;
+        pos = child ;
+    }
+    heap_set( s, pos, n ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static int heap_push( pf_search * s, int n ) {
+    if ( s->heap_count >= s->heap_allocated )
+    {
+        int allocated = s->heap_allocated ? s->heap_allocated * 2 : 256 ;
+        int * heap = realloc( s->heap, allocated * sizeof( int ) ) ;
+        if ( !heap ) return 0 ;
+        s->heap = heap ;
+        s->heap_allocated = allocated ;
+    }
+
+    s->nodes[n].seq = s->seq++ ;
+    s->heap[s->heap_count] = n ;
+    heap_up( s, s->heap_count++ ) ;
+    return 1 ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static int heap_pop( pf_search * s ) {
+    int n = s->heap[0] ;
+
+    s->nodes[n].heap_pos = -1 ;
+    if ( --s->heap_count )
+    {
+        s->heap[0] = s->heap[s->heap_count] ;
+        heap_down( s, 0 ) ;
+    }
+    return n ;
+}
+
+/* --------------------------------------------------------------------------- */
+/* Nodes                                                                       */
+/* --------------------------------------------------------------------------- */
+
+static int node_new( pf_search * s, int parent, int x, int y, int cost_inc ) {
+    node * curr ;
+
+    if ( s->nodes_count >= s->nodes_allocated )
+    {
+        int allocated = s->nodes_allocated ? s->nodes_allocated * 2 : 256 ;
+        node * nodes = realloc( s->nodes, allocated * sizeof( node ) ) ;
+        if ( !nodes ) return -1 ;
+        s->nodes = nodes ;
+        s->nodes_allocated = allocated ;
+    }
+
+    curr = &s->nodes[s->nodes_count] ;
+    curr->x = x ;
+    curr->y = y ;
+    curr->g = ( parent >= 0 ? s->nodes[parent].g : 0 ) + cost_inc ;
+    curr->h = heuristic( s, x, y ) ;
+    curr->f = curr->g + curr->h ;
+    curr->parent = parent ;
+    curr->heap_pos = -1 ;
+
+    return s->nodes_count++ ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static void node_push_succesor( pf_search * s, int parent, int ix, int iy, int cost ) {
+    int x = s->nodes[parent].x + ix, y = s->nodes[parent].y + iy ;
+    uint32_t * stamp ;
+    int * slot, n ;
+    node * curr, * f_op ;
+    double g, h ;
+
+    /* Same test the node would get from heuristic(), without using the pool */
+    h = heuristic( s, x, y ) ;
+    if ( h > 131072 ) return ;
+
+    /* Only the destination can be out of the map here */
+    if ( x < 0 || y < 0 || x >= ( int )s->map->width || y >= ( int )s->map->height )
+    {
+        stamp = &s->outside_stamp ;
+        slot = &s->outside_node ;
+    }
+    else
+    {
+        stamp = &s->cell_stamp[y * s->map->width + x] ;
+        slot = &s->cell_node[y * s->map->width + x] ;
+    }
+
+    if ( *stamp != s->stamp )
+    {
+        n = node_new( s, parent, x, y, cost ) ;
+        if ( n < 0 ) return ;
+        *stamp = s->stamp ;
+        *slot = n ;
+        heap_push( s, n ) ;
+        return ;
+    }
+
+    /* Closed */
+    f_op = &s->nodes[*slot] ;
+    if ( f_op->heap_pos < 0 ) return ;
+
+    g = s->nodes[parent].g + cost ;
+    if ( f_op->f <= g + h ) return ;
+
+    /* Better way to an open node. It was never expanded, so nobody has it as parent */
+    curr = f_op ;
+    curr->g = g ;
+    curr->h = h ;
+    curr->f = g + h ;
+    curr->parent = parent ;
+    curr->seq = s->seq++ ;
+    heap_up( s, curr->heap_pos ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static void node_push_succesors( pf_search * s, int parent, int options ) {
+    node * p = &s->nodes[parent] ;
+    node * prior = p->parent >= 0 ? &s->nodes[p->parent] : p ;
+    unsigned int px = p->x, py = p->y, prx = prior->x, pry = prior->y ;
+
+    /* Pool may move on each push, work with copies. Compared as unsigned,
+       as a start out of the map always did */
+    node_push_succesor( s, parent, 1, 0, prx < px ? 9 : 10 ) ;
+    node_push_succesor( s, parent, 0, 1, prx > px ? 9 : 10 ) ;
+    node_push_succesor( s, parent, -1, 0, pry < py ? 9 : 10 ) ;
+    node_push_succesor( s, parent, 0, -1, pry > py ? 9 : 10 ) ;
+
+    if ( !( options & PF_NODIAG ) )
+    {
+        node_push_succesor( s, parent, 1, 1, 12 ) ;
+        node_push_succesor( s, parent, -1, -1, 12 ) ;
+        node_push_succesor( s, parent, -1, 1, 12 ) ;
+        node_push_succesor( s, parent, 1, -1, 12 ) ;
+    }
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Prepare a search, reusing the pool and the cell arrays of the previous one */
+
+static int pf_search_start( pf_search * s, GRAPH * bitmap, int sx, int sy, int dx, int dy, int options, int wall ) {
+    int cells = bitmap->width * bitmap->height, n ;
+
+    s->map = bitmap ;
+    s->destination_x = dx ;
+    s->destination_y = dy ;
+    s->options = options ;
+    s->block_if = wall ;
+
+    if ( cells > s->cells_allocated )
+    {
+        free( s->cell_stamp ) ;
+        free( s->cell_node ) ;
+        s->cell_stamp = calloc( cells, sizeof( uint32_t ) ) ;
+        s->cell_node = malloc( cells * sizeof( int ) ) ;
+        if ( !s->cell_stamp || !s->cell_node )
+        {
+            free( s->cell_stamp ) ; s->cell_stamp = NULL ;
+            free( s->cell_node ) ; s->cell_node = NULL ;
+            s->cells_allocated = 0 ;
+            return 0 ;
+        }
+        s->cells_allocated = cells ;
+        s->outside_stamp = 0 ;
+        s->stamp = 0 ;
+    }
+
+    if ( !++s->stamp )
+    {
+        memset( s->cell_stamp, 0, s->cells_allocated * sizeof( uint32_t ) ) ;
+        s->outside_stamp = 0 ;
+        s->stamp = 1 ;
+    }
+
+    s->nodes_count = 0 ;
+    s->heap_count = 0 ;
+    s->seq = 0 ;
+    s->expanded = 0 ;
+
+    n = node_new( s, -1, sx, sy, 0 ) ;
+    if ( n < 0 ) return 0 ;
+
+    s->nodes[n].f = s->nodes[n].h = 1 ;
+
+    /* Start may be out of the map, it's never visited again in that case */
+    if ( sx >= 0 && sy >= 0 && sx < ( int )bitmap->width && sy < ( int )bitmap->height )
+    {
+        s->cell_stamp[sy * bitmap->width + sx] = s->stamp ;
+        s->cell_node[sy * bitmap->width + sx] = n ;
+    }
+
+    return heap_push( s, n ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Expands up to steps nodes (no limit if steps <= 0). Returns the index of
+   the destination node, -1 if there is no path or PF_SEARCH_RUNNING */
+
+#define PF_SEARCH_RUNNING   -2
+
+static int pf_search_run( pf_search * s, int steps ) {
+    int curr ;
+
+    while ( s->heap_count ) {
+        curr = heap_pop( s ) ;
+        s->expanded++ ;
+
+        if ( s->nodes[curr].x == s->destination_x && s->nodes[curr].y == s->destination_y ) return curr ;
+
+        node_push_succesors( s, curr, s->options ) ;
+
+        if ( steps > 0 && !--steps ) return s->heap_count ? PF_SEARCH_RUNNING : -1 ;
+    }
+
+    return -1 ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Builds a -1,-1 terminated list of x,y pairs from the start to found */
+
+static int * pf_search_result( pf_search * s, int found ) {
+    int count = 1, curr, * result, * ptr ;
+
+    for ( curr = found ; s->nodes[curr].parent >= 0 ; curr = s->nodes[curr].parent ) count++ ;
+
+    result = malloc( sizeof( int ) * 2 * ( count + 4 ) ) ;
+    if ( !result ) return NULL ;
+
+    if ( !( s->options & PF_REVERSE ) ) {
+        ptr = result + count * 2 + 1;
+        *ptr-- = -1 ;
+        *ptr-- = -1 ;
+        for ( curr = found ; curr >= 0 ; curr = s->nodes[curr].parent ) {
+            *ptr-- = s->nodes[curr].y ;
+            *ptr-- = s->nodes[curr].x ;
+        }
+    } else {
+        ptr = result ;
+        for ( curr = found ; curr >= 0 ; curr = s->nodes[curr].parent ) {
+            *ptr++ = s->nodes[curr].x ;
+            *ptr++ = s->nodes[curr].y ;
+        }
+        *ptr++ = -1 ;
+        *ptr++ = -1 ;
+    }
+
+    return result ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* --------------------------------------------------------------------------- */
+/* Hierarchical search                                                         */
+/* --------------------------------------------------------------------------- */
+
+/* PATH_HIERARCHY() splits a map in square clusters and keeps, for each one,
+ * the border cells where paths cross to a neighbour cluster (entrances) and
+ * the cost of the best path between every pair of entrances inside it. Long
+ * searches run on that small graph and are then refined cluster by cluster.
+ * Clusters touched by bitmap_changed() are rebuilt on the next search.
+ */
+
+#define HPA_STRAIGHT    10
+#define HPA_DIAGONAL    12
+#define HPA_INFINITE    0x7fffffff
+#define HPA_MAX_EXITS   2           /* Corner cells are on two borders */
+#define HPA_RUN_SPLIT   6           /* Longer entrances get a transition at each end */
+
+typedef struct
+{
+    int x, y ;
+    int nexits ;
+    int ex[HPA_MAX_EXITS], ey[HPA_MAX_EXITS] ;
+} hpa_node ;
+
+typedef struct
+{
+    int dirty ;
+    int nnodes ;
+    int allocated ;
+    hpa_node * nodes ;
+    int * cost[2] ;                 /* nnodes x nnodes, [0] with diagonals, [1] PF_NODIAG */
+} hpa_cluster ;
+
+typedef struct _hpa_map
+{
+    GRAPH * map ;
+    int wall ;
+    int size ;
+    int cw, ch ;
+    hpa_cluster * clusters ;
+    int dirty ;
+
+    int * first ;                   /* Abstract id of the first node of each cluster */
+    int * owner ;                   /* Cluster of each abstract id */
+    int total ;
+
+    struct _hpa_map * next ;
+} hpa_map ;
+
+typedef struct
+{
+    int key, id ;
+} hpa_item ;
+
+typedef struct
+{
+    hpa_item * items ;
+    int count ;
+    int allocated ;
+} hpa_heap ;
+
+static hpa_map * hpa_maps = NULL ;
+
+/* Workspace, shared by all maps */
+
+static hpa_heap hpa_open = { NULL, 0, 0 } ;       /* Abstract search */
+static hpa_heap hpa_lopen = { NULL, 0, 0 } ;      /* Cluster search */
+
+static int * hpa_ldist = NULL ;     /* Cluster search, by local cell */
+static int * hpa_lparent = NULL ;
+static uint32_t * hpa_lstamp = NULL ;
+static uint32_t hpa_lcurrent = 0 ;
+static int hpa_lallocated = 0 ;
+
+static int * hpa_adist = NULL ;     /* Abstract search, by abstract id */
+static int * hpa_aparent = NULL ;
+static int hpa_aallocated = 0 ;
+
+static int * hpa_scost = NULL ;     /* Start and goal to their cluster nodes */
+static int * hpa_gcost = NULL ;
+static int hpa_sallocated = 0 ;
+
+static int hpa_expanded = 0 ;
+
+/* --------------------------------------------------------------------------- */
+
+static void hpa_heap_push( hpa_heap * h, int key, int id ) {
+    int pos, parent ;
+
+    if ( h->count >= h->allocated )
+    {
+        int allocated = h->allocated ? h->allocated * 2 : 256 ;
+        hpa_item * items = realloc( h->items, allocated * sizeof( hpa_item ) ) ;
+        if ( !items ) return ;
+        h->items = items ;
+        h->allocated = allocated ;
+    }
+
+    for ( pos = h->count++ ; pos > 0 ; pos = parent )
+    {
+        parent = ( pos - 1 ) / 2 ;
+        if ( h->items[parent].key <= key ) break ;
+        h->items[pos] = h->items[parent] ;
+    }
+    h->items[pos].key = key ;
+    h->items[pos].id = id ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static hpa_item hpa_heap_pop( hpa_heap * h ) {
+    hpa_item top = h->items[0], last = h->items[--h->count] ;
+    int pos = 0, child ;
+
+    while ( ( child = pos * 2 + 1 ) < h->count )
+    {
+        if ( child + 1 < h->count && h->items[child + 1].key < h->items[child].key ) child++ ;
+        if ( last.key <= h->items[child].key ) break ;
+        h->items[pos] = h->items[child] ;
+        pos = child ;
+    }
+    if ( h->count ) h->items[pos] = last ;
+
+    return top ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static int hpa_block( hpa_map * h, int x, int y ) {
+    if ( x < 0 || y < 0 || x >= ( int )h->map->width || y >= ( int )h->map->height ) return -1 ;
+    return (( uint8_t * )h->map->data )[h->map->pitch * y + x] ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static int hpa_walkable( hpa_map * h, int x, int y ) {
+    int block = hpa_block( h, x, y ) ;
+    return block >= 0 && block < h->wall ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static void hpa_cluster_box( hpa_map * h, int c, int * bx, int * by, int * bw, int * bh ) {
+    *bx = ( c % h->cw ) * h->size ;
+    *by = ( c / h->cw ) * h->size ;
+    *bw = MIN( h->size, ( int )h->map->width - *bx ) ;
+    *bh = MIN( h->size, ( int )h->map->height - *by ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Dijkstra from sx,sy without leaving the cluster c. Stops once tx,ty is
+   settled (tx < 0 for a full search). The target may be a wall, just like
+   the destination of path_find(). Results are in hpa_ldist/hpa_lparent */
+
+static void hpa_local_search( hpa_map * h, int c, int sx, int sy, int tx, int ty, int nodiag ) {
+    static const int dirs[8][2] = { { 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 }, { 1, 1 }, { -1, -1 }, { -1, 1 }, { 1, -1 } } ;
+    int bx, by, bw, bh, cell, ncell, x, y, nx, ny, d, dist, block ;
+    hpa_item item ;
+
+    hpa_cluster_box( h, c, &bx, &by, &bw, &bh ) ;
+
+    if ( !++hpa_lcurrent )
+    {
+        memset( hpa_lstamp, 0, hpa_lallocated * sizeof( uint32_t ) ) ;
+        hpa_lcurrent = 1 ;
+    }
+
+    hpa_lopen.count = 0 ;
+
+    cell = ( sy - by ) * bw + ( sx - bx ) ;
+    hpa_lstamp[cell] = hpa_lcurrent ;
+    hpa_ldist[cell] = 0 ;
+    hpa_lparent[cell] = -1 ;
+    hpa_heap_push( &hpa_lopen, 0, cell ) ;
+
+    while ( hpa_lopen.count )
+    {
+        item = hpa_heap_pop( &hpa_lopen ) ;
+        if ( item.key != hpa_ldist[item.id] ) continue ;
+
+        hpa_expanded++ ;
+
+        x = bx + item.id % bw ;
+        y = by + item.id / bw ;
+        if ( x == tx && y == ty ) return ;
+
+        for ( d = 0 ; d < ( nodiag ? 4 : 8 ) ; d++ )
+        {
+            nx = x + dirs[d][0] ;
+            ny = y + dirs[d][1] ;
+            if ( nx < bx || ny < by || nx >= bx + bw || ny >= by + bh ) continue ;
+
+            block = hpa_block( h, nx, ny ) ;
+            if ( block >= h->wall )
+            {
+                if ( nx != tx || ny != ty ) continue ;
+                block = 0 ;
+            }
+
+            dist = item.key + ( d < 4 ? HPA_STRAIGHT : HPA_DIAGONAL ) + block ;
+            ncell = ( ny - by ) * bw + ( nx - bx ) ;
+
+            if ( hpa_lstamp[ncell] == hpa_lcurrent && hpa_ldist[ncell] <= dist ) continue ;
+
+            hpa_lstamp[ncell] = hpa_lcurrent ;
+            hpa_ldist[ncell] = dist ;
+            hpa_lparent[ncell] = item.id ;
+            hpa_heap_push( &hpa_lopen, dist, ncell ) ;
+        }
+    }
+}
+
+/* --------------------------------------------------------------------------- */
+
+static int hpa_local_dist( hpa_map * h, int c, int x, int y ) {
+    int bx, by, bw, bh, cell ;
+
+    hpa_cluster_box( h, c, &bx, &by, &bw, &bh ) ;
+    cell = ( y - by ) * bw + ( x - bx ) ;
+
+    return hpa_lstamp[cell] == hpa_lcurrent ? hpa_ldist[cell] : HPA_INFINITE ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static void hpa_add_node( hpa_cluster * cl, int x, int y, int ex, int ey ) {
+    hpa_node * node ;
+    int n ;
+
+    for ( n = 0 ; n < cl->nnodes ; n++ )
+        if ( cl->nodes[n].x == x && cl->nodes[n].y == y ) break ;
+
+    if ( n == cl->nnodes )
+    {
+        if ( cl->nnodes >= cl->allocated )
+        {
+            int allocated = cl->allocated ? cl->allocated * 2 : 8 ;
+            hpa_node * nodes = realloc( cl->nodes, allocated * sizeof( hpa_node ) ) ;
+            if ( !nodes ) return ;
+            cl->nodes = nodes ;
+            cl->allocated = allocated ;
+        }
+        node = &cl->nodes[cl->nnodes++] ;
+        node->x = x ;
+        node->y = y ;
+        node->nexits = 0 ;
+    }
+    else
+        node = &cl->nodes[n] ;
+
+    if ( node->nexits < HPA_MAX_EXITS )
+    {
+        node->ex[node->nexits] = ex ;
+        node->ey[node->nexits] = ey ;
+        node->nexits++ ;
+    }
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Scans one border of a cluster, from x,y stepping sx,sy for len cells, with
+   the neighbour cluster at ox,oy. Both clusters scan a shared border the same
+   way, so they always agree on its transitions */
+
+static void hpa_scan_border( hpa_map * h, hpa_cluster * cl, int x, int y, int sx, int sy, int len, int ox, int oy ) {
+    int n, start = -1, mid ;
+
+    for ( n = 0 ; n <= len ; n++ )
+    {
+        if ( n < len && hpa_walkable( h, x + sx * n, y + sy * n ) && hpa_walkable( h, x + sx * n + ox, y + sy * n + oy ) )
+        {
+            if ( start < 0 ) start = n ;
+            continue ;
+        }
+
+        if ( start < 0 ) continue ;
+
+        if ( n - start < HPA_RUN_SPLIT )
+        {
+            mid = start + ( n - start ) / 2 ;
+            hpa_add_node( cl, x + sx * mid, y + sy * mid, x + sx * mid + ox, y + sy * mid + oy ) ;
+        }
+        else
+        {
+            hpa_add_node( cl, x + sx * start, y + sy * start, x + sx * start + ox, y + sy * start + oy ) ;
+            hpa_add_node( cl, x + sx * ( n - 1 ), y + sy * ( n - 1 ), x + sx * ( n - 1 ) + ox, y + sy * ( n - 1 ) + oy ) ;
+        }
+        start = -1 ;
+    }
+}
+
+/* --------------------------------------------------------------------------- */
+
+static void hpa_build_costs( hpa_map * h, int c, int nodiag ) {
+    hpa_cluster * cl = &h->clusters[c] ;
+    int i, j ;
+
+    if ( !cl->nnodes || !( cl->cost[nodiag] = malloc( cl->nnodes * cl->nnodes * sizeof( int ) ) ) ) return ;
+
+    for ( i = 0 ; i < cl->nnodes ; i++ )
+    {
+        hpa_local_search( h, c, cl->nodes[i].x, cl->nodes[i].y, -1, -1, nodiag ) ;
+        for ( j = 0 ; j < cl->nnodes ; j++ )
+            cl->cost[nodiag][i * cl->nnodes + j] = hpa_local_dist( h, c, cl->nodes[j].x, cl->nodes[j].y ) ;
+    }
+}
+
+/* --------------------------------------------------------------------------- */
+
+static void hpa_build_cluster( hpa_map * h, int c ) {
+    hpa_cluster * cl = &h->clusters[c] ;
+    int bx, by, bw, bh ;
+
+    hpa_cluster_box( h, c, &bx, &by, &bw, &bh ) ;
+
+    cl->nnodes = 0 ;
+    if ( bx > 0 ) hpa_scan_border( h, cl, bx, by, 0, 1, bh, -1, 0 ) ;
+    if ( bx + bw < ( int )h->map->width ) hpa_scan_border( h, cl, bx + bw - 1, by, 0, 1, bh, 1, 0 ) ;
+    if ( by > 0 ) hpa_scan_border( h, cl, bx, by, 1, 0, bw, 0, -1 ) ;
+    if ( by + bh < ( int )h->map->height ) hpa_scan_border( h, cl, bx, by + bh - 1, 1, 0, bw, 0, 1 ) ;
+
+    free( cl->cost[0] ) ; cl->cost[0] = NULL ;
+    free( cl->cost[1] ) ; cl->cost[1] = NULL ;
+
+    /* PF_NODIAG costs are only built when a search needs them */
+    hpa_build_costs( h, c, 0 ) ;
+
+    cl->dirty = 0 ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Rebuilds the clusters changed since the last search. With a limit, it
+ * stops once the performance counter reaches it (after one cluster at
+ * least) and returns -1, the next call goes on from there. Returns 0 if
+ * there is no memory, 1 when done */
+
+static int hpa_update( hpa_map * h, Uint64 limit ) {
+    int c, n, total, built = 0 ;
+
+    if ( !h->dirty ) return 1 ;
+
+    for ( c = 0 ; c < h->cw * h->ch ; c++ )
+    {
+        if ( !h->clusters[c].dirty ) continue ;
+        if ( limit && built && SDL_GetPerformanceCounter() >= limit ) return -1 ;
+        hpa_build_cluster( h, c ) ;
+        built++ ;
+    }
+
+    for ( total = 0, c = 0 ; c < h->cw * h->ch ; c++ )
+    {
+        h->first[c] = total ;
+        total += h->clusters[c].nnodes ;
+    }
+
+    free( h->owner ) ;
+    h->owner = malloc( ( total + 1 ) * sizeof( int ) ) ;
+    if ( !h->owner ) return 0 ;
+
+    for ( c = 0 ; c < h->cw * h->ch ; c++ )
+        for ( n = 0 ; n < h->clusters[c].nnodes ; n++ ) h->owner[h->first[c] + n] = c ;
+
+    h->total = total ;
+    h->dirty = 0 ;
+
+    return 1 ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static void hpa_invalidate( hpa_map * h, int x, int y, int x2, int y2 ) {
+    int cx, cy ;
+
+    /* A change next to a border changes the entrances of both clusters */
+    x = MAX( x - 1, 0 ) / h->size ;
+    y = MAX( y - 1, 0 ) / h->size ;
+    x2 = MIN( ( x2 + 1 ) / h->size, h->cw - 1 ) ;
+    y2 = MIN( ( y2 + 1 ) / h->size, h->ch - 1 ) ;
+
+    for ( cy = y ; cy <= y2 ; cy++ )
+        for ( cx = x ; cx <= x2 ; cx++ ) h->clusters[cy * h->cw + cx].dirty = 1 ;
+
+    h->dirty = 1 ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static void hpa_destroy( hpa_map * h ) {
+    int c ;
+
+    for ( c = 0 ; c < h->cw * h->ch ; c++ )
+    {
+        free( h->clusters[c].nodes ) ;
+        free( h->clusters[c].cost[0] ) ;
+        free( h->clusters[c].cost[1] ) ;
+    }
+    free( h->clusters ) ;
+    free( h->first ) ;
+    free( h->owner ) ;
+    free( h ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static hpa_map * hpa_get( GRAPH * map ) {
+    hpa_map * h ;
+
+    for ( h = hpa_maps ; h ; h = h->next ) if ( h->map == map ) return h ;
+    return NULL ;
+}
 
-#include "libgrbase.h"
+/* --------------------------------------------------------------------------- */
+
+static void hpa_remove( GRAPH * map ) {
+    hpa_map ** ph, * h ;
+
+    for ( ph = &hpa_maps ; ( h = *ph ) ; ph = &h->next )
+    {
+        if ( h->map == map )
+        {
+            *ph = h->next ;
+            hpa_destroy( h ) ;
+            return ;
+        }
+    }
+}
 
 /* --------------------------------------------------------------------------- */
 
-typedef struct _node
-{
-    unsigned int x, y ;
-    double f, g, h ;
-    struct _node * parent ;
-    struct _node * next ;
-    struct _node * inext ;
-} node ;
+static void hpa_map_changed( GRAPH * map, REGION * region ) {
+    hpa_map * h = hpa_get( map ) ;
+
+    if ( !h ) return ;
+
+    if ( !region )
+        hpa_remove( map ) ;
+    else
+        hpa_invalidate( h, region->x, region->y, region->x2, region->y2 ) ;
+}
 
 /* --------------------------------------------------------------------------- */
 
-static int  * path_result = NULL ;
-static int  * path_result_pointer = NULL ;
+static int hpa_create( GRAPH * map, int size ) {
+    hpa_map * h ;
+    int c ;
 
-static node * pf_all = NULL;
+    hpa_remove( map ) ;
+    if ( size <= 0 ) return 1 ;
 
-static node * pf_open = NULL ;
-static node * pf_closed = NULL ;
-static node * found = NULL ;
+    if ( size < 4 ) size = 4 ;
+    if ( size > 256 ) size = 256 ;
 
-static int destination_x, destination_y ;
-static int startup_x, startup_y ;
+    if ( size * size > hpa_lallocated )
+    {
+        free( hpa_ldist ) ; free( hpa_lparent ) ; free( hpa_lstamp ) ;
+        hpa_ldist = malloc( size * size * sizeof( int ) ) ;
+        hpa_lparent = malloc( size * size * sizeof( int ) ) ;
+        hpa_lstamp = calloc( size * size, sizeof( uint32_t ) ) ;
+        hpa_lcurrent = 0 ;
+        hpa_lallocated = ( hpa_ldist && hpa_lparent && hpa_lstamp ) ? size * size : 0 ;
+        if ( !hpa_lallocated ) return 0 ;
+    }
 
-static GRAPH * map ;
+    h = calloc( 1, sizeof( hpa_map ) ) ;
+    if ( !h ) return 0 ;
+
+    h->map = map ;
+    h->wall = block_if ;
+    h->size = size ;
+    h->cw = ( map->width + size - 1 ) / size ;
+    h->ch = ( map->height + size - 1 ) / size ;
+    h->clusters = calloc( h->cw * h->ch, sizeof( hpa_cluster ) ) ;
+    h->first = malloc( h->cw * h->ch * sizeof( int ) ) ;
+    if ( !h->clusters || !h->first )
+    {
+        free( h->clusters ) ; free( h->first ) ; free( h ) ;
+        return 0 ;
+    }
 
-static int block_if = 1 ;
+    for ( c = 0 ; c < h->cw * h->ch ; c++ ) h->clusters[c].dirty = 1 ;
+    h->dirty = 1 ;
+
+    h->next = hpa_maps ;
+    hpa_maps = h ;
+
+    return hpa_update( h, 0 ) ;
+}
 
 /* --------------------------------------------------------------------------- */
 
-#define PF_NODIAG       1
-#define PF_REVERSE      2
+/* Near searches are cheaper and exact on the grid. The caller brings the
+ * hierarchy up to date with hpa_update() */
+
+static hpa_map * hpa_usable( GRAPH * map, int sx, int sy, int dx, int dy, int wall ) {
+    hpa_map * h = hpa_get( map ) ;
+
+    if ( !h ) return NULL ;
+
+    if ( sx < 0 || sy < 0 || sx >= ( int )map->width || sy >= ( int )map->height ||
+         dx < 0 || dy < 0 || dx >= ( int )map->width || dy >= ( int )map->height ) return NULL ;
+
+    if ( abs( sx / h->size - dx / h->size ) <= 1 && abs( sy / h->size - dy / h->size ) <= 1 ) return NULL ;
+
+    if ( h->wall != wall )
+    {
+        h->wall = wall ;
+        hpa_invalidate( h, 0, 0, map->width - 1, map->height - 1 ) ;
+    }
+
+    return h ;
+}
 
 /* --------------------------------------------------------------------------- */
 
-DLCONSTANT __bgdexport( mod_path, constants_def )[] =
-{
-    { "PF_NODIAG"   , TYPE_INT, PF_NODIAG   }, /* Prohibit the pathfinding from using diagonal paths. */
-    { "PF_REVERSE"  , TYPE_INT, PF_REVERSE  }, /* Return the path found in reverse order.             */
+static int hpa_heuristic( int x, int y, int dx, int dy, int nodiag ) {
+    int ax = abs( dx - x ), ay = abs( dy - y ) ;
 
-    { NULL          , 0       , 0           }
-} ;
+    if ( nodiag ) return ( ax + ay ) * HPA_STRAIGHT ;
+    return MAX( ax, ay ) * HPA_STRAIGHT + MIN( ax, ay ) * ( HPA_DIAGONAL - HPA_STRAIGHT ) ;
+}
 
 /* --------------------------------------------------------------------------- */
 
-static double heuristic( int x, int y ) {
-    int dx, dy ;
-    uint8_t block = (( uint8_t* )map->data )[map->pitch*y+x] ;
+/* Appends to cells the path from the last cell to x,y inside cluster c */
 
-    if ( x == destination_x && y == destination_y ) return 0 ;
-    if ( block >= block_if ) return 1073741824.0 ;
-    if ( x < 0 || y < 0 || x >= ( int )map->width || y >= ( int )map->height ) return 1073741824.0 ;
+static int hpa_refine( hpa_map * h, int c, int * cells, int count, int x, int y, int nodiag ) {
+    int bx, by, bw, bh, cell, n, len = 0 ;
 
-    dx = abs( destination_x - x ) ;
-    dy = abs( destination_y - y ) ;
-    return ( double )block + ( double )dx*dx + ( double )dy*dy ;
+    hpa_local_search( h, c, cells[count * 2 - 2], cells[count * 2 - 1], x, y, nodiag ) ;
+    if ( hpa_local_dist( h, c, x, y ) == HPA_INFINITE ) return -1 ;
+
+    hpa_cluster_box( h, c, &bx, &by, &bw, &bh ) ;
+
+    /* Count the steps, then write them backwards */
+    for ( cell = ( y - by ) * bw + ( x - bx ) ; hpa_lparent[cell] >= 0 ; cell = hpa_lparent[cell] ) len++ ;
+
+    n = count + len ;
+    for ( cell = ( y - by ) * bw + ( x - bx ) ; hpa_lparent[cell] >= 0 ; cell = hpa_lparent[cell] )
+    {
+        n-- ;
+        cells[n * 2] = bx + cell % bw ;
+        cells[n * 2 + 1] = by + cell / bw ;
+    }
+
+    return count + len ;
 }
 
 /* --------------------------------------------------------------------------- */
 
-/* Uso: pf_open = add(pf_open, this) ; */
-/* La lista permanecerá ordenada */
-static node * node_add( node * list, node * this ) {
-    node * curr = list ;
-    if ( !curr )
+/* Returns a result list like pf_search_result(), or NULL if there is no path */
+
+static int * hpa_find( hpa_map * h, int sx, int sy, int dx, int dy, int options ) {
+    int nodiag = ( options & PF_NODIAG ) ? 1 : 0 ;
+    int sc = ( sy / h->size ) * h->cw + sx / h->size ;
+    int gc = ( dy / h->size ) * h->cw + dx / h->size ;
+    int start = h->total, goal = h->total + 1 ;
+    int n, i, k, c, id, nid, dist, x, y, count, max_cells ;
+    int * cells, * result, * ptr ;
+    hpa_cluster * cl, * ncl ;
+    hpa_item item ;
+
+    /* Workspace */
+
+    if ( h->total + 2 > hpa_aallocated )
     {
-        this->next = NULL ;
-        return this ;
+        free( hpa_adist ) ; free( hpa_aparent ) ;
+        hpa_adist = malloc( ( h->total + 2 ) * sizeof( int ) ) ;
+        hpa_aparent = malloc( ( h->total + 2 ) * sizeof( int ) ) ;
+        hpa_aallocated = ( hpa_adist && hpa_aparent ) ? h->total + 2 : 0 ;
+        if ( !hpa_aallocated ) return NULL ;
     }
-    if ( curr->f > this->f )
+
+    n = MAX( h->clusters[sc].nnodes, h->clusters[gc].nnodes ) ;
+    if ( n > hpa_sallocated )
     {
-        this->next = curr ;
-        return this ;
+        free( hpa_scost ) ; free( hpa_gcost ) ;
+        hpa_scost = malloc( n * sizeof( int ) ) ;
+        hpa_gcost = malloc( n * sizeof( int ) ) ;
+        hpa_sallocated = ( hpa_scost && hpa_gcost ) ? n : 0 ;
+        if ( !hpa_sallocated ) return NULL ;
     }
 
-    for ( ;; )
+    /* Connect start and goal to the nodes of their clusters */
+
+    cl = &h->clusters[sc] ;
+    hpa_local_search( h, sc, sx, sy, -1, -1, nodiag ) ;
+    for ( n = 0 ; n < cl->nnodes ; n++ ) hpa_scost[n] = hpa_local_dist( h, sc, cl->nodes[n].x, cl->nodes[n].y ) ;
+
+    cl = &h->clusters[gc] ;
+    hpa_local_search( h, gc, dx, dy, -1, -1, nodiag ) ;
+    for ( n = 0 ; n < cl->nnodes ; n++ ) hpa_gcost[n] = hpa_local_dist( h, gc, cl->nodes[n].x, cl->nodes[n].y ) ;
+
+    /* Abstract search */
+
+    for ( n = 0 ; n < h->total + 2 ; n++ ) hpa_adist[n] = HPA_INFINITE ;
+
+    hpa_open.count = 0 ;
+    hpa_adist[start] = 0 ;
+    hpa_aparent[start] = -1 ;
+    hpa_heap_push( &hpa_open, hpa_heuristic( sx, sy, dx, dy, nodiag ), start ) ;
+
+#define HPA_RELAX(to,cost,tx,ty) \
+    if ( ( cost ) != HPA_INFINITE && dist + ( cost ) < hpa_adist[to] ) \
+    { \
+        hpa_adist[to] = dist + ( cost ) ; \
+        hpa_aparent[to] = id ; \
+        hpa_heap_push( &hpa_open, hpa_adist[to] + hpa_heuristic( tx, ty, dx, dy, nodiag ), to ) ; \
+    }
+
+    while ( hpa_open.count )
+    {
+        item = hpa_heap_pop( &hpa_open ) ;
+        id = item.id ;
+        if ( id == goal ) break ;
+
+        dist = hpa_adist[id] ;
+
+        if ( id == start )
+        {
+            hpa_expanded++ ;
+            cl = &h->clusters[sc] ;
+            for ( n = 0 ; n < cl->nnodes ; n++ )
+                HPA_RELAX( h->first[sc] + n, hpa_scost[n], cl->nodes[n].x, cl->nodes[n].y ) ;
+            continue ;
+        }
+
+        /* Stale entry */
+        if ( item.key != dist + hpa_heuristic( h->clusters[h->owner[id]].nodes[id - h->first[h->owner[id]]].x,
+                                               h->clusters[h->owner[id]].nodes[id - h->first[h->owner[id]]].y, dx, dy, nodiag ) ) continue ;
+
+        hpa_expanded++ ;
+
+        c = h->owner[id] ;
+        cl = &h->clusters[c] ;
+        i = id - h->first[c] ;
+
+        if ( !cl->cost[nodiag] ) hpa_build_costs( h, c, nodiag ) ;
+        if ( cl->cost[nodiag] )
+            for ( n = 0 ; n < cl->nnodes ; n++ )
+                HPA_RELAX( h->first[c] + n, cl->cost[nodiag][i * cl->nnodes + n], cl->nodes[n].x, cl->nodes[n].y ) ;
+
+        for ( k = 0 ; k < cl->nodes[i].nexits ; k++ )
+        {
+            x = cl->nodes[i].ex[k] ;
+            y = cl->nodes[i].ey[k] ;
+            ncl = &h->clusters[( y / h->size ) * h->cw + x / h->size] ;
+            for ( n = 0 ; n < ncl->nnodes ; n++ )
+            {
+                if ( ncl->nodes[n].x != x || ncl->nodes[n].y != y ) continue ;
+                nid = h->first[( y / h->size ) * h->cw + x / h->size] + n ;
+                HPA_RELAX( nid, HPA_STRAIGHT + hpa_block( h, x, y ), x, y ) ;
+                break ;
+            }
+        }
+
+        if ( c == gc ) HPA_RELAX( goal, hpa_gcost[i], dx, dy ) ;
+    }
+
+#undef HPA_RELAX
+
+    if ( hpa_adist[goal] == HPA_INFINITE ) return NULL ;
+
+    /* Refine, walking the abstract path from the start. Each hop stays in
+       a cluster, so it can't be longer than the cluster area */
+
+    for ( count = 0, id = goal ; id >= 0 ; id = hpa_aparent[id] ) count++ ;
+
+    max_cells = count * h->size * h->size + 1 ;
+    cells = malloc( max_cells * 2 * sizeof( int ) ) ;
+    if ( !cells ) return NULL ;
+
+    /* The abstract chain, from the start */
+    ptr = malloc( count * sizeof( int ) ) ;
+    if ( !ptr ) { free( cells ) ; return NULL ; }
+    for ( n = count, id = goal ; id >= 0 ; id = hpa_aparent[id] ) ptr[--n] = id ;
+
+    cells[0] = sx ;
+    cells[1] = sy ;
+    n = 1 ;
+
+    for ( k = 1 ; k < count && n > 0 ; k++ )
     {
-        if ( !curr->next )
+        id = ptr[k] ;
+        if ( id == goal )
         {
-            curr->next = this ;
-            this->next = NULL ;
-            return list ;
+            n = hpa_refine( h, gc, cells, n, dx, dy, nodiag ) ;
+            continue ;
         }
-        if ( curr->next->f > this->f )
+
+        c = h->owner[id] ;
+        x = h->clusters[c].nodes[id - h->first[c]].x ;
+        y = h->clusters[c].nodes[id - h->first[c]].y ;
+
+        /* Crossing a border is a single step */
+        if ( ptr[k - 1] != start && h->owner[ptr[k - 1]] != c )
         {
-            this->next = curr->next ;
-            curr->next = this ;
-            return list ;
+            cells[n * 2] = x ;
+            cells[n * 2 + 1] = y ;
+            n++ ;
+            continue ;
         }
-        curr = curr->next ;
+
+        n = hpa_refine( h, c, cells, n, x, y, nodiag ) ;
+    }
+
+    free( ptr ) ;
+
+    if ( n <= 0 || ( result = malloc( sizeof( int ) * 2 * ( n + 4 ) ) ) == NULL )
+    {
+        free( cells ) ;
+        return NULL ;
     }
+
+    ptr = result ;
+    if ( !( options & PF_REVERSE ) )
+        for ( k = 0 ; k < n ; k++ ) { *ptr++ = cells[k * 2] ; *ptr++ = cells[k * 2 + 1] ; }
+    else
+        for ( k = n - 1 ; k >= 0 ; k-- ) { *ptr++ = cells[k * 2] ; *ptr++ = cells[k * 2 + 1] ; }
+    *ptr++ = -1 ;
+    *ptr++ = -1 ;
+
+    free( cells ) ;
+    return result ;
 }
 
 /* --------------------------------------------------------------------------- */
 
-/* Uso: pf_open = remove(pf_open, this) ; */
-static node * node_remove( node * list, node * this ) {
-    node * curr = list ;
-    if ( curr == this ) return this->next ;
-    while ( curr )
+static int path_find( GRAPH * bitmap, int sx, int sy, int dx, int dy, int options ) {
+    hpa_map * h ;
+    int found ;
+
+    if ( path_result ) { free ( path_result ); path_result = NULL; }
+    path_result_pointer = NULL;
+    path_expanded = 0 ;
+
+    if ( ( h = hpa_usable( bitmap, sx, sy, dx, dy, block_if ) ) && hpa_update( h, 0 ) > 0 )
     {
-        if ( curr->next == this )
+        hpa_expanded = 0 ;
+        path_result = hpa_find( h, sx, sy, dx, dy, options ) ;
+        path_expanded = hpa_expanded ;
+        if ( path_result )
         {
-            curr->next = this->next ;
-            return list ;
+            path_result_pointer = path_result ;
+            return 1 ;
         }
-        curr = curr->next ;
+
+        /* Paths that only cross a border diagonally are not in the hierarchy */
     }
-    return list ;
+
+    if ( !pf_search_start( &search, bitmap, sx, sy, dx, dy, options, block_if ) ) return 0 ;
+
+    found = pf_search_run( &search, 0 ) ;
+    path_expanded += search.expanded ;
+    if ( found < 0 ) return 0 ;
+
+    path_result = pf_search_result( &search, found ) ;
+    if ( !path_result ) return 0 ;
+
+    path_result_pointer = path_result ;
+    return 1 ;
 }
 
 /* --------------------------------------------------------------------------- */
 
-static node * node_find( node * list, int x, int y ) {
-    while ( list )
-    {
-        if ( list->x == ( unsigned )x && list->y == ( unsigned )y ) return list ;
-        list = list->next ;
+static int path_get( int * x, int * y ) {
+    if ( path_result_pointer ) {
+        ( *x ) = *path_result_pointer++ ;
+        ( *y ) = *path_result_pointer++ ;
+        if ( *path_result_pointer == -1 ) path_result_pointer = NULL ;
+        return 1 ;
     }
-    return NULL ;
+    return 0 ;
 }
 
 /* --------------------------------------------------------------------------- */
 
-static node * node_new( node * parent, int x, int y, int cost_inc ) {
-    node * curr ;
+static int path_set_wall( int n ) {
+    if ( n >= 1 ) {
+        block_if = n ;
+    }
+    return block_if ;
+}
+
+/* --------------------------------------------------------------------------- */
+/* Path requests                                                               */
+/* --------------------------------------------------------------------------- */
 
-    curr = ( node * ) malloc( sizeof( node ) ) ;
-    if ( !curr ) return NULL ;
+/* Requests are solved in order by the frame hook, one at a time, on their own
+ * search workspace. The running search is suspended when the per frame budget
+ * runs out and resumed next frame. Handles are slot index + 1 in the low
+ * bits and the slot generation above, so a handle freed and reused by
+ * another request is rejected. The requests of each process are linked
+ * from its _mod_path_reserved.requests local.
+ */
 
-    curr->x = x ;
-    curr->y = y ;
-    curr->g = ( parent ? parent->g : 0 ) + cost_inc ;
-    curr->h = heuristic( x, y ) ;
-    curr->f = curr->g + curr->h ;
+#define PATH_HANDLE_BITS        20
+#define PATH_HANDLE_SLOTS       ( ( 1 << PATH_HANDLE_BITS ) - 1 )
+#define PATH_HANDLE_GENERATIONS 0x7FF
 
-    curr->parent = parent ;
-    curr->next   = NULL ;
-    return curr ;
+#define PATH_HANDLE(n,gen)      ( ( ( gen ) << PATH_HANDLE_BITS ) | ( ( n ) + 1 ) )
+
+typedef struct
+{
+    int used ;
+    int generation ;
+    int owner ;                     /* Process id, requests die with their owner */
+    int next_owned, prev_owned ;    /* Handles of the owner's other requests */
+    int file, graph ;
+    int sx, sy, dx, dy ;
+    int options ;
+    int wall ;
+    int status ;
+    int expanded ;
+    int * result ;
+    int * pointer ;
+} path_request ;
+
+static path_request * requests = NULL ;
+static int requests_allocated = 0 ;
+
+static int * queue = NULL ;
+static int queue_head = 0 ;
+static int queue_count = 0 ;
+static int queue_allocated = 0 ;
+
+static pf_search queue_search = { 0 } ;
+static int queue_active = -1 ;
+
+static int path_budget = 2000 ;     /* Microseconds per frame */
+
+#define PF_QUEUE_STEPS  64          /* Nodes expanded between clock checks */
+
+/* --------------------------------------------------------------------------- */
+
+static path_request * path_request_get( int handle ) {
+    int n = ( handle & PATH_HANDLE_SLOTS ) - 1 ;
+
+    if ( handle < 1 || n < 0 || n >= requests_allocated || !requests[n].used ||
+         PATH_HANDLE( n, requests[n].generation ) != handle ) return NULL ;
+    return &requests[n] ;
 }
 
 /* --------------------------------------------------------------------------- */
 
-static void node_push_succesor( node * parent, int ix, int iy, int cost ) {
-    node * curr, * f_op, * f_cl ;
+static int path_request_new( INSTANCE * my, int file, int graph, int sx, int sy, int dx, int dy, int options ) {
+    path_request * r ;
+    int n, handle, head = 0 ;
 
-    curr = node_new( parent, parent->x + ix, parent->y + iy, cost ) ;
-    if ( curr->h > 131072 )
+    for ( n = 0 ; n < requests_allocated ; n++ ) if ( !requests[n].used ) break ;
+
+    if ( n == requests_allocated )
     {
-        free( curr ); return ;
+        int allocated = requests_allocated ? requests_allocated * 2 : 32 ;
+        path_request * p ;
+        if ( requests_allocated >= PATH_HANDLE_SLOTS ) return 0 ;
+        if ( allocated > PATH_HANDLE_SLOTS ) allocated = PATH_HANDLE_SLOTS ;
+        p = realloc( requests, allocated * sizeof( path_request ) ) ;
+        if ( !p ) return 0 ;
+        memset( p + requests_allocated, 0, ( allocated - requests_allocated ) * sizeof( path_request ) ) ;
+        requests = p ;
+        requests_allocated = allocated ;
     }
 
-    f_cl = node_find( pf_closed, curr->x, curr->y ) ;
-    if ( f_cl )
+    if ( queue_head + queue_count >= queue_allocated )
     {
-        free( curr ); return ;
+        if ( queue_head )
+        {
+            memmove( queue, queue + queue_head, queue_count * sizeof( int ) ) ;
+            queue_head = 0 ;
+        }
+        if ( queue_count >= queue_allocated )
+        {
+            int allocated = queue_allocated ? queue_allocated * 2 : 32 ;
+            int * q = realloc( queue, allocated * sizeof( int ) ) ;
+            if ( !q ) return 0 ;
+            queue = q ;
+            queue_allocated = allocated ;
+        }
     }
 
-    f_op = node_find( pf_open, curr->x, curr->y ) ;
-    if ( f_op && f_op->f <= curr->f )
+    r = &requests[n] ;
+    handle = PATH_HANDLE( n, r->generation ) ;
+    r->used = 1 ;
+    r->owner = my ? LOCDWORD( mod_path, my, PROCESS_ID ) : 0 ;
+
+    /* Clones inherit the father's list head, it belongs to them only if the
+       request is theirs */
+    if ( my )
     {
-        free( curr ); return ;
+        path_request * h = path_request_get( LOCDWORD( mod_path, my, PATH_REQUESTS ) ) ;
+        if ( h && h->owner == r->owner )
+        {
+            head = LOCDWORD( mod_path, my, PATH_REQUESTS ) ;
+            h->prev_owned = handle ;
+        }
+        LOCDWORD( mod_path, my, PATH_REQUESTS ) = handle ;
     }
+    r->next_owned = head ;
+    r->prev_owned = 0 ;
+    r->file = file ;
+    r->graph = graph ;
+    r->sx = sx ;
+    r->sy = sy ;
+    r->dx = dx ;
+    r->dy = dy ;
+    r->options = options ;
+    r->wall = block_if ;
+    r->status = PF_PENDING ;
+    r->expanded = 0 ;
+    r->result = NULL ;
+    r->pointer = NULL ;
+
+    queue[queue_head + queue_count++] = handle ;
+
+    return handle ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Handles still in the queue are skipped when they are reached */
 
-    /* Add to general list (used for free resources)*/
-    curr->inext = pf_all; pf_all = curr;
+static void path_request_free( int handle ) {
+    path_request * r = path_request_get( handle ), * o ;
+    INSTANCE * owner ;
 
-    if ( f_op ) { pf_open = node_remove( pf_open, f_op ); } /* this node is removed but childs that referent this node as parent will be wrong */
-/* this can't be possible, previous "if ( f_cl )" abort this code ->   if ( f_cl ) { pf_closed = node_remove( pf_closed, f_cl ); }*/ /* this node is removed but childs that referent this node as parent will be wrong */
+    if ( !r ) return ;
 
-    pf_open = node_add( pf_open, curr ) ;
+    if ( ( o = path_request_get( r->next_owned ) ) ) o->prev_owned = r->prev_owned ;
+    if ( ( o = path_request_get( r->prev_owned ) ) )
+        o->next_owned = r->next_owned ;
+    else if ( r->owner && ( owner = instance_get( r->owner ) ) && LOCDWORD( mod_path, owner, PATH_REQUESTS ) == handle )
+        LOCDWORD( mod_path, owner, PATH_REQUESTS ) = r->next_owned ;
+
+    if ( queue_active == handle ) queue_active = -1 ;
+    if ( r->result ) free( r->result ) ;
+    r->result = r->pointer = NULL ;
+    r->used = 0 ;
+    r->generation = ( r->generation + 1 ) & PATH_HANDLE_GENERATIONS ;
 }
 
 /* --------------------------------------------------------------------------- */
 
-static void node_push_succesors( node * parent, int options ) {
-    node * prior = parent->parent ;
-    if ( !prior ) prior = parent ;
-
-    node_push_succesor( parent, 1, 0, prior->x < parent->x ? 9 : 10 ) ;
-    node_push_succesor( parent, 0, 1, prior->x > parent->x ? 9 : 10 ) ;
-    node_push_succesor( parent, -1, 0, prior->y < parent->y ? 9 : 10 ) ;
-    node_push_succesor( parent, 0, -1, prior->y > parent->y ? 9 : 10 ) ;
+static void path_request_done( path_request * r, int found ) {
+    path_expanded = r->expanded += queue_search.expanded ;
 
-    if ( !( options & PF_NODIAG ) )
+    if ( found >= 0 && ( r->result = pf_search_result( &queue_search, found ) ) )
     {
-        node_push_succesor( parent, 1, 1, 12 ) ;
-        node_push_succesor( parent, -1, -1, 12 ) ;
-        node_push_succesor( parent, -1, 1, 12 ) ;
-        node_push_succesor( parent, 1, -1, 12 ) ;
+        r->pointer = r->result ;
+        r->status = PF_FOUND ;
     }
+    else
+        r->status = PF_NOTFOUND ;
 }
 
 /* --------------------------------------------------------------------------- */
 
-static int path_find( GRAPH * bitmap, int sx, int sy, int dx, int dy, int options ) {
-    node * curr, * inext ;
-
-    startup_x = sx ;
-    startup_y = sy ;
-    map = bitmap ;
-    destination_x = dx ;
-    destination_y = dy ;
+static void path_queue_pop() {
+    queue_head++ ;
+    if ( !--queue_count ) queue_head = 0 ;
+}
 
-    /* Release all resources */
+/* --------------------------------------------------------------------------- */
 
-    curr = pf_all;
-    while ( curr )
-    {
-        inext = curr->inext ;
-        free( curr ) ;
-        curr = inext ;
-    }
-    pf_all = NULL;
+static void path_queue_hook() {
+    Uint64 limit ;
+    path_request * r ;
+    GRAPH * gpath ;
+    hpa_map * h ;
+    int found, update, rebuilt ;
 
-    pf_open = NULL;
-    pf_closed = NULL;
+    if ( queue_active < 0 && !queue_count ) return ;
 
-    if ( path_result ) { free ( path_result ); path_result = NULL; }
-    path_result_pointer = NULL;
+    limit = SDL_GetPerformanceCounter() + ( Uint64 )path_budget * SDL_GetPerformanceFrequency() / 1000000 ;
 
-    curr = node_new( NULL, startup_x, startup_y, 0 ) ;
+    for ( ;; )
+    {
+        if ( queue_active < 0 )
+        {
+            if ( !queue_count ) break ;
 
-    /* Add to general list (used for free resources)*/
-    curr->inext = pf_all; pf_all = curr;
+            r = path_request_get( queue[queue_head] ) ;
+            if ( !r || r->status != PF_PENDING )
+            {
+                path_queue_pop() ;
+                continue ;
+            }
 
-    curr->f = curr->h = 1 ;
-    pf_open = node_add( pf_open, curr ) ;
+            gpath = bitmap_get( r->file, r->graph ) ;
+            if ( !gpath || !gpath->format || gpath->format->depth != 8 )
+            {
+                path_queue_pop() ;
+                r->status = PF_NOTFOUND ;
+                path_expanded = 0 ;
+                continue ;
+            }
 
-    while ( pf_open ) {
-        curr = pf_open ;
-        pf_open = node_remove( pf_open, curr ) ;
+            /* Rebuilding the hierarchy after a map change is charged to the
+               budget too, the request stays first in the queue until the
+               rebuild is done. Hierarchical searches are short enough to
+               finish here, but only start them with some budget left */
+            if ( ( h = hpa_usable( gpath, r->sx, r->sy, r->dx, r->dy, r->wall ) ) )
+            {
+                rebuilt = h->dirty ;
+                update = hpa_update( h, limit ) ;
+                if ( update < 0 || ( rebuilt && SDL_GetPerformanceCounter() >= limit ) ) break ;
+
+                hpa_expanded = 0 ;
+                r->result = update ? hpa_find( h, r->sx, r->sy, r->dx, r->dy, r->options ) : NULL ;
+                r->expanded = hpa_expanded ;
+
+                if ( r->result )
+                {
+                    path_queue_pop() ;
+                    r->pointer = r->result ;
+                    r->status = PF_FOUND ;
+                    path_expanded = r->expanded ;
+                    if ( SDL_GetPerformanceCounter() >= limit ) break ;
+                    continue ;
+                }
+            }
 
-        if ( curr->x == ( unsigned )destination_x && curr->y == ( unsigned )destination_y ) {
-            int count = 1 ;
+            path_queue_pop() ;
 
-            found = curr ;
-            while ( curr->parent ) {
-                count++ ;
-                curr = curr->parent ;
+            if ( !pf_search_start( &queue_search, gpath, r->sx, r->sy, r->dx, r->dy, r->options, r->wall ) )
+            {
+                r->status = PF_NOTFOUND ;
+                path_expanded = r->expanded ;
+                continue ;
             }
 
-            path_result = malloc( sizeof( int ) * 2 * ( count + 4 ) ) ;
-            if ( !( options & PF_REVERSE ) ) {
-                path_result_pointer = path_result + count * 2 + 1;
-                *path_result_pointer-- = -1 ;
-                *path_result_pointer-- = -1 ;
-                while ( found ) {
-                    *path_result_pointer-- = found->y ;
-                    *path_result_pointer-- = found->x ;
-                    found = found->parent ;
-                }
+            queue_active = PATH_HANDLE( r - requests, r->generation ) ;
+        }
 
-                if ( path_result_pointer != path_result - 1 ) {
-                    path_result_pointer = NULL;
-                    return 0;
-                }
-            } else {
-                path_result_pointer = path_result ;
-                while ( found ) {
-                    *path_result_pointer++ = found->x ;
-                    *path_result_pointer++ = found->y ;
-                    found = found->parent ;
-                }
-                *path_result_pointer++ = -1 ;
-                *path_result_pointer++ = -1 ;
-            }
+        r = path_request_get( queue_active ) ;
 
-            path_result_pointer = path_result ;
-            return 1 ;
+        /* The map may have been unloaded while the search was suspended */
+        if ( !( gpath = bitmap_get( r->file, r->graph ) ) || gpath != queue_search.map )
+        {
+            path_request_done( r, -1 ) ;
+            queue_active = -1 ;
+            continue ;
         }
 
-        node_push_succesors( curr, options ) ;
+        found = pf_search_run( &queue_search, PF_QUEUE_STEPS ) ;
+        if ( found != PF_SEARCH_RUNNING )
+        {
+            path_request_done( r, found ) ;
+            queue_active = -1 ;
+        }
 
-        pf_closed = node_add( pf_closed, curr ) ;
+        if ( SDL_GetPerformanceCounter() >= limit ) break ;
     }
-
-    return 0 ;
 }
 
 /* --------------------------------------------------------------------------- */
 
-static int path_get( int * x, int * y ) {
-    if ( path_result_pointer ) {
-        ( *x ) = *path_result_pointer++ ;
-        ( *y ) = *path_result_pointer++ ;
-        if ( *path_result_pointer == -1 ) path_result_pointer = NULL ;
+static int path_request_getxy( int handle, int * x, int * y ) {
+    path_request * r = path_request_get( handle ) ;
+
+    if ( r && r->pointer ) {
+        ( *x ) = *r->pointer++ ;
+        ( *y ) = *r->pointer++ ;
+        if ( *r->pointer == -1 ) r->pointer = NULL ;
         return 1 ;
     }
     return 0 ;
 }
 
-/* --------------------------------------------------------------------------- */
-
-static int path_set_wall( int n ) {
-    if ( n >= 1 ) {
-        block_if = n ;
-    }
-    return block_if ;
-}
-
 /* --------------------------------------------------------------------------- */
 /* Funciones de búsqueda de caminos */
 
@@ -364,6 +1548,68 @@ static int modpathfind_path_wall( INSTANCE * my, int * params ) {
 
 /* --------------------------------------------------------------------------- */
 
+static int modpathfind_path_request( INSTANCE * my, int * params ) {
+    return path_request_new( my, params[0], params[1], params[2], params[3], params[4], params[5], params[6] ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static int modpathfind_path_status( INSTANCE * my, int * params ) {
+    path_request * r = path_request_get( params[0] ) ;
+    return r ? r->status : -1 ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static int modpathfind_path_get_handle_xy( INSTANCE * my, int * params ) {
+    return path_request_getxy( params[0], ( int * )params[1], ( int * )params[2] ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static int modpathfind_path_free( INSTANCE * my, int * params ) {
+    if ( !path_request_get( params[0] ) ) return 0 ;
+    path_request_free( params[0] ) ;
+    return 1 ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static int modpathfind_path_budget( INSTANCE * my, int * params ) {
+    int old = path_budget ;
+    if ( params[0] >= 0 ) path_budget = params[0] ;
+    return old ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static int modpathfind_path_hierarchy( INSTANCE * my, int * params ) {
+    GRAPH * gpath = bitmap_get( params[0], params[1] ) ;
+    if ( !gpath || !gpath->format || gpath->format->depth != 8 ) {
+        return 0;
+    }
+    return hpa_create( gpath, params[2] ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static int modpathfind_path_invalidate( INSTANCE * my, int * params ) {
+    GRAPH * gpath = bitmap_get( params[0], params[1] ) ;
+    hpa_map * h ;
+
+    if ( !gpath || !( h = hpa_get( gpath ) ) ) return 0 ;
+    hpa_invalidate( h, 0, 0, gpath->width - 1, gpath->height - 1 ) ;
+    return 1 ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static int modpathfind_path_expanded( INSTANCE * my, int * params ) {
+    return path_expanded ;
+}
+
+/* --------------------------------------------------------------------------- */
+
 DLSYSFUNCS __bgdexport( mod_path, functions_exports )[] =
 {
     /* Búsqueda de caminos*/
@@ -371,11 +1617,55 @@ DLSYSFUNCS __bgdexport( mod_path, functions_exports )[] =
     { "PATH_GETXY"  , "PP"     , TYPE_INT   , modpathfind_path_getxy    },
     { "PATH_WALL"   , "I"      , TYPE_INT   , modpathfind_path_wall     },
 
+    { "PATH_REQUEST"        , "IIIIIII", TYPE_INT   , modpathfind_path_request          },
+    { "PATH_STATUS"         , "I"      , TYPE_INT   , modpathfind_path_status           },
+    { "PATH_GET_HANDLE_XY"  , "IPP"    , TYPE_INT   , modpathfind_path_get_handle_xy    },
+    { "PATH_FREE"           , "I"      , TYPE_INT   , modpathfind_path_free             },
+    { "PATH_BUDGET"         , "I"      , TYPE_INT   , modpathfind_path_budget           },
+
+    { "PATH_HIERARCHY"      , "III"    , TYPE_INT   , modpathfind_path_hierarchy        },
+    { "PATH_INVALIDATE"     , "II"     , TYPE_INT   , modpathfind_path_invalidate       },
+    { "PATH_EXPANDED"       , ""       , TYPE_INT   , modpathfind_path_expanded         },
+
     { 0             , 0        , 0          , 0                         }
 };
 
 /* --------------------------------------------------------------------------- */
 
+/* Bigest priority first execute
+   Lowest priority last execute */
+
+HOOK __bgdexport( mod_path, handler_hooks )[] =
+{
+    { 9600, path_queue_hook },
+    {    0, NULL            }
+} ;
+
+/* --------------------------------------------------------------------------- */
+
+void __bgdexport( mod_path, module_initialize )()
+{
+    bitmap_add_change_hook( hpa_map_changed ) ;
+}
+
+/* --------------------------------------------------------------------------- */
+
+void __bgdexport( mod_path, instance_destroy_hook )( INSTANCE * r )
+{
+    int id = LOCDWORD( mod_path, r, PROCESS_ID ), handle, next ;
+    path_request * p ;
+
+    /* Only the requests linked from this instance, see path_request_new() */
+    for ( handle = LOCDWORD( mod_path, r, PATH_REQUESTS ) ; ( p = path_request_get( handle ) ) && p->owner == id ; handle = next )
+    {
+        next = p->next_owned ;
+        path_request_free( handle ) ;
+    }
+    LOCDWORD( mod_path, r, PATH_REQUESTS ) = 0 ;
+}
+
+/* --------------------------------------------------------------------------- */
+
 char * __bgdexport( mod_path, modules_dependency )[] =
 {
     "libgrbase",
@@ -34,11 +34,23 @@
 #define PF_NODIAG       1
 #define PF_REVERSE      2
 
+#define PF_NOTFOUND     0
+#define PF_FOUND        1
+#define PF_PENDING      2
+
 #ifdef __PXTB__
+char __bgdexport( mod_path, locals_def )[] =
+    "STRUCT _mod_path_reserved\n"
+    "int requests;\n"
+    "END\n";
+
 DLCONSTANT __bgdexport( mod_path, constants_def )[] =
 {
     { "PF_NODIAG"   , TYPE_INT, PF_NODIAG   },
     { "PF_REVERSE"  , TYPE_INT, PF_REVERSE  },
+    { "PF_NOTFOUND" , TYPE_INT, PF_NOTFOUND },
+    { "PF_FOUND"    , TYPE_INT, PF_FOUND    },
+    { "PF_PENDING"  , TYPE_INT, PF_PENDING  },
     { NULL          , 0       , 0           }
 } ;
 
@@ -48,6 +60,14 @@ DLSYSFUNCS __bgdexport( mod_path, functions_exports )[] =
     { "PATH_FIND"   , "IIIIIII", TYPE_INT   , 0 },
     { "PATH_GETXY"  , "PP"     , TYPE_INT   , 0 },
     { "PATH_WALL"   , "I"      , TYPE_INT   , 0 },
+    { "PATH_REQUEST"        , "IIIIIII", TYPE_INT   , 0 },
+    { "PATH_STATUS"         , "I"      , TYPE_INT   , 0 },
+    { "PATH_GET_HANDLE_XY"  , "IPP"    , TYPE_INT   , 0 },
+    { "PATH_FREE"           , "I"      , TYPE_INT   , 0 },
+    { "PATH_BUDGET"         , "I"      , TYPE_INT   , 0 },
+    { "PATH_HIERARCHY"      , "III"    , TYPE_INT   , 0 },
+    { "PATH_INVALIDATE"     , "II"     , TYPE_INT   , 0 },
+    { "PATH_EXPANDED"       , ""       , TYPE_INT   , 0 },
     { 0             , 0        , 0          , 0 }
 };
 
@@ -57,8 +77,13 @@ char * __bgdexport( mod_path, modules_dependency )[] =
     NULL
 };
 #else
+extern char __bgdexport( mod_path, locals_def )[];
 extern DLCONSTANT __bgdexport( mod_path, constants_def )[];
+extern DLVARFIXUP __bgdexport( mod_path, locals_fixup )[];
 extern DLSYSFUNCS __bgdexport( mod_path, functions_exports )[];
+extern HOOK __bgdexport( mod_path, handler_hooks )[];
+extern void __bgdexport( mod_path, module_initialize )();
+extern void __bgdexport( mod_path, instance_destroy_hook )( INSTANCE * r );
 extern char * __bgdexport( mod_path, modules_dependency )[];
 #endif
 
@@ -67,6 +67,10 @@
 #define S_DFL               0
 #define S_IGN               1
 
+#define INSTANCES_CREATED   0
+#define INSTANCES_RECYCLED  1
+#define INSTANCES_POOLED    2
+
 #define SMASK_KILL          0x0001
 #define SMASK_WAKEUP        0x0002
 #define SMASK_SLEEP         0x0004
@@ -121,6 +125,10 @@ DLCONSTANT __bgdexport( mod_proc, constants_def )[] =
 
     { "ALL_PROCESS"         , TYPE_INT, ALL_PROCESS         },
 
+    { "INSTANCES_CREATED"   , TYPE_INT, INSTANCES_CREATED   },
+    { "INSTANCES_RECYCLED"  , TYPE_INT, INSTANCES_RECYCLED  },
+    { "INSTANCES_POOLED"    , TYPE_INT, INSTANCES_POOLED    },
+
     { NULL                  , 0       , 0                   }
 } ;
 
@@ -169,6 +177,7 @@ static void _modproc_kill_all()
     while ( i )
     {
         LOCDWORD( mod_proc, i, STATUS ) = STATUS_KILLED ;
+        instance_status_changed( i ) ;
         i = i->next ;
     }
 }
@@ -338,6 +347,8 @@ static int modproc_signal( INSTANCE * my, int * params )
                 default:
                     return 1 ;
             }
+
+            instance_status_changed( i ) ;
         }
 
         if ( params[1] >= S_TREE )
@@ -514,7 +525,10 @@ static int modproc_let_me_alone( INSTANCE * my, int * params )
     while ( i )
     {
         if ( i != my && ( LOCDWORD( mod_proc, i, STATUS ) & ~STATUS_WAITING_MASK ) != STATUS_DEAD )
+        {
             LOCDWORD( mod_proc, i, STATUS ) = ( LOCDWORD( mod_proc, i, STATUS ) & STATUS_WAITING_MASK ) | STATUS_KILLED ;
+            instance_status_changed( i ) ;
+        }
         i = i->next ;
     }
     if ( LOCDWORD( mod_proc, my, STATUS ) > STATUS_KILLED ) LOCDWORD( mod_proc, my, STATUS ) = STATUS_RUNNING;
@@ -585,6 +599,65 @@ static int modproc_get_status( INSTANCE * my, int * params )
     return LOCDWORD( mod_proc, i, STATUS ) ;
 }
 
+/* ----------------------------------------------------------------- */
+
+/*
+ *  FUNCTION : modproc_instance_stats
+ *
+ *  Returns one of the counters of the instance allocator
+ *
+ *  PARAMS :
+ *      params[0]       INSTANCES_CREATED: memory blocks allocated
+ *                      INSTANCES_RECYCLED: instances that reused a block
+ *                      INSTANCES_POOLED: free blocks waiting to be reused
+ *
+ *  RETURN VALUE :
+ *      Value of the counter, or -1 if unknown
+ */
+
+static int modproc_instance_stats( INSTANCE * my, int * params )
+{
+    switch ( params[0] )
+    {
+        case INSTANCES_CREATED:
+            return instance_created ;
+
+        case INSTANCES_RECYCLED:
+            return instance_recycled ;
+
+        case INSTANCES_POOLED:
+            return instance_pooled ;
+    }
+
+    return -1 ;
+}
+
+/* ----------------------------------------------------------------- */
+
+/*
+ *  FUNCTION : modproc_set_pure
+ *
+ *  Marks the processes of a type as pure: when the interpreter runs with
+ *  worker threads, their instances are executed in parallel at the start
+ *  of every frame. Pure processes can only use their own variables and
+ *  thread-safe functions (math, rand, advance...), and no strings.
+ *
+ *  PARAMS :
+ *      params[0]       Process type
+ *      params[1]       1 to mark it as pure, 0 to unmark it
+ *
+ *  RETURN VALUE :
+ *      1 if the process is pure now, 0 otherwise
+ */
+
+static int modproc_set_pure( INSTANCE * my, int * params )
+{
+    PROCDEF * proc ;
+
+    if ( params[0] <= 0 || params[0] >= FIRST_INSTANCE_ID || !( proc = procdef_get( params[0] ) ) ) return 0 ;
+    return instance_set_pure( proc, params[1] ) ;
+}
+
 /* ---------------------------------------------------------------------- */
 
 DLSYSFUNCS __bgdexport( mod_proc, functions_exports )[] =
@@ -600,6 +673,8 @@ DLSYSFUNCS __bgdexport( mod_proc, functions_exports )[] =
     { "EXIT"            , "S"   , TYPE_INT , modproc_exit_1          },
     { "EXIT"            , ""    , TYPE_INT , modproc_exit_0          },
     { "EXISTS"          , "I"   , TYPE_INT , modproc_running         },
+    { "INSTANCE_STATS"  , "I"   , TYPE_INT , modproc_instance_stats  },
+    { "SET_PURE"        , "II"  , TYPE_INT , modproc_set_pure        },
     { 0                 , 0     , 0        , 0                       }
 };
 
@@ -53,6 +53,9 @@
 #define S_FREEZE_TREE_FORCE (S_FORCE + S_FREEZE_TREE)
 #define S_DFL               0
 #define S_IGN               1
+#define INSTANCES_CREATED   0
+#define INSTANCES_RECYCLED  1
+#define INSTANCES_POOLED    2
 
 DLCONSTANT __bgdexport( mod_proc, constants_def )[] =
 {
@@ -77,6 +80,9 @@ DLCONSTANT __bgdexport( mod_proc, constants_def )[] =
     { "S_DFL"               , TYPE_INT, S_DFL               },
     { "S_IGN"               , TYPE_INT, S_IGN               },
     { "ALL_PROCESS"         , TYPE_INT, ALL_PROCESS         },
+    { "INSTANCES_CREATED"   , TYPE_INT, INSTANCES_CREATED   },
+    { "INSTANCES_RECYCLED"  , TYPE_INT, INSTANCES_RECYCLED  },
+    { "INSTANCES_POOLED"    , TYPE_INT, INSTANCES_POOLED    },
     { NULL                  , 0       , 0                   }
 } ;
 
@@ -101,6 +107,8 @@ DLSYSFUNCS __bgdexport( mod_proc, functions_exports )[] =
     { "EXIT"            , "S"   , TYPE_INT , 0 },
     { "EXIT"            , ""    , TYPE_INT , 0 },
     { "EXISTS"          , "I"   , TYPE_INT , 0 },
+    { "INSTANCE_STATS"  , "I"   , TYPE_INT , 0 },
+    { "SET_PURE"        , "II"  , TYPE_INT , 0 },
     { 0                 , 0     , 0        , 0 }
 };
 #else
@@ -30,13 +30,85 @@
 #include <stdlib.h>
 
 #include "bgddl.h"
+#include "dlvaracc.h"
 #include "fmath.h"
 
 /* ---------------------------------------------------------------------- */
 
+enum
+{
+    PROCESS_ID = 0,
+    RAND_STATE,
+    RAND_SERIAL,
+    RAND_OWNER
+} ;
+
+/* ---------------------------------------------------------------------- */
+
+char * __bgdexport( mod_rand, locals_def ) =
+    "STRUCT mod_rand_reserved\n"
+    "   dword state;\n"
+    "   int serial;\n"
+    "   int owner;\n"
+    "END\n";
+
+/* ---------------------------------------------------------------------- */
+
+DLVARFIXUP __bgdexport( mod_rand, locals_fixup )[]  =
+{
+    /* Nombre de variable local, offset al dato, tamaño del elemento, cantidad de elementos */
+    { "id", NULL, -1, -1 },
+    { "mod_rand_reserved.state", NULL, -1, -1 },
+    { "mod_rand_reserved.serial", NULL, -1, -1 },
+    { "mod_rand_reserved.owner", NULL, -1, -1 },
+    { NULL, NULL, -1, -1 }
+};
+
+/* ---------------------------------------------------------------------- */
+
+/* rand() state is shared, so pure processes running in worker threads
+ * use a generator of their own for each instance. It is derived from the
+ * RAND_SEED value and the process id, so the results don't depend on the
+ * thread that runs each instance. The state is derived again after every
+ * RAND_SEED, and in clones, which start with a copy of their father's */
+
+#define INSTANCE_RAND_MAX   0x7fffffff
+
+static uint32_t rand_base   = 1 ;
+static int      rand_serial = 1 ;
+
+static int instance_rand( INSTANCE * my )
+{
+    uint32_t x = LOCDWORD( mod_rand, my, RAND_STATE ) ;
+    int id = LOCINT32( mod_rand, my, PROCESS_ID ) ;
+
+    if ( !x || LOCINT32( mod_rand, my, RAND_SERIAL ) != rand_serial || LOCINT32( mod_rand, my, RAND_OWNER ) != id )
+    {
+        x = rand_base ^ ( ( uint32_t ) id * 0x9E3779B9 ) ;
+        x ^= x >> 16 ; x *= 0x85EBCA6B ;
+        x ^= x >> 13 ; x *= 0xC2B2AE35 ;
+        x ^= x >> 16 ;
+        if ( !x ) x = 0x9E3779B9 ;
+
+        LOCINT32( mod_rand, my, RAND_SERIAL ) = rand_serial ;
+        LOCINT32( mod_rand, my, RAND_OWNER ) = id ;
+    }
+
+    x ^= x << 13 ;
+    x ^= x >> 17 ;
+    x ^= x << 5 ;
+    LOCDWORD( mod_rand, my, RAND_STATE ) = x ;
+
+    return ( int )( x & INSTANCE_RAND_MAX ) ;
+}
+
+/* ---------------------------------------------------------------------- */
+
 static int rand_seed( INSTANCE * my, int * params )
 {
     srand( params[0] ) ;
+    rand_base = ( uint32_t ) params[0] ;
+    rand_serial++ ;
     return 1 ;
 }
 
@@ -48,6 +120,14 @@ static int rand_std( INSTANCE * my, int * params )
     int num2 = MAX( params[0], params[1] ) ;
     int var = num2 - num1 + 1;
 
+    if ( my && my->parallel )
+    {
+        if ( var > INSTANCE_RAND_MAX || var <= 0 )
+            return num1 + instance_rand( my ) * ((( double ) var ) / INSTANCE_RAND_MAX );
+        else
+            return num1 + instance_rand( my ) % var;
+    }
+
     if ( var > RAND_MAX )
         return num1 + rand() * ((( double ) var ) / RAND_MAX );
     else
@@ -60,7 +140,7 @@ static int rand_std( INSTANCE * my, int * params )
 DLSYSFUNCS  __bgdexport( mod_rand, functions_exports )[] =
 {
     { "RAND_SEED"   , "I"   , TYPE_INT  , rand_seed     },
-    { "RAND"        , "II"  , TYPE_INT  , rand_std      },
+    { "RAND"        , "II"  , TYPE_INT  , rand_std      , SYSFUNC_THREADSAFE },
     { 0             , 0     , 0         , 0             }
 };
 
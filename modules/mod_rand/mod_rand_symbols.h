@@ -32,6 +32,13 @@
 #include <bgddl.h>
 
 #ifdef __PXTB__
+char __bgdexport( mod_rand, locals_def )[] =
+    "STRUCT mod_rand_reserved\n"
+    "   dword state;\n"
+    "   int serial;\n"
+    "   int owner;\n"
+    "END\n";
+
 DLSYSFUNCS  __bgdexport( mod_rand, functions_exports )[] =
 {
     { "RAND_SEED"   , "I"   , TYPE_INT  , 0 },
@@ -39,6 +46,8 @@ DLSYSFUNCS  __bgdexport( mod_rand, functions_exports )[] =
     { 0             , 0     , 0         , 0 }
 };
 #else
+extern char __bgdexport( mod_rand, locals_def )[];
+extern DLVARFIXUP __bgdexport( mod_rand, locals_fixup )[];
 extern DLSYSFUNCS  __bgdexport( mod_rand, functions_exports )[];
 #endif
 
@@ -47,6 +47,18 @@ static int mod_scroll_start2( INSTANCE * my, int * params )
     return 1 ;
 }
 
+static int mod_scroll_start_tilemap( INSTANCE * my, int * params )
+{
+    scroll_start_tilemap( params[0], params[1], ( int32_t * ) params[2], params[3], params[4], params[5], params[6], params[7], params[8], params[9], 0, 0 ) ;
+    return 1 ;
+}
+
+static int mod_scroll_start_tilemap2( INSTANCE * my, int * params )
+{
+    scroll_start_tilemap( params[0], params[1], ( int32_t * ) params[2], params[3], params[4], params[5], params[6], params[7], params[8], params[9], params[10], params[11] ) ;
+    return 1 ;
+}
+
 static int mod_scroll_stop( INSTANCE * my, int * params )
 {
     scroll_stop( params[0] ) ;
@@ -73,6 +85,11 @@ DLSYSFUNCS __bgdexport( mod_scroll, functions_exports )[] =
     { "STOP_SCROLL"     , "I"       , TYPE_INT   , mod_scroll_stop    },
     { "MOVE_SCROLL"     , "I"       , TYPE_INT   , mod_scroll_move    },
 
+    { "TILEMAP_START"   , "IIPIIIIIIIII", TYPE_INT , mod_scroll_start_tilemap2 },
+    { "TILEMAP_START"   , "IIPIIIIIII", TYPE_INT   , mod_scroll_start_tilemap  },
+    { "START_TILEMAP"   , "IIPIIIIIIIII", TYPE_INT , mod_scroll_start_tilemap2 },
+    { "START_TILEMAP"   , "IIPIIIIIII", TYPE_INT   , mod_scroll_start_tilemap  },
+
     { 0                 , 0         , 0          , 0                  }
 };
 
@@ -43,6 +43,11 @@ DLSYSFUNCS __bgdexport( mod_scroll, functions_exports )[] =
     { "START_SCROLL"    , "IIIIII"  , TYPE_INT   , 0 },
     { "STOP_SCROLL"     , "I"       , TYPE_INT   , 0 },
     { "MOVE_SCROLL"     , "I"       , TYPE_INT   , 0 },
+
+    { "TILEMAP_START"   , "IIPIIIIIIIII", TYPE_INT , 0 },
+    { "TILEMAP_START"   , "IIPIIIIIII", TYPE_INT   , 0 },
+    { "START_TILEMAP"   , "IIPIIIIIIIII", TYPE_INT , 0 },
+    { "START_TILEMAP"   , "IIPIIIIIII", TYPE_INT   , 0 },
     
     { 0                 , 0         , 0          , 0 }
     
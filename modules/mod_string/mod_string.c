@@ -44,8 +44,7 @@
 
 static int modstring_strlen( INSTANCE * my, int * params )
 {
-    const char * str = string_get( params[0] ) ;
-    int r = str ? strlen( str ) : 0 ;
+    int r = string_length( params[0] ) ;
     string_discard( params[0] ) ;
     return r ;
 }
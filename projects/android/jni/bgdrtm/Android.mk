@@ -86,6 +86,8 @@ LOCAL_SRC_FILES := \
 	../../../../core/bgdrtm/src/sysprocs.c \
 	../../../../core/bgdrtm/src/varspace_file.c \
 	../../../../core/bgdrtm/src/fmath.c \
+	../../../../core/bgdrtm/src/workers.c \
+	../../../../core/bgdrtm/src/profiler.c \
 	../../../../core/common/debug.c \
 	../../../../core/common/files.c \
 	../../../../core/common/xctype.c \
@@ -104,6 +106,7 @@ LOCAL_SRC_FILES := \
 	../../../../modules/mod_proc/mod_proc.c \
 	../../../../modules/mod_sort/mod_sort.c \
 	../../../../modules/mod_timers/mod_timers.c \
+	../../../../modules/libgrbase/g_atlas.c \
 	../../../../modules/libgrbase/g_bitmap.c \
 	../../../../modules/libgrbase/g_clear.c \
 	../../../../modules/libgrbase/g_grlib.c \
@@ -111,7 +114,9 @@ LOCAL_SRC_FILES := \
 	../../../../modules/libgrbase/g_blendop.c \
 	../../../../modules/libgrbase/g_conversion.c \
 	../../../../modules/libgrbase/libgrbase.c \
+	../../../../modules/libblit/g_batch.c \
 	../../../../modules/libblit/g_blit.c \
+	../../../../modules/libblit/g_blit_simd.c \
 	../../../../modules/libblit/g_pixel.c \
 	../../../../modules/libblit/libblit.c \
 	../../../../modules/libvideo/g_regions.c \